@@ -0,0 +1,418 @@
+/**
+ * @file llbvhloader_libtest.cpp
+ * @brief Benchmark and output consistency check for the BVH animation importer
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+
+// Linden library includes
+#include "llapr.h"
+#include "llbvhloader.h"
+#include "lldatapacker.h"
+#include "lldir.h"
+#include "llfile.h"
+#include "llrand.h"
+#include "lltimer.h"
+#include "llxmltree.h"
+
+// system libraries
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllbvhloader_libtest [options] [file.bvh ...]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -d, --data <dir>\n"
+"        Viewer data directory containing app_settings/anim.ini and character/avatar_skeleton.xml.\n"
+"        Default is ../newview relative to the working directory.\n"
+" -f, --frames <n>\n"
+"        Number of frames in the generated clip used when no BVH files are given. Default is 6000.\n"
+" -n, --iterations <n>\n"
+"        Number of times each file is imported. Default is 5.\n"
+" -t, --threads <n>\n"
+"        Number of threads for the parallel key reduction (0 = automatic). Default is 0.\n"
+"\n"
+"Imports each BVH file (or a generated long mocap clip covering the whole skeleton) with\n"
+"the key reduction running serially and in parallel, and checks that both produce the same\n"
+"serialized animation byte for byte. Every frame line is also run through the frame value\n"
+"parser and the boost::tokenizer + boost::lexical_cast code it replaced to check that both\n"
+"accept the same lines and produce the same floats. Reports timings and returns non-zero\n"
+"on any mismatch.\n"
+"\n";
+
+//
+// Skeleton helpers
+//
+
+// Same mapping as LLAvatarAppearance::makeJointAliases() (every bone maps to itself and to each of its aliases)
+static void add_bone_aliases(LLXmlTreeNode* bone_node, std::map<std::string, std::string>& alias_map, std::vector<std::pair<LLXmlTreeNode*, S32> >& bones, S32 depth)
+{
+	std::string bone_name, aliases;
+	bone_node->getAttributeString("name", bone_name);
+	alias_map[bone_name] = bone_name;
+	if (bone_node->getAttributeString("aliases", aliases))
+	{
+		std::istringstream alias_stream(aliases);
+		std::string alias;
+		while (alias_stream >> alias)
+		{
+			alias_map[alias] = bone_name;
+		}
+	}
+	bones.push_back(std::make_pair(bone_node, depth));
+
+	for (LLXmlTreeNode* child = bone_node->getFirstChild(); child; child = bone_node->getNextChild())
+	{
+		if (child->hasName("bone"))
+		{
+			add_bone_aliases(child, alias_map, bones, depth + 1);
+		}
+	}
+}
+
+//
+// Writes a long clip animating every bone of the skeleton (roughly what a full body mocap export looks like)
+//
+static std::string generate_clip(const std::vector<std::pair<LLXmlTreeNode*, S32> >& bones, S32 num_frames)
+{
+	std::ostringstream bvh;
+	bvh << "HIERARCHY\n";
+
+	S32 prev_depth = -1;
+	for (U32 idx = 0; idx < bones.size(); idx++)
+	{
+		LLXmlTreeNode* bone_node = bones[idx].first;
+		const S32 depth = bones[idx].second;
+		for (; prev_depth >= depth; prev_depth--)
+		{
+			bvh << std::string(prev_depth, '\t') << "}\n";
+		}
+
+		std::string bone_name;
+		bone_node->getAttributeString("name", bone_name);
+		const std::string indent(depth, '\t');
+		if (0 == idx)
+		{
+			bvh << "ROOT hip\n{\n\tOFFSET 0.00 0.00 0.00\n\tCHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n";
+		}
+		else
+		{
+			bvh << indent << "JOINT " << bone_name << "\n" << indent << "{\n"
+			    << indent << "\tOFFSET 0.00 1.00 0.00\n" << indent << "\tCHANNELS 3 Zrotation Xrotation Yrotation\n";
+		}
+
+		const bool is_leaf = (idx + 1 == bones.size()) || (bones[idx + 1].second <= depth);
+		if (is_leaf)
+		{
+			bvh << indent << "\tEnd Site\n" << indent << "\t{\n" << indent << "\t\tOFFSET 0.00 1.00 0.00\n" << indent << "\t}\n";
+		}
+		prev_depth = depth;
+	}
+	for (; prev_depth >= 0; prev_depth--)
+	{
+		bvh << std::string(prev_depth, '\t') << "}\n";
+	}
+
+	bvh << "MOTION\nFrames: " << num_frames << "\nFrame Time: 0.033333\n";
+
+	// Smooth motion with a little capture noise and the mix of number formats exporters produce
+	bvh << std::setprecision(6);
+	for (S32 frame = 0; frame < num_frames; frame++)
+	{
+		const F32 t = frame / 30.f;
+		bvh << 0.5f * sinf(t * 0.3f) << " " << 43.f + 2.f * sinf(t * 2.f) << " " << t * 0.1f;
+		for (U32 idx = 0; idx < bones.size(); idx++)
+		{
+			for (S32 channel = 0; channel < 3; channel++)
+			{
+				const F32 angle = 25.f * sinf(t * (0.5f + 0.1f * channel) + idx) + 0.05f * (ll_frand() - 0.5f);
+				if (0 == (frame + idx + channel) % 7)
+					bvh << "\t" << std::scientific << angle << std::defaultfloat;
+				else
+					bvh << ((channel) ? " " : "\t") << angle;
+			}
+		}
+		bvh << "\r\n";
+	}
+	return bvh.str();
+}
+
+//
+// Frame value parsing checks
+//
+
+// The parsing LLBVHLoader::loadBVHFile() did before LLBVHLoader::parseFrameValues()
+static bool parse_frame_values_reference(const std::string& line, std::vector<F32>& values)
+{
+	typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+	boost::char_separator<char> whitespace_sep("\t ");
+	tokenizer float_tokens(line, whitespace_sep);
+
+	values.clear();
+	for (tokenizer::iterator float_token_iter = float_tokens.begin(); float_token_iter != float_tokens.end(); ++float_token_iter)
+	{
+		try
+		{
+			values.push_back(boost::lexical_cast<float>(*float_token_iter));
+		}
+		catch (const boost::bad_lexical_cast&)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool check_frame_line(const std::string& line)
+{
+	std::vector<F32> values, ref_values;
+	const bool success = LLBVHLoader::parseFrameValues(line.c_str(), line.c_str() + line.size(), values);
+	const bool ref_success = parse_frame_values_reference(line, ref_values);
+	if (success != ref_success)
+	{
+		return false;
+	}
+	// Compare bit patterns so NaN payloads and signed zeros count too
+	return (!success) || ( (values.size() == ref_values.size()) && (values.empty() || 0 == memcmp(&values[0], &ref_values[0], values.size() * sizeof(F32))) );
+}
+
+// Returns the frame lines of a BVH file (everything after "Frame Time:")
+static std::vector<std::string> get_frame_lines(const std::string& bvh)
+{
+	std::vector<std::string> lines;
+
+	size_t pos = bvh.find("Frame Time:");
+	if (std::string::npos == pos)
+	{
+		return lines;
+	}
+	pos = bvh.find_first_of("\r\n", pos);
+	while (std::string::npos != pos)
+	{
+		const size_t line_begin = bvh.find_first_not_of("\r\n", pos);
+		if (std::string::npos == line_begin)
+			break;
+		pos = bvh.find_first_of("\r\n", line_begin);
+		lines.push_back(bvh.substr(line_begin, (std::string::npos != pos) ? pos - line_begin : std::string::npos));
+	}
+	return lines;
+}
+
+//
+// Import helpers
+//
+
+struct LLImportResult
+{
+	ELoadStatus		mStatus;
+	S32				mErrorLine;
+	std::vector<U8>	mOutput;
+	F64				mSeconds;
+};
+
+static void import_bvh(const std::string& bvh, std::map<std::string, std::string>& alias_map, U32 thread_count, S32 iterations, LLImportResult& result)
+{
+	LLBVHLoader::setOptimizeThreadCount(thread_count);
+
+	LLTimer timer;
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		LLBVHLoader loader(bvh.c_str(), result.mStatus, result.mErrorLine, alias_map);
+		if (i + 1 < iterations)
+		{
+			continue;
+		}
+		result.mSeconds = timer.getElapsedTimeF64() / iterations;
+
+		result.mOutput.clear();
+		if (loader.isInitialized())
+		{
+			result.mOutput.resize(loader.getOutputSize());
+			LLDataPackerBinaryBuffer dp(&result.mOutput[0], (S32)result.mOutput.size());
+			loader.serialize(dp);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string data_dir = "../newview";
+	S32 num_frames = 6000;
+	S32 iterations = 5;
+	U32 thread_count = 0;
+	std::vector<std::string> files;
+
+	// Init whatever is necessary
+	ll_init_apr();
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--data") || !strcmp(argv[arg], "-d")) && arg < argc-1)
+		{
+			data_dir = argv[++arg];
+		}
+		else if ((!strcmp(argv[arg], "--frames") || !strcmp(argv[arg], "-f")) && arg < argc-1)
+		{
+			num_frames = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--iterations") || !strcmp(argv[arg], "-n")) && arg < argc-1)
+		{
+			iterations = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--threads") || !strcmp(argv[arg], "-t")) && arg < argc-1)
+		{
+			thread_count = llmax(0, atoi(argv[++arg]));
+		}
+		else
+		{
+			files.push_back(argv[arg]);
+		}
+	}
+
+	// LLBVHLoader picks up anim.ini from the app settings directory
+	gDirUtilp->initAppDirs("SecondLife", data_dir);
+
+	LLXmlTree xml_tree;
+	if (!xml_tree.parseFile(gDirUtilp->add(data_dir, "character/avatar_skeleton.xml"), FALSE))
+	{
+		std::cout << "Error: unable to parse avatar_skeleton.xml in " << data_dir << std::endl;
+		return 1;
+	}
+
+	std::map<std::string, std::string> alias_map;
+	std::vector<std::pair<LLXmlTreeNode*, S32> > bones;
+	LLXmlTreeNode* root = xml_tree.getRoot();
+	for (LLXmlTreeNode* bone_node = root->getChildByName("bone"); bone_node; bone_node = root->getNextNamedChild())
+	{
+		add_bone_aliases(bone_node, alias_map, bones, 0);
+	}
+
+	int result = 0;
+
+	// Tokens at the edges of what the old parser accepted
+	static const char* EDGE_LINES[] = {
+		"0 -0 +1 1. .5 -.5 1e3 1E-3 1e+3 -1.5e-07", "1e", "1e+", "1-", "+", "-", ".", "0x1p3", "0X10", "1.5f", "1,5",
+		"inf -inf +INF Infinity nan NAN -nan nan(123)", "1e39", "-1e39", "1e-46", "3.4028235e38", "\t 1 \t 2\t", "", "abc", "1.2.3", "--1",
+	};
+	for (const char* line : EDGE_LINES)
+	{
+		if (!check_frame_line(line))
+		{
+			std::cout << "Error: frame value parser disagrees with the reference on \"" << line << "\"" << std::endl;
+			result = 1;
+		}
+	}
+
+	std::vector<std::pair<std::string, std::string> > inputs;
+	if (files.empty())
+	{
+		std::ostringstream name;
+		name << "generated (" << bones.size() << " joints, " << num_frames << " frames)";
+		inputs.push_back(std::make_pair(name.str(), generate_clip(bones, num_frames)));
+	}
+	for (const std::string& file_name : files)
+	{
+		std::ifstream in_file(file_name.c_str(), std::ios::binary);
+		if (!in_file)
+		{
+			std::cout << "Error: unable to open " << file_name << std::endl;
+			result = 1;
+			continue;
+		}
+		std::ostringstream contents;
+		contents << in_file.rdbuf();
+		inputs.push_back(std::make_pair(file_name, contents.str()));
+	}
+
+	std::cout << std::setw(12) << "threads" << std::setw(12) << "ms/import" << std::setw(12) << "bytes" << std::setw(12) << "parse ms" << std::setw(12) << "ref ms" << std::endl;
+	for (const auto& input : inputs)
+	{
+		std::cout << input.first << std::endl;
+
+		// Frame value parsing against the code it replaced
+		const std::vector<std::string> frame_lines = get_frame_lines(input.second);
+		U32 num_mismatches = 0;
+		for (const std::string& line : frame_lines)
+		{
+			if (!check_frame_line(line))
+			{
+				if (0 == num_mismatches++)
+				{
+					std::cout << "Error: frame value parser disagrees with the reference on \"" << line.substr(0, 80) << "\"" << std::endl;
+				}
+				result = 1;
+			}
+		}
+
+		std::vector<F32> values;
+		LLTimer parse_timer;
+		for (const std::string& line : frame_lines)
+		{
+			LLBVHLoader::parseFrameValues(line.c_str(), line.c_str() + line.size(), values);
+		}
+		const F64 parse_ms = parse_timer.getElapsedTimeF64() * 1000.0;
+
+		LLTimer ref_timer;
+		for (const std::string& line : frame_lines)
+		{
+			parse_frame_values_reference(line, values);
+		}
+		const F64 ref_ms = ref_timer.getElapsedTimeF64() * 1000.0;
+
+		// Serial and parallel key reduction have to produce the same animation
+		LLImportResult serial, parallel;
+		import_bvh(input.second, alias_map, 1, iterations, serial);
+		import_bvh(input.second, alias_map, thread_count, iterations, parallel);
+
+		std::cout << std::setw(12) << 1 << std::setw(12) << std::fixed << std::setprecision(2) << serial.mSeconds * 1000.0 << std::setw(12) << serial.mOutput.size()
+		          << std::setw(12) << parse_ms << std::setw(12) << ref_ms << std::endl;
+		std::cout << std::setw(12) << LLBVHLoader::getOptimizeThreadCount() << std::setw(12) << parallel.mSeconds * 1000.0 << std::setw(12) << parallel.mOutput.size() << std::endl;
+
+		if (E_ST_OK != serial.mStatus)
+		{
+			std::cout << "Error: import failed with status " << serial.mStatus << " on line " << serial.mErrorLine << std::endl;
+			result = 1;
+		}
+		if ( (serial.mStatus != parallel.mStatus) || (serial.mOutput != parallel.mOutput) )
+		{
+			std::cout << "Error: serial and parallel key reduction produced different output" << std::endl;
+			result = 1;
+		}
+	}
+
+	// Cleanup and exit
+	return result;
+}
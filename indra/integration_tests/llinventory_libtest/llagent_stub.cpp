@@ -0,0 +1,43 @@
+/**
+ * @file llagent_stub.cpp
+ * @brief Stub agent globals to allow benchmarking LLInventoryModel outside of the viewer
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llagent.h"
+#include "llvoavatarself.h"
+
+// There is no agent (or region) outside of the viewer; the inventory owner is all the benchmark needs
+
+LLAgent gAgent;
+LLUUID gAgentID;
+LLUUID gAgentSessionID;
+LLPointer<LLVOAvatarSelf> gAgentAvatarp = NULL;
+
+LLAgent::LLAgent() : mFirstLogin(FALSE), mAgentAccess(NULL) { }
+LLAgent::~LLAgent() { }
+LLViewerRegion* LLAgent::getRegion() const { return NULL; }
+void LLAgent::sendReliableMessage() { }
+
+void dump_sequential_xml(const std::string outprefix, const LLSD& content) { }
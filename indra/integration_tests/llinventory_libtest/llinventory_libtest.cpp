@@ -0,0 +1,564 @@
+/**
+ * @file llinventory_libtest.cpp
+ * @brief Stress benchmark of the inventory model: cache serialization, traversal, filtering and update storms
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+
+// Linden library includes
+#include "lldir.h"
+#include "llformat.h"
+#include "llinventory.h"
+#include "llinventorytype.h"
+#include "llpermissions.h"
+#include "llsaleinfo.h"
+#include "llsd.h"
+#include "lltimer.h"
+
+// Viewer sources (the parts of the viewer they call into are stubbed out in the *_stub.cpp files)
+#include "llagent.h"
+#include "llinventorycache.h"
+#include "llinventoryfilter.h"
+#include "llinventoryfunctions.h"
+#include "llinventorymodel.h"
+#include "llviewercontrol.h"
+#include "llviewerinventory.h"
+
+// system libraries
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <set>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllinventory_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -i, --items <n>\n"
+"        Number of items in the generated inventory. Default is 500000.\n"
+" -f, --folders <n>\n"
+"        Number of folders in the generated inventory. Default is 10000.\n"
+" -d, --depth <n>\n"
+"        Depth of the deepest folder chain. Default is 32.\n"
+" -u, --updates <n>\n"
+"        Number of item updates in each update storm. Default is 100000.\n"
+" -c, --cache-dir <dir>\n"
+"        Directory the inventory cache is written to and read back from. Default is the\n"
+"        current directory; the cache file is removed afterwards.\n"
+"\n"
+"Generates a synthetic inventory (wide and deep folders, links, many wearables) and times\n"
+"the viewer's own inventory code on it: LLInventoryModel loading it from the binary cache\n"
+"(loadSkeleton() and buildParentChildMap() like a login does), collectDescendentsIf(),\n"
+"LLInventoryFilter::collectNameMatches() both by scanning and through the name index,\n"
+"storms of renames and moves through updateItem() and the cache() calls that follow them.\n"
+"Reports the time and the heap growth of each step and the peak heap size overall. Checks\n"
+"that the model and the cache reproduce the inventory and that both filter paths agree\n"
+"and returns non-zero on any mismatch. Heap figures only cover allocations made through\n"
+"this executable's operator new.\n"
+"\n";
+
+//
+// Heap accounting
+//
+
+static std::atomic<U64> sHeapBytes(0);
+static std::atomic<U64> sHeapPeakBytes(0);
+
+// Keeps the requested size in front of each block (16 bytes to preserve the alignment of the block handed out)
+static const size_t HEAP_HEADER_SIZE = 16;
+
+void* operator new(size_t size)
+{
+	void* ptr = malloc(size + HEAP_HEADER_SIZE);
+	if (!ptr)
+	{
+		throw std::bad_alloc();
+	}
+	*static_cast<size_t*>(ptr) = size;
+
+	const U64 heap_bytes = (sHeapBytes += size);
+	U64 peak_bytes = sHeapPeakBytes;
+	while ( (heap_bytes > peak_bytes) && (!sHeapPeakBytes.compare_exchange_weak(peak_bytes, heap_bytes)) )
+	{
+	}
+	return static_cast<char*>(ptr) + HEAP_HEADER_SIZE;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr)
+	{
+		char* block = static_cast<char*>(ptr) - HEAP_HEADER_SIZE;
+		sHeapBytes -= *reinterpret_cast<size_t*>(block);
+		free(block);
+	}
+}
+
+//
+// Inventory generation
+//
+
+typedef LLInventoryModel::cat_array_t cat_array_t;
+typedef LLInventoryModel::item_array_t item_array_t;
+
+static LLUUID make_id(U32 kind, U32 idx)
+{
+	return LLUUID(llformat("%08x-%04x-4%03x-8000-%012x", idx * 2654435761U, kind, idx & 0xFFF, idx));
+}
+
+static const char* ITEM_WORDS[] = { "Red", "Mesh", "Hair", "Shirt", "Boots", "Gloves", "Skin", "Shape", "Eyes", "Tattoo",
+                                    "Jacket", "Dress", "Hud", "Ring", "Chair", "Tree", "Light", "Door", "Texture", "Script" };
+
+// Folder 0 is the root; the first depth folders form a single chain below it and the rest are spread out underneath
+static void generate_inventory(S32 num_items, S32 num_folders, S32 depth, const LLUUID& owner_id, cat_array_t& cats, item_array_t& items)
+{
+	cats.reserve(num_folders);
+	for (S32 idx = 0; idx < num_folders; idx++)
+	{
+		LLUUID parent_id;
+		if ( (idx > 0) && (idx <= depth) )
+			parent_id = make_id(2, idx - 1);
+		else if (idx > depth)
+			parent_id = make_id(2, (U32)((idx * 7919U) % idx));
+		// buildParentChildMap() only settles on a root folder named "My Inventory"
+		LLPointer<LLViewerInventoryCategory> cat = (idx == 0)
+			? new LLViewerInventoryCategory(make_id(2, idx), parent_id, LLFolderType::FT_ROOT_INVENTORY, "My Inventory", owner_id)
+			: new LLViewerInventoryCategory(make_id(2, idx), parent_id, LLFolderType::FT_NONE,
+			                                llformat("Folder %s %d", ITEM_WORDS[idx % LL_ARRAY_SIZE(ITEM_WORDS)], idx), owner_id);
+		// Only folders with a known version get cached
+		cat->setVersion(1 + idx % 5);
+		cats.push_back(cat);
+	}
+
+	items.reserve(num_items);
+	for (S32 idx = 0; idx < num_items; idx++)
+	{
+		LLAssetType::EType type; LLInventoryType::EType inv_type; U32 flags = 0;
+		LLUUID asset_id = make_id(5, idx);
+		switch (idx % 10)
+		{
+			case 0:
+			case 1:
+				{
+					// Links to an earlier clothing item (as COF, outfits and RLV shared folders are full of); links to links
+					// would be broken
+					U32 target_idx = (U32)((idx * 104729U) % llmax(idx, 1));
+					if (target_idx % 10 < 2)
+						target_idx = target_idx - target_idx % 10 + 2;
+					type = LLAssetType::AT_LINK;
+					inv_type = LLInventoryType::IT_WEARABLE;
+					asset_id = make_id(3, target_idx % (U32)num_items);
+				}
+				break;
+			case 2:
+			case 3:
+			case 4:
+				type = LLAssetType::AT_CLOTHING;
+				inv_type = LLInventoryType::IT_WEARABLE;
+				flags = 4 + idx % 10;
+				break;
+			case 5:
+				type = LLAssetType::AT_BODYPART;
+				inv_type = LLInventoryType::IT_WEARABLE;
+				flags = idx % 4;
+				break;
+			case 6:
+				type = LLAssetType::AT_TEXTURE;
+				inv_type = LLInventoryType::IT_TEXTURE;
+				break;
+			case 7:
+				type = LLAssetType::AT_NOTECARD;
+				inv_type = LLInventoryType::IT_NOTECARD;
+				break;
+			default:
+				type = LLAssetType::AT_OBJECT;
+				inv_type = LLInventoryType::IT_OBJECT;
+				break;
+		}
+
+		LLPermissions perms;
+		perms.init(make_id(4, idx % 97), owner_id, (idx % 3) ? LLUUID::null : make_id(4, idx % 89), LLUUID::null);
+		perms.initMasks(PERM_ALL, (idx % 5) ? PERM_ALL : PERM_ALL & ~PERM_MODIFY, PERM_NONE, PERM_NONE, (idx % 3) ? PERM_MOVE | PERM_TRANSFER : PERM_ALL);
+
+		// Folders get items in proportion to where they are so some end up much larger than others
+		const U32 folder_idx = (U32)((idx * 2654435761U) % (U32)num_folders) % ((idx % 7) ? (U32)num_folders : (U32)llmin(num_folders, 64));
+		items.push_back(new LLViewerInventoryItem(make_id(3, idx), make_id(2, folder_idx), perms, asset_id, type, inv_type,
+		                                    llformat("%s %s %d", ITEM_WORDS[idx % LL_ARRAY_SIZE(ITEM_WORDS)], ITEM_WORDS[(idx / 7) % LL_ARRAY_SIZE(ITEM_WORDS)], idx),
+		                                    (idx % 4) ? std::string() : llformat("(No Description) %d", idx),
+		                                    LLSaleInfo::DEFAULT, flags, 1400000000 + idx * 37));
+	}
+}
+
+// The inventory skeleton the login response carries
+static LLSD build_skeleton(const cat_array_t& cats)
+{
+	LLSD skeleton = LLSD::emptyArray();
+	for (const LLViewerInventoryCategory* cat : cats)
+	{
+		LLSD folder;
+		folder["name"] = cat->getName();
+		folder["folder_id"] = cat->getUUID();
+		folder["parent_id"] = cat->getParentUUID();
+		folder["version"] = cat->getVersion();
+		folder["type_default"] = (S32)cat->getPreferredType();
+		skeleton.append(folder);
+	}
+	return skeleton;
+}
+
+//
+// Verification
+//
+
+// Checks that gInventory holds exactly the given folders and items (links resolve through the model so the stored fields
+// are compared rather than what the getters return)
+static bool verify_model(const LLUUID& root_id, const cat_array_t& cats, const item_array_t& items)
+{
+	cat_array_t model_cats; item_array_t model_items;
+	gInventory.collectDescendents(root_id, model_cats, model_items, LLInventoryModel::INCLUDE_TRASH);
+	if ( (cats.size() != model_cats.size() + 1) || (items.size() != model_items.size()) )
+	{
+		std::cout << "Error: expected " << cats.size() << " folders and " << items.size() << " items, the inventory model holds "
+		          << model_cats.size() + 1 << " and " << model_items.size() << std::endl;
+		return false;
+	}
+	for (const LLViewerInventoryCategory* cat : cats)
+	{
+		const LLViewerInventoryCategory* model_cat = gInventory.getCategory(cat->getUUID());
+		if ( (!model_cat) || (cat->getName() != model_cat->getName()) || (cat->getParentUUID() != model_cat->getParentUUID()) ||
+		     (cat->getVersion() != model_cat->getVersion()) || (cat->getPreferredType() != model_cat->getPreferredType()) )
+		{
+			std::cout << "Error: folder " << cat->getUUID() << " differs" << std::endl;
+			return false;
+		}
+	}
+	for (const LLViewerInventoryItem* item : items)
+	{
+		const LLViewerInventoryItem* model_item = gInventory.getItem(item->getUUID());
+		if ( (!model_item) || (item->LLInventoryItem::getName() != model_item->LLInventoryItem::getName()) ||
+		     (item->getParentUUID() != model_item->getParentUUID()) || (item->LLInventoryItem::getType() != model_item->LLInventoryItem::getType()) ||
+		     (item->LLInventoryItem::getAssetUUID() != model_item->LLInventoryItem::getAssetUUID()) || (item->getPermissions() != model_item->getPermissions()) ||
+		     (item->LLInventoryItem::getDescription() != model_item->LLInventoryItem::getDescription()) )
+		{
+			std::cout << "Error: item " << item->getUUID() << " differs" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+//
+// Traversal and filtering
+//
+
+// Wearables and links to them, like the COF and outfit collectors use
+class LLIsWearableCollector : public LLInventoryCollectFunctor
+{
+public:
+	bool operator()(LLInventoryCategory* cat, LLInventoryItem* item) override
+	{
+		return (item) && ((item->getType() == LLAssetType::AT_CLOTHING) || (item->getType() == LLAssetType::AT_BODYPART));
+	}
+};
+
+// Everything the filter matches by name below the given root, the way the inventory panel asks for it while searching
+static std::set<LLUUID> collect_name_matches(LLInventoryFilter& filter, const LLUUID& root_id, bool use_name_index)
+{
+	gSavedSettings.setBOOL("InventoryNameIndex", use_name_index);
+
+	uuid_vec_t object_ids;
+	filter.collectNameMatches(uuid_vec_t(1, root_id), object_ids);
+	return std::set<LLUUID>(object_ids.begin(), object_ids.end());
+}
+
+//
+// Update storms
+//
+
+// The viewer notifies observers once per inventory message and frame rather than per item
+static const S32 UPDATES_PER_NOTIFY = 100;
+
+// Applies a rename and/or a move the way the viewer does once the server confirmed it
+static void update_item(const LLUUID& item_id, const std::string& name, const LLUUID& parent_id)
+{
+	const LLViewerInventoryItem* item = gInventory.getItem(item_id);
+	if (!item)
+	{
+		return;
+	}
+
+	LLPointer<LLViewerInventoryItem> new_item = new LLViewerInventoryItem(item);
+	new_item->rename(name);
+	if (item->getParentUUID() != parent_id)
+	{
+		LLInventoryModel::update_list_t update;
+		update.push_back(LLInventoryModel::LLCategoryUpdate(item->getParentUUID(), -1));
+		update.push_back(LLInventoryModel::LLCategoryUpdate(parent_id, 1));
+		gInventory.accountForUpdate(update);
+		new_item->setParent(parent_id);
+	}
+	gInventory.updateItem(new_item);
+}
+
+//
+// Benchmark helpers
+//
+
+struct LLBenchStep
+{
+	LLBenchStep(const char* name) : mName(name), mHeapBytes(sHeapBytes) { }
+	~LLBenchStep()
+	{
+		const S64 heap_delta = (S64)sHeapBytes - (S64)mHeapBytes;
+		std::cout << std::setw(34) << std::left << mName << std::right << std::fixed << std::setprecision(2)
+		          << std::setw(12) << mTimer.getElapsedTimeF64() * 1000.0 << std::setw(14) << heap_delta / 1024 << std::setw(14);
+		if (mCount >= 0)
+			std::cout << mCount << std::endl;
+		else
+			std::cout << "-" << std::endl;
+	}
+
+	const char*	mName;
+	U64			mHeapBytes;
+	LLTimer		mTimer;
+	S64			mCount = -1;
+};
+
+int main(int argc, char** argv)
+{
+	S32 num_items = 500000;
+	S32 num_folders = 10000;
+	S32 depth = 32;
+	S32 num_updates = 100000;
+	std::string cache_dir = ".";
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--items") || !strcmp(argv[arg], "-i")) && arg < argc-1)
+		{
+			num_items = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--folders") || !strcmp(argv[arg], "-f")) && arg < argc-1)
+		{
+			num_folders = llmax(2, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--depth") || !strcmp(argv[arg], "-d")) && arg < argc-1)
+		{
+			depth = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--updates") || !strcmp(argv[arg], "-u")) && arg < argc-1)
+		{
+			num_updates = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--cache-dir") || !strcmp(argv[arg], "-c")) && arg < argc-1)
+		{
+			cache_dir = argv[++arg];
+		}
+		else
+		{
+			std::cout << "Error: unknown argument " << argv[arg] << std::endl << USAGE << std::endl;
+			return 1;
+		}
+	}
+	depth = llmin(depth, num_folders - 1);
+
+	// Set up what the viewer would have by the time the inventory skeleton arrives
+	if (!gDirUtilp->setCacheDir(cache_dir))
+	{
+		std::cout << "Error: unable to write to " << cache_dir << std::endl;
+		return 1;
+	}
+	gSavedSettings.declareBOOL("InventoryCacheBinary", TRUE, "Use the binary inventory cache", LLControlVariable::PERSIST_NO);
+	gSavedSettings.declareBOOL("InventoryNameIndex", TRUE, "Use the name index to filter inventory", LLControlVariable::PERSIST_NO);
+
+	int result = 0;
+	const LLUUID owner_id = make_id(1, 0);
+	const LLUUID root_id = make_id(2, 0);
+	const std::string cache_file = LLInventoryModel::getInvBinaryCacheAddres(owner_id);
+	gAgentID = owner_id;
+	gInventory.setRootFolderID(root_id);
+
+	std::cout << llformat("Synthetic inventory: %d folders (chain depth %d), %d items", num_folders, depth, num_items) << std::endl;
+	std::cout << std::setw(34) << std::left << "step" << std::right << std::setw(12) << "ms" << std::setw(14) << "heap KB" << std::setw(14) << "count" << std::endl;
+
+	cat_array_t cats; item_array_t items;
+	{
+		LLBenchStep step("generate");
+		generate_inventory(num_items, num_folders, depth, owner_id, cats, items);
+		step.mCount = cats.size() + items.size();
+	}
+
+	{
+		LLBenchStep step("LLInventoryCache::save");
+		if (!LLInventoryCache::instance().save(cache_file, cats, items))
+		{
+			std::cout << "Error: unable to write " << cache_file << std::endl;
+			return 1;
+		}
+		step.mCount = cats.size() + items.size();
+	}
+
+	// Everything from here on works off the cache like a login does
+	const LLSD skeleton = build_skeleton(cats);
+	{
+		LLBenchStep step("LLInventoryModel::loadSkeleton");
+		gInventory.loadSkeleton(skeleton, owner_id);
+	}
+
+	{
+		LLBenchStep step("buildParentChildMap");
+		gInventory.buildParentChildMap();
+	}
+	if ( (!gInventory.isInventoryUsable()) || (!verify_model(root_id, cats, items)) )
+	{
+		std::cout << "Error: the inventory model didn't load what was cached" << std::endl;
+		result = 1;
+	}
+	cats.clear();
+	items.clear();
+
+	{
+		LLBenchStep step("collectDescendentsIf");
+		for (int pass = 0; pass < 5; pass++)
+		{
+			cat_array_t found_cats; item_array_t found_items;
+			LLIsWearableCollector is_wearable;
+			gInventory.collectDescendentsIf(root_id, found_cats, found_items, LLInventoryModel::INCLUDE_TRASH, is_wearable);
+			step.mCount = found_items.size();
+		}
+	}
+
+	// A full scan of the model versus going through the name index for the same search terms
+	LLInventoryFilter filter;
+	filter.setFilterSubString("shirt|red");
+
+	std::set<LLUUID> scan_matches;
+	{
+		LLBenchStep step("collectNameMatches (scan)");
+		scan_matches = collect_name_matches(filter, root_id, false);
+		step.mCount = scan_matches.size();
+	}
+
+	std::set<LLUUID> index_matches;
+	{
+		LLBenchStep step("collectNameMatches (name index)");
+		index_matches = collect_name_matches(filter, root_id, true);
+		step.mCount = index_matches.size();
+	}
+	if (scan_matches != index_matches)
+	{
+		std::cout << "Error: name index returned " << index_matches.size() << " matches, scanning found " << scan_matches.size() << std::endl;
+		result = 1;
+	}
+
+	{
+		LLBenchStep step("updateItem storm (rename)");
+		for (S32 idx = 0; idx < num_updates; idx++)
+		{
+			const U32 item_idx = (U32)((idx * 2654435761U) % (U32)num_items);
+			if (const LLInventoryItem* item = gInventory.getItem(make_id(3, item_idx)))
+				update_item(item->getUUID(), llformat("Renamed %s %d", ITEM_WORDS[idx % LL_ARRAY_SIZE(ITEM_WORDS)], idx), item->getParentUUID());
+			if (0 == (idx + 1) % UPDATES_PER_NOTIFY)
+				gInventory.notifyObservers();
+		}
+		gInventory.notifyObservers();
+		step.mCount = num_updates;
+	}
+
+	{
+		LLBenchStep step("updateItem storm (move)");
+		for (S32 idx = 0; idx < num_updates; idx++)
+		{
+			const U32 item_idx = (U32)((idx * 40503U) % (U32)num_items);
+			if (const LLInventoryItem* item = gInventory.getItem(make_id(3, item_idx)))
+				update_item(item->getUUID(), item->LLInventoryItem::getName(), make_id(2, (U32)(idx % num_folders)));
+			if (0 == (idx + 1) % UPDATES_PER_NOTIFY)
+				gInventory.notifyObservers();
+		}
+		gInventory.notifyObservers();
+		step.mCount = num_updates;
+	}
+
+	// The storms touched nearly every folder so caching rewrites the cache while a handful of changes afterwards only
+	// append a segment
+	{
+		LLBenchStep step("LLInventoryModel::cache (storm)");
+		gInventory.cache(root_id, owner_id);
+	}
+
+	{
+		LLBenchStep step("updateItem (few)");
+		for (S32 idx = 0; idx < 100; idx++)
+		{
+			if (const LLInventoryItem* item = gInventory.getItem(make_id(3, (U32)((idx * 7U) % (U32)num_items))))
+				update_item(item->getUUID(), llformat("Touched %s %d", ITEM_WORDS[idx % LL_ARRAY_SIZE(ITEM_WORDS)], idx), item->getParentUUID());
+		}
+		gInventory.notifyObservers();
+		step.mCount = 100;
+	}
+
+	{
+		LLBenchStep step("LLInventoryModel::cache (few)");
+		gInventory.cache(root_id, owner_id);
+	}
+
+	{
+		cat_array_t cached_cats; item_array_t cached_items;
+		{
+			LLBenchStep step("LLInventoryCache::load (segments)");
+			LLInventoryModel::changed_items_t cats_to_update; bool is_cache_obsolete = false;
+			if (!LLInventoryCache::instance().load(cache_file, cached_cats, cached_items, cats_to_update, is_cache_obsolete))
+			{
+				std::cout << "Error: unable to read " << cache_file << std::endl;
+				result = 1;
+			}
+			step.mCount = cached_cats.size() + cached_items.size();
+		}
+		if (!verify_model(root_id, cached_cats, cached_items))
+		{
+			std::cout << "Error: the cache doesn't match the inventory model" << std::endl;
+			result = 1;
+		}
+	}
+	LLInventoryCache::instance().remove(cache_file);
+
+	{
+		LLBenchStep step("cleanupInventory");
+		gInventory.cleanupInventory();
+	}
+
+	std::cout << "Peak heap: " << sHeapPeakBytes / (1024 * 1024) << " MB" << std::endl;
+
+	// Cleanup and exit
+	return result;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file llinventorybridge_stub.cpp
+ * @brief Stub folder view classes to allow benchmarking LLInventoryFilter outside of the viewer
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llinventorybridge.h"
+#include "llinventorypanel.h"
+
+// No folder views are ever created outside of the viewer; the filter only needs the classes it casts its items to
+
+//
+// LLFolderViewModelItemCommon
+//
+
+bool LLFolderViewModelItemCommon::hasFilterStringMatch() { return !mStringMatchOffsets.empty(); }
+int LLFolderViewModelItemCommon::getFilterStringMatchCount() const { return mStringMatchOffsets.size(); }
+filter_stringmatch_results_t::value_type LLFolderViewModelItemCommon::getFilterStringMatchOffset(int index) const { return std::make_pair(0, 0); }
+const filter_stringmatch_results_t& LLFolderViewModelItemCommon::getFilterStringMatchOffsets() const { return mStringMatchOffsets; }
+std::string::size_type LLFolderViewModelItemCommon::getFilterStringSize() { return 0; }
+
+//
+// LLFolderViewModelItemInventory
+//
+
+void LLFolderViewModelItemInventory::requestSort() { }
+void LLFolderViewModelItemInventory::setPassedFilter(bool passed, S32 filter_generation, filter_stringmatch_results_t& match_offsets, std::string::size_type string_size) { }
+bool LLFolderViewModelItemInventory::filter(LLFolderViewFilter& filter) { return false; }
+bool LLFolderViewModelItemInventory::filterChildItem(LLFolderViewModelItem* item, LLFolderViewFilter& filter) { return false; }
+
+//
+// LLInvFVBridge
+//
+
+const std::string& LLInvFVBridge::getName() const { return mDisplayName; }
+const std::string& LLInvFVBridge::getDisplayName() const { return mDisplayName; }
+const std::string& LLInvFVBridge::getDescription() const { return LLStringUtil::null; }
+PermissionMask LLInvFVBridge::getPermissionMask() const { return PERM_NONE; }
+LLFolderType::EType LLInvFVBridge::getPreferredType() const { return LLFolderType::FT_NONE; }
+const LLUUID& LLInvFVBridge::getCreatorUUID() const { return LLUUID::null; }
+time_t LLInvFVBridge::getCreationDate() const { return 0; }
+void LLInvFVBridge::setCreationDate(time_t creation_date_utc) { }
+void LLInvFVBridge::showProperties() { }
+BOOL LLInvFVBridge::isItemRemovable() const { return FALSE; }
+BOOL LLInvFVBridge::isItemMovable() const { return FALSE; }
+BOOL LLInvFVBridge::isItemInTrash() const { return FALSE; }
+BOOL LLInvFVBridge::isLink() const { return FALSE; }
+BOOL LLInvFVBridge::isLibraryItem() const { return FALSE; }
+void LLInvFVBridge::removeBatch(std::vector<LLFolderViewModelItem*>& batch) { }
+BOOL LLInvFVBridge::copyToClipboard() const { return FALSE; }
+BOOL LLInvFVBridge::cutToClipboard() { return FALSE; }
+bool LLInvFVBridge::isCutToClipboard() { return false; }
+BOOL LLInvFVBridge::isClipboardPasteable() const { return FALSE; }
+BOOL LLInvFVBridge::isClipboardPasteableAsLink() const { return FALSE; }
+void LLInvFVBridge::buildContextMenu(LLMenuGL& menu, U32 flags) { }
+LLToolDragAndDrop::ESource LLInvFVBridge::getDragSource() const { return LLToolDragAndDrop::SOURCE_AGENT; }
+BOOL LLInvFVBridge::startDrag(EDragAndDropType* type, LLUUID* id) const { return FALSE; }
+LLInventoryObject* LLInvFVBridge::getInventoryObject() const { return NULL; }
+bool LLInvFVBridge::isItemWorn() const { return false; }
+LLAssetType::EType LLInvFVBridge::getAssetType() const { return LLAssetType::AT_NONE; }
+void LLInvFVBridge::addTrashContextMenuOptions(menuentry_vec_t& items, menuentry_vec_t& disabled_items) { }
+void LLInvFVBridge::addDeleteContextMenuOptions(menuentry_vec_t& items, menuentry_vec_t& disabled_items) { }
+void LLInvFVBridge::addOpenRightClickMenuOption(menuentry_vec_t& items) { }
+void LLInvFVBridge::addMarketplaceContextMenuOptions(U32 flags, menuentry_vec_t& items, menuentry_vec_t& disabled_items) { }
+void LLInvFVBridge::addLinkReplaceMenuOption(menuentry_vec_t& items, menuentry_vec_t& disabled_items) { }
+BOOL LLInvFVBridge::isItemPermissive() const { return FALSE; }
+
+//
+// LLInventoryPanel
+//
+
+LLInventoryPanel* LLInventoryPanel::getActiveInventoryPanel(BOOL auto_open) { return NULL; }
+void LLInventoryPanel::setSelection(const LLUUID& obj_id, BOOL take_keyboard_focus) { }
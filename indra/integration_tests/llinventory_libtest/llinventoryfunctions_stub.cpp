@@ -0,0 +1,41 @@
+/**
+ * @file llinventoryfunctions_stub.cpp
+ * @brief Stub inventory helper functions to allow benchmarking LLInventoryModel outside of the viewer
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llinventoryfunctions.h"
+
+// There are no worn items, marketplace listings or inventory panels outside of the viewer
+
+bool LLInventoryState::sShowNewInventory = false;
+BOOL LLInventoryState::sWearNewClothing = FALSE;
+LLUUID LLInventoryState::sWearNewClothingTransactionID;
+
+BOOL get_is_item_worn(const LLUUID& id) { return FALSE; }
+BOOL get_is_category_removable(const LLInventoryModel* model, const LLUUID& id) { return TRUE; }
+void show_item(const LLUUID& idItem, EShowItemOptions showItemFlags, LLInventoryPanel* pActiveInvPanel) { }
+void update_marketplace_category(const LLUUID& cat_id, bool perform_consistency_enforcement) { }
+S32 depth_nesting_in_marketplace(LLUUID cur_uuid) { return -1; }
+LLUUID nested_parent_id(LLUUID cur_uuid, S32 depth) { return LLUUID::null; }
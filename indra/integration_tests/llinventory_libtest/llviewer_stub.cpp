@@ -0,0 +1,121 @@
+/**
+ * @file llviewer_stub.cpp
+ * @brief Stub viewer subsystems the inventory model calls into to allow benchmarking it outside of the viewer
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llappearancemgr.h"
+#include "llappviewer.h"
+#include "llfloaterpreviewtrash.h"
+#include "llgesturemgr.h"
+#include "llinventorymodelbackgroundfetch.h"
+#include "llinventoryobserver.h"
+#include "llmarketplacefunctions.h"
+#include "llnotificationsutil.h"
+#include "llpreview.h"
+#include "llstartup.h"
+#include "lltrans.h"
+#include "llviewerfoldertype.h"
+#include "llviewermessage.h"
+#include "llviewernetwork.h"
+#include "llviewerwindow.h"
+#include "rlvhandler.h"
+#include "rlvlocks.h"
+
+// None of these run outside of the viewer: there is no avatar to wear anything, no gestures, marketplace, background
+// fetch or UI and the inventory is always a production grid one
+
+LLAppViewer* LLAppViewer::sInstance = NULL;
+LLViewerWindow* gViewerWindow = NULL;
+EStartupState LLStartUp::gStartupState = STATE_STARTED;
+bool RlvHandler::m_fEnabled = false;
+
+//
+// LLInventoryObserver
+//
+
+LLInventoryObserver::LLInventoryObserver() { }
+LLInventoryObserver::~LLInventoryObserver() { }
+LLInventoryFetchObserver::LLInventoryFetchObserver(const LLUUID& id) { }
+LLInventoryFetchItemsObserver::LLInventoryFetchItemsObserver(const LLUUID& item_id) : LLInventoryFetchObserver(item_id) { }
+void LLInventoryFetchItemsObserver::startFetch() { }
+void LLInventoryFetchItemsObserver::changed(U32 mask) { }
+void start_new_inventory_observer() { }
+
+//
+// Singletons
+//
+
+// Declared by llappearancemgr.h but only defined in llappearancemgr.cpp
+class LLOutfitUnLockTimer : public LLEventTimer
+{
+public:
+	LLOutfitUnLockTimer(F32 period) : LLEventTimer(period) { }
+	BOOL tick() { return FALSE; }
+};
+
+LLAppearanceMgr::LLAppearanceMgr() { }
+LLAppearanceMgr::~LLAppearanceMgr() { }
+void LLAppearanceMgr::wearItemOnAvatar(const LLUUID& item_to_wear, bool do_update, bool replace, LLPointer<LLInventoryCallback> cb) { }
+
+LLGestureMgr::LLGestureMgr() { }
+LLGestureMgr::~LLGestureMgr() { }
+void LLGestureMgr::changed(U32 mask) { }
+void LLGestureMgr::done() { }
+void LLGestureMgr::deactivateGesture(const LLUUID& item_id) { }
+BOOL LLGestureMgr::isGestureActive(const LLUUID& item_id) { return FALSE; }
+
+LLGridManager::LLGridManager() : mIsInProductionGrid(true) { }
+LLGridManager::~LLGridManager() { }
+std::string LLGridManager::getGridId(const std::string& grid) { return grid; }
+bool LLGridManager::isInProductionGrid() { return mIsInProductionGrid; }
+
+LLInventoryModelBackgroundFetch::LLInventoryModelBackgroundFetch() { }
+LLInventoryModelBackgroundFetch::~LLInventoryModelBackgroundFetch() { }
+void LLInventoryModelBackgroundFetch::start(const LLUUID& cat_id, BOOL recursive) { }
+BOOL LLInventoryModelBackgroundFetch::folderFetchActive() const { return FALSE; }
+
+LLMarketplaceData::LLMarketplaceData() { }
+LLMarketplaceData::~LLMarketplaceData() { }
+bool LLMarketplaceData::getListing(S32 listing_id) { return false; }
+bool LLMarketplaceData::isListed(const LLUUID& folder_id) { return false; }
+bool LLMarketplaceData::getActivationState(const LLUUID& folder_id) { return false; }
+S32 LLMarketplaceData::getListingID(const LLUUID& folder_id) { return 0; }
+
+RlvAttachmentLockWatchdog::RlvAttachmentLockWatchdog() { }
+void RlvAttachmentLockWatchdog::onSavedAssetIntoInventory(const LLUUID& idItem) { }
+RlvFolderLocks::RlvFolderLocks() { }
+
+//
+// UI
+//
+
+bool LLFloaterPreviewTrash::isVisible() { return false; }
+void LLFloaterPreviewTrash::show() { }
+void LLPreview::hide(const LLUUID& item_uuid, BOOL no_saving) { }
+bool LLViewerFolderType::lookupIsHiddenIfEmpty(LLFolderType::EType folder_type) { return false; }
+const std::string& LLViewerFolderType::lookupNewCategoryName(LLFolderType::EType folder_type) { return LLStringUtil::null; }
+std::string LLTrans::getString(const std::string& xml_desc, const LLStringUtil::format_map_t& args, bool def_string) { return xml_desc; }
+LLNotificationPtr LLNotificationsUtil::add(const std::string& name, const LLSD& substitutions, const LLSD& payload, boost::function<void (const LLSD&, const LLSD&)> functor) { return LLNotificationPtr(); }
+S32 LLNotificationsUtil::getSelectedOption(const LLSD& notification, const LLSD& response) { return -1; }
@@ -0,0 +1,248 @@
+/**
+ * @file llviewerinventory_stub.cpp
+ * @brief Stub viewer inventory classes to allow benchmarking LLInventoryModel outside of the viewer
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llinventorymodel.h"
+#include "llviewerinventory.h"
+
+// There is no server to talk to outside of the viewer; links are resolved against gInventory the same way the viewer does
+
+//
+// LLViewerInventoryItem
+//
+
+LLViewerInventoryItem::LLViewerInventoryItem(const LLUUID& uuid, const LLUUID& parent_uuid, const LLPermissions& perm, const LLUUID& asset_uuid,
+                                             LLAssetType::EType type, LLInventoryType::EType inv_type, const std::string& name, const std::string& desc,
+                                             const LLSaleInfo& sale_info, U32 flags, time_t creation_date_utc)
+	: LLInventoryItem(uuid, parent_uuid, perm, asset_uuid, type, inv_type, name, desc, sale_info, flags, creation_date_utc)
+	, mIsComplete(TRUE)
+{
+}
+
+LLViewerInventoryItem::LLViewerInventoryItem()
+	: LLInventoryItem()
+	, mIsComplete(FALSE)
+{
+}
+
+LLViewerInventoryItem::LLViewerInventoryItem(const LLViewerInventoryItem* other)
+	: LLInventoryItem()
+{
+	copyViewerItem(other);
+}
+
+LLViewerInventoryItem::LLViewerInventoryItem(const LLInventoryItem* other)
+	: LLInventoryItem(other)
+	, mIsComplete(TRUE)
+{
+}
+
+LLViewerInventoryItem::~LLViewerInventoryItem()
+{
+}
+
+void LLViewerInventoryItem::copyViewerItem(const LLViewerInventoryItem* other)
+{
+	LLInventoryItem::copyItem(other);
+	mIsComplete = other->mIsComplete;
+	mTransactionID = other->mTransactionID;
+}
+
+LLViewerInventoryItem* LLViewerInventoryItem::getLinkedItem() const
+{
+	if (LLAssetType::AT_LINK == mType)
+	{
+		LLViewerInventoryItem* linked_item = gInventory.getItem(mAssetUUID);
+		return ( (linked_item) && (!linked_item->getIsLinkType()) ) ? linked_item : NULL;
+	}
+	return NULL;
+}
+
+LLViewerInventoryCategory* LLViewerInventoryItem::getLinkedCategory() const
+{
+	return (LLAssetType::AT_LINK_FOLDER == mType) ? gInventory.getCategory(mAssetUUID) : NULL;
+}
+
+bool LLViewerInventoryItem::getIsBrokenLink() const
+{
+	return LLAssetType::lookupIsLinkType(getType());
+}
+
+LLAssetType::EType LLViewerInventoryItem::getType() const
+{
+	if (const LLViewerInventoryItem* linked_item = getLinkedItem())
+		return linked_item->getType();
+	if (const LLViewerInventoryCategory* linked_category = getLinkedCategory())
+		return linked_category->getType();
+	return LLInventoryItem::getType();
+}
+
+const LLUUID& LLViewerInventoryItem::getAssetUUID() const
+{
+	const LLViewerInventoryItem* linked_item = getLinkedItem();
+	return (linked_item) ? linked_item->getAssetUUID() : LLInventoryItem::getAssetUUID();
+}
+
+const std::string& LLViewerInventoryItem::getName() const
+{
+	if (const LLViewerInventoryItem* linked_item = getLinkedItem())
+		return linked_item->getName();
+	if (const LLViewerInventoryCategory* linked_category = getLinkedCategory())
+		return linked_category->getName();
+	return LLInventoryItem::getName();
+}
+
+const LLUUID& LLViewerInventoryItem::getCreatorUUID() const
+{
+	const LLViewerInventoryItem* linked_item = getLinkedItem();
+	return (linked_item) ? linked_item->getCreatorUUID() : LLInventoryItem::getCreatorUUID();
+}
+
+const std::string& LLViewerInventoryItem::getDescription() const
+{
+	const LLViewerInventoryItem* linked_item = getLinkedItem();
+	return (linked_item) ? linked_item->getDescription() : LLInventoryItem::getDescription();
+}
+
+const LLSaleInfo& LLViewerInventoryItem::getSaleInfo() const
+{
+	const LLViewerInventoryItem* linked_item = getLinkedItem();
+	return (linked_item) ? linked_item->getSaleInfo() : LLInventoryItem::getSaleInfo();
+}
+
+LLInventoryType::EType LLViewerInventoryItem::getInventoryType() const
+{
+	if (const LLViewerInventoryItem* linked_item = getLinkedItem())
+		return linked_item->getInventoryType();
+	if (getLinkedCategory())
+		return LLInventoryType::IT_CATEGORY;
+	return LLInventoryItem::getInventoryType();
+}
+
+U32 LLViewerInventoryItem::getFlags() const
+{
+	const LLViewerInventoryItem* linked_item = getLinkedItem();
+	return (linked_item) ? linked_item->getFlags() : LLInventoryItem::getFlags();
+}
+
+const LLUUID& LLViewerInventoryItem::getProtectedAssetUUID() const { return getAssetUUID(); }
+S32 LLViewerInventoryItem::getSortField() const { return -1; }
+void LLViewerInventoryItem::getSLURL() { }
+const LLPermissions& LLViewerInventoryItem::getPermissions() const { return LLInventoryItem::getPermissions(); }
+const bool LLViewerInventoryItem::getIsFullPerm() const { return (getPermissions().getMaskOwner() & PERM_ITEM_UNRESTRICTED) == PERM_ITEM_UNRESTRICTED; }
+bool LLViewerInventoryItem::isWearableType() const { return LLInventoryType::IT_WEARABLE == getInventoryType(); }
+LLWearableType::EType LLViewerInventoryItem::getWearableType() const { return LLWearableType::WT_NONE; }
+bool LLViewerInventoryItem::isSettingsType() const { return false; }
+LLSettingsType::type_e LLViewerInventoryItem::getSettingsType() const { return LLSettingsType::ST_NONE; }
+time_t LLViewerInventoryItem::getCreationDate() const { return LLInventoryItem::getCreationDate(); }
+U32 LLViewerInventoryItem::getCRC32() const { return LLInventoryItem::getCRC32(); }
+PermissionMask LLViewerInventoryItem::getPermissionMask() const { return getPermissions().getMaskOwner(); }
+
+void LLViewerInventoryItem::copyItem(const LLInventoryItem* other)
+{
+	LLInventoryItem::copyItem(other);
+	mIsComplete = true;
+	mTransactionID.setNull();
+}
+
+void LLViewerInventoryItem::updateParentOnServer(BOOL restamp) const { }
+void LLViewerInventoryItem::updateServer(BOOL is_new) const { }
+void LLViewerInventoryItem::packMessage(LLMessageSystem* msg) const { }
+BOOL LLViewerInventoryItem::unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num) { return FALSE; }
+BOOL LLViewerInventoryItem::unpackMessage(const LLSD& item) { return FALSE; }
+BOOL LLViewerInventoryItem::importLegacyStream(std::istream& input_stream) { return FALSE; }
+void LLViewerInventoryItem::setTransactionID(const LLTransactionID& transaction_id) { mTransactionID = transaction_id; }
+void LLViewerInventoryItem::onCallingCardNameLookup(const LLUUID& id, const LLAvatarName& name) { }
+
+//
+// LLViewerInventoryCategory
+//
+
+LLViewerInventoryCategory::LLViewerInventoryCategory(const LLUUID& uuid, const LLUUID& parent_uuid, LLFolderType::EType pref,
+                                                     const std::string& name, const LLUUID& owner_id)
+	: LLInventoryCategory(uuid, parent_uuid, pref, name)
+	, mOwnerID(owner_id)
+	, mVersion(LLViewerInventoryCategory::VERSION_UNKNOWN)
+	, mDescendentCount(LLViewerInventoryCategory::DESCENDENT_COUNT_UNKNOWN)
+{
+}
+
+LLViewerInventoryCategory::LLViewerInventoryCategory(const LLUUID& owner_id)
+	: mOwnerID(owner_id)
+	, mVersion(LLViewerInventoryCategory::VERSION_UNKNOWN)
+	, mDescendentCount(LLViewerInventoryCategory::DESCENDENT_COUNT_UNKNOWN)
+{
+}
+
+LLViewerInventoryCategory::LLViewerInventoryCategory(const LLViewerInventoryCategory* other)
+{
+	copyViewerCategory(other);
+}
+
+LLViewerInventoryCategory::~LLViewerInventoryCategory()
+{
+}
+
+void LLViewerInventoryCategory::copyViewerCategory(const LLViewerInventoryCategory* other)
+{
+	copyCategory(other);
+	mOwnerID = other->mOwnerID;
+	setVersion(other->getVersion());
+	mDescendentCount = other->mDescendentCount;
+}
+
+S32 LLViewerInventoryCategory::getViewerDescendentCount() const
+{
+	LLInventoryModel::cat_array_t* cats; LLInventoryModel::item_array_t* items;
+	gInventory.getDirectDescendentsOf(getUUID(), cats, items);
+	return ( (cats) && (items) ) ? cats->size() + items->size() : 0;
+}
+
+S32 LLViewerInventoryCategory::getVersion() const { return mVersion; }
+void LLViewerInventoryCategory::setVersion(S32 version) { mVersion = version; }
+bool LLViewerInventoryCategory::fetch() { return false; }
+void LLViewerInventoryCategory::localizeName() { }
+LLSD LLViewerInventoryCategory::exportLLSD() const { return LLInventoryCategory::exportLLSD(); }
+bool LLViewerInventoryCategory::importLLSD(const LLSD& cat_data) { return LLInventoryCategory::importLLSD(cat_data); }
+
+void LLViewerInventoryCategory::updateParentOnServer(BOOL restamp_children) const { }
+void LLViewerInventoryCategory::updateServer(BOOL is_new) const { }
+void LLViewerInventoryCategory::packMessage(LLMessageSystem* msg) const { }
+void LLViewerInventoryCategory::unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num) { }
+BOOL LLViewerInventoryCategory::unpackMessage(const LLSD& category) { return FALSE; }
+
+//
+// Server side operations
+//
+
+LLInventoryCallbackManager gInventoryCallbacks;
+
+LLInventoryCallbackManager::LLInventoryCallbackManager() : mLastCallback(0) { }
+LLInventoryCallbackManager::~LLInventoryCallbackManager() { }
+void LLInventoryCallbackManager::destroyClass() { }
+void LLInventoryCallbackManager::fire(U32 callback_id, const LLUUID& item_id) { }
+void remove_inventory_category(const LLUUID& cat_id, LLPointer<LLInventoryCallback> cb) { }
+void purge_descendents_of(const LLUUID& id, LLPointer<LLInventoryCallback> cb) { }
@@ -0,0 +1,403 @@
+/**
+ * @file llsd_libtest.cpp
+ * @brief Memory and throughput benchmark of LLSD storage on inventory and mesh header payloads
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#define LLSD_DEBUG_INFO
+#include "linden_common.h"
+
+// Linden library includes
+#include "llformat.h"
+#include "llsd.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "lltimer.h"
+
+// system libraries
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllsd_libtest [options] [file ...]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -b, --binary\n"
+"        Files are headerless binary LLSD (e.g. mesh headers taken from the mesh cache) rather\n"
+"        than LLSD with a header, XML or notation.\n"
+" -i, --items <n>\n"
+"        Number of items in the generated AIS category payload. Default is 20000.\n"
+" -m, --meshes <n>\n"
+"        Number of headers in the generated mesh header payload. Default is 20000.\n"
+" -n, --iterations <n>\n"
+"        Number of times each payload is parsed. Default is 5.\n"
+"\n"
+"Parses each captured payload (or a generated AIS category response and a set of mesh\n"
+"headers when no files are given) from its binary and XML serialization, through both the\n"
+"stream and the buffer parsers, and reports the time per parse, the heap allocations and\n"
+"bytes per parse, the number of LLSD values that needed their own storage, and the time to\n"
+"deep copy and walk the parsed result. Checks\n"
+"that every parse reproduces the original payload and returns non-zero on any mismatch.\n"
+"Heap figures only cover allocations made through this executable's operator new.\n"
+"\n";
+
+//
+// Heap accounting
+//
+
+static std::atomic<U64> sHeapAllocations(0);
+static std::atomic<U64> sHeapBytes(0);
+
+// Keeps the requested size in front of each block (16 bytes to preserve the alignment of the block handed out)
+static const size_t HEAP_HEADER_SIZE = 16;
+
+void* operator new(size_t size)
+{
+	void* ptr = malloc(size + HEAP_HEADER_SIZE);
+	if (!ptr)
+	{
+		throw std::bad_alloc();
+	}
+	sHeapAllocations++;
+	sHeapBytes += size;
+	*static_cast<size_t*>(ptr) = size;
+	return static_cast<char*>(ptr) + HEAP_HEADER_SIZE;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr)
+	{
+		free(static_cast<char*>(ptr) - HEAP_HEADER_SIZE);
+	}
+}
+
+struct LLHeapSnapshot
+{
+	LLHeapSnapshot() : mAllocations(sHeapAllocations), mBytes(sHeapBytes), mImpls(llsd::allocationCount()) { }
+
+	U64 mAllocations;
+	U64 mBytes;
+	U32 mImpls;
+};
+
+//
+// Payload generation
+//
+
+static LLUUID make_id(U32 kind, U32 idx)
+{
+	return LLUUID(llformat("%08x-%04x-4%03x-8000-%012x", idx * 2654435761U, kind, idx & 0xFFF, idx));
+}
+
+// Shaped after an AIS category response with its embedded items and links
+static LLSD generate_ais_category(S32 num_items)
+{
+	const LLUUID owner_id = make_id(1, 0), folder_id = make_id(2, 0);
+
+	LLSD items = LLSD::emptyMap(), links = LLSD::emptyMap();
+	for (S32 idx = 0; idx < num_items; idx++)
+	{
+		const bool is_link = (0 == idx % 5);
+		const LLUUID item_id = make_id(3, idx);
+
+		LLSD perms;
+		perms["creator_id"] = make_id(4, idx % 97);
+		perms["owner_id"] = owner_id;
+		perms["last_owner_id"] = (idx % 3) ? LLUUID::null : make_id(4, idx % 89);
+		perms["group_id"] = LLUUID::null;
+		perms["is_owner_group"] = false;
+		perms["base_mask"] = (S32)0x7FFFFFFF;
+		perms["owner_mask"] = (S32)0x7FFFFFFF;
+		perms["group_mask"] = 0;
+		perms["everyone_mask"] = 0;
+		perms["next_owner_mask"] = (S32)0x82000;
+
+		LLSD sale_info;
+		sale_info["sale_price"] = (idx % 7) ? 0 : 10 * (idx % 50);
+		sale_info["sale_type"] = 0;
+
+		LLSD item;
+		item["item_id"] = item_id;
+		item["parent_id"] = folder_id;
+		item["asset_id"] = (is_link) ? make_id(3, idx + 1) : make_id(5, idx);
+		item["name"] = llformat("%s %d", (is_link) ? "Outfit link" : "Object", idx);
+		item["desc"] = (idx % 4) ? std::string() : llformat("(No Description) %d", idx);
+		item["type"] = (is_link) ? 24 : 6;
+		item["inv_type"] = 6;
+		item["flags"] = (idx % 11) ? 0 : 0x100000;
+		item["created_at"] = 1400000000 + idx * 37;
+		item["permissions"] = perms;
+		item["sale_info"] = sale_info;
+		item["_links"]["self"]["href"] = llformat("/item/%s", item_id.asString().c_str());
+
+		((is_link) ? links : items)[item_id.asString()] = item;
+	}
+
+	LLSD category;
+	category["category_id"] = folder_id;
+	category["parent_id"] = make_id(2, 1);
+	category["agent_id"] = owner_id;
+	category["name"] = "Objects";
+	category["type_default"] = -1;
+	category["version"] = 1234;
+	category["_embedded"]["items"] = items;
+	category["_embedded"]["links"] = links;
+	category["_embedded"]["categories"] = LLSD::emptyMap();
+	return category;
+}
+
+// Shaped after the header LLMeshRepository reads in front of each mesh asset
+static LLSD generate_mesh_headers(S32 num_meshes)
+{
+	static const char* LOD_NAMES[] = { "lowest_lod", "low_lod", "medium_lod", "high_lod", "physics_convex", "physics_mesh", "skin" };
+
+	LLSD headers = LLSD::emptyArray();
+	for (S32 idx = 0; idx < num_meshes; idx++)
+	{
+		LLSD header;
+		header["version"] = 1;
+		header["creator"] = make_id(6, idx % 311);
+		header["date"] = LLDate((F64)(1400000000 + idx));
+		S32 offset = 0;
+		for (S32 lod = 0; lod < LL_ARRAY_SIZE(LOD_NAMES); lod++)
+		{
+			if ( (lod == 5 && idx % 3) || (lod == 6 && idx % 4) )
+			{
+				continue;
+			}
+			const S32 size = 1500 + ((idx * 7919 + lod * 104729) % 60000);
+			header[LOD_NAMES[lod]]["offset"] = offset;
+			header[LOD_NAMES[lod]]["size"] = size;
+			offset += size;
+		}
+		headers.append(header);
+	}
+	return headers;
+}
+
+//
+// Benchmark helpers
+//
+
+// Visits every value and touches keys and scalars the way consumers of a payload would
+static U64 walk_llsd(const LLSD& sd)
+{
+	U64 total = 1;
+	switch (sd.type())
+	{
+		case LLSD::TypeMap:
+			for (LLSD::map_const_iterator it = sd.beginMap(); it != sd.endMap(); ++it)
+			{
+				total += it->first.size() + walk_llsd(it->second);
+			}
+			break;
+		case LLSD::TypeArray:
+			for (LLSD::array_const_iterator it = sd.beginArray(); it != sd.endArray(); ++it)
+			{
+				total += walk_llsd(*it);
+			}
+			break;
+		case LLSD::TypeString:
+			total += sd.asStringRef().size();
+			break;
+		default:
+			total += sd.asInteger();
+			break;
+	}
+	return total;
+}
+
+static bool parse_llsd(const std::string& data, bool is_xml, bool from_buffer, LLSD& sd)
+{
+	if (from_buffer)
+	{
+		return (is_xml) ? LLSDSerialize::fromXML(sd, data.data(), data.size()) > 0 : LLSDSerialize::fromBinary(sd, data.data(), data.size()) > 0;
+	}
+	std::istringstream in_str(data);
+	return (is_xml) ? LLSDSerialize::fromXML(sd, in_str) > 0 : LLSDSerialize::fromBinary(sd, in_str, data.size()) > 0;
+}
+
+static bool load_file(const std::string& file_name, bool headerless_binary, LLSD& sd)
+{
+	std::ifstream in_file(file_name.c_str(), std::ios::binary);
+	if (!in_file)
+	{
+		return false;
+	}
+	std::ostringstream contents;
+	contents << in_file.rdbuf();
+	const std::string data = contents.str();
+
+	std::istringstream in_str(data);
+	if (headerless_binary)
+	{
+		return LLSDSerialize::fromBinary(sd, in_str, data.size()) > 0;
+	}
+	if (LLSDSerialize::deserialize(sd, in_str, data.size()))
+	{
+		return true;
+	}
+	in_str.clear();
+	in_str.seekg(0);
+	return LLSDSerialize::fromNotation(sd, in_str, data.size()) > 0;
+}
+
+// Returns false if a parse didn't reproduce the payload
+static bool bench_payload(const std::string& name, const LLSD& payload, S32 iterations)
+{
+	bool success = true;
+
+	std::ostringstream binary_str, xml_str;
+	LLSDSerialize::toBinary(payload, binary_str);
+	LLSDSerialize::toXML(payload, xml_str);
+
+	std::cout << name << std::endl;
+	for (int format = 0; format < 4; format++)
+	{
+		// Stream parsers first, then the buffer parsers
+		const bool is_xml = (1 == (format & 1));
+		const bool from_buffer = (format >= 2);
+		const char* format_name = (from_buffer) ? ((is_xml) ? "xml buf" : "binary buf") : ((is_xml) ? "xml" : "binary");
+		const std::string data = (is_xml) ? xml_str.str() : binary_str.str();
+
+		F64 parse_seconds = 0.0, clone_seconds = 0.0, walk_seconds = 0.0;
+		U64 heap_allocations = 0, heap_bytes = 0;
+		U32 impls = 0;
+		for (S32 iteration = 0; iteration < iterations; iteration++)
+		{
+			LLSD parsed;
+			LLHeapSnapshot before_parse;
+			LLTimer parse_timer;
+			const bool parse_ok = parse_llsd(data, is_xml, from_buffer, parsed);
+			parse_seconds += parse_timer.getElapsedTimeF64();
+			LLHeapSnapshot after_parse;
+
+			heap_allocations += after_parse.mAllocations - before_parse.mAllocations;
+			heap_bytes += after_parse.mBytes - before_parse.mBytes;
+			impls = after_parse.mImpls - before_parse.mImpls;
+
+			if ( (!parse_ok) || (!llsd_equals(parsed, payload)) )
+			{
+				std::cout << "Error: " << format_name << " parse didn't reproduce the payload" << std::endl;
+				success = false;
+				break;
+			}
+
+			LLTimer clone_timer;
+			LLSD copy = llsd_clone(parsed);
+			clone_seconds += clone_timer.getElapsedTimeF64();
+
+			LLTimer walk_timer;
+			if (walk_llsd(copy) != walk_llsd(parsed))
+			{
+				std::cout << "Error: deep copy differs from the parsed payload" << std::endl;
+				success = false;
+			}
+			walk_seconds += walk_timer.getElapsedTimeF64() / 2;
+		}
+
+		std::cout << std::setw(10) << format_name << std::setw(12) << data.size() / 1024 << std::fixed << std::setprecision(2)
+		          << std::setw(12) << parse_seconds * 1000.0 / iterations << std::setw(14) << heap_allocations / iterations << std::setw(14) << heap_bytes / iterations / 1024
+		          << std::setw(12) << impls << std::setw(12) << clone_seconds * 1000.0 / iterations << std::setw(12) << walk_seconds * 1000.0 / iterations << std::endl;
+	}
+	return success;
+}
+
+int main(int argc, char** argv)
+{
+	S32 num_items = 20000;
+	S32 num_meshes = 20000;
+	S32 iterations = 5;
+	bool headerless_binary = false;
+	std::vector<std::string> files;
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if (!strcmp(argv[arg], "--binary") || !strcmp(argv[arg], "-b"))
+		{
+			headerless_binary = true;
+		}
+		else if ((!strcmp(argv[arg], "--items") || !strcmp(argv[arg], "-i")) && arg < argc-1)
+		{
+			num_items = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--meshes") || !strcmp(argv[arg], "-m")) && arg < argc-1)
+		{
+			num_meshes = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--iterations") || !strcmp(argv[arg], "-n")) && arg < argc-1)
+		{
+			iterations = llmax(1, atoi(argv[++arg]));
+		}
+		else
+		{
+			files.push_back(argv[arg]);
+		}
+	}
+
+	int result = 0;
+
+	std::vector<std::pair<std::string, LLSD> > payloads;
+	if (files.empty())
+	{
+		payloads.push_back(std::make_pair(llformat("generated AIS category (%d items)", num_items), generate_ais_category(num_items)));
+		payloads.push_back(std::make_pair(llformat("generated mesh headers (%d headers)", num_meshes), generate_mesh_headers(num_meshes)));
+	}
+	for (const std::string& file_name : files)
+	{
+		LLSD sd;
+		if (!load_file(file_name, headerless_binary, sd))
+		{
+			std::cout << "Error: unable to load " << file_name << std::endl;
+			result = 1;
+			continue;
+		}
+		payloads.push_back(std::make_pair(file_name, sd));
+	}
+
+	std::cout << std::setw(10) << "format" << std::setw(12) << "KB" << std::setw(12) << "ms/parse" << std::setw(14) << "allocs/parse"
+	          << std::setw(14) << "heap KB/parse" << std::setw(12) << "values" << std::setw(12) << "ms/copy" << std::setw(12) << "ms/walk" << std::endl;
+	for (const auto& payload : payloads)
+	{
+		if (!bench_payload(payload.first, payload.second, iterations))
+		{
+			result = 1;
+		}
+	}
+
+	// Cleanup and exit
+	return result;
+}
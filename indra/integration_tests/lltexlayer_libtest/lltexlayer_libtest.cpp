@@ -0,0 +1,451 @@
+/**
+ * @file lltexlayer_libtest.cpp
+ * @brief Benchmark and consistency check for the CPU tex layer compositor
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+
+// Linden library includes
+#include "llapr.h"
+#include "llavatarappearance.h"
+#include "llavatarappearancedefines.h"
+#include "llavatarjoint.h"
+#include "llavatarjointmesh.h"
+#include "llcleanup.h"
+#include "lldir.h"
+#include "llimage.h"
+#include "llinvtranslationbrdg.h"
+#include "lllocaltextureobject.h"
+#include "llrand.h"
+#include "lltexlayer.h"
+#include "lltexlayercompositor.h"
+#include "lltexlayerparams.h"
+#include "lltimer.h"
+#include "llwearable.h"
+#include "llwearabledata.h"
+#include "llwearabletype.h"
+#include "v3dmath.h"
+
+// system libraries
+#include <iostream>
+#include <iomanip>
+
+using namespace LLAvatarAppearanceDefines;
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tlltexlayer_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -d, --data <dir>\n"
+"        Directory containing the character directory (avatar_lad.xml, meshes and static layer images).\n"
+"        Default is ../newview relative to the working directory.\n"
+" -n, --iterations <n>\n"
+"        Number of times each layer set is composited. Default is 20.\n"
+" -t, --tolerance <n>\n"
+"        Maximum per-channel difference allowed against the 8-bit reference blender. Default is 3.\n"
+"\n"
+"Builds a headless avatar from avatar_lad.xml, wears one wearable of every type that feeds a bake\n"
+"(random texture parameters, local textures replaced with random images) and bakes every layer set\n"
+"through LLTexLayerSet::compositeToImage(). The draw calls LLTexLayerSet::composite() issues are also\n"
+"replayed through a scalar 8-bit implementation of the GL blend equations; reports timings and the\n"
+"largest difference between the two. Returns non-zero if any layer set exceeds the tolerance.\n"
+"\n";
+
+static const S32 LOCAL_TEXTURE_SIZE = 512;
+
+//
+// Headless stand-ins for the viewer side of llappearance
+//
+class LLBakeTestTranslationBridge : public LLTranslationBridge
+{
+public:
+	/*virtual*/ std::string getString(const std::string& xml_desc) { return xml_desc; }
+};
+
+class LLBakeTestJoint : public LLAvatarJoint
+{
+public:
+	LLBakeTestJoint() {}
+	LLBakeTestJoint(S32 joint_num) : LLAvatarJoint(joint_num) {}
+
+	/*virtual*/ U32 render(F32 pixelArea, BOOL first_pass, BOOL is_dummy) { return 0; }
+};
+
+class LLBakeTestJointMesh : public LLAvatarJointMesh
+{
+public:
+	/*virtual*/ U32 render(F32 pixelArea, BOOL first_pass, BOOL is_dummy) { return 0; }
+};
+
+class LLBakeTestLayerSet : public LLTexLayerSet
+{
+public:
+	LLBakeTestLayerSet(LLAvatarAppearance* const appearance) : LLTexLayerSet(appearance) {}
+
+	/*virtual*/ void createComposite() {}
+	/*virtual*/ void requestUpdate() {}
+};
+
+class LLBakeTestAvatar : public LLAvatarAppearance
+{
+public:
+	LLBakeTestAvatar(LLWearableData* wearable_data) : LLAvatarAppearance(wearable_data) { mID.generate(); }
+
+	// LLCharacter
+	/*virtual*/ LLVector3 getCharacterPosition()									{ return LLVector3::zero; }
+	/*virtual*/ LLQuaternion getCharacterRotation()								{ return LLQuaternion::DEFAULT; }
+	/*virtual*/ LLVector3 getCharacterVelocity()									{ return LLVector3::zero; }
+	/*virtual*/ LLVector3 getCharacterAngularVelocity()							{ return LLVector3::zero; }
+	/*virtual*/ void getGround(const LLVector3& inPos, LLVector3& outPos, LLVector3& outNorm) { outPos = inPos; outNorm = LLVector3::z_axis; }
+	/*virtual*/ F32 getTimeDilation()												{ return 1.f; }
+	/*virtual*/ F32 getPixelArea() const											{ return 0.f; }
+	/*virtual*/ LLVector3d getPosGlobalFromAgent(const LLVector3& position)		{ return LLVector3d(position); }
+	/*virtual*/ LLVector3 getPosAgentFromGlobal(const LLVector3d& position)		{ return LLVector3(position); }
+	/*virtual*/ void addDebugText(const std::string& text)						{}
+	/*virtual*/ const LLUUID& getID() const										{ return mID; }
+
+	// LLAvatarAppearance
+	/*virtual*/ BOOL isUsingLocalAppearance() const								{ return FALSE; }
+	/*virtual*/ BOOL isEditingAppearance() const									{ return FALSE; }
+	/*virtual*/ LLAvatarJoint* createAvatarJoint()								{ return new LLBakeTestJoint(); }
+	/*virtual*/ LLAvatarJoint* createAvatarJoint(S32 joint_num)					{ return new LLBakeTestJoint(joint_num); }
+	/*virtual*/ LLAvatarJointMesh* createAvatarJointMesh()						{ return new LLBakeTestJointMesh(); }
+	/*virtual*/ LLAvatarJointBlock* createAvatarJointBlock(U32 num)				{ return new LLAvatarJointBlockT<LLBakeTestJoint>(num); }
+	/*virtual*/ void applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components, EBakedTextureIndex index) {}
+	/*virtual*/ void invalidateComposite(LLTexLayerSet* layerset)				{}
+	/*virtual*/ void updateMeshTextures()											{}
+	/*virtual*/ void dirtyMesh()													{}
+	/*virtual*/ void dirtyMesh(S32 priority)										{}
+	/*virtual*/ void onGlobalColorChanged(const LLTexGlobalColor* global_color)	{}
+	/*virtual*/ BOOL isTextureDefined(ETextureIndex te, U32 index) const			{ return TRUE; }
+	/*virtual*/ LLTexLayerSet* createTexLayerSet()								{ return new LLBakeTestLayerSet(this); }
+
+protected:
+	LLUUID mID;
+};
+
+class LLBakeTestWearableData : public LLWearableData
+{
+public:
+	void addWearable(LLWearable* wearable) { pushWearable(wearable->getType(), wearable, false); }
+};
+
+// A wearable of the given type with a fresh (random) id for each of its local textures
+class LLBakeTestWearable : public LLWearable
+{
+public:
+	LLBakeTestWearable(LLWearableType::EType type, LLAvatarAppearance* avatarp)
+	{
+		setType(type, avatarp);
+		for (S32 te = 0; te < TEX_NUM_INDICES; te++)
+		{
+			if (LLAvatarAppearance::getDictionary()->getTEWearableType((ETextureIndex)te) == type)
+			{
+				LLUUID id;
+				id.generate();
+				mTEMap[te] = new LLLocalTextureObject(NULL, id);
+				createLayers(te, avatarp);
+			}
+		}
+	}
+
+	/*virtual*/ LLUUID getDefaultTextureImageID(ETextureIndex index) const	{ return IMG_DEFAULT_AVATAR; }
+	/*virtual*/ void setUpdated() const										{}
+	/*virtual*/ void addToBakedTextureHash(LLMD5& hash) const					{}
+};
+
+// Hands the compositor a random image for every local texture id
+class LLBakeTestRawSource : public LLTexLayerRawSource
+{
+public:
+	/*virtual*/ LLImageRaw* getLocalTextureRaw(const LLLocalTextureObject* lto, ETextureIndex tex_index) const
+	{
+		std::map<LLUUID, LLPointer<LLImageRaw> >::const_iterator itImage = (lto) ? mImages.find(lto->getID()) : mImages.end();
+		return (mImages.end() != itImage) ? itImage->second.get() : NULL;
+	}
+
+	void addImage(const LLUUID& id, LLImageRaw* image) { mImages[id] = image; }
+
+protected:
+	std::map<LLUUID, LLPointer<LLImageRaw> > mImages;
+};
+
+static LLPointer<LLImageRaw> create_random_image(S32 width, S32 height, S32 components)
+{
+	LLPointer<LLImageRaw> image = new LLImageRaw(width, height, components);
+	U8* data = image->getData();
+	for (S32 i = 0, count = image->getDataSize(); i < count; ++i)
+	{
+		data[i] = (U8)ll_rand(256);
+	}
+	return image;
+}
+
+static void fetch_reference_texel(const LLImageRaw* image, S32 sx, S32 sy, bool is_mask, F32* out)
+{
+	const S32 comp = image->getComponents();
+	const U8* texel = image->getData() + (sy * image->getWidth() + sx) * comp;
+	if (comp == 1)
+	{
+		out[0] = out[1] = out[2] = (is_mask) ? 0.f : texel[0] / 255.f;
+		out[3] = (is_mask) ? texel[0] / 255.f : 1.f;
+	}
+	else
+	{
+		for (S32 c = 0; c < 3; ++c) out[c] = texel[llmin(c, comp - 1)] / 255.f;
+		out[3] = (comp == 4) ? texel[3] / 255.f : (comp == 2) ? texel[1] / 255.f : 1.f;
+	}
+}
+
+//
+// Reference blender: one op at a time, scalar, over an 8-bit RGBA buffer the way the GL render target sees it.
+//
+static void replay_reference(const LLTexLayerCompositor::command_list_t& ops, LLImageRaw* target)
+{
+	const S32 width = target->getWidth(), height = target->getHeight();
+	U8* dst = target->getData();
+	memset(dst, 0, target->getDataSize());
+
+	for (LLTexLayerCompositor::command_list_t::const_iterator itOp = ops.begin(); itOp != ops.end(); ++itOp)
+	{
+		const LLTexLayerCompositor::LLDrawCommand& op = *itOp;
+		const LLImageRaw* image = op.mImage;
+		for (S32 y = 0; y < height; ++y)
+		{
+			for (S32 x = 0; x < width; ++x)
+			{
+				F32 src[4] = { 1.f, 1.f, 1.f, 1.f };
+				if (image)
+				{
+					// GL_LINEAR, TAM_CLAMP
+					const S32 src_width = image->getWidth(), src_height = image->getHeight();
+					const F32 u = llclamp((x + 0.5f) * src_width / width - 0.5f, 0.f, (F32)(src_width - 1));
+					const F32 v = llclamp((y + 0.5f) * src_height / height - 0.5f, 0.f, (F32)(src_height - 1));
+					const S32 x0 = (S32)u, y0 = (S32)v;
+					const S32 x1 = llmin(x0 + 1, src_width - 1), y1 = llmin(y0 + 1, src_height - 1);
+					F32 t00[4], t10[4], t01[4], t11[4];
+					fetch_reference_texel(image, x0, y0, op.mIsMask, t00);
+					fetch_reference_texel(image, x1, y0, op.mIsMask, t10);
+					fetch_reference_texel(image, x0, y1, op.mIsMask, t01);
+					fetch_reference_texel(image, x1, y1, op.mIsMask, t11);
+					for (S32 c = 0; c < 4; ++c)
+					{
+						const F32 top = lerp(t00[c], t10[c], u - x0), bottom = lerp(t01[c], t11[c], u - x0);
+						src[c] = lerp(top, bottom, v - y0);
+					}
+				}
+				for (S32 c = 0; c < 4; ++c)
+				{
+					src[c] *= op.mColor.mV[c];
+				}
+
+				if ( (op.mMinimumAlpha > 0.f) && (src[3] < op.mMinimumAlpha) )
+				{
+					continue;
+				}
+
+				U8* pixel = dst + (y * width + x) * 4;
+				const F32 dst_alpha = pixel[3] / 255.f;
+				for (S32 c = 0; c < 4; ++c)
+				{
+					if ( (c < 3) ? !op.mWriteColor : !op.mWriteAlpha )
+					{
+						continue;
+					}
+
+					const F32 d = pixel[c] / 255.f;
+					F32 r = 0.f;
+					switch (op.mBlendMode)
+					{
+						case LLTexLayerCompositor::BM_ALPHA:		r = src[c] * src[3] + d * (1.f - src[3]); break;
+						case LLTexLayerCompositor::BM_ADD:			r = src[c] + d; break;
+						case LLTexLayerCompositor::BM_REPLACE:		r = src[c]; break;
+						case LLTexLayerCompositor::BM_MULT_ALPHA:	r = src[c] * dst_alpha; break;
+						case LLTexLayerCompositor::BM_DEST_ALPHA:	r = src[c] * dst_alpha + d * (1.f - dst_alpha); break;
+					}
+					pixel[c] = (U8)llclamp((S32)(r * 255.f + 0.5f), 0, 255);
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string data_dir = "../newview";
+	S32 iterations = 20;
+	S32 tolerance = 3;
+
+	// Init whatever is necessary
+	ll_init_apr();
+	LLImage::initClass();
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--data") || !strcmp(argv[arg], "-d")) && arg < argc-1)
+		{
+			data_dir = argv[++arg];
+		}
+		else if ((!strcmp(argv[arg], "--iterations") || !strcmp(argv[arg], "-n")) && arg < argc-1)
+		{
+			iterations = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--tolerance") || !strcmp(argv[arg], "-t")) && arg < argc-1)
+		{
+			tolerance = atoi(argv[++arg]);
+		}
+	}
+
+	// avatar_lad.xml, the meshes and the static layer images are all looked up in LL_PATH_CHARACTER
+	gDirUtilp->initAppDirs("SecondLife", data_dir);
+	if (!gDirUtilp->fileExists(gDirUtilp->getExpandedFilename(LL_PATH_CHARACTER, "avatar_lad.xml")))
+	{
+		std::cout << "Error: unable to find character/avatar_lad.xml in " << data_dir << std::endl;
+		return 1;
+	}
+	LLWearableType::initParamSingleton(new LLBakeTestTranslationBridge());
+	LLAvatarAppearance::initClass();
+
+	LLBakeTestWearableData wearable_data;
+	LLBakeTestAvatar* avatar = new LLBakeTestAvatar(&wearable_data);
+	wearable_data.setAvatarAppearance(avatar);
+	avatar->initInstance();
+
+	// Wear one of everything that contributes to a bake
+	LLBakeTestRawSource raw_source;
+	std::vector<LLWearable*> wearables;
+	for (S32 type = 0; type < LLWearableType::WT_COUNT; type++)
+	{
+		bool has_textures = false;
+		for (S32 te = 0; (te < TEX_NUM_INDICES) && (!has_textures); te++)
+		{
+			const LLAvatarAppearanceDictionary::TextureEntry* texture_dict = LLAvatarAppearance::getDictionary()->getTexture((ETextureIndex)te);
+			has_textures = (texture_dict) && (texture_dict->mIsUsedByBakedTexture) && (texture_dict->mWearableType == (LLWearableType::EType)type);
+		}
+		if (!has_textures)
+		{
+			continue;
+		}
+
+		LLWearable* wearable = new LLBakeTestWearable((LLWearableType::EType)type, avatar);
+		for (S32 te = 0; te < TEX_NUM_INDICES; te++)
+		{
+			if (const LLLocalTextureObject* lto = wearable->getLocalTextureObject(te))
+			{
+				raw_source.addImage(lto->getID(), create_random_image(LOCAL_TEXTURE_SIZE, LOCAL_TEXTURE_SIZE, 4));
+			}
+		}
+
+		// Color and alpha parameters drive the draw calls; anything in range exercises the same paths
+		LLWearable::visual_param_vec_t params;
+		wearable->getVisualParams(params);
+		for (LLWearable::visual_param_vec_t::const_iterator itParam = params.begin(); itParam != params.end(); ++itParam)
+		{
+			const LLVisualParam* param = *itParam;
+			if (dynamic_cast<const LLTexLayerParam*>(param))
+			{
+				wearable->setVisualParamWeight(param->getID(), lerp(param->getMinWeight(), param->getMaxWeight(), ll_frand()));
+			}
+		}
+
+		wearable_data.addWearable(wearable);
+		wearable->writeToAvatar(avatar);
+		wearables.push_back(wearable);
+	}
+
+	int result = 0;
+	std::cout << std::setw(12) << "layer set" << std::setw(11) << "size" << std::setw(6) << "ops"
+	          << std::setw(12) << "ms/bake" << std::setw(12) << "Mpix/s" << std::setw(10) << "max diff" << std::endl;
+	for (S32 baked_index = 0; baked_index < BAKED_NUM_INDICES; baked_index++)
+	{
+		LLTexLayerSet* layer_set = avatar->getAvatarLayerSet((EBakedTextureIndex)baked_index);
+		if ( (!layer_set) || (!layer_set->getInfo()) )
+		{
+			continue;
+		}
+		const S32 width = layer_set->getInfo()->getWidth(), height = layer_set->getInfo()->getHeight();
+
+		// Capture the draw calls of one composite and run them through the reference blender
+		LLPointer<LLImageRaw> first_bake = new LLImageRaw;
+		LLPointer<LLImageRaw> ref_bake = new LLImageRaw(width, height, 4);
+		size_t op_count = 0;
+		{
+			LLTexLayerCompositor compositor(width, height, &raw_source);
+			layer_set->composite(compositor);
+			op_count = compositor.getCommands().size();
+			replay_reference(compositor.getCommands(), ref_bake);
+			compositor.readback(first_bake);
+		}
+
+		LLPointer<LLImageRaw> cpu_bake = new LLImageRaw;
+		BOOL success = TRUE;
+		LLTimer timer;
+		for (S32 i = 0; i < iterations; ++i)
+		{
+			success &= layer_set->compositeToImage(cpu_bake, &raw_source);
+		}
+		const F64 ms_per_bake = timer.getElapsedTimeF64() * 1000.0 / iterations;
+		const F64 mpix = (F64)width * height * op_count / 1000000.0;
+
+		const S32 max_diff = LLTexLayerCompositor::compareImages(cpu_bake, ref_bake);
+		const std::string name = layer_set->getBodyRegionName();
+		std::cout << std::setw(12) << name << std::setw(6) << width << "x" << std::setw(4) << height << std::setw(6) << op_count
+		          << std::setw(12) << std::fixed << std::setprecision(2) << ms_per_bake
+		          << std::setw(12) << std::setprecision(1) << (mpix * 1000.0 / llmax(ms_per_bake, 0.001))
+		          << std::setw(10) << max_diff << std::endl;
+
+		if (!success)
+		{
+			std::cout << "Error: " << name << " failed to composite" << std::endl;
+			result = 1;
+		}
+		if (LLTexLayerCompositor::compareImages(cpu_bake, first_bake) != 0)
+		{
+			std::cout << "Error: " << name << " bakes differently on repeated calls" << std::endl;
+			result = 1;
+		}
+		if ( (max_diff < 0) || (max_diff > tolerance) )
+		{
+			std::cout << "Error: " << name << " differs from the reference blender by " << max_diff << std::endl;
+			result = 1;
+		}
+	}
+
+	// Cleanup and exit
+	for (std::vector<LLWearable*>::const_iterator itWearable = wearables.begin(); itWearable != wearables.end(); ++itWearable)
+	{
+		delete *itWearable;
+	}
+	delete avatar;
+	LLAvatarAppearance::cleanupClass();
+	SUBSYSTEM_CLEANUP(LLImage);
+	return result;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file llthreadsafequeue_libtest.cpp
+ * @brief Contention benchmark of the locking and the lock-free thread safe queues
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+
+// Linden library includes
+#include "lllockfreequeue.h"
+#include "llthreadsafequeue.h"
+#include "lltimer.h"
+
+// system libraries
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllthreadsafequeue_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -n, --items <n>\n"
+"        Number of elements each producer pushes. Default is 200000.\n"
+" -c, --capacity <n>\n"
+"        Queue capacity. Default is 1024 (what LLMainLoopRepeater uses).\n"
+"\n"
+"Pushes elements through LLThreadSafeQueue and LLLockFreeQueue from a number of producer\n"
+"threads to a number of consumer threads and reports the throughput of each. 'blocking'\n"
+"consumers wait in popBack() until the queue is closed, 'polling' consumers spin on\n"
+"tryPopBack() the way the main loop drains its queues once per frame. Checks that every\n"
+"element arrives exactly once and returns non-zero on any mismatch.\n"
+"\n";
+
+enum EConsumerMode
+{
+	CONSUMER_BLOCKING,
+	CONSUMER_POLLING
+};
+
+struct BenchResult
+{
+	F64 mSeconds;
+	U64 mCount;
+	U64 mSum;
+};
+
+template<typename QueueT>
+BenchResult bench_queue(U32 capacity, S32 num_producers, S32 num_consumers, S32 num_items, EConsumerMode mode)
+{
+	QueueT queue(capacity);
+	std::atomic<S32> producers_left(num_producers);
+	std::atomic<U64> count(0), sum(0);
+
+	std::vector<std::thread> threads;
+	LLTimer timer;
+	for (S32 idx = 0; idx < num_consumers; idx++)
+	{
+		threads.emplace_back([&]()
+			{
+				U64 local_count = 0, local_sum = 0;
+				U64 value;
+				if (CONSUMER_BLOCKING == mode)
+				{
+					try
+					{
+						while (true)
+						{
+							local_sum += queue.popBack();
+							local_count++;
+						}
+					}
+					catch (const LLThreadSafeQueueInterrupt&)
+					{
+						// Closed and drained
+					}
+				}
+				else
+				{
+					while (true)
+					{
+						if (queue.tryPopBack(value))
+						{
+							local_sum += value;
+							local_count++;
+						}
+						else if ( (0 == producers_left) && (0 == queue.size()) )
+						{
+							break;
+						}
+						else
+						{
+							std::this_thread::yield();
+						}
+					}
+				}
+				count += local_count;
+				sum += local_sum;
+			});
+	}
+
+	std::vector<std::thread> producers;
+	for (S32 idx = 0; idx < num_producers; idx++)
+	{
+		producers.emplace_back([&, idx]()
+			{
+				const U64 base = (U64)idx * num_items;
+				for (S32 item = 0; item < num_items; item++)
+				{
+					queue.pushFront(base + item + 1);
+				}
+				producers_left--;
+			});
+	}
+	for (std::thread& producer : producers)
+	{
+		producer.join();
+	}
+	queue.close();
+	for (std::thread& consumer : threads)
+	{
+		consumer.join();
+	}
+
+	return BenchResult{ timer.getElapsedTimeF64(), count, sum };
+}
+
+bool report(const char* name, S32 num_producers, S32 num_consumers, S32 num_items, const BenchResult& result)
+{
+	const U64 expected_count = (U64)num_producers * num_items;
+	const U64 expected_sum = expected_count * (expected_count + 1) / 2;
+	const bool ok = (expected_count == result.mCount) && (expected_sum == result.mSum);
+
+	std::cout << std::setw(20) << name << std::setw(8) << num_producers << std::setw(8) << num_consumers
+	          << std::setw(12) << std::fixed << std::setprecision(1) << result.mSeconds * 1000.0
+	          << std::setw(12) << std::setprecision(2) << (result.mCount / result.mSeconds) / 1000000.0
+	          << (ok ? "" : "    MISMATCH") << std::endl;
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	S32 num_items = 200000;
+	U32 capacity = 1024;
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--items") || !strcmp(argv[arg], "-n")) && arg < argc-1)
+		{
+			num_items = llmax(1, atoi(argv[++arg]));
+		}
+		else if ((!strcmp(argv[arg], "--capacity") || !strcmp(argv[arg], "-c")) && arg < argc-1)
+		{
+			capacity = (U32)llmax(2, atoi(argv[++arg]));
+		}
+		else
+		{
+			std::cout << "Error: unknown option " << argv[arg] << std::endl << USAGE << std::endl;
+			return 1;
+		}
+	}
+
+	const S32 thread_counts[][2] = { { 1, 1 }, { 2, 1 }, { 4, 1 }, { 8, 1 }, { 4, 4 }, { 8, 8 } };
+
+	int result = 0;
+	for (EConsumerMode mode : { CONSUMER_BLOCKING, CONSUMER_POLLING })
+	{
+		std::cout << ((CONSUMER_BLOCKING == mode) ? "Blocking consumers" : "Polling consumers") << std::endl;
+		std::cout << std::setw(20) << "queue" << std::setw(8) << "push" << std::setw(8) << "pop" << std::setw(12) << "ms"
+		          << std::setw(12) << "M items/s" << std::endl;
+		for (const auto& threads : thread_counts)
+		{
+			BenchResult locking = bench_queue<LLThreadSafeQueue<U64> >(capacity, threads[0], threads[1], num_items, mode);
+			if (!report("LLThreadSafeQueue", threads[0], threads[1], num_items, locking))
+			{
+				result = 1;
+			}
+			BenchResult lock_free = bench_queue<LLLockFreeQueue<U64> >(capacity, threads[0], threads[1], num_items, mode);
+			if (!report("LLLockFreeQueue", threads[0], threads[1], num_items, lock_free))
+			{
+				result = 1;
+			}
+		}
+		std::cout << std::endl;
+	}
+
+	// Cleanup and exit
+	return result;
+}
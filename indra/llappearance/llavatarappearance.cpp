@@ -190,6 +190,9 @@ LLAvatarAppearance::LLAvatarAppearance(LLWearableData* wearable_data) :
     mNumCollisionVolumes(0),
     mCollisionVolumes(NULL),
     mIsBuilt(FALSE),
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+    mSkeletonBlock(NULL),
+// [/SL:KB]
     mInitFlags(0)
 {
 	llassert_always(mWearableData);
@@ -213,6 +216,9 @@ void LLAvatarAppearance::initInstance()
 	//-------------------------------------------------------------------------
 	mRoot = createAvatarJoint();
 	mRoot->setName( "mRoot" );
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	mRootUpdateList.setRoot(mRoot);
+// [/SL:KB]
 
 	for (LLAvatarAppearanceDictionary::MeshEntries::const_iterator iter = sAvatarDictionary->getMeshEntries().begin();
 		 iter != sAvatarDictionary->getMeshEntries().end();
@@ -307,6 +313,9 @@ LLAvatarAppearance::~LLAvatarAppearance()
 
 	if (mRoot) mRoot->removeAllChildren();
 	mJointMap.clear();
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	mRootUpdateList.clear();
+// [/SL:KB]
 
 	clearSkeleton();
 	delete_and_clear_array(mCollisionVolumes);
@@ -683,6 +692,10 @@ BOOL LLAvatarAppearance::setupBone(const LLAvatarBoneInfo* info, LLJoint* parent
 		volume_num++;
 	}
 
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	// Attachment points get added later; this covers every child the skeleton itself adds
+	joint->mChildren.reserve(joint->mChildren.size() + info->mChildren.size());
+// [/SL:KB]
 
 	// setup children
 	LLAvatarBoneInfo::bones_t::const_iterator iter;
@@ -706,7 +719,15 @@ BOOL LLAvatarAppearance::allocateCharacterJoints( U32 num )
     if (mSkeleton.size() != num)
     {
         clearSkeleton();
-        mSkeleton = avatar_joint_list_t(num,NULL);
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+        mSkeletonBlock = createAvatarJointBlock(num);
+        mSkeleton.reserve(num);
+        for (U32 idx = 0; idx < num; idx++)
+        {
+            mSkeleton.push_back(mSkeletonBlock->getJoint(idx));
+        }
+// [/SL:KB]
+//        mSkeleton = avatar_joint_list_t(num,NULL);
         mNumBones = num;
     }
 
@@ -759,8 +780,12 @@ BOOL LLAvatarAppearance::buildSkeleton(const LLAvatarSkeletonInfo *info)
 //-----------------------------------------------------------------------------
 void LLAvatarAppearance::clearSkeleton()
 {
-	std::for_each(mSkeleton.begin(), mSkeleton.end(), DeletePointer());
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
 	mSkeleton.clear();
+	delete_and_clear(mSkeletonBlock);
+// [/SL:KB]
+//	std::for_each(mSkeleton.begin(), mSkeleton.end(), DeletePointer());
+//	mSkeleton.clear();
 }
 
 //------------------------------------------------------------------------
@@ -128,6 +128,9 @@ class LLAvatarAppearance : public LLCharacter
 	virtual LLAvatarJoint*	createAvatarJoint() = 0;
     virtual LLAvatarJoint*  createAvatarJoint(S32 joint_num) = 0;
 	virtual LLAvatarJointMesh*	createAvatarJointMesh() = 0;
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	virtual LLAvatarJointBlock*	createAvatarJointBlock(U32 num) = 0;
+// [/SL:KB]
     void makeJointAliases(LLAvatarBoneInfo *bone_info);
 
 
@@ -140,6 +143,10 @@ class LLAvatarAppearance : public LLCharacter
 
 	LLVector3			mHeadOffset; // current head position
 	LLAvatarJoint		*mRoot;
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	// Equivalent of mRoot->updateWorldMatrixChildren() (but walks a flattened copy of the hierarchy)
+	void				updateSkeletonWorldMatrices() { mRootUpdateList.updateWorldMatrixChildren(); }
+// [/SL:KB]
 
 	typedef std::map<std::string, LLJoint*> joint_map_t;
 // [SL:KB] - Patch: Viewer-OptimizationSkinningMatrix | Checked: Catznip-6.0
@@ -173,6 +180,10 @@ class LLAvatarAppearance : public LLCharacter
 	void				clearSkeleton();
 	BOOL				mIsBuilt; // state of deferred character building
 	avatar_joint_list_t	mSkeleton;
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	LLAvatarJointBlock*	mSkeletonBlock; // Backing storage of mSkeleton
+	LLJointUpdateList	mRootUpdateList;
+// [/SL:KB]
 	LLVector3OverrideMap	mPelvisFixups;
     joint_alias_map_t   mJointAliasMap;
 
@@ -135,6 +135,38 @@ class LLAvatarJointCollisionVolume : public LLAvatarJoint
 	LLVector3 getVolumePos(LLVector3 &offset);
 };
 
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+//-----------------------------------------------------------------------------
+// LLAvatarJointBlock
+// Owns a contiguous array of avatar joints so a skeleton's bones share a
+// single allocation (and end up next to each other in memory, in the depth
+// first order LLAvatarAppearance::setupBone() assigns joint numbers in).
+//-----------------------------------------------------------------------------
+class LLAvatarJointBlock
+{
+public:
+	virtual ~LLAvatarJointBlock() {}
+
+	virtual LLAvatarJoint* getJoint(U32 idx) = 0;
+	virtual U32 size() const = 0;
+};
+
+template<class T>
+class LLAvatarJointBlockT : public LLAvatarJointBlock
+{
+public:
+	LLAvatarJointBlockT(U32 num) : mJoints(new T[num]), mNumJoints(num) {}
+	/*virtual*/ ~LLAvatarJointBlockT() { delete[] mJoints; }
+
+	/*virtual*/ LLAvatarJoint* getJoint(U32 idx) override { llassert(idx < mNumJoints); return &mJoints[idx]; }
+	/*virtual*/ U32 size() const override { return mNumJoints; }
+
+protected:
+	T*  mJoints;
+	U32 mNumJoints;
+};
+// [/SL:KB]
+
 #endif // LL_LLAVATARJOINT_H
 
 
@@ -35,6 +35,9 @@
 #include "lldir.h"
 #include "llvfile.h"
 #include "llvfs.h"
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+#include "lltexlayercompositor.h"
+// [/SL:KB]
 #include "lltexlayerparams.h"
 #include "lltexturemanagerbridge.h"
 #include "lllocaltextureobject.h"
@@ -463,6 +466,71 @@ BOOL LLTexLayerSet::render( S32 x, S32 y, S32 width, S32 height, LLRenderTarget*
 	return success;
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+BOOL LLTexLayerSet::composite(LLTexLayerCompositor& compositor)
+{
+	llassert(on_main_thread());
+
+	BOOL success = TRUE;
+	// Unlike render() this leaves mIsVisible alone; it belongs to the GL composite
+	BOOL is_visible = TRUE;
+
+	for (layer_list_t::iterator iter = mMaskLayerList.begin(); iter != mMaskLayerList.end(); iter++)
+	{
+		LLTexLayerInterface* layer = *iter;
+		if (layer->isInvisibleAlphaMask())
+		{
+			is_visible = FALSE;
+		}
+	}
+
+	// Same initial state LLTexLayerSetBuffer::renderTexLayerSet() sets up
+	compositor.setColorMask(true, true);
+	compositor.setBlendMode(LLTexLayerCompositor::BM_ALPHA);
+
+	// clear buffer area
+	compositor.setMinimumAlpha(0.f);
+	compositor.drawColor(LLColor4(0.f, 0.f, 0.f, 1.f));
+	compositor.setMinimumAlpha(0.004f);
+
+	if (is_visible)
+	{
+		// composite color layers
+		for (layer_list_t::iterator iter = mLayerList.begin(); iter != mLayerList.end(); iter++)
+		{
+			LLTexLayerInterface* layer = *iter;
+			if (layer->getRenderPass() == LLTexLayer::RP_COLOR)
+			{
+				success &= layer->composite(compositor);
+			}
+		}
+
+		compositeAlphaMaskTextures(compositor, false);
+	}
+	else
+	{
+		compositor.setBlendMode(LLTexLayerCompositor::BM_REPLACE);
+		compositor.setMinimumAlpha(0.f);
+		compositor.drawColor(LLColor4(0.f, 0.f, 0.f, 0.f));
+		compositor.setBlendMode(LLTexLayerCompositor::BM_ALPHA);
+		compositor.setMinimumAlpha(0.004f);
+	}
+
+	return success;
+}
+
+static LLTrace::BlockTimerStatHandle FTM_COMPOSITE_TO_IMAGE("compositeToImage");
+BOOL LLTexLayerSet::compositeToImage(LLImageRaw* image_raw, const LLTexLayerRawSource* raw_source)
+{
+	LL_RECORD_BLOCK_TIME(FTM_COMPOSITE_TO_IMAGE);
+	llassert(image_raw && mInfo);
+
+	LLTexLayerCompositor compositor(mInfo->getWidth(), mInfo->getHeight(), raw_source);
+	BOOL success = composite(compositor);
+	compositor.readback(image_raw);
+	return success;
+}
+// [/SL:KB]
 
 BOOL LLTexLayerSet::isBodyRegion(const std::string& region) const 
 { 
@@ -609,6 +677,47 @@ void LLTexLayerSet::renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height,
 	gGL.setSceneBlendType(LLRender::BT_ALPHA);
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+void LLTexLayerSet::compositeAlphaMaskTextures(LLTexLayerCompositor& compositor, bool forceClear)
+{
+	const LLTexLayerSetInfo *info = getInfo();
+
+	compositor.setColorMask(false, true);
+	compositor.setBlendMode(LLTexLayerCompositor::BM_REPLACE);
+
+	// (Optionally) replace alpha with a single component image from a tga file.
+	if (!info->mStaticAlphaFileName.empty())
+	{
+		LLImageRaw* image_raw = LLTexLayerStaticImageList::getInstance()->getImageRaw(info->mStaticAlphaFileName);
+		if (image_raw)
+		{
+			compositor.drawImage(image_raw, LLColor4::white, true);
+		}
+	}
+	else if (forceClear || info->mClearAlpha || (mMaskLayerList.size() > 0))
+	{
+		// Set the alpha channel to one (clean up after previous blending)
+		compositor.setMinimumAlpha(0.f);
+		compositor.drawColor(LLColor4(0.f, 0.f, 0.f, 1.f));
+		compositor.setMinimumAlpha(0.004f);
+	}
+
+	// (Optional) Mask out part of the baked texture with alpha masks
+	if (mMaskLayerList.size() > 0)
+	{
+		compositor.setBlendMode(LLTexLayerCompositor::BM_MULT_ALPHA);
+		for (layer_list_t::iterator iter = mMaskLayerList.begin(); iter != mMaskLayerList.end(); iter++)
+		{
+			LLTexLayerInterface* layer = *iter;
+			layer->compositeAlphaTexture(compositor);
+		}
+	}
+
+	compositor.setColorMask(true, true);
+	compositor.setBlendMode(LLTexLayerCompositor::BM_ALPHA);
+}
+// [/SL:KB]
+
 void LLTexLayerSet::applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components)
 {
 	mAvatarAppearance->applyMorphMask(tex_data, width, height, num_components, mBakedTexIndex);
@@ -1306,6 +1415,100 @@ BOOL LLTexLayer::render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bou
 	return success;
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+BOOL LLTexLayer::composite(LLTexLayerCompositor& compositor)
+{
+	LLColor4 net_color;
+	BOOL color_specified = findNetColor(&net_color);
+
+	if (mTexLayerSet->getAvatarAppearance()->mIsDummy)
+	{
+		color_specified = true;
+		net_color = LLAvatarAppearance::getDummyColor();
+	}
+
+	BOOL success = TRUE;
+
+	// If you can't see the layer, don't render it.
+	if (is_approx_zero(net_color.mV[VW]))
+	{
+		return success;
+	}
+
+	BOOL alpha_mask_specified = FALSE;
+	if (!mParamAlphaList.empty())
+	{
+		compositeMorphMasks(compositor, net_color);
+		alpha_mask_specified = TRUE;
+		compositor.setBlendMode(LLTexLayerCompositor::BM_DEST_ALPHA);
+	}
+
+	if (getInfo()->mWriteAllChannels)
+	{
+		compositor.setBlendMode(LLTexLayerCompositor::BM_REPLACE);
+	}
+
+	if ( (getInfo()->mLocalTexture != -1) && (!getInfo()->mUseLocalTextureAlphaOnly) )
+	{
+		const LLTexLayerRawSource* raw_source = compositor.getRawSource();
+		LLImageRaw* image_raw = NULL;
+		if ( (raw_source) && (mLocalTextureObject) && (mLocalTextureObject->getID() != IMG_DEFAULT_AVATAR) )
+		{
+			image_raw = raw_source->getLocalTextureRaw(mLocalTextureObject, (ETextureIndex)getInfo()->mLocalTexture);
+		}
+
+		if (image_raw)
+		{
+			bool no_alpha_test = getInfo()->mWriteAllChannels;
+			if (no_alpha_test)
+			{
+				compositor.setMinimumAlpha(0.f);
+			}
+
+			compositor.drawImage(image_raw, net_color);
+
+			if (no_alpha_test)
+			{
+				compositor.setMinimumAlpha(0.004f);
+			}
+		}
+	}
+
+	if (!getInfo()->mStaticImageFileName.empty())
+	{
+		LLImageRaw* image_raw = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName);
+		if (image_raw)
+		{
+			compositor.drawImage(image_raw, net_color, getInfo()->mStaticImageIsMask);
+		}
+		else
+		{
+			success = FALSE;
+		}
+	}
+
+	if ( ((-1 == getInfo()->mLocalTexture) || (getInfo()->mUseLocalTextureAlphaOnly)) &&
+		 (getInfo()->mStaticImageFileName.empty()) && (color_specified) )
+	{
+		compositor.setMinimumAlpha(0.f);
+		compositor.drawColor(net_color);
+		compositor.setMinimumAlpha(0.004f);
+	}
+
+	if ( (alpha_mask_specified) || (getInfo()->mWriteAllChannels) )
+	{
+		// Restore standard blend func value
+		compositor.setBlendMode(LLTexLayerCompositor::BM_ALPHA);
+	}
+
+	if (!success)
+	{
+		LL_INFOS() << "LLTexLayer::composite() partial: " << getInfo()->mName << LL_ENDL;
+	}
+	return success;
+}
+// [/SL:KB]
+
 const U8*	LLTexLayer::getAlphaData() const
 {
 	LLCRC alpha_mask_crc;
@@ -1428,6 +1631,35 @@ BOOL LLTexLayer::blendAlphaTexture(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+BOOL LLTexLayer::compositeAlphaTexture(LLTexLayerCompositor& compositor)
+{
+	BOOL success = TRUE;
+
+	LLImageRaw* image_raw = NULL;
+	bool is_mask = false;
+	if (!getInfo()->mStaticImageFileName.empty())
+	{
+		image_raw = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName);
+		is_mask = getInfo()->mStaticImageIsMask;
+		success = (image_raw != NULL);
+	}
+	else if ( (getInfo()->mLocalTexture >= 0) && (getInfo()->mLocalTexture < TEX_NUM_INDICES) && (compositor.getRawSource()) )
+	{
+		image_raw = compositor.getRawSource()->getLocalTextureRaw(mLocalTextureObject, (ETextureIndex)getInfo()->mLocalTexture);
+	}
+
+	if (image_raw)
+	{
+		compositor.setMinimumAlpha(0.f);
+		compositor.drawImage(image_raw, LLColor4::white, is_mask);
+		compositor.setMinimumAlpha(0.004f);
+	}
+
+	return success;
+}
+// [/SL:KB]
+
 /*virtual*/ void LLTexLayer::gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target)
 {
 	addAlphaMask(data, originX, originY, width, height, bound_target);
@@ -1639,6 +1871,73 @@ void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLC
 	}
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+// CPU equivalent of renderMorphMasks(); leaves the accumulated mask in the compositor's alpha channel.
+// Unlike the GL path this doesn't read the mask back into mAlphaCache or apply it to the avatar mesh.
+void LLTexLayer::compositeMorphMasks(LLTexLayerCompositor& compositor, const LLColor4 &layer_color)
+{
+	llassert(!mParamAlphaList.empty());
+
+	compositor.setMinimumAlpha(0.f);
+	compositor.setColorMask(false, true);
+
+	LLTexLayerParamAlpha* first_param = *mParamAlphaList.begin();
+	// Note: if the first param is a mulitply, multiply against the current buffer's alpha
+	if ( (!first_param) || (!first_param->getMultiplyBlend()) )
+	{
+		// Clear the alpha
+		compositor.setBlendMode(LLTexLayerCompositor::BM_REPLACE);
+		compositor.drawColor(LLColor4(0.f, 0.f, 0.f, 0.f));
+	}
+
+	// Accumulate alphas
+	for (param_alpha_list_t::iterator iter = mParamAlphaList.begin(); iter != mParamAlphaList.end(); iter++)
+	{
+		LLTexLayerParamAlpha* param = *iter;
+		param->composite(compositor);
+	}
+
+	// Approximates a min() function
+	compositor.setBlendMode(LLTexLayerCompositor::BM_MULT_ALPHA);
+
+	// Accumulate the alpha component of the texture
+	if ( (getInfo()->mLocalTexture != -1) && (compositor.getRawSource()) )
+	{
+		LLImageRaw* image_raw = compositor.getRawSource()->getLocalTextureRaw(mLocalTextureObject, (ETextureIndex)getInfo()->mLocalTexture);
+		if ( (image_raw) && (image_raw->getComponents() == 4) )
+		{
+			compositor.drawImage(image_raw, LLColor4::white);
+		}
+	}
+
+	if ( (!getInfo()->mStaticImageFileName.empty()) && (getInfo()->mStaticImageIsMask) )
+	{
+		LLImageRaw* image_raw = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName);
+		if (image_raw)
+		{
+			if ( (image_raw->getComponents() == 4) || (image_raw->getComponents() == 1) )
+			{
+				compositor.drawImage(image_raw, LLColor4::white, true);
+			}
+			else
+			{
+				LL_WARNS() << "Skipping rendering of " << getInfo()->mStaticImageFileName 
+						<< "; expected 1 or 4 components." << LL_ENDL;
+			}
+		}
+	}
+
+	// Multiply the alpha by the layer color's alpha
+	if (!is_approx_equal(layer_color.mV[VW], 1.f))
+	{
+		compositor.drawColor(layer_color);
+	}
+
+	compositor.setMinimumAlpha(0.004f);
+	compositor.setColorMask(true, true);
+}
+// [/SL:KB]
+
 static LLTrace::BlockTimerStatHandle FTM_ADD_ALPHA_MASK("addAlphaMask");
 void LLTexLayer::addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target)
 {
@@ -1820,6 +2119,33 @@ LLTexLayer* LLTexLayerTemplate::getLayer(U32 i) const
 	return success;
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+/*virtual*/ BOOL LLTexLayerTemplate::composite(LLTexLayerCompositor& compositor)
+{
+	if(!mInfo)
+	{
+		return FALSE ;
+	}
+
+	BOOL success = TRUE;
+	updateWearableCache();
+	for (wearable_cache_t::const_iterator iter = mWearableCache.begin(); iter!= mWearableCache.end(); iter++)
+	{
+		LLWearable* wearable = *iter;
+		LLLocalTextureObject *lto = (wearable) ? wearable->getLocalTextureObject(mInfo->mLocalTexture) : NULL;
+		LLTexLayer *layer = (lto) ? lto->getTexLayer(getName()) : NULL;
+		if (layer)
+		{
+			wearable->writeToAvatar(mAvatarAppearance);
+			layer->setLTO(lto);
+			success &= layer->composite(compositor);
+		}
+	}
+
+	return success;
+}
+// [/SL:KB]
+
 /*virtual*/ BOOL LLTexLayerTemplate::blendAlphaTexture( S32 x, S32 y, S32 width, S32 height) // Multiplies a single alpha texture against the frame buffer
 {
 	BOOL success = TRUE;
@@ -1835,6 +2161,23 @@ LLTexLayer* LLTexLayerTemplate::getLayer(U32 i) const
 	return success;
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+/*virtual*/ BOOL LLTexLayerTemplate::compositeAlphaTexture(LLTexLayerCompositor& compositor)
+{
+	BOOL success = TRUE;
+	U32 num_wearables = updateWearableCache();
+	for (U32 i = 0; i < num_wearables; i++)
+	{
+		LLTexLayer *layer = getLayer(i);
+		if (layer)
+		{
+			success &= layer->compositeAlphaTexture(compositor);
+		}
+	}
+	return success;
+}
+// [/SL:KB]
+
 /*virtual*/ void LLTexLayerTemplate::gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target)
 {
 	U32 num_wearables = updateWearableCache();
@@ -1943,6 +2286,9 @@ void LLTexLayerSet::cloneTemplates(LLLocalTextureObject *lto, LLAvatarAppearance
 LLTexLayerStaticImageList::LLTexLayerStaticImageList() :
 	mGLBytes(0),
 	mTGABytes(0),
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	mRawBytes(0),
+// [/SL:KB]
 	mImageNames(16384)
 {
 }
@@ -1956,24 +2302,41 @@ void LLTexLayerStaticImageList::dumpByteCount() const
 {
 	LL_INFOS() << "Avatar Static Textures " <<
 		"KB GL:" << (mGLBytes / 1024) <<
-		"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+		"KB TGA:" << (mTGABytes / 1024) <<
+		"KB Raw:" << (mRawBytes / 1024) << "KB" << LL_ENDL;
+// [/SL:KB]
+//		"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
 }
 
 void LLTexLayerStaticImageList::deleteCachedImages()
 {
-	if( mGLBytes || mTGABytes )
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	if( mGLBytes || mTGABytes || mRawBytes )
+// [/SL:KB]
+//	if( mGLBytes || mTGABytes )
 	{
 		LL_INFOS() << "Clearing Static Textures " <<
 			"KB GL:" << (mGLBytes / 1024) <<
-			"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+			"KB TGA:" << (mTGABytes / 1024) <<
+			"KB Raw:" << (mRawBytes / 1024) << "KB" << LL_ENDL;
+// [/SL:KB]
+//			"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
 
 		//mStaticImageLists uses LLPointers, clear() will cause deletion
 		
 		mStaticImageListTGA.clear();
 		mStaticImageList.clear();
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+		mStaticImageListRaw.clear();
+// [/SL:KB]
 		
 		mGLBytes = 0;
 		mTGABytes = 0;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+		mRawBytes = 0;
+// [/SL:KB]
 	}
 }
 
@@ -2011,6 +2374,33 @@ LLImageTGA* LLTexLayerStaticImageList::getImageTGA(const std::string& file_name)
 	}
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+// Returns the decoded data from a tga file named file_name for use by the CPU compositor.
+// Single channel images are kept as-is (the compositor expands masks itself).
+// Caches the result to speed identical subsequent requests.
+static LLTrace::BlockTimerStatHandle FTM_LOAD_STATIC_RAW("getImageRaw");
+LLImageRaw* LLTexLayerStaticImageList::getImageRaw(const std::string& file_name)
+{
+	LL_RECORD_BLOCK_TIME(FTM_LOAD_STATIC_RAW);
+	llassert(on_main_thread());
+	const char *namekey = mImageNames.addString(file_name);
+	image_raw_map_t::const_iterator iter = mStaticImageListRaw.find(namekey);
+	if( iter != mStaticImageListRaw.end() )
+	{
+		return iter->second;
+	}
+
+	LLPointer<LLImageRaw> image_raw = new LLImageRaw;
+	if( !loadImageRaw( file_name, image_raw ) )
+	{
+		return NULL;
+	}
+	mStaticImageListRaw[ namekey ] = image_raw;
+	mRawBytes += image_raw->getDataSize();
+	return image_raw;
+}
+// [/SL:KB]
+
 // Returns a GL Image (without a backing ImageRaw) that contains the decoded data from a tga file named file_name.
 // Caches the result to speed identical subsequent requests.
 static LLTrace::BlockTimerStatHandle FTM_LOAD_STATIC_TEXTURE("getTexture");
@@ -42,6 +42,10 @@ class LLTexLayerSet;
 class LLTexLayerSetInfo;
 class LLTexLayerInfo;
 class LLTexLayerSetBuffer;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+class LLTexLayerCompositor;
+class LLTexLayerRawSource;
+// [/SL:KB]
 class LLWearable;
 class LLViewerVisualParam;
 
@@ -66,8 +70,14 @@ class LLTexLayerInterface
 	virtual ~LLTexLayerInterface() {}
 
 	virtual BOOL			render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target) = 0;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	virtual BOOL			composite(LLTexLayerCompositor& compositor) = 0; // CPU equivalent of render()
+// [/SL:KB]
 	virtual void			deleteCaches() = 0;
 	virtual BOOL			blendAlphaTexture(S32 x, S32 y, S32 width, S32 height) = 0;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	virtual BOOL			compositeAlphaTexture(LLTexLayerCompositor& compositor) = 0; // CPU equivalent of blendAlphaTexture()
+// [/SL:KB]
 	virtual BOOL			isInvisibleAlphaMask() const = 0;
 
 	const LLTexLayerInfo* 	getInfo() const 			{ return mInfo; }
@@ -122,8 +132,14 @@ class LLTexLayerTemplate : public LLTexLayerInterface
 	LLTexLayerTemplate(const LLTexLayerTemplate &layer);
 	/*virtual*/ ~LLTexLayerTemplate();
 	/*virtual*/ BOOL		render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target);
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	/*virtual*/ BOOL		composite(LLTexLayerCompositor& compositor);
+// [/SL:KB]
 	/*virtual*/ BOOL		setInfo(const LLTexLayerInfo *info, LLWearable* wearable); // This sets mInfo and calls initialization functions
 	/*virtual*/ BOOL		blendAlphaTexture(S32 x, S32 y, S32 width, S32 height); // Multiplies a single alpha texture against the frame buffer
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	/*virtual*/ BOOL		compositeAlphaTexture(LLTexLayerCompositor& compositor);
+// [/SL:KB]
 	/*virtual*/ void		gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
 	/*virtual*/ void		setHasMorph(BOOL newval);
 	/*virtual*/ void		deleteCaches();
@@ -153,14 +169,23 @@ class LLTexLayer : public LLTexLayerInterface
 
 	/*virtual*/ BOOL		setInfo(const LLTexLayerInfo *info, LLWearable* wearable); // This sets mInfo and calls initialization functions
 	/*virtual*/ BOOL		render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target);
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	/*virtual*/ BOOL		composite(LLTexLayerCompositor& compositor);
+// [/SL:KB]
 
 	/*virtual*/ void		deleteCaches();
 	const U8*				getAlphaData() const;
 
 	BOOL					findNetColor(LLColor4* color) const;
 	/*virtual*/ BOOL		blendAlphaTexture(S32 x, S32 y, S32 width, S32 height); // Multiplies a single alpha texture against the frame buffer
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	/*virtual*/ BOOL		compositeAlphaTexture(LLTexLayerCompositor& compositor);
+// [/SL:KB]
 	/*virtual*/ void		gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
 	void					renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render);
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	void					compositeMorphMasks(LLTexLayerCompositor& compositor, const LLColor4 &layer_color);
+// [/SL:KB]
 	void					addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
 	/*virtual*/ BOOL		isInvisibleAlphaMask() const;
 
@@ -202,6 +227,15 @@ class LLTexLayerSet
 	BOOL						render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target = nullptr);
 	void						renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target = nullptr, bool forceClear = false);
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	// CPU compositing path: produces the same bake as render() without touching GL (morph mask caches are not updated).
+	// Main thread only: like render() it writes wearable params to the avatar, refreshes the processed alpha param
+	// images shared with the GL path and fills the LLTexLayerStaticImageList caches.
+	BOOL						composite(LLTexLayerCompositor& compositor);
+	void						compositeAlphaMaskTextures(LLTexLayerCompositor& compositor, bool forceClear = false);
+	BOOL						compositeToImage(LLImageRaw* image_raw, const LLTexLayerRawSource* raw_source);
+// [/SL:KB]
+
 	BOOL						isBodyRegion(const std::string& region) const;
 	void						applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components);
 	BOOL						isMorphValid() const;
@@ -298,6 +332,9 @@ class LLTexLayerStaticImageList : public LLSingleton<LLTexLayerStaticImageList>
 public:
 	LLGLTexture*		getTexture(const std::string& file_name, BOOL is_mask);
 	LLImageTGA*			getImageTGA(const std::string& file_name);
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	LLImageRaw*			getImageRaw(const std::string& file_name);
+// [/SL:KB]
 	void				deleteCachedImages();
 	void				dumpByteCount() const;
 protected:
@@ -308,8 +345,15 @@ class LLTexLayerStaticImageList : public LLSingleton<LLTexLayerStaticImageList>
 	texture_map_t 		mStaticImageList;
 	typedef std::map<const char*, LLPointer<LLImageTGA> > image_tga_map_t;
 	image_tga_map_t 	mStaticImageListTGA;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	typedef std::map<const char*, LLPointer<LLImageRaw> > image_raw_map_t;
+	image_raw_map_t 	mStaticImageListRaw;
+// [/SL:KB]
 	S32 				mGLBytes;
 	S32 				mTGABytes;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	S32 				mRawBytes;
+// [/SL:KB]
 };
 
 #endif  // LL_LLTEXLAYER_H
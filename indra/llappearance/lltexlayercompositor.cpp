@@ -0,0 +1,349 @@
+/**
+ * @file lltexlayercompositor.cpp
+ * @brief CPU compositor for avatar texture layer sets.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltexlayercompositor.h"
+
+#include "llfasttimer.h"
+#include "llmemory.h"
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+
+static const F32 ONE_OVER_255 = 1.f / 255.f;
+
+// Expands a texel to normalized RGBA the same way GL does when sampling the
+// formats LLTexLayerStaticImageList and the texture manager upload.
+static inline void fetch_texel(const U8* texel, S32 components, bool is_mask, LLVector4a& out)
+{
+	switch (components)
+	{
+		case 1:
+			if (is_mask)
+			{
+				out.set(0.f, 0.f, 0.f, texel[0] * ONE_OVER_255);
+			}
+			else
+			{
+				out.splat(texel[0] * ONE_OVER_255);
+				out.getF32ptr()[VW] = 1.f;
+			}
+			break;
+		case 2:
+			out.splat(texel[0] * ONE_OVER_255);
+			out.getF32ptr()[VW] = texel[1] * ONE_OVER_255;
+			break;
+		case 3:
+			out.set(texel[0] * ONE_OVER_255, texel[1] * ONE_OVER_255, texel[2] * ONE_OVER_255, 1.f);
+			break;
+		default:
+			out.set(texel[0] * ONE_OVER_255, texel[1] * ONE_OVER_255, texel[2] * ONE_OVER_255, texel[3] * ONE_OVER_255);
+			break;
+	}
+}
+
+static inline U8 to_u8(F32 value)
+{
+	return (U8)llclamp((S32)(value * 255.f + 0.5f), 0, 255);
+}
+
+//-----------------------------------------------------------------------------
+// LLTexLayerCompositor
+//-----------------------------------------------------------------------------
+
+LLTexLayerCompositor::LLTexLayerCompositor(S32 width, S32 height, const LLTexLayerRawSource* raw_source) :
+	mWidth(width),
+	mHeight(height),
+	mPixels(NULL),
+	mRawSource(raw_source),
+	mBlendMode(BM_ALPHA),
+	mWriteColor(true),
+	mWriteAlpha(true),
+	mMinimumAlpha(0.f)
+{
+	llassert(mWidth > 0 && mHeight > 0);
+	mPixels = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a) * mWidth * mHeight);
+	for (S32 i = 0, count = mWidth * mHeight; i < count; ++i)
+	{
+		mPixels[i].clear();
+	}
+}
+
+LLTexLayerCompositor::~LLTexLayerCompositor()
+{
+	ll_aligned_free_16(mPixels);
+	mPixels = NULL;
+}
+
+void LLTexLayerCompositor::drawColor(const LLColor4& color)
+{
+	queueCommand(NULL, color, false);
+}
+
+void LLTexLayerCompositor::drawImage(const LLImageRaw* image, const LLColor4& color, bool is_mask)
+{
+	if ( (!image) || (!image->getData()) || (image->getWidth() <= 0) || (image->getHeight() <= 0) )
+	{
+		LL_WARNS() << "Skipping draw of an empty image" << LL_ENDL;
+		return;
+	}
+	queueCommand(image, color, is_mask);
+}
+
+void LLTexLayerCompositor::queueCommand(const LLImageRaw* image, const LLColor4& color, bool is_mask)
+{
+	if ( (!mWriteColor) && (!mWriteAlpha) )
+	{
+		return;
+	}
+
+	LLDrawCommand cmd;
+	cmd.mImage = const_cast<LLImageRaw*>(image);
+	cmd.mColor = color;
+	cmd.mBlendMode = mBlendMode;
+	cmd.mWriteColor = mWriteColor;
+	cmd.mWriteAlpha = mWriteAlpha;
+	cmd.mMinimumAlpha = mMinimumAlpha;
+	cmd.mIsMask = is_mask;
+	mCommands.push_back(cmd);
+}
+
+static LLTrace::BlockTimerStatHandle FTM_TEX_LAYER_COMPOSITE_CPU("CPU tex layer composite");
+void LLTexLayerCompositor::flush()
+{
+	if (mCommands.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_TEX_LAYER_COMPOSITE_CPU);
+	for (S32 tile_y = 0; tile_y < mHeight; tile_y += TILE_SIZE)
+	{
+		for (S32 tile_x = 0; tile_x < mWidth; tile_x += TILE_SIZE)
+		{
+			compositeTile(tile_x, tile_y);
+		}
+	}
+	mCommands.clear();
+}
+
+// Bilinearly samples [x0, x1) of row y of the command's source (or its flat color) into out, modulated by the command color
+void LLTexLayerCompositor::sampleRow(const LLDrawCommand& cmd, S32 x0, S32 x1, S32 y, LLVector4a* out) const
+{
+	LLVector4a color;
+	color.loadua(cmd.mColor.mV);
+
+	const LLImageRaw* image = cmd.mImage.get();
+	if (!image)
+	{
+		for (S32 x = x0; x < x1; ++x)
+		{
+			*out++ = color;
+		}
+		return;
+	}
+
+	const S32 src_width = image->getWidth();
+	const S32 src_height = image->getHeight();
+	const S32 components = image->getComponents();
+	const U8* data = image->getData();
+
+	if ( (src_width == mWidth) && (src_height == mHeight) )
+	{
+		// Common case: texture and bake have the same size, texel centers line up exactly
+		const U8* texel = data + (y * src_width + x0) * components;
+		for (S32 x = x0; x < x1; ++x, texel += components)
+		{
+			fetch_texel(texel, components, cmd.mIsMask, *out);
+			out->mul(color);
+			++out;
+		}
+		return;
+	}
+
+	// GL_LINEAR with TAM_CLAMP: sample positions are taken at destination pixel centers
+	const F32 scale_x = (F32)src_width / (F32)mWidth;
+	const F32 scale_y = (F32)src_height / (F32)mHeight;
+
+	const F32 v = llclamp((y + 0.5f) * scale_y - 0.5f, 0.f, (F32)(src_height - 1));
+	const S32 row0 = (S32)v;
+	const S32 row1 = llmin(row0 + 1, src_height - 1);
+	const F32 frac_y = v - row0;
+	const U8* src_row0 = data + row0 * src_width * components;
+	const U8* src_row1 = data + row1 * src_width * components;
+
+	LLVector4a t00, t10, t01, t11, top, bottom;
+	for (S32 x = x0; x < x1; ++x)
+	{
+		const F32 u = llclamp((x + 0.5f) * scale_x - 0.5f, 0.f, (F32)(src_width - 1));
+		const S32 col0 = (S32)u;
+		const S32 col1 = llmin(col0 + 1, src_width - 1);
+		const F32 frac_x = u - col0;
+
+		fetch_texel(src_row0 + col0 * components, components, cmd.mIsMask, t00);
+		fetch_texel(src_row0 + col1 * components, components, cmd.mIsMask, t10);
+		fetch_texel(src_row1 + col0 * components, components, cmd.mIsMask, t01);
+		fetch_texel(src_row1 + col1 * components, components, cmd.mIsMask, t11);
+
+		top.setLerp(t00, t10, frac_x);
+		bottom.setLerp(t01, t11, frac_x);
+		out->setLerp(top, bottom, frac_y);
+		out->mul(color);
+		++out;
+	}
+}
+
+void LLTexLayerCompositor::compositeTile(S32 tile_x, S32 tile_y)
+{
+	const S32 x1 = llmin(tile_x + TILE_SIZE, mWidth);
+	const S32 y1 = llmin(tile_y + TILE_SIZE, mHeight);
+
+	LL_ALIGN_16(LLVector4a src_row[TILE_SIZE]);
+
+	LLVector4a zero, one;
+	zero.clear();
+	one.splat(1.f);
+
+	for (command_list_t::const_iterator itCmd = mCommands.begin(); itCmd != mCommands.end(); ++itCmd)
+	{
+		const LLDrawCommand& cmd = *itCmd;
+
+		LLVector4Logical write_mask;
+		write_mask.clear();
+		if (cmd.mWriteColor)
+		{
+			write_mask.setElement<VX>();
+			write_mask.setElement<VY>();
+			write_mask.setElement<VZ>();
+		}
+		if (cmd.mWriteAlpha)
+		{
+			write_mask.setElement<VW>();
+		}
+
+		for (S32 y = tile_y; y < y1; ++y)
+		{
+			sampleRow(cmd, tile_x, x1, y, src_row);
+
+			LLVector4a* dst = mPixels + y * mWidth + tile_x;
+			const LLVector4a* src = src_row;
+			for (S32 x = tile_x; x < x1; ++x, ++dst, ++src)
+			{
+				// Alpha test (gAlphaMaskProgram.setMinimumAlpha)
+				if ( (cmd.mMinimumAlpha > 0.f) && ((*src)[VW] < cmd.mMinimumAlpha) )
+				{
+					continue;
+				}
+
+				LLVector4a result, factor, inv_factor;
+				switch (cmd.mBlendMode)
+				{
+					case BM_ALPHA:
+						factor.splat<VW>(*src);
+						inv_factor.setSub(one, factor);
+						result.setMul(*src, factor);
+						inv_factor.mul(*dst);
+						result.add(inv_factor);
+						break;
+					case BM_ADD:
+						result.setAdd(*src, *dst);
+						break;
+					case BM_REPLACE:
+						result = *src;
+						break;
+					case BM_MULT_ALPHA:
+						factor.splat<VW>(*dst);
+						result.setMul(*src, factor);
+						break;
+					case BM_DEST_ALPHA:
+						factor.splat<VW>(*dst);
+						inv_factor.setSub(one, factor);
+						result.setMul(*src, factor);
+						inv_factor.mul(*dst);
+						result.add(inv_factor);
+						break;
+				}
+
+				// Fixed point render targets saturate
+				result.clamp(zero, one);
+				dst->setSelectWithMask(write_mask, result, *dst);
+			}
+		}
+	}
+}
+
+void LLTexLayerCompositor::readback(LLImageRaw* image, S32 components)
+{
+	llassert(image && ((components == 1) || (components == 4)));
+	flush();
+
+	image->resize(mWidth, mHeight, components);
+	U8* out = image->getData();
+	const LLVector4a* pixel = mPixels;
+	for (S32 i = 0, count = mWidth * mHeight; i < count; ++i, ++pixel)
+	{
+		if (components == 4)
+		{
+			*out++ = to_u8((*pixel)[VX]);
+			*out++ = to_u8((*pixel)[VY]);
+			*out++ = to_u8((*pixel)[VZ]);
+		}
+		*out++ = to_u8((*pixel)[VW]);
+	}
+}
+
+void LLTexLayerCompositor::readbackAlpha(U8* data)
+{
+	llassert(data);
+	flush();
+
+	const LLVector4a* pixel = mPixels;
+	for (S32 i = 0, count = mWidth * mHeight; i < count; ++i, ++pixel)
+	{
+		data[i] = to_u8((*pixel)[VW]);
+	}
+}
+
+// static
+S32 LLTexLayerCompositor::compareImages(const LLImageRaw* lhs, const LLImageRaw* rhs)
+{
+	if ( (!lhs) || (!rhs) || (lhs->getWidth() != rhs->getWidth()) || (lhs->getHeight() != rhs->getHeight()) ||
+		 (lhs->getComponents() != rhs->getComponents()) )
+	{
+		return -1;
+	}
+
+	S32 max_diff = 0;
+	const U8* lhs_data = lhs->getData();
+	const U8* rhs_data = rhs->getData();
+	for (S32 i = 0, count = lhs->getDataSize(); i < count; ++i)
+	{
+		max_diff = llmax(max_diff, llabs((S32)lhs_data[i] - (S32)rhs_data[i]));
+	}
+	return max_diff;
+}
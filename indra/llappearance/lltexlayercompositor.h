@@ -0,0 +1,150 @@
+/**
+ * @file lltexlayercompositor.h
+ * @brief CPU compositor for avatar texture layer sets.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXLAYERCOMPOSITOR_H
+#define LL_LLTEXLAYERCOMPOSITOR_H
+
+#include "llimage.h"
+#include "llpointer.h"
+#include "llmath.h"
+#include "v4color.h"
+#include "llavatarappearancedefines.h"
+
+class LLLocalTextureObject;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLTexLayerRawSource
+//
+// Supplies decoded pixel data for local (wearable) textures to the CPU
+// compositor. The GL path binds LLGLTextures directly; the CPU path has no
+// access to GL texture memory so the owner of the raw images (the viewer's
+// texture list, or a test harness) has to hand them over.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLTexLayerRawSource
+{
+public:
+	virtual ~LLTexLayerRawSource() {}
+
+	// Returns NULL if no decoded data is available for the texture (the layer is skipped, as the GL path does for a missing texture)
+	virtual LLImageRaw*		getLocalTextureRaw(const LLLocalTextureObject* lto, LLAvatarAppearanceDefines::ETextureIndex tex_index) const = 0;
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLTexLayerCompositor
+//
+// Software equivalent of the render target LLTexLayerSet::render() draws into.
+// Draw calls mirror the fixed set of blend functions the layer code uses and
+// are recorded into a command list; flush() then replays the whole list one
+// tile at a time so each tile stays in cache while every layer is applied to it.
+// Pixels are kept as LLVector4a (RGBA floats) so each blend is a handful of
+// SSE operations per pixel.
+//
+// An instance only touches its own surface and command list; the layer set
+// traversal that feeds it (LLTexLayerSet::composite) is main thread only.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLTexLayerCompositor
+{
+	LOG_CLASS(LLTexLayerCompositor);
+public:
+	// Matches the LLRender scene blend types used by the tex layer code
+	enum EBlendMode
+	{
+		BM_ALPHA,			// BF_SOURCE_ALPHA, BF_ONE_MINUS_SOURCE_ALPHA
+		BM_ADD,				// BF_ONE, BF_ONE
+		BM_REPLACE,			// BF_ONE, BF_ZERO
+		BM_MULT_ALPHA,		// BF_DEST_ALPHA, BF_ZERO
+		BM_DEST_ALPHA		// BF_DEST_ALPHA, BF_ONE_MINUS_DEST_ALPHA
+	};
+
+	static const S32 TILE_SIZE = 64;
+
+	LLTexLayerCompositor(S32 width, S32 height, const LLTexLayerRawSource* raw_source = NULL);
+	~LLTexLayerCompositor();
+
+	// Owns an aligned pixel buffer
+	LLTexLayerCompositor(const LLTexLayerCompositor&) = delete;
+	LLTexLayerCompositor& operator=(const LLTexLayerCompositor&) = delete;
+
+	S32						getWidth() const				{ return mWidth; }
+	S32						getHeight() const				{ return mHeight; }
+	const LLTexLayerRawSource* getRawSource() const			{ return mRawSource; }
+
+	// Render state (equivalent of gGL.setSceneBlendType / setColorMask / setMinimumAlpha)
+	void					setBlendMode(EBlendMode mode)	{ mBlendMode = mode; }
+	EBlendMode				getBlendMode() const			{ return mBlendMode; }
+	void					setColorMask(bool write_color, bool write_alpha)	{ mWriteColor = write_color; mWriteAlpha = write_alpha; }
+	void					setMinimumAlpha(F32 min_alpha)	{ mMinimumAlpha = min_alpha; }
+
+	// Draws a full-surface quad of the given color
+	void					drawColor(const LLColor4& color);
+	// Draws image stretched over the full surface, modulated by color (TB_MULT).
+	// Single channel images are treated as alpha masks (black RGB) when is_mask is set.
+	void					drawImage(const LLImageRaw* image, const LLColor4& color, bool is_mask = false);
+
+	// Executes all pending draw calls
+	void					flush();
+
+	// Copies the composited result into image (resized to RGBA, or alpha only if components == 1)
+	void					readback(LLImageRaw* image, S32 components = 4);
+	void					readbackAlpha(U8* data);
+
+	// Largest per-channel difference between two images of identical dimensions (-1 on mismatch)
+	static S32				compareImages(const LLImageRaw* lhs, const LLImageRaw* rhs);
+
+	struct LLDrawCommand
+	{
+		LLPointer<LLImageRaw>	mImage;
+		LLColor4				mColor;
+		EBlendMode				mBlendMode;
+		bool					mWriteColor;
+		bool					mWriteAlpha;
+		F32						mMinimumAlpha;
+		bool					mIsMask;
+	};
+	typedef std::vector<LLDrawCommand> command_list_t;
+
+	// Draw calls queued since the last flush (lets a test replay them through a reference blender)
+	const command_list_t&	getCommands() const				{ return mCommands; }
+
+private:
+	void					queueCommand(const LLImageRaw* image, const LLColor4& color, bool is_mask);
+	void					compositeTile(S32 tile_x, S32 tile_y);
+	void					sampleRow(const LLDrawCommand& cmd, S32 x0, S32 x1, S32 y, LLVector4a* out) const;
+
+private:
+	S32						mWidth;
+	S32						mHeight;
+	LLVector4a*				mPixels;
+	const LLTexLayerRawSource* mRawSource;
+
+	EBlendMode				mBlendMode;
+	bool					mWriteColor;
+	bool					mWriteAlpha;
+	F32						mMinimumAlpha;
+	command_list_t			mCommands;
+};
+
+#endif  // LL_LLTEXLAYERCOMPOSITOR_H
@@ -32,6 +32,9 @@
 #include "llimagetga.h"
 #include "llquantize.h"
 #include "lltexlayer.h"
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+#include "lltexlayercompositor.h"
+// [/SL:KB]
 #include "lltexturemanagerbridge.h"
 #include "../llui/llui.h"
 #include "llwearable.h"
@@ -373,6 +376,69 @@ BOOL LLTexLayerParamAlpha::render(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+BOOL LLTexLayerParamAlpha::composite(LLTexLayerCompositor& compositor)
+{
+	BOOL success = TRUE;
+
+	if (!mTexLayer)
+	{
+		return success;
+	}
+
+	F32 effective_weight = (mTexLayer->getTexLayerSet()->getAvatarAppearance()->getSex() & getSex()) ? mCurWeight : getDefaultWeight();
+	BOOL weight_changed = effective_weight != mCachedEffectiveWeight;
+	if (getSkip())
+	{
+		return success;
+	}
+
+	LLTexLayerParamAlphaInfo *info = (LLTexLayerParamAlphaInfo *)getInfo();
+	if (info->mMultiplyBlend)
+	{
+		compositor.setBlendMode(LLTexLayerCompositor::BM_MULT_ALPHA); // Multiplication: approximates a min() function
+	}
+	else
+	{
+		compositor.setBlendMode(LLTexLayerCompositor::BM_ADD);  // Addition: approximates a max() function
+	}
+
+	if (!info->mStaticImageFileName.empty() && !mStaticImageInvalid)
+	{
+		if (mStaticImageTGA.isNull())
+		{
+			mStaticImageTGA = LLTexLayerStaticImageList::getInstance()->getImageTGA(info->mStaticImageFileName);
+			LLTexLayerSet::sHasCaches |= mStaticImageTGA.notNull() ? TRUE : FALSE;
+
+			if (mStaticImageTGA.isNull())
+			{
+				LL_WARNS() << "Unable to load static file: " << info->mStaticImageFileName << LL_ENDL;
+				mStaticImageInvalid = TRUE; // don't try again.
+				return FALSE;
+			}
+		}
+
+		if ( (mStaticImageRaw.isNull()) || (weight_changed) )
+		{
+			mCachedEffectiveWeight = effective_weight;
+
+			// Shares the processed image with the GL path so it gets re-uploaded there as well
+			mStaticImageRaw = new LLImageRaw;
+			mStaticImageTGA->decodeAndProcess(mStaticImageRaw, info->mDomain, effective_weight);
+			mNeedsCreateTexture = TRUE;
+		}
+
+		compositor.drawImage(mStaticImageRaw, LLColor4::white, true);
+	}
+	else
+	{
+		compositor.drawColor(LLColor4(0.f, 0.f, 0.f, effective_weight));
+	}
+
+	return success;
+}
+// [/SL:KB]
+
 //-----------------------------------------------------------------------------
 // LLTexLayerParamAlphaInfo
 //-----------------------------------------------------------------------------
@@ -35,6 +35,9 @@ class LLAvatarAppearance;
 class LLImageRaw;
 class LLImageTGA;
 class LLTexLayer;
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+class LLTexLayerCompositor;
+// [/SL:KB]
 class LLTexLayerInterface;
 class LLGLTexture;
 class LLWearable;
@@ -99,6 +102,9 @@ class LLTexLayerParamAlpha : public LLTexLayerParam
 
 	// New functions
 	BOOL					render( S32 x, S32 y, S32 width, S32 height );
+// [SL:KB] - Patch: Appearance-CpuBake | Checked: Catznip-6.7
+	BOOL					composite(LLTexLayerCompositor& compositor); // CPU equivalent of render()
+// [/SL:KB]
 	BOOL					getSkip() const;
 	void					deleteCaches();
 	BOOL					getMultiplyBlend() const;
@@ -28,8 +28,14 @@
 
 #include "llbvhloader.h"
 
-#include <boost/tokenizer.hpp>
-#include <boost/lexical_cast.hpp>
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+// [/SL:KB]
+//#include <boost/tokenizer.hpp>
+//#include <boost/lexical_cast.hpp>
 
 #include "lldatapacker.h"
 #include "lldir.h"
@@ -101,6 +107,128 @@ const char *find_next_whitespace(const char *p)
 }
 
 
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+// Clips with fewer keys (frames x joints) than this are reduced on the calling thread
+const U64 OPTIMIZE_PARALLEL_MIN_KEYS = 16384;
+const U32 OPTIMIZE_MAX_THREADS = 8;
+
+U32 LLBVHLoader::sOptimizeThreadCount = 0;
+
+//------------------------------------------------------------------------
+// LLBVHLineReader
+//
+// Hands out the lines of the BVH text one at a time straight from the
+// caller's buffer. Splits the same way boost::char_separator<char>("\r\n")
+// did (empty lines are dropped) but without first copying the whole file
+// into a std::string and allocating a new string for every line.
+//------------------------------------------------------------------------
+class LLBVHLineReader
+{
+public:
+	LLBVHLineReader(const char* buffer) : mPos(buffer) {}
+
+	bool next(const char*& line_begin, const char*& line_end)
+	{
+		while ( ('\r' == *mPos) || ('\n' == *mPos) )
+			mPos++;
+		if (!*mPos)
+			return false;
+
+		line_begin = mPos;
+		while ( (*mPos) && ('\r' != *mPos) && ('\n' != *mPos) )
+			mPos++;
+		line_end = mPos;
+		return true;
+	}
+
+	bool next(std::string& line)
+	{
+		const char *line_begin, *line_end;
+		if (!next(line_begin, line_end))
+			return false;
+		line.assign(line_begin, line_end);
+		return true;
+	}
+
+	void skip()
+	{
+		const char *line_begin, *line_end;
+		next(line_begin, line_end);
+	}
+
+	// Number of bytes left to read
+	size_t remaining() const { return strlen(mPos); }
+
+protected:
+	const char* mPos;
+};
+
+static void copy_error_text(char* error_text, const char* line_begin, const char* line_end)
+{
+	size_t len = llmin((size_t)(line_end - line_begin), (size_t)127);
+	memcpy(error_text, line_begin, len);
+	error_text[len] = '\0';
+}
+
+// static
+bool LLBVHLoader::parseFrameValues(const char* line_begin, const char* line_end, std::vector<F32>& values)
+{
+	values.clear();
+
+	char token_buf[64];
+	std::string token_str;
+	const char* cur = line_begin;
+	while (cur < line_end)
+	{
+		if ( (' ' == *cur) || ('\t' == *cur) )
+		{
+			cur++;
+			continue;
+		}
+
+		const char* token_begin = cur;
+		while ( (cur < line_end) && (' ' != *cur) && ('\t' != *cur) )
+			cur++;
+		const size_t token_len = cur - token_begin;
+
+		// strtof needs a terminated string
+		const char* token = token_buf;
+		if (token_len < sizeof(token_buf))
+		{
+			memcpy(token_buf, token_begin, token_len);
+			token_buf[token_len] = '\0';
+		}
+		else
+		{
+			token_str.assign(token_begin, token_len);
+			token = token_str.c_str();
+		}
+
+		// Accept exactly what boost::lexical_cast<float> used to: the whole token has to be consumed, no hexadecimal
+		// notation, no dangling exponent or sign and no out of range values
+		const char last_char = token[token_len - 1];
+		if ( (strpbrk(token, "xX")) || ('e' == last_char) || ('E' == last_char) || ('+' == last_char) || ('-' == last_char) )
+		{
+			return false;
+		}
+
+		char* token_end = nullptr;
+		F32 value = strtof(token, &token_end);
+		if ( (token_end != token + token_len) || ((std::isinf(value)) && (!strpbrk(token, "iI"))) )
+		{
+			return false;
+		}
+		if (std::isnan(value))
+		{
+			// lexical_cast ignored any "nan(...)" payload
+			value = std::copysign(std::numeric_limits<F32>::quiet_NaN(), value);
+		}
+		values.push_back(value);
+	}
+	return true;
+}
+// [/SL:KB]
+
 //------------------------------------------------------------------------
 // bvhStringToOrder()
 //
@@ -574,11 +702,14 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	err_line = 0;
 	error_text[127] = '\0';
 
-	std::string str(buffer);
-	typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
-	boost::char_separator<char> sep("\r\n");
-	tokenizer tokens(str, sep);
-	tokenizer::iterator iter = tokens.begin();
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	LLBVHLineReader reader(buffer);
+// [/SL:KB]
+//	std::string str(buffer);
+//	typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+//	boost::char_separator<char> sep("\r\n");
+//	tokenizer tokens(str, sep);
+//	tokenizer::iterator iter = tokens.begin();
 
 	mLineNumber = 0;
 	mJoints.clear();
@@ -588,9 +719,13 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// consume  hierarchy
 	//--------------------------------------------------------------------
-	if (iter == tokens.end())
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	if (!reader.next(line))
 		return E_ST_EOF;
-	line = (*(iter++));
+// [/SL:KB]
+//	if (iter == tokens.end())
+//		return E_ST_EOF;
+//	line = (*(iter++));
 	err_line++;
 
 	if ( !strstr(line.c_str(), "HIERARCHY") )
@@ -607,9 +742,13 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+		if (!reader.next(line))
 			return E_ST_EOF;
-		line = (*(iter++));
+// [/SL:KB]
+//		if (iter == tokens.end())
+//			return E_ST_EOF;
+//		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -641,9 +780,14 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		}
 		else if ( strstr(line.c_str(), "End Site") )
 		{
-			iter++; // {
-			iter++; //     OFFSET
-			iter++; // }
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+			reader.skip(); // {
+			reader.skip(); //     OFFSET
+			reader.skip(); // }
+// [/SL:KB]
+//			iter++; // {
+//			iter++; //     OFFSET
+//			iter++; // }
 			S32 depth = 0;
 			for (S32 j = (S32)parent_joints.size() - 1; j >= 0; j--)
 			{
@@ -713,11 +857,17 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+		if (!reader.next(line))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
+// [/SL:KB]
+//		if (iter == tokens.end())
+//		{
+//			return E_ST_EOF;
+//		}
+//		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -736,11 +886,17 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+		if (!reader.next(line))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
+// [/SL:KB]
+//		if (iter == tokens.end())
+//		{
+//			return E_ST_EOF;
+//		}
+//		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -755,11 +911,17 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+		if (!reader.next(line))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
+// [/SL:KB]
+//		if (iter == tokens.end())
+//		{
+//			return E_ST_EOF;
+//		}
+//		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -824,11 +986,17 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// get number of frames
 	//--------------------------------------------------------------------
-	if (iter == tokens.end())
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	if (!reader.next(line))
 	{
 		return E_ST_EOF;
 	}
-	line = (*(iter++));
+// [/SL:KB]
+//	if (iter == tokens.end())
+//	{
+//		return E_ST_EOF;
+//	}
+//	line = (*(iter++));
 	err_line++;
 
 	if ( !strstr(line.c_str(), "Frames:") )
@@ -846,11 +1014,17 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// get frame time
 	//--------------------------------------------------------------------
-	if (iter == tokens.end())
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	if (!reader.next(line))
 	{
 		return E_ST_EOF;
 	}
-	line = (*(iter++));
+// [/SL:KB]
+//	if (iter == tokens.end())
+//	{
+//		return E_ST_EOF;
+//	}
+//	line = (*(iter++));
 	err_line++;
 
 	if ( !strstr(line.c_str(), "Frame Time:") )
@@ -874,45 +1048,48 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// load frames
 	//--------------------------------------------------------------------
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	if ( (mNumFrames > 0) && (!mJoints.empty()) )
+	{
+		// A frame holds at least three values (six characters) per joint which bounds what a bogus frame count can make us reserve
+		const size_t max_frames = reader.remaining() / (6 * mJoints.size()) + 1;
+		const size_t num_keys = llmin((size_t)mNumFrames, max_frames);
+		for (Joint* joint : mJoints)
+		{
+			joint->mKeys.reserve(num_keys);
+		}
+	}
+
+	std::vector<F32> floats;
 	for (S32 i=0; i<mNumFrames; i++)
 	{
 		// get next line
-		if (iter == tokens.end())
+		const char *line_begin, *line_end;
+		if (!reader.next(line_begin, line_end))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
 		err_line++;
 
 		// Split line into a collection of floats.
-		std::deque<F32> floats;
-		boost::char_separator<char> whitespace_sep("\t ");
-		tokenizer float_tokens(line, whitespace_sep);
-		tokenizer::iterator float_token_iter = float_tokens.begin();
-		while (float_token_iter != float_tokens.end())
+		if (!parseFrameValues(line_begin, line_end, floats))
 		{
-            try
-            {
-                F32 val = boost::lexical_cast<float>(*float_token_iter);
-                floats.push_back(val);
-            }
-            catch (const boost::bad_lexical_cast&)
-            {
-				strncpy(error_text, line.c_str(), 127);	/*Flawfinder: ignore*/
-				return E_ST_NO_POS;
-            }
-            float_token_iter++;
+			copy_error_text(error_text, line_begin, line_end);
+			return E_ST_NO_POS;
 		}
 		LL_DEBUGS("BVH") << "Got " << floats.size() << " floats " << LL_ENDL;
+
+		size_t idx_float = 0;
 		for (U32 j=0; j<mJoints.size(); j++)
 		{
 			Joint *joint = mJoints[j];
 			joint->mKeys.push_back( Key() );
 			Key &key = joint->mKeys.back();
 
-			if (floats.size() < joint->mNumChannels)
+			const size_t num_remaining = floats.size() - idx_float;
+			if ( (num_remaining < (size_t)joint->mNumChannels) || (num_remaining < 3) )
 			{
-				strncpy(error_text, line.c_str(), 127);	/*Flawfinder: ignore*/
+				copy_error_text(error_text, line_begin, line_end);
 				return E_ST_NO_POS;
 			}
 
@@ -920,15 +1097,72 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 			// or numChannels == 3, in which case we have only rot.
 			if (joint->mNumChannels == 6)
 			{
-				key.mPos[0] = floats.front(); floats.pop_front();
-				key.mPos[1] = floats.front(); floats.pop_front();
-				key.mPos[2] = floats.front(); floats.pop_front();
+				key.mPos[0] = floats[idx_float++];
+				key.mPos[1] = floats[idx_float++];
+				key.mPos[2] = floats[idx_float++];
 			}
-			key.mRot[ joint->mOrder[0]-'X' ] = floats.front(); floats.pop_front();
-			key.mRot[ joint->mOrder[1]-'X' ] = floats.front(); floats.pop_front();
-			key.mRot[ joint->mOrder[2]-'X' ] = floats.front(); floats.pop_front();
+			key.mRot[ joint->mOrder[0]-'X' ] = floats[idx_float++];
+			key.mRot[ joint->mOrder[1]-'X' ] = floats[idx_float++];
+			key.mRot[ joint->mOrder[2]-'X' ] = floats[idx_float++];
 		}
 	}
+// [/SL:KB]
+//	for (S32 i=0; i<mNumFrames; i++)
+//	{
+//		// get next line
+//		if (iter == tokens.end())
+//		{
+//			return E_ST_EOF;
+//		}
+//		line = (*(iter++));
+//		err_line++;
+
+//		// Split line into a collection of floats.
+//		std::deque<F32> floats;
+//		boost::char_separator<char> whitespace_sep("\t ");
+//		tokenizer float_tokens(line, whitespace_sep);
+//		tokenizer::iterator float_token_iter = float_tokens.begin();
+//		while (float_token_iter != float_tokens.end())
+//		{
+//            try
+//            {
+//                F32 val = boost::lexical_cast<float>(*float_token_iter);
+//                floats.push_back(val);
+//            }
+//            catch (const boost::bad_lexical_cast&)
+//            {
+//				strncpy(error_text, line.c_str(), 127);	/*Flawfinder: ignore*/
+//				return E_ST_NO_POS;
+//            }
+//            float_token_iter++;
+//		}
+//		LL_DEBUGS("BVH") << "Got " << floats.size() << " floats " << LL_ENDL;
+//		for (U32 j=0; j<mJoints.size(); j++)
+//		{
+//			Joint *joint = mJoints[j];
+//			joint->mKeys.push_back( Key() );
+//			Key &key = joint->mKeys.back();
+
+//			if (floats.size() < joint->mNumChannels)
+//			{
+//				strncpy(error_text, line.c_str(), 127);	/*Flawfinder: ignore*/
+//				return E_ST_NO_POS;
+//			}
+
+//			// assume either numChannels == 6, in which case we have pos + rot,
+//			// or numChannels == 3, in which case we have only rot.
+//			if (joint->mNumChannels == 6)
+//			{
+//				key.mPos[0] = floats.front(); floats.pop_front();
+//				key.mPos[1] = floats.front(); floats.pop_front();
+//				key.mPos[2] = floats.front(); floats.pop_front();
+//			}
+//			key.mRot[ joint->mOrder[0]-'X' ] = floats.front(); floats.pop_front();
+//			key.mRot[ joint->mOrder[1]-'X' ] = floats.front(); floats.pop_front();
+//			key.mRot[ joint->mOrder[2]-'X' ] = floats.front(); floats.pop_front();
+//		}
+//	}
+
 
 	return E_ST_OK;
 }
@@ -1055,181 +1289,421 @@ void LLBVHLoader::optimize()
 		mEaseOut *= factor;
 	}
 
-	JointVector::iterator ji;
-	for (ji = mJoints.begin(); ji != mJoints.end(); ++ji)
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	// Key reduction is independent per joint so long clips get spread across worker threads (each joint's keys are still
+	// processed front to back by a single thread which keeps the output identical to the serial path)
+	const U32 num_joints = (U32)mJoints.size();
+	U32 num_threads = llmin(getOptimizeThreadCount(), num_joints);
+	if ((U64)llmax(mNumFrames, 0) * num_joints < OPTIMIZE_PARALLEL_MIN_KEYS)
 	{
-		Joint *joint = *ji;
-		BOOL pos_changed = FALSE;
-		BOOL rot_changed = FALSE;
-
-		if ( ! joint->mIgnore )
-		{
-			joint->mNumPosKeys = 0;
-			joint->mNumRotKeys = 0;
-			LLQuaternion::Order order = bvhStringToOrder( joint->mOrder );
+		num_threads = 1;
+	}
 
-			KeyVector::iterator first_key = joint->mKeys.begin();
+	if (num_threads > 1)
+	{
+		std::atomic<U32> next_joint(0);
+		auto worker = [this, &next_joint, num_joints]()
+			{
+				for (U32 idx_joint = next_joint++; idx_joint < num_joints; idx_joint = next_joint++)
+				{
+					optimizeJoint(mJoints[idx_joint]);
+				}
+			};
 
-			// no keys?
-			if (first_key == joint->mKeys.end())
+		std::vector<std::thread> threads;
+		threads.reserve(num_threads - 1);
+		for (U32 idx_thread = 1; idx_thread < num_threads; idx_thread++)
+		{
+			try
 			{
-				joint->mIgnore = TRUE;
-				continue;
+				threads.emplace_back(worker);
+			}
+			catch (const std::system_error& e)
+			{
+				// The calling thread picks up whatever is left
+				LL_WARNS("BVH") << "Failed to start optimize worker thread: " << e.what() << LL_ENDL;
+				break;
 			}
+		}
+		worker();
 
-			LLVector3 first_frame_pos(first_key->mPos);
-			LLQuaternion first_frame_rot = mayaQ( first_key->mRot[0], first_key->mRot[1], first_key->mRot[2], order);
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+	else
+	{
+		for (Joint* joint : mJoints)
+		{
+			optimizeJoint(joint);
+		}
+	}
+// [/SL:KB]
+//	JointVector::iterator ji;
+//	for (ji = mJoints.begin(); ji != mJoints.end(); ++ji)
+//	{
+//		Joint *joint = *ji;
+//		BOOL pos_changed = FALSE;
+//		BOOL rot_changed = FALSE;
+
+//		if ( ! joint->mIgnore )
+//		{
+//			joint->mNumPosKeys = 0;
+//			joint->mNumRotKeys = 0;
+//			LLQuaternion::Order order = bvhStringToOrder( joint->mOrder );
+
+//			KeyVector::iterator first_key = joint->mKeys.begin();
+
+//			// no keys?
+//			if (first_key == joint->mKeys.end())
+//			{
+//				joint->mIgnore = TRUE;
+//				continue;
+//			}
+
+//			LLVector3 first_frame_pos(first_key->mPos);
+//			LLQuaternion first_frame_rot = mayaQ( first_key->mRot[0], first_key->mRot[1], first_key->mRot[2], order);
 	
-			// skip first key
-			KeyVector::iterator ki = joint->mKeys.begin();
-			if (joint->mKeys.size() == 1)
+//			// skip first key
+//			KeyVector::iterator ki = joint->mKeys.begin();
+//			if (joint->mKeys.size() == 1)
+//			{
+//				// *FIX: use single frame to move pelvis
+//				// if only one keyframe force output for this joint
+//				rot_changed = TRUE;
+//			}
+//			else
+//			{
+//				// if more than one keyframe, use first frame as reference and skip to second
+//				first_key->mIgnorePos = TRUE;
+//				first_key->mIgnoreRot = TRUE;
+//				++ki;
+//			}
+
+//			KeyVector::iterator ki_prev = ki;
+//			KeyVector::iterator ki_last_good_pos = ki;
+//			KeyVector::iterator ki_last_good_rot = ki;
+//			S32 numPosFramesConsidered = 2;
+//			S32 numRotFramesConsidered = 2;
+
+//			F32 rot_threshold = ROTATION_KEYFRAME_THRESHOLD / llmax((F32)joint->mChildTreeMaxDepth * 0.33f, 1.f);
+
+//			double diff_max = 0;
+//			KeyVector::iterator ki_max = ki;
+//			for (; ki != joint->mKeys.end(); ++ki)
+//			{
+//				if (ki_prev == ki_last_good_pos)
+//				{
+//					joint->mNumPosKeys++;
+//					if (dist_vec_squared(LLVector3(ki_prev->mPos), first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
+//					{
+//						pos_changed = TRUE;
+//					}
+//				}
+//				else
+//				{
+//					//check position for noticeable effect
+//					LLVector3 test_pos(ki_prev->mPos);
+//					LLVector3 last_good_pos(ki_last_good_pos->mPos);
+//					LLVector3 current_pos(ki->mPos);
+//					LLVector3 interp_pos = lerp(current_pos, last_good_pos, 1.f / (F32)numPosFramesConsidered);
+
+//					if (dist_vec_squared(current_pos, first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
+//					{
+//						pos_changed = TRUE;
+//					}
+
+//					if (dist_vec_squared(interp_pos, test_pos) < POSITION_KEYFRAME_THRESHOLD_SQUARED)
+//					{
+//						ki_prev->mIgnorePos = TRUE;
+//						numPosFramesConsidered++;
+//					}
+//					else
+//					{
+//						numPosFramesConsidered = 2;
+//						ki_last_good_pos = ki_prev;
+//						joint->mNumPosKeys++;
+//					}
+//				}
+
+//				if (ki_prev == ki_last_good_rot)
+//				{
+//					joint->mNumRotKeys++;
+//					LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
+//					F32 x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
+//					F32 y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
+//					F32 rot_test = x_delta + y_delta;
+
+//					if (rot_test > ROTATION_MOTION_THRESHOLD)
+//					{
+//						rot_changed = TRUE;
+//					}
+//				}
+//				else
+//				{
+//					//check rotation for noticeable effect
+//					LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
+//					LLQuaternion last_good_rot = mayaQ( ki_last_good_rot->mRot[0], ki_last_good_rot->mRot[1], ki_last_good_rot->mRot[2], order);
+//					LLQuaternion current_rot = mayaQ( ki->mRot[0], ki->mRot[1], ki->mRot[2], order);
+//					LLQuaternion interp_rot = lerp(1.f / (F32)numRotFramesConsidered, current_rot, last_good_rot);
+
+//					F32 x_delta;
+//					F32 y_delta;
+//					F32 rot_test;
+					
+//					// Test if the rotation has changed significantly since the very first frame.  If false
+//					// for all frames, then we'll just throw out this joint's rotation entirely.
+//					x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
+//					y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
+//					rot_test = x_delta + y_delta;
+//					if (rot_test > ROTATION_MOTION_THRESHOLD)
+//					{
+//						rot_changed = TRUE;
+//					}
+//					x_delta = dist_vec(LLVector3::x_axis * interp_rot, LLVector3::x_axis * test_rot);
+//					y_delta = dist_vec(LLVector3::y_axis * interp_rot, LLVector3::y_axis * test_rot);
+//					rot_test = x_delta + y_delta;
+
+//					// Draw a line between the last good keyframe and current.  Test the distance between the last frame (current-1, i.e. ki_prev)
+//					// and the line.  If it's greater than some threshold, then it represents a significant frame and we want to include it.
+//					if (rot_test >= rot_threshold ||
+//						(ki+1 == joint->mKeys.end() && numRotFramesConsidered > 2))
+//					{
+//						// Add the current test keyframe (which is technically the previous key, i.e. ki_prev).
+//						numRotFramesConsidered = 2;
+//						ki_last_good_rot = ki_prev;
+//						joint->mNumRotKeys++;
+
+//						// Add another keyframe between the last good keyframe and current, at whatever point was the most "significant" (i.e.
+//						// had the largest deviation from the earlier tests).  Note that a more robust approach would be test all intermediate
+//						// keyframes against the line between the last good keyframe and current, but we're settling for this other method
+//						// because it's significantly faster.
+//						if (diff_max > 0)
+//						{
+//							if (ki_max->mIgnoreRot == TRUE)
+//							{
+//								ki_max->mIgnoreRot = FALSE;
+//								joint->mNumRotKeys++;
+//							}
+//							diff_max = 0;
+//						}
+//					}
+//					else
+//					{
+//						// This keyframe isn't significant enough, throw it away.
+//						ki_prev->mIgnoreRot = TRUE;
+//						numRotFramesConsidered++;
+//						// Store away the keyframe that has the largest deviation from the interpolated line, for insertion later.
+//						if (rot_test > diff_max)
+//						{
+//							diff_max = rot_test;
+//							ki_max = ki;
+//						}
+//					}
+//				}
+
+//				ki_prev = ki;
+//			}
+//		}	
+
+//		// don't output joints with no motion
+//		if (!(pos_changed || rot_changed))
+//		{
+//			//LL_INFOS() << "Ignoring joint " << joint->mName << LL_ENDL;
+//			joint->mIgnore = TRUE;
+//		}
+//	}
+}
+
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+
+// static
+U32 LLBVHLoader::getOptimizeThreadCount()
+{
+	if (0 == sOptimizeThreadCount)
+	{
+		return llclamp(std::thread::hardware_concurrency(), 1U, OPTIMIZE_MAX_THREADS);
+	}
+	return sOptimizeThreadCount;
+}
+
+void LLBVHLoader::optimizeJoint(Joint* joint) const
+{
+	BOOL pos_changed = FALSE;
+	BOOL rot_changed = FALSE;
+
+	if ( ! joint->mIgnore )
+	{
+		joint->mNumPosKeys = 0;
+		joint->mNumRotKeys = 0;
+		LLQuaternion::Order order = bvhStringToOrder( joint->mOrder );
+
+		KeyVector::iterator first_key = joint->mKeys.begin();
+
+		// no keys?
+		if (first_key == joint->mKeys.end())
+		{
+			joint->mIgnore = TRUE;
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+			return;
+// [/SL:KB]
+//			continue;
+		}
+
+		LLVector3 first_frame_pos(first_key->mPos);
+		LLQuaternion first_frame_rot = mayaQ( first_key->mRot[0], first_key->mRot[1], first_key->mRot[2], order);
+
+		// skip first key
+		KeyVector::iterator ki = joint->mKeys.begin();
+		if (joint->mKeys.size() == 1)
+		{
+			// *FIX: use single frame to move pelvis
+			// if only one keyframe force output for this joint
+			rot_changed = TRUE;
+		}
+		else
+		{
+			// if more than one keyframe, use first frame as reference and skip to second
+			first_key->mIgnorePos = TRUE;
+			first_key->mIgnoreRot = TRUE;
+			++ki;
+		}
+
+		KeyVector::iterator ki_prev = ki;
+		KeyVector::iterator ki_last_good_pos = ki;
+		KeyVector::iterator ki_last_good_rot = ki;
+		S32 numPosFramesConsidered = 2;
+		S32 numRotFramesConsidered = 2;
+
+		F32 rot_threshold = ROTATION_KEYFRAME_THRESHOLD / llmax((F32)joint->mChildTreeMaxDepth * 0.33f, 1.f);
+
+		double diff_max = 0;
+		KeyVector::iterator ki_max = ki;
+		for (; ki != joint->mKeys.end(); ++ki)
+		{
+			if (ki_prev == ki_last_good_pos)
 			{
-				// *FIX: use single frame to move pelvis
-				// if only one keyframe force output for this joint
-				rot_changed = TRUE;
+				joint->mNumPosKeys++;
+				if (dist_vec_squared(LLVector3(ki_prev->mPos), first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
+				{
+					pos_changed = TRUE;
+				}
 			}
 			else
 			{
-				// if more than one keyframe, use first frame as reference and skip to second
-				first_key->mIgnorePos = TRUE;
-				first_key->mIgnoreRot = TRUE;
-				++ki;
-			}
-
-			KeyVector::iterator ki_prev = ki;
-			KeyVector::iterator ki_last_good_pos = ki;
-			KeyVector::iterator ki_last_good_rot = ki;
-			S32 numPosFramesConsidered = 2;
-			S32 numRotFramesConsidered = 2;
+				//check position for noticeable effect
+				LLVector3 test_pos(ki_prev->mPos);
+				LLVector3 last_good_pos(ki_last_good_pos->mPos);
+				LLVector3 current_pos(ki->mPos);
+				LLVector3 interp_pos = lerp(current_pos, last_good_pos, 1.f / (F32)numPosFramesConsidered);
 
-			F32 rot_threshold = ROTATION_KEYFRAME_THRESHOLD / llmax((F32)joint->mChildTreeMaxDepth * 0.33f, 1.f);
+				if (dist_vec_squared(current_pos, first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
+				{
+					pos_changed = TRUE;
+				}
 
-			double diff_max = 0;
-			KeyVector::iterator ki_max = ki;
-			for (; ki != joint->mKeys.end(); ++ki)
-			{
-				if (ki_prev == ki_last_good_pos)
+				if (dist_vec_squared(interp_pos, test_pos) < POSITION_KEYFRAME_THRESHOLD_SQUARED)
 				{
-					joint->mNumPosKeys++;
-					if (dist_vec_squared(LLVector3(ki_prev->mPos), first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
-					{
-						pos_changed = TRUE;
-					}
+					ki_prev->mIgnorePos = TRUE;
+					numPosFramesConsidered++;
 				}
 				else
 				{
-					//check position for noticeable effect
-					LLVector3 test_pos(ki_prev->mPos);
-					LLVector3 last_good_pos(ki_last_good_pos->mPos);
-					LLVector3 current_pos(ki->mPos);
-					LLVector3 interp_pos = lerp(current_pos, last_good_pos, 1.f / (F32)numPosFramesConsidered);
+					numPosFramesConsidered = 2;
+					ki_last_good_pos = ki_prev;
+					joint->mNumPosKeys++;
+				}
+			}
 
-					if (dist_vec_squared(current_pos, first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
-					{
-						pos_changed = TRUE;
-					}
+			if (ki_prev == ki_last_good_rot)
+			{
+				joint->mNumRotKeys++;
+				LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
+				F32 x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
+				F32 y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
+				F32 rot_test = x_delta + y_delta;
 
-					if (dist_vec_squared(interp_pos, test_pos) < POSITION_KEYFRAME_THRESHOLD_SQUARED)
-					{
-						ki_prev->mIgnorePos = TRUE;
-						numPosFramesConsidered++;
-					}
-					else
-					{
-						numPosFramesConsidered = 2;
-						ki_last_good_pos = ki_prev;
-						joint->mNumPosKeys++;
-					}
+				if (rot_test > ROTATION_MOTION_THRESHOLD)
+				{
+					rot_changed = TRUE;
 				}
-
-				if (ki_prev == ki_last_good_rot)
+			}
+			else
+			{
+				//check rotation for noticeable effect
+				LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
+				LLQuaternion last_good_rot = mayaQ( ki_last_good_rot->mRot[0], ki_last_good_rot->mRot[1], ki_last_good_rot->mRot[2], order);
+				LLQuaternion current_rot = mayaQ( ki->mRot[0], ki->mRot[1], ki->mRot[2], order);
+				LLQuaternion interp_rot = lerp(1.f / (F32)numRotFramesConsidered, current_rot, last_good_rot);
+
+				F32 x_delta;
+				F32 y_delta;
+				F32 rot_test;
+				
+				// Test if the rotation has changed significantly since the very first frame.  If false
+				// for all frames, then we'll just throw out this joint's rotation entirely.
+				x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
+				y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
+				rot_test = x_delta + y_delta;
+				if (rot_test > ROTATION_MOTION_THRESHOLD)
+				{
+					rot_changed = TRUE;
+				}
+				x_delta = dist_vec(LLVector3::x_axis * interp_rot, LLVector3::x_axis * test_rot);
+				y_delta = dist_vec(LLVector3::y_axis * interp_rot, LLVector3::y_axis * test_rot);
+				rot_test = x_delta + y_delta;
+
+				// Draw a line between the last good keyframe and current.  Test the distance between the last frame (current-1, i.e. ki_prev)
+				// and the line.  If it's greater than some threshold, then it represents a significant frame and we want to include it.
+				if (rot_test >= rot_threshold ||
+					(ki+1 == joint->mKeys.end() && numRotFramesConsidered > 2))
 				{
+					// Add the current test keyframe (which is technically the previous key, i.e. ki_prev).
+					numRotFramesConsidered = 2;
+					ki_last_good_rot = ki_prev;
 					joint->mNumRotKeys++;
-					LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
-					F32 x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
-					F32 y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
-					F32 rot_test = x_delta + y_delta;
 
-					if (rot_test > ROTATION_MOTION_THRESHOLD)
+					// Add another keyframe between the last good keyframe and current, at whatever point was the most "significant" (i.e.
+					// had the largest deviation from the earlier tests).  Note that a more robust approach would be test all intermediate
+					// keyframes against the line between the last good keyframe and current, but we're settling for this other method
+					// because it's significantly faster.
+					if (diff_max > 0)
 					{
-						rot_changed = TRUE;
+						if (ki_max->mIgnoreRot == TRUE)
+						{
+							ki_max->mIgnoreRot = FALSE;
+							joint->mNumRotKeys++;
+						}
+						diff_max = 0;
 					}
 				}
 				else
 				{
-					//check rotation for noticeable effect
-					LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
-					LLQuaternion last_good_rot = mayaQ( ki_last_good_rot->mRot[0], ki_last_good_rot->mRot[1], ki_last_good_rot->mRot[2], order);
-					LLQuaternion current_rot = mayaQ( ki->mRot[0], ki->mRot[1], ki->mRot[2], order);
-					LLQuaternion interp_rot = lerp(1.f / (F32)numRotFramesConsidered, current_rot, last_good_rot);
-
-					F32 x_delta;
-					F32 y_delta;
-					F32 rot_test;
-					
-					// Test if the rotation has changed significantly since the very first frame.  If false
-					// for all frames, then we'll just throw out this joint's rotation entirely.
-					x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
-					y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
-					rot_test = x_delta + y_delta;
-					if (rot_test > ROTATION_MOTION_THRESHOLD)
-					{
-						rot_changed = TRUE;
-					}
-					x_delta = dist_vec(LLVector3::x_axis * interp_rot, LLVector3::x_axis * test_rot);
-					y_delta = dist_vec(LLVector3::y_axis * interp_rot, LLVector3::y_axis * test_rot);
-					rot_test = x_delta + y_delta;
-
-					// Draw a line between the last good keyframe and current.  Test the distance between the last frame (current-1, i.e. ki_prev)
-					// and the line.  If it's greater than some threshold, then it represents a significant frame and we want to include it.
-					if (rot_test >= rot_threshold ||
-						(ki+1 == joint->mKeys.end() && numRotFramesConsidered > 2))
+					// This keyframe isn't significant enough, throw it away.
+					ki_prev->mIgnoreRot = TRUE;
+					numRotFramesConsidered++;
+					// Store away the keyframe that has the largest deviation from the interpolated line, for insertion later.
+					if (rot_test > diff_max)
 					{
-						// Add the current test keyframe (which is technically the previous key, i.e. ki_prev).
-						numRotFramesConsidered = 2;
-						ki_last_good_rot = ki_prev;
-						joint->mNumRotKeys++;
-
-						// Add another keyframe between the last good keyframe and current, at whatever point was the most "significant" (i.e.
-						// had the largest deviation from the earlier tests).  Note that a more robust approach would be test all intermediate
-						// keyframes against the line between the last good keyframe and current, but we're settling for this other method
-						// because it's significantly faster.
-						if (diff_max > 0)
-						{
-							if (ki_max->mIgnoreRot == TRUE)
-							{
-								ki_max->mIgnoreRot = FALSE;
-								joint->mNumRotKeys++;
-							}
-							diff_max = 0;
-						}
-					}
-					else
-					{
-						// This keyframe isn't significant enough, throw it away.
-						ki_prev->mIgnoreRot = TRUE;
-						numRotFramesConsidered++;
-						// Store away the keyframe that has the largest deviation from the interpolated line, for insertion later.
-						if (rot_test > diff_max)
-						{
-							diff_max = rot_test;
-							ki_max = ki;
-						}
+						diff_max = rot_test;
+						ki_max = ki;
 					}
 				}
-
-				ki_prev = ki;
 			}
-		}	
 
-		// don't output joints with no motion
-		if (!(pos_changed || rot_changed))
-		{
-			//LL_INFOS() << "Ignoring joint " << joint->mName << LL_ENDL;
-			joint->mIgnore = TRUE;
+			ki_prev = ki;
 		}
+	}	
+
+	// don't output joints with no motion
+	if (!(pos_changed || rot_changed))
+	{
+		//LL_INFOS() << "Ignoring joint " << joint->mName << LL_ENDL;
+		joint->mIgnore = TRUE;
 	}
 }
+// [/SL:KB]
 
 void LLBVHLoader::reset()
 {
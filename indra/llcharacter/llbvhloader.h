@@ -298,6 +298,15 @@ class LLBVHLoader
 	// flags redundant keyframe data
 	void optimize();
 
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	// Splits one frame line on spaces and tabs into its values; returns false if any of them isn't a valid float
+	static bool parseFrameValues(const char* line_begin, const char* line_end, std::vector<F32>& values);
+
+	// Number of threads optimize() may spread the per-joint key reduction across (0 = pick based on the hardware, 1 = serial)
+	static void setOptimizeThreadCount(U32 thread_count) { sOptimizeThreadCount = thread_count; }
+	static U32  getOptimizeThreadCount();
+// [/SL:KB]
+
 	void reset();
 
 	F32 getDuration() { return mDuration; }
@@ -310,6 +319,13 @@ class LLBVHLoader
 	// Consumes one line of input from file.
 	BOOL getLine(apr_file_t *fp);
 
+// [SL:KB] - Patch: Viewer-OptimizationBvhLoader | Checked: Catznip-6.7
+	// Key reduction for a single joint; only touches that joint's data so joints can be processed concurrently
+	void optimizeJoint(Joint* joint) const;
+
+	static U32 sOptimizeThreadCount;
+// [/SL:KB]
+
 	// parser state
 	char		mLine[BVH_PARSER_LINE_SIZE];		/* Flawfinder: ignore */
 	S32			mLineNumber;
@@ -33,10 +33,19 @@
 
 #include "llmath.h"
 #include "llcallstack.h"
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+#include "llmutex.h"
+// [/SL:KB]
 #include <boost/algorithm/string.hpp>
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+#include <unordered_set>
+// [/SL:KB]
 
 S32 LLJoint::sNumUpdates = 0;
 S32 LLJoint::sNumTouches = 0;
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+U32 LLJoint::sTopologySerial = 0;
+// [/SL:KB]
 
 template <class T> 
 bool attachment_map_iter_compare_key(const T& a, const T& b)
@@ -104,7 +113,10 @@ void LLVector3OverrideMap::clear()
 
 void LLJoint::init()
 {
-	mName = "unnamed";
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	mName = internName("unnamed");
+// [/SL:KB]
+//	mName = "unnamed";
 	mParent = NULL;
 	mXform.setScaleChildOffset(TRUE);
 	mXform.setScale(LLVector3(1.0f, 1.0f, 1.0f));
@@ -172,6 +184,24 @@ void LLJoint::setup(const std::string &name, LLJoint *parent)
 	}
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+//-----------------------------------------------------------------------------
+// internName()
+// Joint names come from a small fixed vocabulary (skeleton, attachment points
+// and meshes) which every avatar repeats; keep a single copy of each.
+//-----------------------------------------------------------------------------
+// static
+const std::string* LLJoint::internName(const std::string& name)
+{
+	static LLMutex s_names_mutex;
+	static std::unordered_set<std::string> s_names;
+
+	LLMutexLock lock(&s_names_mutex);
+	// Node based container: pointers to elements stay valid when it rehashes
+	return &*s_names.insert(name).first;
+}
+// [/SL:KB]
+
 //-----------------------------------------------------------------------------
 // setSupport()
 //-----------------------------------------------------------------------------
@@ -278,6 +308,9 @@ void LLJoint::addChild(LLJoint* joint)
 	joint->mXform.setParent(&mXform);
 	joint->mParent = this;	
 	joint->touch();
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	sTopologySerial++;
+// [/SL:KB]
 }
 
 
@@ -294,6 +327,9 @@ void LLJoint::removeChild(LLJoint* joint)
 		joint->mXform.setParent(NULL);
 		joint->mParent = NULL;
 		joint->touch();
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+		sTopologySerial++;
+// [/SL:KB]
 	}
 }
 
@@ -313,6 +349,12 @@ void LLJoint::removeAllChildren()
             //delete joint;
         }
 	}
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	if (!mChildren.empty())
+	{
+		sTopologySerial++;
+	}
+// [/SL:KB]
     mChildren.clear();
 }
 
@@ -1048,3 +1090,86 @@ void LLJoint::clampRotation(LLQuaternion old_rot, LLQuaternion new_rot)
 
 // End
 
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+//-----------------------------------------------------------------------------
+// LLJointUpdateList
+//-----------------------------------------------------------------------------
+
+LLJointUpdateList::LLJointUpdateList()
+	: mRoot(NULL)
+	, mTopologySerial(0)
+{
+}
+
+void LLJointUpdateList::setRoot(LLJoint* root)
+{
+	if (mRoot != root)
+	{
+		clear();
+		mRoot = root;
+	}
+}
+
+void LLJointUpdateList::clear()
+{
+	mRoot = NULL;
+	mJoints.clear();
+	mParentIndex.clear();
+	mActive.clear();
+}
+
+void LLJointUpdateList::rebuild()
+{
+	mJoints.clear();
+	mParentIndex.clear();
+	mTopologySerial = LLJoint::sTopologySerial;
+	if (!mRoot)
+	{
+		return;
+	}
+
+	// Iterative pre-order walk; children are pushed in reverse so they come out in the same order the recursive update visits them
+	std::vector<std::pair<LLJoint*, S32> > pending;
+	pending.push_back(std::make_pair(mRoot, -1));
+	while (!pending.empty())
+	{
+		LLJoint* joint = pending.back().first;
+		S32 parent_idx = pending.back().second;
+		pending.pop_back();
+
+		S32 idx = mJoints.size();
+		mJoints.push_back(joint);
+		mParentIndex.push_back(parent_idx);
+
+		for (LLJoint::joints_t::const_reverse_iterator itChild = joint->mChildren.rbegin(); itChild != joint->mChildren.rend(); ++itChild)
+		{
+			if (*itChild)
+			{
+				pending.push_back(std::make_pair(*itChild, idx));
+			}
+		}
+	}
+	mActive.resize(mJoints.size());
+}
+
+void LLJointUpdateList::updateWorldMatrixChildren()
+{
+	if ( (mTopologySerial != LLJoint::sTopologySerial) || (mJoints.empty()) )
+	{
+		rebuild();
+	}
+
+	for (U32 idx = 0, cnt = mJoints.size(); idx < cnt; idx++)
+	{
+		LLJoint* joint = mJoints[idx];
+
+		// A joint with mUpdateXform cleared cuts off its whole subtree (see LLJoint::updateWorldMatrixChildren)
+		const S32 parent_idx = mParentIndex[idx];
+		mActive[idx] = ((parent_idx < 0) || (mActive[parent_idx])) && (joint->mUpdateXform);
+		if ( (mActive[idx]) && (joint->mDirtyFlags & LLJoint::MATRIX_DIRTY) )
+		{
+			joint->updateWorldMatrix();
+		}
+	}
+}
+// [/SL:KB]
@@ -114,7 +114,11 @@ class LLJoint
         SUPPORT_EXTENDED
     };
 protected:
-	std::string	mName;
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	// Points into the shared name pool (see internName) so avatars don't each carry a copy of every joint name
+	const std::string* mName;
+// [/SL:KB]
+//	std::string	mName;
 
 	SupportCategory mSupport;
 
@@ -147,6 +151,10 @@ class LLJoint
 	// debug statics
 	static S32		sNumTouches;
 	static S32		sNumUpdates;
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	// Incremented whenever a joint is added to or removed from a parent (see LLJointUpdateList)
+	static U32		sTopologySerial;
+// [/SL:KB]
     typedef std::set<std::string> debug_joint_name_t;
     static debug_joint_name_t s_debugJointNames;
     static void setDebugJointNames(const debug_joint_name_t& names);
@@ -195,8 +203,15 @@ class LLJoint
 	void touch(U32 flags = ALL_DIRTY);
 
 	// get/set name
-	const std::string& getName() const { return mName; }
-	void setName( const std::string &name ) { mName = name; }
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	const std::string& getName() const { return *mName; }
+	void setName( const std::string &name ) { mName = internName(name); }
+protected:
+	static const std::string* internName(const std::string& name);
+public:
+// [/SL:KB]
+//	const std::string& getName() const { return mName; }
+//	void setName( const std::string &name ) { mName = name; }
 
     // joint num
 	S32 getJointNum() const { return mJointNum; }
@@ -297,5 +312,42 @@ class LLJoint
     bool aboveJointPosThreshold(const LLVector3& pos) const;
     bool aboveJointScaleThreshold(const LLVector3& scale) const;
 };
+
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+//-----------------------------------------------------------------------------
+// class LLJointUpdateList
+//
+// Flattened, depth-first copy of a joint hierarchy with index based parent
+// links. Walking it front to back visits every parent before its children,
+// so updating world matrices becomes a single linear pass instead of the
+// recursion through each joint's mChildren that updateWorldMatrixChildren()
+// does. The list is rebuilt lazily whenever LLJoint::sTopologySerial changes.
+//-----------------------------------------------------------------------------
+class LLJointUpdateList
+{
+public:
+	LLJointUpdateList();
+
+	void setRoot(LLJoint* root);
+	LLJoint* getRoot() const { return mRoot; }
+	void clear();
+
+	// Same result as mRoot->updateWorldMatrixChildren()
+	void updateWorldMatrixChildren();
+
+	U32 size() const { return mJoints.size(); }
+
+protected:
+	void rebuild();
+
+protected:
+	LLJoint*				mRoot;
+	U32						mTopologySerial;
+	std::vector<LLJoint*>	mJoints;		// Depth first order, mJoints[0] == mRoot
+	std::vector<S32>		mParentIndex;	// Index of each joint's parent in mJoints (-1 for the root)
+	std::vector<U8>			mActive;		// Scratch: whether the joint (and its ancestors) have mUpdateXform set
+};
+// [/SL:KB]
+
 #endif // LL_LLJOINT_H
 
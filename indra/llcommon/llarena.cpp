@@ -0,0 +1,202 @@
+/**
+ * @file llarena.cpp
+ * @brief Resettable bump allocator for short lived scratch memory
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llarena.h"
+
+#include "lltrace.h"
+
+#include <cstdlib>
+
+static LLTrace::MemStatHandle sArenaMemStat("LLArena");
+
+// ============================================================================
+// LLArena class
+//
+
+LL_THREAD_LOCAL LLArena* LLArena::sThreadArena = nullptr;
+
+LLArena::LLArena(size_t block_size, U32 retain_blocks)
+	: mBlockSize(block_size)
+	, mRetainBlocks(retain_blocks)
+	, mFirst(nullptr)
+	, mCurrent(nullptr)
+	, mBytesUsed(0)
+	, mBytesReserved(0)
+	, mHighWater(0)
+{
+}
+
+LLArena::~LLArena()
+{
+	while (mFirst)
+	{
+		Block* blockp = mFirst;
+		mFirst = blockp->mNext;
+		freeBlock(blockp);
+	}
+}
+
+// static
+LLArena& LLArena::getThreadArena()
+{
+	if (!sThreadArena)
+	{
+		sThreadArena = new LLArena();
+	}
+	return *sThreadArena;
+}
+
+// static
+void LLArena::releaseThreadArena()
+{
+	if (sThreadArena)
+	{
+		llassert(0 == sThreadArena->getBytesUsed());
+		delete sThreadArena;
+		sThreadArena = nullptr;
+	}
+}
+
+void* LLArena::allocateSlow(size_t size, size_t alignment)
+{
+	// Use the next unused block if the request fits (unused blocks are always regular sized), otherwise insert a new one
+	Block* nextp = (mCurrent) ? mCurrent->mNext : mFirst;
+	if ( (!nextp) || (size + alignment > nextp->mSize) )
+	{
+		Block* blockp = allocateBlock(llmax(mBlockSize, size + alignment));
+		blockp->mNext = nextp;
+		if (mCurrent)
+			mCurrent->mNext = blockp;
+		else
+			mFirst = blockp;
+		nextp = blockp;
+	}
+	mCurrent = nextp;
+
+	void* ptr = allocate(size, alignment);
+	mHighWater = llmax(mHighWater, mBytesUsed);
+	return ptr;
+}
+
+LLArena::Marker LLArena::getMarker() const
+{
+	Marker marker;
+	marker.mBlock = mCurrent;
+	marker.mUsed = (mCurrent) ? mCurrent->mUsed : 0;
+	marker.mBytesUsed = mBytesUsed;
+	return marker;
+}
+
+void LLArena::rewind(const Marker& marker)
+{
+	if (mCurrent != marker.mBlock)
+	{
+		// Release every block after the marker's one up to (and including) the current one
+		Block* prevp = marker.mBlock;
+		Block* blockp = (prevp) ? prevp->mNext : mFirst;
+		while (blockp)
+		{
+			const bool is_last = (blockp == mCurrent);
+			Block* nextp = blockp->mNext;
+			if (blockp->mSize > mBlockSize)
+			{
+				// Oversized blocks belonged to a single request so don't hold on to them
+				if (prevp)
+					prevp->mNext = nextp;
+				else
+					mFirst = nextp;
+				freeBlock(blockp);
+			}
+			else
+			{
+				blockp->mUsed = 0;
+				prevp = blockp;
+			}
+
+			if (is_last)
+				break;
+			blockp = nextp;
+		}
+		mCurrent = marker.mBlock;
+	}
+
+	if (mCurrent)
+	{
+		mCurrent->mUsed = marker.mUsed;
+	}
+	mBytesUsed = marker.mBytesUsed;
+}
+
+void LLArena::reset()
+{
+	rewind(Marker());
+
+	// Trim the pool of unused blocks
+	U32 block_count = 0;
+	Block* prevp = nullptr;
+	for (Block* blockp = mFirst; blockp; )
+	{
+		Block* nextp = blockp->mNext;
+		if (++block_count > mRetainBlocks)
+		{
+			if (prevp)
+				prevp->mNext = nextp;
+			else
+				mFirst = nextp;
+			freeBlock(blockp);
+		}
+		else
+		{
+			prevp = blockp;
+		}
+		blockp = nextp;
+	}
+}
+
+LLArena::Block* LLArena::allocateBlock(size_t size)
+{
+	Block* blockp = static_cast<Block*>(malloc(sizeof(Block) + size));
+	if (!blockp)
+	{
+		LL_ERRS() << "Failed to allocate " << size << " bytes of arena memory" << LL_ENDL;
+	}
+	blockp->mNext = nullptr;
+	blockp->mSize = size;
+	blockp->mUsed = 0;
+
+	mBytesReserved += size;
+	claim_alloc(sArenaMemStat, (U32)(sizeof(Block) + size));
+	return blockp;
+}
+
+void LLArena::freeBlock(Block* blockp)
+{
+	mBytesReserved -= blockp->mSize;
+	disclaim_alloc(sArenaMemStat, (U32)(sizeof(Block) + blockp->mSize));
+	free(blockp);
+}
@@ -0,0 +1,239 @@
+/**
+ * @file llarena.h
+ * @brief Resettable bump allocator for short lived scratch memory
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLARENA_H
+#define LL_LLARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//============================================================================
+// LLArena - bump allocator for scratch memory that doesn't outlive a scope
+// (or a message, or a frame).
+//
+// Memory is handed out from large blocks by bumping a pointer and is never
+// freed individually; instead the arena is rewound to a marker (or reset
+// entirely) which makes all memory allocated since then available again in
+// one go. Blocks are kept around between uses so a warmed up arena doesn't
+// touch the heap at all. Requests larger than the block size get a block of
+// their own which is freed again as soon as it's rewound past.
+//
+// An arena isn't thread safe; every thread has its own one through
+// getThreadArena() and LLArena::Scope/LLArenaBuffer<T> default to it. Scopes
+// on the thread arena have to be strictly nested, so never keep one open
+// across a coroutine yield.
+//
+// Block allocations are reported through the "LLArena" memory stat.
+
+class LL_COMMON_API LLArena
+{
+public:
+	enum { DEFAULT_BLOCK_SIZE = 64 * 1024, DEFAULT_ALIGNMENT = 16 };
+
+	LLArena(size_t block_size = DEFAULT_BLOCK_SIZE, U32 retain_blocks = 4);
+	~LLArena();
+
+	LLArena(const LLArena&) = delete;
+	LLArena& operator=(const LLArena&) = delete;
+
+	// Alignment has to be a power of two; never returns NULL
+	LL_FORCE_INLINE void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT)
+	{
+		if (mCurrent)
+		{
+			const uintptr_t base = reinterpret_cast<uintptr_t>(mCurrent->getData());
+			const size_t offset = ((base + mCurrent->mUsed + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+			if (offset + size <= mCurrent->mSize)
+			{
+				mBytesUsed += offset + size - mCurrent->mUsed;
+				mCurrent->mUsed = offset + size;
+				return mCurrent->getData() + offset;
+			}
+		}
+		return allocateSlow(size, alignment);
+	}
+
+	template<typename T>
+	T* allocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Arena memory is never destructed");
+		return static_cast<T*>(allocate(count * sizeof(T), llmax(alignof(T), (size_t)DEFAULT_ALIGNMENT)));
+	}
+
+	struct Block;
+	struct Marker
+	{
+		Block*	mBlock = nullptr;
+		size_t	mUsed = 0;
+		size_t	mBytesUsed = 0;
+	};
+
+	// Everything allocated after getMarker() is released by rewind(); markers have to be rewound to in LIFO order
+	Marker getMarker() const;
+	void rewind(const Marker& marker);
+	// Releases everything and frees all but the retained blocks
+	void reset();
+
+	size_t getBytesUsed() const		{ return mBytesUsed; }
+	size_t getBytesReserved() const	{ return mBytesReserved; }
+	size_t getHighWater() const		{ return mHighWater; }
+
+	// Lazily created, released by LLThread when the thread exits
+	static LLArena& getThreadArena();
+	static void releaseThreadArena();
+
+	// Rewinds the arena to where it was when the scope was created
+	class Scope
+	{
+	public:
+		Scope(LLArena& arena = LLArena::getThreadArena()) : mArena(arena), mMarker(arena.getMarker()) {}
+		~Scope() { mArena.rewind(mMarker); }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT) { return mArena.allocate(size, alignment); }
+		LLArena& getArena() { return mArena; }
+
+	protected:
+		LLArena&	mArena;
+		Marker		mMarker;
+	};
+
+	struct Block
+	{
+		Block*	mNext;
+		size_t	mSize;
+		size_t	mUsed;
+
+		U8* getData() { return reinterpret_cast<U8*>(this + 1); }
+	};
+
+protected:
+	void* allocateSlow(size_t size, size_t alignment);
+	Block* allocateBlock(size_t size);
+	void freeBlock(Block* blockp);
+
+protected:
+	const size_t	mBlockSize;
+	const U32		mRetainBlocks;
+	Block*			mFirst;
+	Block*			mCurrent;	// NULL when nothing has been allocated yet (blocks after it are unused)
+	size_t			mBytesUsed;
+	size_t			mBytesReserved;
+	size_t			mHighWater;
+
+	static LL_THREAD_LOCAL LLArena* sThreadArena;
+};
+
+//============================================================================
+// LLArenaBuffer - uninitialized scratch array of trivial types that's
+// returned to the arena when it goes out of scope. Drop-in for the usual
+// std::vector<U8> temporary buffer.
+
+template<typename T>
+class LLArenaBuffer
+{
+	static_assert(std::is_trivial<T>::value, "LLArenaBuffer is for plain scratch data only");
+public:
+	explicit LLArenaBuffer(size_t count, LLArena& arena = LLArena::getThreadArena())
+		: mScope(arena)
+		, mData(arena.allocateArray<T>(count))
+		, mCount(count)
+	{
+	}
+
+	T* data()							{ return mData; }
+	const T* data() const				{ return mData; }
+	size_t size() const					{ return mCount; }
+	T& operator[](size_t idx)			{ return mData[idx]; }
+	const T& operator[](size_t idx) const { return mData[idx]; }
+
+protected:
+	LLArena::Scope	mScope;
+	T*				mData;
+	size_t			mCount;
+};
+
+//============================================================================
+// LLArenaAllocator - standard allocator that takes its memory from an arena
+// (deallocation is a no-op) or from the heap when constructed without one so
+// a container type can be shared between arena and heap owned instances.
+
+template<typename T>
+class LLArenaAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	template<typename U> struct rebind { typedef LLArenaAllocator<U> other; };
+
+	LLArenaAllocator(LLArena* arenap = nullptr) : mArena(arenap) {}
+	template<typename U> LLArenaAllocator(const LLArenaAllocator<U>& other) : mArena(other.getArena()) {}
+
+	T* allocate(size_t count)
+	{
+		if (mArena)
+		{
+			return static_cast<T*>(mArena->allocate(count * sizeof(T), llmax(alignof(T), sizeof(void*))));
+		}
+		return static_cast<T*>(::operator new(count * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t)
+	{
+		if (!mArena)
+		{
+			::operator delete(ptr);
+		}
+	}
+
+	size_t max_size() const { return std::numeric_limits<size_t>::max() / sizeof(T); }
+
+	template<typename U, typename... Args> void construct(U* ptr, Args&&... args) { ::new((void*)ptr) U(std::forward<Args>(args)...); }
+	template<typename U> void destroy(U* ptr) { ptr->~U(); }
+
+	LLArena* getArena() const { return mArena; }
+
+protected:
+	LLArena* mArena;
+};
+
+template<typename T, typename U>
+inline bool operator==(const LLArenaAllocator<T>& lhs, const LLArenaAllocator<U>& rhs) { return lhs.getArena() == rhs.getArena(); }
+template<typename T, typename U>
+inline bool operator!=(const LLArenaAllocator<T>& lhs, const LLArenaAllocator<U>& rhs) { return lhs.getArena() != rhs.getArena(); }
+
+#endif // LL_LLARENA_H
@@ -0,0 +1,293 @@
+/**
+ * @file llasyncfileio.cpp
+ * @brief Thread pool backed asynchronous file reads, writes and syncs
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llasyncfileio.h"
+
+#include "llapr.h"
+#include "llcoros.h"
+#include "llthread.h"
+
+#include "apr_portable.h"
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <unistd.h>
+#endif
+
+#include <memory>
+
+// ============================================================================
+// LLAsyncFileIOThread class
+//
+
+class LLAsyncFileIOThread : public LLThread
+{
+public:
+	LLAsyncFileIOThread(LLAsyncFileIO* iop, S32 thread_idx)
+		: LLThread(llformat("FileIO %d", thread_idx))
+		, mIOp(iop)
+	{
+		// Every I/O thread needs its own pool since LLAPRFile's global one isn't thread safe
+		mLocalAPRFilePoolp = new LLVolatileAPRPool();
+	}
+
+protected:
+	void run() override
+	{
+		mIOp->runThread(this);
+	}
+
+protected:
+	LLAsyncFileIO* mIOp;
+};
+
+// ============================================================================
+// LLAsyncFileIO class
+//
+
+LLAsyncFileIO* LLAsyncFileIO::sInstance = nullptr;
+
+// static
+void LLAsyncFileIO::initClass(S32 num_threads)
+{
+	if (sInstance)
+	{
+		return;
+	}
+
+	num_threads = llclamp(num_threads, 1, 32);
+	sInstance = new LLAsyncFileIO(num_threads);
+	LL_INFOS("FileIO") << "Started " << num_threads << " file I/O threads" << LL_ENDL;
+}
+
+// static
+void LLAsyncFileIO::cleanupClass()
+{
+	// Operations that are still queued are finished (and their callbacks called) before the threads exit
+	LLAsyncFileIO* instancep = sInstance;
+	sInstance = nullptr;
+	delete instancep;
+}
+
+LLAsyncFileIO::LLAsyncFileIO(S32 num_threads)
+	: mPending(0)
+	, mQuitting(false)
+{
+	mThreads.reserve(num_threads);
+	for (S32 idx = 0; idx < num_threads; idx++)
+	{
+		mThreads.push_back(new LLAsyncFileIOThread(this, idx));
+		mThreads.back()->start();
+	}
+}
+
+LLAsyncFileIO::~LLAsyncFileIO()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuitting = true;
+		mCondition.notify_all();
+	}
+
+	// ~LLThread() waits for the thread to stop
+	for (LLAsyncFileIOThread* threadp : mThreads)
+	{
+		delete threadp;
+	}
+	mThreads.clear();
+}
+
+// static
+void LLAsyncFileIO::read(const std::string& filename, U8* buffer, S32 offset, S32 numbytes, const callback_t& cb)
+{
+	post(Request{ OP_READ, filename, buffer, offset, numbytes, false, cb });
+}
+
+// static
+void LLAsyncFileIO::write(const std::string& filename, const U8* buffer, S32 offset, S32 numbytes, const callback_t& cb, bool truncate)
+{
+	post(Request{ OP_WRITE, filename, const_cast<U8*>(buffer), offset, numbytes, truncate, cb });
+}
+
+// static
+void LLAsyncFileIO::fsync(const std::string& filename, const callback_t& cb)
+{
+	post(Request{ OP_FSYNC, filename, nullptr, 0, 0, false, cb });
+}
+
+// static
+S32 LLAsyncFileIO::readAndSuspend(const std::string& filename, U8* buffer, S32 offset, S32 numbytes)
+{
+	return postAndSuspend(Request{ OP_READ, filename, buffer, offset, numbytes, false, callback_t() });
+}
+
+// static
+S32 LLAsyncFileIO::writeAndSuspend(const std::string& filename, const U8* buffer, S32 offset, S32 numbytes, bool truncate)
+{
+	return postAndSuspend(Request{ OP_WRITE, filename, const_cast<U8*>(buffer), offset, numbytes, truncate, callback_t() });
+}
+
+// static
+S32 LLAsyncFileIO::fsyncAndSuspend(const std::string& filename)
+{
+	return postAndSuspend(Request{ OP_FSYNC, filename, nullptr, 0, 0, false, callback_t() });
+}
+
+// static
+void LLAsyncFileIO::post(Request&& request)
+{
+	LLAsyncFileIO* instancep = sInstance;
+	if (!instancep)
+	{
+		// Not (or no longer) running, do it here and now
+		const S32 result = process(request, nullptr);
+		if (request.mCallback)
+		{
+			request.mCallback(result);
+		}
+		return;
+	}
+
+	instancep->mPending++;
+	{
+		std::lock_guard<std::mutex> lock(instancep->mMutex);
+		instancep->mRequests.push_back(std::move(request));
+	}
+	instancep->mCondition.notify_one();
+}
+
+// static
+S32 LLAsyncFileIO::postAndSuspend(Request&& request)
+{
+	// The promise is shared with the callback since it might still be running on the I/O thread as the coroutine resumes
+	std::shared_ptr<LLCoros::Promise<S32>> promisep = std::make_shared<LLCoros::Promise<S32>>();
+	LLCoros::Future<S32> future = LLCoros::getFuture(*promisep);
+	request.mCallback = [promisep](S32 result) { promisep->set_value(result); };
+	post(std::move(request));
+
+	// Fiber futures only suspend the calling coroutine, everything else on this thread keeps running
+	return future.get();
+}
+
+void LLAsyncFileIO::runThread(LLAsyncFileIOThread* threadp)
+{
+	LLVolatileAPRPool* poolp = threadp->getLocalAPRFilePool();
+	while (true)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this]() { return (mQuitting) || (!mRequests.empty()); });
+			if (mRequests.empty())
+			{
+				// Only stop once everything that was posted is done
+				break;
+			}
+			request = std::move(mRequests.front());
+			mRequests.pop_front();
+		}
+
+		const S32 result = process(request, poolp);
+		// The operation is done once the callback runs so anyone it wakes up shouldn't still see it as pending
+		mPending--;
+		if (request.mCallback)
+		{
+			request.mCallback(result);
+		}
+	}
+}
+
+// static
+S32 LLAsyncFileIO::process(const Request& request, LLVolatileAPRPool* poolp)
+{
+	switch (request.mOperation)
+	{
+		case OP_READ:
+			{
+				llassert(request.mOffset >= 0);
+				LLAPRFile infile; // auto-closes
+				infile.open(request.mFilename, LL_APR_RB, poolp);
+				if (!infile.getFileHandle())
+				{
+					LL_WARNS("FileIO") << "Unable to read file: " << request.mFilename << LL_ENDL;
+					return -1;
+				}
+				if ( (request.mOffset > 0) && (infile.seek(APR_SET, request.mOffset) < 0) )
+				{
+					return -1;
+				}
+				return infile.read(request.mBuffer, request.mBytes);
+			}
+		case OP_WRITE:
+			{
+				apr_int32_t flags = APR_CREATE | APR_WRITE | APR_BINARY;
+				if (request.mTruncate)
+					flags |= APR_TRUNCATE;
+				if (request.mOffset < 0)
+					flags |= APR_APPEND;
+
+				LLAPRFile outfile; // auto-closes
+				outfile.open(request.mFilename, flags, poolp);
+				if (!outfile.getFileHandle())
+				{
+					LL_WARNS("FileIO") << "Unable to write file: " << request.mFilename << LL_ENDL;
+					return -1;
+				}
+				if ( (request.mOffset > 0) && (outfile.seek(APR_SET, request.mOffset) < 0) )
+				{
+					LL_WARNS("FileIO") << "Unable to write file (seek failed): " << request.mFilename << LL_ENDL;
+					return -1;
+				}
+				const S32 bytes_written = outfile.write(request.mBuffer, request.mBytes);
+				return (bytes_written == request.mBytes) ? bytes_written : -1;
+			}
+		case OP_FSYNC:
+			{
+				LLAPRFile file; // auto-closes
+				file.open(request.mFilename, APR_WRITE | APR_BINARY, poolp);
+				if (!file.getFileHandle())
+				{
+					return -1;
+				}
+
+				apr_os_file_t os_file;
+				if ( (APR_SUCCESS != apr_file_flush(file.getFileHandle())) || (APR_SUCCESS != apr_os_file_get(&os_file, file.getFileHandle())) )
+				{
+					return -1;
+				}
+#if LL_WINDOWS
+				return (FlushFileBuffers(os_file)) ? 0 : -1;
+#else
+				return (0 == ::fsync(os_file)) ? 0 : -1;
+#endif
+			}
+		default:
+			LL_ERRS("FileIO") << "Unknown operation: " << (S32)request.mOperation << LL_ENDL;
+			return -1;
+	}
+}
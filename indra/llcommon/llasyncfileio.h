@@ -0,0 +1,119 @@
+/**
+ * @file llasyncfileio.h
+ * @brief Thread pool backed asynchronous file reads, writes and syncs
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLASYNCFILEIO_H
+#define LL_LLASYNCFILEIO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class LLAsyncFileIOThread;
+class LLVolatileAPRPool;
+
+//============================================================================
+// LLAsyncFileIO - runs blocking file operations on a small pool of I/O
+// threads so callers don't have to wait on the disk.
+//
+// Unlike LLLFSThread (one thread working through a priority queue) any
+// number of operations can be in flight at once, which is what lets a fast
+// drive serve lots of small reads in parallel.
+//
+// Every operation takes a completion callback which is called on an I/O
+// thread with the number of bytes transferred (or -1 on failure); buffers
+// have to stay valid until then. The *AndSuspend() variants are meant for
+// coroutines: they suspend the calling coroutine (rather than the thread)
+// until the operation completes and return its result.
+//
+// Operations run synchronously on the calling thread before initClass()
+// and after cleanupClass().
+
+class LL_COMMON_API LLAsyncFileIO
+{
+public:
+	// Bytes read or written, or -1 if the operation failed
+	typedef std::function<void(S32 result)> callback_t;
+
+	static void initClass(S32 num_threads = 4);
+	static void cleanupClass();
+	// NULL before initClass() and after cleanupClass()
+	static LLAsyncFileIO* getInstance() { return sInstance; }
+
+protected:
+	LLAsyncFileIO(S32 num_threads);
+	~LLAsyncFileIO();
+
+public:
+	// Reads up to numbytes from offset; it's not an error to read past the end of the file
+	static void read(const std::string& filename, U8* buffer, S32 offset, S32 numbytes, const callback_t& cb);
+	// Writes at offset (appends if offset < 0), truncates the file first if requested
+	static void write(const std::string& filename, const U8* buffer, S32 offset, S32 numbytes, const callback_t& cb, bool truncate = false);
+	// Flushes the file's data to the disk; returns 0 on success
+	static void fsync(const std::string& filename, const callback_t& cb);
+
+	static S32 readAndSuspend(const std::string& filename, U8* buffer, S32 offset, S32 numbytes);
+	static S32 writeAndSuspend(const std::string& filename, const U8* buffer, S32 offset, S32 numbytes, bool truncate = false);
+	static S32 fsyncAndSuspend(const std::string& filename);
+
+	// Operations queued or running (an operation no longer counts by the time its callback is called)
+	S32 getPending() const { return mPending; }
+
+protected:
+	friend class LLAsyncFileIOThread;
+
+	enum EOperation { OP_READ, OP_WRITE, OP_FSYNC };
+	struct Request
+	{
+		EOperation	mOperation;
+		std::string	mFilename;
+		U8*			mBuffer;
+		S32			mOffset;
+		S32			mBytes;
+		bool		mTruncate;
+		callback_t	mCallback;
+	};
+
+	static void post(Request&& request);
+	static S32 postAndSuspend(Request&& request);
+	static S32 process(const Request& request, LLVolatileAPRPool* poolp);
+	void runThread(LLAsyncFileIOThread* threadp);
+
+protected:
+	std::vector<LLAsyncFileIOThread*>	mThreads;
+	std::mutex							mMutex;
+	std::condition_variable				mCondition;
+	std::deque<Request>					mRequests;
+	std::atomic<S32>					mPending;
+	bool								mQuitting;
+
+	static LLAsyncFileIO*				sInstance;
+};
+
+#endif // LL_LLASYNCFILEIO_H
@@ -123,6 +123,16 @@ LLEventPump& LLEventPumps::make(const std::string& name, bool tweak,
     return *newInstance;
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+U32 LLEventPumps::sGeneration = 1;
+
+LLEventPump* LLEventPumps::find(const std::string& name) const
+{
+    PumpMap::const_iterator found = mPumpMap.find(name);
+    return (found != mPumpMap.end()) ? found->second : nullptr;
+}
+// [/SL:KB]
+
 bool LLEventPumps::post(const std::string&name, const LLSD&message)
 {
     PumpMap::iterator found = mPumpMap.find(name);
@@ -169,7 +179,13 @@ std::string LLEventPumps::registerNew(const LLEventPump& pump, const std::string
         mPumpMap.insert(PumpMap::value_type(name, const_cast<LLEventPump*>(&pump)));
     // If the insert worked, then the name is unique; return that.
     if (inserted.second)
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    {
+        ++sGeneration;
         return name;
+    }
+// [/SL:KB]
+//        return name;
     // Here the new entry was NOT inserted, and therefore name isn't unique.
     // Unless we're permitted to tweak it, that's Bad.
     if (! tweak)
@@ -244,6 +260,9 @@ void LLEventPumps::unregister(const LLEventPump& pump)
     if (found != mPumpMap.end())
     {
         mPumpMap.erase(found);
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+        ++sGeneration;
+// [/SL:KB]
     }
     // If this instance is one we created, also remove it from mOurPumps so we
     // won't try again to delete it later!
@@ -286,7 +305,12 @@ LLEventPump::LLEventPump(const std::string& name, bool tweak):
     mRegistry(LLEventPumps::instance().getHandle()),
     mName(mRegistry.get()->registerNew(*this, name, tweak)),
     mSignal(boost::make_shared<LLStandardSignal>()),
-    mEnabled(true)
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    mEnabled(true),
+    mFastDispatch(false),
+    mFastCacheValid(false)
+// [/SL:KB]
+//    mEnabled(true)
 {}
 
 #if LL_WINDOWS
@@ -319,6 +343,10 @@ void LLEventPump::clear()
     // whole new one.
     mSignal = boost::make_shared<LLStandardSignal>();
     mConnections.clear();
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    mFastListeners.clear();
+    mFastCacheValid = false;
+// [/SL:KB]
 }
 
 void LLEventPump::reset()
@@ -326,7 +354,97 @@ void LLEventPump::reset()
     mSignal.reset();
     mConnections.clear();
     //mDeps.clear();
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    mFastListeners.clear();
+    mFastCache.reset();
+    mFastCacheValid = false;
+// [/SL:KB]
+}
+
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+void LLEventPump::setFastDispatch(bool enable)
+{
+    if (mFastDispatch != enable)
+    {
+        mFastDispatch = enable;
+        mFastListeners.clear();
+        mFastCache.reset();
+        mFastCacheValid = false;
+    }
+}
+
+boost::shared_ptr<const LLEventPump::FastListenerCache> LLEventPump::getFastListeners()
+{
+    if ( (mFastCacheValid) && ((!mFastCache) || (!mFastCache->mStale)) )
+    {
+        return mFastCache;
+    }
+
+    // Forget about listeners that were disconnected since the last rebuild
+    mFastListeners.erase(std::remove_if(mFastListeners.begin(), mFastListeners.end(),
+                                        [](const FastListener& listener) { return !listener.mConnection.connected(); }),
+                         mFastListeners.end());
+    mFastCacheValid = true;
+
+    // If mSignal has listeners we don't know about (connected while fast
+    // dispatch was off) they can only be reached through mSignal
+    if ( (!mSignal) || (mFastListeners.size() != mSignal->num_slots()) )
+    {
+        mFastCache.reset();
+        return mFastCache;
+    }
+
+    // mSignal calls its groups in ascending order and the listeners of a
+    // group in the order they were connected
+    boost::shared_ptr<FastListenerCache> cache = boost::make_shared<FastListenerCache>();
+    cache->mListeners = mFastListeners;
+    std::stable_sort(cache->mListeners.begin(), cache->mListeners.end(),
+                     [](const FastListener& lhs, const FastListener& rhs) { return lhs.mPlacement < rhs.mPlacement; });
+    mFastCache = cache;
+    return mFastCache;
+}
+
+// static
+bool LLEventPump::dispatchFast(const FastListenerCache& cache, const LLSD& event)
+{
+    // NOTE: 'this' might be gone by the time a listener returns, see
+    // LLEventStream::post(); only touch the cache we were handed
+    for (const FastListener& listener : cache.mListeners)
+    {
+        if (!listener.mConnection.connected())
+        {
+            cache.mStale = true;
+            continue;
+        }
+        if (listener.mConnection.blocked())
+        {
+            continue;
+        }
+
+        // Same semantics as LLStopWhenHandled
+        try
+        {
+            // Calling the slot locks its tracked objects (if any) for the duration of the call
+            if (listener.mListener(event))
+            {
+                return true;
+            }
+        }
+        catch (const boost::signals2::expired_slot&)
+        {
+            // One of the tracked objects was destroyed; mSignal would
+            // disconnect the listener here as well
+            listener.mConnection.disconnect();
+            cache.mStale = true;
+        }
+        catch (const LLContinueError&)
+        {
+            LOG_UNHANDLED_EXCEPTION("LLEventPump");
+        }
+    }
+    return false;
 }
+// [/SL:KB]
 
 LLBoundListener LLEventPump::listen_impl(const std::string& name, const LLEventListener& listener,
                                          const NameList& after,
@@ -487,6 +605,13 @@ LLBoundListener LLEventPump::listen_impl(const std::string& name, const LLEventL
     // Now that newNode has a value that places it appropriately in mSignal,
     // connect it.
     LLBoundListener bound = mSignal->connect(nodePosition, listener);
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    if (mFastDispatch)
+    {
+        mFastListeners.push_back(FastListener{ nodePosition, bound, listener });
+        mFastCacheValid = false;
+    }
+// [/SL:KB]
     
     if (!name.empty())
     {   // note that we are not tracking anonymous listeners here either.
@@ -516,6 +641,9 @@ void LLEventPump::stopListening(const std::string& name)
     {
         found->second.disconnect();
         mConnections.erase(found);
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+        mFastCacheValid = false;
+// [/SL:KB]
     }
     // We intentionally do NOT remove this name from mDeps. It may happen that
     // the same listener with the same name and dependencies will jump on and
@@ -543,6 +671,18 @@ bool LLEventStream::post(const LLSD& event)
     // *stack* instance of the shared_ptr, ensuring that our heap
     // LLStandardSignal object will live at least until post() returns, even
     // if 'this' gets destroyed during the call.
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    if (mFastDispatch)
+    {
+        // Same reasoning as for mSignal below: our own reference keeps the
+        // listener list alive even if a listener destroys 'this'
+        boost::shared_ptr<const FastListenerCache> cache(getFastListeners());
+        if (cache)
+        {
+            return dispatchFast(*cache, event);
+        }
+    }
+// [/SL:KB]
     boost::shared_ptr<LLStandardSignal> signal(mSignal);
     // Let caller know if any one listener handled the event. This is mostly
     // useful when using LLEventStream as a listener for an upstream
@@ -281,6 +281,22 @@ class LL_COMMON_API LLEventPumps: public LLSingleton<LLEventPumps>,
      */
     bool post(const std::string&, const LLSD&);
 
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    /**
+     * Find the named LLEventPump instance without creating it. Returns NULL
+     * if there is no such pump. Callers that look up the same pump over and
+     * over should hold an LLEventPumpHandle instead.
+     */
+    LLEventPump* find(const std::string& name) const;
+
+    /**
+     * Changes whenever an LLEventPump instance is registered or unregistered
+     * so LLEventPumpHandle knows when its cached pointer has to be looked up
+     * again. (Static so it survives deleteSingleton().)
+     */
+    static U32 getGeneration() { return sGeneration; }
+// [/SL:KB]
+
     /**
      * Flush all known LLEventPump instances
      */
@@ -339,6 +355,10 @@ class LL_COMMON_API LLEventPumps: public LLSingleton<LLEventPumps>,
     // obtain() must create the instance
     typedef std::map<std::string, std::string> InstanceTypes;
     InstanceTypes mTypes;
+
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    static U32 sGeneration;
+// [/SL:KB]
 };
 
 /*****************************************************************************
@@ -552,6 +572,22 @@ class LL_COMMON_API LLEventPump: public LLEventTrackable
     /// flush queued events
     virtual void flush() {}
 
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    /**
+     * Fast dispatch: LLEventStream::post() walks a cached copy of the
+     * listener list, already sorted by placement, instead of going through
+     * mSignal. The copy is only rebuilt when a listener is added or removed.
+     * Call this before anyone listens: listeners that were connected while
+     * fast dispatch was off aren't known to the cache, and as long as any of
+     * them is still connected post() keeps using mSignal.
+     *
+     * Only meant for pumps that are exclusively used on the main thread
+     * (e.g. "mainloop").
+     */
+    void setFastDispatch(bool enable);
+    bool getFastDispatch() const { return mFastDispatch; }
+// [/SL:KB]
+
 private:
     friend class LLEventPumps;
     virtual void clear();
@@ -588,6 +624,36 @@ class LL_COMMON_API LLEventPump: public LLEventTrackable
     /// same listener with the same dependencies keeps hopping on and off this
     /// LLEventPump.
     DependencyMap mDeps;
+
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+    struct FastListener
+    {
+        float           mPlacement;
+        LLBoundListener mConnection;
+        LLEventListener mListener;
+    };
+    typedef std::vector<FastListener> FastListenerList;
+    /// Sorted snapshot of the listeners; post() holds on to its own
+    /// reference so it stays valid even if a listener changes the pump
+    struct FastListenerCache
+    {
+        FastListenerList mListeners;
+        /// set by dispatchFast() when it runs into a disconnected or expired
+        /// listener so the next post() rebuilds the snapshot
+        mutable bool     mStale = false;
+    };
+
+    /// Returns NULL when the event has to go through mSignal instead
+    boost::shared_ptr<const FastListenerCache> getFastListeners();
+    static bool dispatchFast(const FastListenerCache& cache, const LLSD& event);
+
+    bool mFastDispatch;
+    /// Listeners in the order they were connected (only kept while fast
+    /// dispatch is on); disconnected entries are pruned on the next rebuild
+    FastListenerList mFastListeners;
+    boost::shared_ptr<const FastListenerCache> mFastCache;
+    bool mFastCacheValid;
+// [/SL:KB]
 };
 
 /*****************************************************************************
@@ -650,6 +716,74 @@ class LL_COMMON_API LLEventMailDrop : public LLEventStream
     EventList mEventHistory;
 };
 
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+/*****************************************************************************
+*   LLEventPumpHandle
+*****************************************************************************/
+/**
+ * LLEventPumpHandle refers to an LLEventPump by name but only looks it up
+ * in LLEventPumps when a pump has been registered or unregistered since the
+ * last lookup. Hold one (e.g. as a static or a class member) instead of
+ * calling LLEventPumps::obtain() or LLEventPumps::post() with the same name
+ * over and over.
+ *
+ * PUMP can be any LLEventPump subclass; get() returns NULL if the named
+ * pump isn't of that type.
+ *
+ * @code
+ * static LLEventPumpHandle<> s_pump("SomePump");
+ * s_pump.post(event);
+ * @endcode
+ */
+template<typename PUMP = LLEventPump>
+class LLEventPumpHandle
+{
+public:
+    explicit LLEventPumpHandle(const std::string& name)
+        : mName(name), mPump(nullptr), mGeneration(0)
+    {}
+
+    const std::string& getName() const { return mName; }
+
+    /// The named pump if it exists (doesn't create it)
+    PUMP* get() const
+    {
+        if (mGeneration != LLEventPumps::getGeneration())
+        {
+            mPump = (LLEventPumps::instanceExists()) ? dynamic_cast<PUMP*>(LLEventPumps::instance().find(mName)) : nullptr;
+            mGeneration = LLEventPumps::getGeneration();
+        }
+        return mPump;
+    }
+
+    /// Find-or-create, see LLEventPumps::obtain() (throws std::bad_cast if
+    /// the existing pump isn't a PUMP)
+    PUMP& obtain() const
+    {
+        if (PUMP* pump = get())
+        {
+            return *pump;
+        }
+        PUMP& pump = dynamic_cast<PUMP&>(LLEventPumps::instance().obtain(mName));
+        mPump = &pump;
+        mGeneration = LLEventPumps::getGeneration();
+        return pump;
+    }
+
+    /// Same as LLEventPumps::post(): does nothing if the pump doesn't exist
+    bool post(const LLSD& event) const
+    {
+        PUMP* pump = get();
+        return (pump) ? pump->post(event) : false;
+    }
+
+private:
+    std::string   mName;
+    mutable PUMP* mPump;
+    mutable U32   mGeneration;
+};
+// [/SL:KB]
+
 /*****************************************************************************
 *   LLReqID
 *****************************************************************************/
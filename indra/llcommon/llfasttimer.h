@@ -30,6 +30,9 @@
 #include "llinstancetracker.h"
 #include "lltrace.h"
 #include "lltreeiterators.h"
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+#include "llfasttimertrace.h"
+// [/SL:KB]
 
 #if LL_WINDOWS
 #include <intrin.h>
@@ -213,6 +216,11 @@ class BlockTimer
 private:
 	U64						mStartTime;
 	BlockTimerStackRecord	mParentTimerData;
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	// Unlike mStartTime this isn't moved forward by updateTimes() (0 when the scope isn't being traced)
+	U64						mTraceStartTime;
+	BlockTimerStatHandle*	mTraceTimer;
+// [/SL:KB]
 
 public:
 	// statics
@@ -282,6 +290,11 @@ block_timer_tree_bf_iterator_t end_block_timer_tree_bf();
 LL_FORCE_INLINE BlockTimer::BlockTimer(BlockTimerStatHandle& timer)
 {
 #if LL_FAST_TIMER_ON
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	// Tracing works independently from the accumulated timings so it's not affected by DisableIdleFastTimer
+	mTraceStartTime = (BlockTimerTrace::sEnabled) ? getCPUClockCount64() : 0;
+	mTraceTimer = &timer;
+// [/SL:KB]
 // [SL:KB] - Patch: Viewer-OptimizationFastTimers | Checked: Catznip-6.0
 	if (!sEnabled)
 	{
@@ -320,6 +333,12 @@ LL_FORCE_INLINE BlockTimer::BlockTimer(BlockTimerStatHandle& timer)
 LL_FORCE_INLINE BlockTimer::~BlockTimer()
 {
 #if LL_FAST_TIMER_ON
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	if (mTraceStartTime)
+	{
+		BlockTimerTrace::record(mTraceTimer, mTraceStartTime, getCPUClockCount64());
+	}
+// [/SL:KB]
 // [SL:KB] - Patch: Viewer-OptimizationFastTimers | Checked: Catznip-6.0
 	if (!mStartTime)
 	{
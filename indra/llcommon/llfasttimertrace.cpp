@@ -0,0 +1,293 @@
+/**
+ * @file llfasttimertrace.cpp
+ * @brief Per-thread event recorder for block timers with Chrome trace export
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfasttimertrace.h"
+
+#include "llfasttimer.h"
+#include "llfile.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace LLTrace
+{
+
+// ============================================================================
+// Helper functions
+//
+
+namespace
+{
+	// Number of events copied at a time before checking whether the owning thread caught up with them
+	const U64 SNAPSHOT_CHUNK = 4096;
+
+	struct ThreadRegistry
+	{
+		std::mutex									mMutex;
+		std::vector<BlockTimerTrace::ThreadBuffer*>	mBuffers;
+		U32											mNextID = 1;
+	};
+
+	// Constructed on first use since block timers can run during static initialization
+	ThreadRegistry& get_thread_registry()
+	{
+		static ThreadRegistry s_registry;
+		return s_registry;
+	}
+
+	void write_json_string(std::ostream& os, const std::string& str)
+	{
+		os << '"';
+		for (char ch : str)
+		{
+			switch (ch)
+			{
+				case '"':  os << "\\\""; break;
+				case '\\': os << "\\\\"; break;
+				case '\n': os << "\\n"; break;
+				case '\t': os << "\\t"; break;
+				default:
+					if ((U8)ch < 0x20)
+						os << llformat("\\u%04x", (U32)(U8)ch);
+					else
+						os << ch;
+					break;
+			}
+		}
+		os << '"';
+	}
+}
+
+// ============================================================================
+// BlockTimerTrace class
+//
+
+bool BlockTimerTrace::sEnabled = false;
+LL_THREAD_LOCAL BlockTimerTrace::ThreadBuffer* BlockTimerTrace::sThreadBuffer = nullptr;
+
+BlockTimerTrace::ThreadBuffer::ThreadBuffer(U32 id, const std::string& name)
+	: mID(id)
+	, mName(name)
+	, mEvents(nullptr)
+	, mHead(0)
+{
+}
+
+BlockTimerTrace::ThreadBuffer::~ThreadBuffer()
+{
+	delete[] mEvents;
+}
+
+// static
+void BlockTimerTrace::setEnabled(bool enabled)
+{
+	// Recorded scopes are kept around when disabling so they can still be written out
+	sEnabled = enabled;
+}
+
+// static
+void BlockTimerTrace::setThreadName(const std::string& name)
+{
+	ThreadBuffer* bufferp = getThreadBuffer();
+
+	ThreadRegistry& registry = get_thread_registry();
+	std::lock_guard<std::mutex> lock(registry.mMutex);
+	bufferp->mName = name;
+}
+
+// static
+void BlockTimerTrace::releaseThread()
+{
+	if (ThreadBuffer* bufferp = sThreadBuffer)
+	{
+		ThreadRegistry& registry = get_thread_registry();
+		{
+			std::lock_guard<std::mutex> lock(registry.mMutex);
+			registry.mBuffers.erase(std::remove(registry.mBuffers.begin(), registry.mBuffers.end(), bufferp), registry.mBuffers.end());
+		}
+		sThreadBuffer = nullptr;
+		delete bufferp;
+	}
+}
+
+// static
+BlockTimerTrace::ThreadBuffer* BlockTimerTrace::getThreadBuffer()
+{
+	if (!sThreadBuffer)
+	{
+		ThreadRegistry& registry = get_thread_registry();
+		std::lock_guard<std::mutex> lock(registry.mMutex);
+
+		// Event storage is only allocated once the thread records its first scope
+		const U32 id = registry.mNextID++;
+		sThreadBuffer = new ThreadBuffer(id, llformat("Thread %u", id));
+		registry.mBuffers.push_back(sThreadBuffer);
+	}
+	return sThreadBuffer;
+}
+
+// static
+BlockTimerTrace::ThreadBuffer* BlockTimerTrace::initThreadBuffer()
+{
+	ThreadBuffer* bufferp = getThreadBuffer();
+	if (!bufferp->mEvents)
+	{
+		ThreadRegistry& registry = get_thread_registry();
+		std::lock_guard<std::mutex> lock(registry.mMutex);
+		bufferp->mEvents = new Event[BUFFER_SIZE];
+	}
+	return bufferp;
+}
+
+// static
+void BlockTimerTrace::takeSnapshot(snapshot_t& snapshots, F64 window_secs)
+{
+	snapshots.clear();
+
+	// Scopes are recorded as they end so every thread's events are ordered by their end time
+	const U64 now = BlockTimer::getCPUClockCount64();
+	const U64 window = (window_secs > 0.0) ? (U64)(window_secs * (F64)BlockTimer::countsPerSecond()) : 0;
+	const U64 cutoff = ( (window) && (window < now) ) ? now - window : 0;
+
+	ThreadRegistry& registry = get_thread_registry();
+	std::lock_guard<std::mutex> lock(registry.mMutex);
+
+	snapshots.reserve(registry.mBuffers.size());
+	for (const ThreadBuffer* bufferp : registry.mBuffers)
+	{
+		snapshots.push_back(ThreadSnapshot{ bufferp->mID, bufferp->mName, std::vector<Event>() });
+		if (!bufferp->mEvents)
+		{
+			continue;
+		}
+
+		// The owning thread keeps writing while we copy so copy newest to oldest in chunks and stop at the first event that
+		// might have been overwritten in the meantime (or that reaches past the window). The slot of the oldest event is
+		// the one the next scope goes into so it's never safe to copy.
+		std::vector<Event>& events = snapshots.back().mEvents;
+
+		const U64 head = bufferp->mHead.load(std::memory_order_acquire);
+		const U64 first = (head >= BUFFER_SIZE) ? head - BUFFER_SIZE + 1 : 0;
+		events.resize(head - first);
+
+		U64 copied_first = head;
+		while (copied_first > first)
+		{
+			const U64 chunk_first = (copied_first - first > SNAPSHOT_CHUNK) ? copied_first - SNAPSHOT_CHUNK : first;
+			for (U64 idx = chunk_first; idx < copied_first; idx++)
+			{
+				events[idx - first] = bufferp->mEvents[idx & (BUFFER_SIZE - 1)];
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			// Event idx is (being) overwritten once the scope BUFFER_SIZE after it is recorded
+			const U64 head_now = bufferp->mHead.load(std::memory_order_relaxed);
+			if (chunk_first + BUFFER_SIZE <= head_now)
+			{
+				copied_first = llmin(copied_first, head_now - BUFFER_SIZE + 1);
+				break;
+			}
+			copied_first = chunk_first;
+
+			if (events[chunk_first - first].mEnd < cutoff)
+			{
+				break;
+			}
+		}
+
+		auto itFirst = std::find_if(events.begin() + (copied_first - first), events.end(), [cutoff](const Event& event) { return event.mEnd >= cutoff; });
+		events.erase(events.begin(), itFirst);
+	}
+}
+
+// static
+void BlockTimerTrace::writeChromeTrace(std::ostream& os, const snapshot_t& snapshots)
+{
+	// Timestamps are written relative to the oldest scope in microseconds
+	U64 time_base = std::numeric_limits<U64>::max();
+	for (const ThreadSnapshot& snapshot : snapshots)
+	{
+		for (const Event& event : snapshot.mEvents)
+		{
+			time_base = llmin(time_base, event.mStart);
+		}
+	}
+	const F64 to_usec = 1000000.0 / (F64)BlockTimer::countsPerSecond();
+
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first_event = true;
+	for (const ThreadSnapshot& snapshot : snapshots)
+	{
+		os << (first_event ? "\n" : ",\n") << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << snapshot.mID << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+		write_json_string(os, snapshot.mName);
+		os << "}}";
+		first_event = false;
+
+		for (const Event& event : snapshot.mEvents)
+		{
+			os << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << snapshot.mID << ",\"name\":";
+			write_json_string(os, event.mTimer->getName());
+			os << llformat(",\"ts\":%.3f,\"dur\":%.3f}", (event.mStart - time_base) * to_usec, (event.mEnd - event.mStart) * to_usec);
+		}
+	}
+	os << "\n]}\n";
+}
+
+// static
+bool BlockTimerTrace::writeChromeTrace(const std::string& filename, const snapshot_t& snapshots)
+{
+	llofstream os(filename.c_str());
+	if (!os.is_open())
+	{
+		LL_WARNS("FastTimers") << "Unable to open " << filename << " for writing" << LL_ENDL;
+		return false;
+	}
+
+	writeChromeTrace(os, snapshots);
+	return os.good();
+}
+
+// static
+void BlockTimerTrace::writeChromeTrace(std::ostream& os)
+{
+	snapshot_t snapshots;
+	takeSnapshot(snapshots);
+	writeChromeTrace(os, snapshots);
+}
+
+// static
+bool BlockTimerTrace::writeChromeTrace(const std::string& filename)
+{
+	snapshot_t snapshots;
+	takeSnapshot(snapshots);
+	return writeChromeTrace(filename, snapshots);
+}
+
+}
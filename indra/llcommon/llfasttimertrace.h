@@ -0,0 +1,148 @@
+/**
+ * @file llfasttimertrace.h
+ * @brief Per-thread event recorder for block timers with Chrome trace export
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFASTTIMERTRACE_H
+#define LL_LLFASTTIMERTRACE_H
+
+#include <atomic>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace LLTrace
+{
+
+class BlockTimerStatHandle;
+
+/**
+ * @class BlockTimerTrace
+ * @brief Keeps the last few seconds of block timer scopes of every thread.
+ *
+ * Unlike the accumulated timer tree this keeps each individual scope with
+ * its start and end time so a single slow frame can be inspected later on,
+ * including what the other threads were doing at the time. Every thread
+ * writes into its own fixed size ring buffer so recording a scope is a
+ * handful of stores and never takes a lock; once a buffer is full the
+ * oldest scopes are overwritten.
+ *
+ * writeChromeTrace() snapshots all buffers into the Chrome trace event
+ * format which can be opened in chrome://tracing or ui.perfetto.dev. The
+ * snapshot can also be taken separately so only the (quick) copy has to
+ * happen on the recording thread and the (slow) formatting and writing can
+ * be left to another thread.
+ */
+class BlockTimerTrace
+{
+public:
+	struct Event
+	{
+		U64							mStart;
+		U64							mEnd;
+		const BlockTimerStatHandle*	mTimer;
+	};
+
+	// Number of scopes kept per thread (must be a power of two)
+	static const U32 BUFFER_SIZE = 64 * 1024;
+
+	struct ThreadSnapshot
+	{
+		U32					mID;
+		std::string			mName;
+		std::vector<Event>	mEvents;
+	};
+	typedef std::vector<ThreadSnapshot> snapshot_t;
+
+	struct ThreadBuffer
+	{
+		ThreadBuffer(U32 id, const std::string& name);
+		~ThreadBuffer();
+
+		const U32			mID;
+		std::string			mName;
+		Event*				mEvents;
+		std::atomic<U64>	mHead;
+	};
+
+	static bool isEnabled() { return sEnabled; }
+	static void setEnabled(bool enabled);
+
+	/**
+	 * @brief Names the calling thread in the trace output (threads that never call this show up as "Thread <n>").
+	 */
+	static void setThreadName(const std::string& name);
+
+	/**
+	 * @brief Frees the calling thread's buffer; call right before a thread exits.
+	 */
+	static void releaseThread();
+
+	/**
+	 * @brief Copies the recorded scopes of all threads (only the ones that ended in the last window_secs if non-zero).
+	 */
+	static void takeSnapshot(snapshot_t& snapshot, F64 window_secs = 0.0);
+
+	/**
+	 * @brief Writes a snapshot as Chrome trace event JSON; can be called from any thread.
+	 */
+	static void writeChromeTrace(std::ostream& os, const snapshot_t& snapshot);
+	static bool writeChromeTrace(const std::string& filename, const snapshot_t& snapshot);
+
+	/**
+	 * @brief Writes the recorded scopes of all threads as Chrome trace event JSON.
+	 */
+	static void writeChromeTrace(std::ostream& os);
+	static bool writeChromeTrace(const std::string& filename);
+
+	LL_FORCE_INLINE static void record(const BlockTimerStatHandle* timer, U64 start, U64 end)
+	{
+		ThreadBuffer* bufferp = sThreadBuffer;
+		if ( (!bufferp) || (!bufferp->mEvents) )
+		{
+			bufferp = initThreadBuffer();
+		}
+
+		// Only the owning thread ever writes to the buffer, the release store publishes the event to writeChromeTrace()
+		const U64 head = bufferp->mHead.load(std::memory_order_relaxed);
+		Event& event = bufferp->mEvents[head & (BUFFER_SIZE - 1)];
+		event.mStart = start;
+		event.mEnd = end;
+		event.mTimer = timer;
+		bufferp->mHead.store(head + 1, std::memory_order_release);
+	}
+
+protected:
+	static ThreadBuffer* getThreadBuffer();
+	static ThreadBuffer* initThreadBuffer();
+
+public:
+	static bool								sEnabled;
+protected:
+	static LL_THREAD_LOCAL ThreadBuffer*	sThreadBuffer;
+};
+
+}
+
+#endif // LL_LLFASTTIMERTRACE_H
@@ -0,0 +1,194 @@
+/**
+ * @file llinternedstring.cpp
+ * @brief Global table of unique strings with O(1) comparison and hashing
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llinternedstring.h"
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <mutex>
+
+// ============================================================================
+// Helper functions
+//
+
+namespace
+{
+	// Lookups only need the characters and their hash, this avoids constructing a std::string for every one of them
+	struct EntryKey
+	{
+		const char*	mStr;
+		size_t		mLen;
+		size_t		mHash;
+	};
+
+	template<typename ENTRY>
+	struct EntryHash
+	{
+		size_t operator()(const ENTRY* entryp) const { return entryp->mHash; }
+		size_t operator()(const EntryKey& key) const { return key.mHash; }
+	};
+
+	template<typename ENTRY>
+	struct EntryEqual
+	{
+		bool operator()(const ENTRY* lhs, const ENTRY* rhs) const { return lhs == rhs; }
+		bool operator()(const EntryKey& key, const ENTRY* entryp) const
+		{
+			return (key.mHash == entryp->mHash) && (key.mLen == entryp->mString.size()) && (0 == memcmp(key.mStr, entryp->mString.data(), key.mLen));
+		}
+	};
+
+	// Spreads the strings over a few independently locked tables so interning from several threads doesn't serialize
+	const size_t SHARD_COUNT = 16;
+
+	template<typename ENTRY>
+	struct Shard
+	{
+		std::mutex															mMutex;
+		boost::unordered_set<const ENTRY*, EntryHash<ENTRY>, EntryEqual<ENTRY>>	mEntries;
+	};
+
+	template<typename ENTRY>
+	Shard<ENTRY>* get_shards()
+	{
+		// Constructed on first use since strings can be interned during static initialization; never destroyed so handles in static
+		// objects can still be released after it would have been
+		static Shard<ENTRY>* s_shards = new Shard<ENTRY>[SHARD_COUNT];
+		return s_shards;
+	}
+
+	EntryKey make_key(const char* str, size_t len)
+	{
+		return EntryKey{ str, len, boost::hash_range(str, str + len) };
+	}
+}
+
+// ============================================================================
+// LLInternedString class
+//
+
+const std::string LLInternedString::sEmptyString;
+
+// static
+const LLInternedString::Entry* LLInternedString::intern(const char* str, size_t len)
+{
+	if (!len)
+	{
+		return nullptr;
+	}
+
+	const EntryKey key = make_key(str, len);
+	Shard<Entry>& shard = get_shards<Entry>()[key.mHash % SHARD_COUNT];
+
+	std::lock_guard<std::mutex> lock(shard.mMutex);
+	auto itEntry = shard.mEntries.find(key, EntryHash<Entry>(), EntryEqual<Entry>());
+	if (shard.mEntries.end() != itEntry)
+	{
+		addRef(*itEntry);
+		return *itEntry;
+	}
+
+	Entry* entryp = new Entry(str, len, key.mHash);
+	shard.mEntries.insert(entryp);
+	return entryp;
+}
+
+// static
+const LLInternedString::Entry* LLInternedString::lookup(const char* str, size_t len)
+{
+	if (!len)
+	{
+		return nullptr;
+	}
+
+	const EntryKey key = make_key(str, len);
+	Shard<Entry>& shard = get_shards<Entry>()[key.mHash % SHARD_COUNT];
+
+	std::lock_guard<std::mutex> lock(shard.mMutex);
+	auto itEntry = shard.mEntries.find(key, EntryHash<Entry>(), EntryEqual<Entry>());
+	if (shard.mEntries.end() != itEntry)
+	{
+		addRef(*itEntry);
+		return *itEntry;
+	}
+	return nullptr;
+}
+
+// static
+void LLInternedString::release(const Entry* entryp)
+{
+	if (!entryp)
+	{
+		return;
+	}
+
+	// Dropping anything but the last reference doesn't need the lock
+	U32 ref_count = entryp->mRefCount.load(std::memory_order_relaxed);
+	while (ref_count > 1)
+	{
+		if (entryp->mRefCount.compare_exchange_weak(ref_count, ref_count - 1, std::memory_order_release, std::memory_order_relaxed))
+		{
+			return;
+		}
+	}
+
+	// The last reference is dropped under the lock so a concurrent intern() or find() can't pick the entry up while it's being removed
+	Shard<Entry>& shard = get_shards<Entry>()[entryp->mHash % SHARD_COUNT];
+	std::lock_guard<std::mutex> lock(shard.mMutex);
+	if (1 == entryp->mRefCount.fetch_sub(1, std::memory_order_acq_rel))
+	{
+		shard.mEntries.erase(entryp);
+		delete entryp;
+	}
+}
+
+// static
+LLInternedString LLInternedString::find(const std::string& str)
+{
+	return LLInternedString(lookup(str.data(), str.size()));
+}
+
+// static
+LLInternedString LLInternedString::find(const char* str)
+{
+	return LLInternedString(lookup(str, strlen(str)));
+}
+
+// static
+size_t LLInternedString::getTableSize()
+{
+	size_t count = 0;
+	Shard<Entry>* shards = get_shards<Entry>();
+	for (size_t idx = 0; idx < SHARD_COUNT; idx++)
+	{
+		std::lock_guard<std::mutex> lock(shards[idx].mMutex);
+		count += shards[idx].mEntries.size();
+	}
+	return count;
+}
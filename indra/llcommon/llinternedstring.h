@@ -0,0 +1,150 @@
+/**
+ * @file llinternedstring.h
+ * @brief Global table of unique strings with O(1) comparison and hashing
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINTERNEDSTRING_H
+#define LL_LLINTERNEDSTRING_H
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <string>
+
+//============================================================================
+// LLInternedString - handle to a string in a global, thread safe table of
+// unique strings.
+//
+// Every distinct string is stored (and hashed) exactly once, so two handles
+// are equal if and only if they point at the same table entry: comparing
+// and hashing a handle never looks at the characters. That makes them cheap
+// keys for the name lookups UI and settings code does all the time.
+//
+// Interning a string costs one hash and one table lookup, so hold on to
+// handles rather than re-creating them for every lookup. find() only looks
+// a string up without adding it, which lets a lookup for a name that was
+// never interned fail without growing the table.
+//
+// Entries are reference counted by their handles and removed from the table
+// once the last handle goes away, so interning names that come and go (view
+// names built from inventory item names, say) doesn't grow the table for the
+// rest of the session. Copying a handle is an atomic increment; releasing the
+// last one takes the lock of the entry's shard. The empty string is the
+// (null) default handle.
+
+class LL_COMMON_API LLInternedString
+{
+protected:
+	struct Entry
+	{
+		Entry(const char* str, size_t len, size_t hash) : mString(str, len), mHash(hash), mRefCount(1) {}
+
+		const std::string		mString;
+		const size_t			mHash;
+		mutable std::atomic<U32> mRefCount;
+	};
+
+public:
+	LLInternedString() : mEntryp(nullptr) {}
+	explicit LLInternedString(const std::string& str) : mEntryp(intern(str.data(), str.size())) {}
+	explicit LLInternedString(const char* str) : mEntryp(intern(str, strlen(str))) {}
+	LLInternedString(const LLInternedString& other) : mEntryp(other.mEntryp) { addRef(mEntryp); }
+	LLInternedString(LLInternedString&& other) : mEntryp(other.mEntryp) { other.mEntryp = nullptr; }
+	~LLInternedString() { release(mEntryp); }
+
+	LLInternedString& operator=(const LLInternedString& rhs)
+	{
+		if (mEntryp != rhs.mEntryp)
+		{
+			addRef(rhs.mEntryp);
+			release(mEntryp);
+			mEntryp = rhs.mEntryp;
+		}
+		return *this;
+	}
+
+	LLInternedString& operator=(LLInternedString&& rhs)
+	{
+		if (this != &rhs)
+		{
+			release(mEntryp);
+			mEntryp = rhs.mEntryp;
+			rhs.mEntryp = nullptr;
+		}
+		return *this;
+	}
+
+	// Returns the handle of an already interned string, or an empty handle if it never was
+	static LLInternedString find(const std::string& str);
+	static LLInternedString find(const char* str);
+
+	// Number of strings in the table (i.e. with at least one handle)
+	static size_t getTableSize();
+
+	const std::string& str() const { return (mEntryp) ? mEntryp->mString : sEmptyString; }
+	const char* c_str() const { return str().c_str(); }
+	bool empty() const { return !mEntryp; }
+	size_t hash() const { return (mEntryp) ? mEntryp->mHash : 0; }
+
+	bool operator==(const LLInternedString& rhs) const { return mEntryp == rhs.mEntryp; }
+	bool operator!=(const LLInternedString& rhs) const { return mEntryp != rhs.mEntryp; }
+	// Orders by table entry rather than alphabetically (the order is stable for the lifetime of the process only)
+	bool operator<(const LLInternedString& rhs) const { return std::less<const Entry*>()(mEntryp, rhs.mEntryp); }
+
+protected:
+	// Takes over the reference intern() or lookup() added
+	explicit LLInternedString(const Entry* entryp) : mEntryp(entryp) {}
+
+	// Both return the entry with a reference added for the caller
+	static const Entry* intern(const char* str, size_t len);
+	static const Entry* lookup(const char* str, size_t len);
+
+	static void addRef(const Entry* entryp) { if (entryp) entryp->mRefCount.fetch_add(1, std::memory_order_relaxed); }
+	static void release(const Entry* entryp);
+
+protected:
+	const Entry*				mEntryp;
+	static const std::string	sEmptyString;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const LLInternedString& str)
+{
+	return os << str.str();
+}
+
+// boost::hash support
+inline size_t hash_value(const LLInternedString& str)
+{
+	return str.hash();
+}
+
+namespace std
+{
+	template<> struct hash<LLInternedString>
+	{
+		size_t operator()(const LLInternedString& str) const { return str.hash(); }
+	};
+}
+
+#endif // LL_LLINTERNEDSTRING_H
@@ -0,0 +1,329 @@
+/**
+ * @file lljobsystem.cpp
+ * @brief Shared pool of worker threads with per-worker queues and work stealing
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lljobsystem.h"
+
+#include "llqueuedthread.h"
+#include "llthread.h"
+#include "lltimer.h"
+#include "lltracethreadrecorder.h"
+
+#include <chrono>
+#include <thread>
+
+// ============================================================================
+// Helper functions
+//
+
+namespace
+{
+	LL_THREAD_LOCAL S32 sCurrentWorker = LLJobSystem::ANY_WORKER;
+
+	U64 get_clock_usec()
+	{
+		return totalTime().value();
+	}
+}
+
+// ============================================================================
+// LLJobWorkerThread class
+//
+
+class LLJobWorkerThread : public LLThread
+{
+public:
+	LLJobWorkerThread(LLJobSystem* systemp, S32 worker_idx)
+		: LLThread(llformat("JobWorker %d", worker_idx))
+		, mSystemp(systemp)
+		, mWorkerIdx(worker_idx)
+	{
+	}
+
+protected:
+	void run() override
+	{
+		sCurrentWorker = mWorkerIdx;
+		mSystemp->runWorker(mWorkerIdx);
+		sCurrentWorker = LLJobSystem::ANY_WORKER;
+	}
+
+protected:
+	LLJobSystem*	mSystemp;
+	S32				mWorkerIdx;
+};
+
+// ============================================================================
+// LLJobSystem class
+//
+
+LLJobSystem* LLJobSystem::sInstance = nullptr;
+
+// static
+void LLJobSystem::initClass(S32 num_workers)
+{
+	if (sInstance)
+	{
+		return;
+	}
+
+	if (num_workers <= 0)
+	{
+		num_workers = llmax((S32)std::thread::hardware_concurrency() - 1, 1);
+	}
+	sInstance = new LLJobSystem(num_workers);
+	LL_INFOS("JobSystem") << "Started " << num_workers << " job workers" << LL_ENDL;
+}
+
+// static
+void LLJobSystem::cleanupClass()
+{
+	// Workers are joined before the instance goes away so jobs that are still running can keep using it
+	delete sInstance;
+	sInstance = nullptr;
+}
+
+// static
+LLJobSystem::EPriority LLJobSystem::fromQueuedPriority(U32 priority)
+{
+	const U32 high_bits = priority & LLQueuedThread::PRIORITY_HIGHBITS;
+	if (high_bits >= LLQueuedThread::PRIORITY_HIGH)
+		return PRIORITY_HIGH;
+	else if (high_bits >= LLQueuedThread::PRIORITY_NORMAL)
+		return PRIORITY_NORMAL;
+	return PRIORITY_LOW;
+}
+
+// static
+S32 LLJobSystem::getCurrentWorker()
+{
+	return sCurrentWorker;
+}
+
+LLJobSystem::LLJobSystem(S32 num_workers)
+	: mPending(0)
+	, mSleeping(0)
+	, mNextWorker(0)
+	, mStealCount(0)
+	, mQuitting(false)
+	, mNextDue(0)
+	, mHasTimerWaiter(false)
+{
+	// All workers need to exist before any of them starts looking for work to steal
+	mWorkers.reserve(num_workers);
+	for (S32 idx = 0; idx < num_workers; idx++)
+	{
+		mWorkers.push_back(new Worker());
+	}
+	for (S32 idx = 0; idx < num_workers; idx++)
+	{
+		mWorkers[idx]->mThreadp = new LLJobWorkerThread(this, idx);
+		mWorkers[idx]->mThreadp->start();
+	}
+}
+
+LLJobSystem::~LLJobSystem()
+{
+	mQuitting = true;
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mSleepCondition.notify_all();
+	}
+
+	// ~LLThread() waits for the thread to stop
+	for (Worker* workerp : mWorkers)
+	{
+		delete workerp->mThreadp;
+		workerp->mThreadp = nullptr;
+	}
+
+	S32 dropped = (S32)mDelayedJobs.size();
+	for (Worker* workerp : mWorkers)
+	{
+		for (const std::deque<job_t>& queue : workerp->mQueues)
+		{
+			dropped += (S32)queue.size();
+		}
+		delete workerp;
+	}
+	mWorkers.clear();
+
+	if (dropped)
+	{
+		LL_WARNS("JobSystem") << "Shut down with " << dropped << " jobs that never ran" << LL_ENDL;
+	}
+}
+
+void LLJobSystem::post(job_t job, EPriority priority, S32 affinity)
+{
+	push(std::move(job), priority, affinity);
+}
+
+void LLJobSystem::postDelayed(job_t job, F32 delay_ms, EPriority priority, S32 affinity)
+{
+	if (delay_ms <= 0.f)
+	{
+		push(std::move(job), priority, affinity);
+		return;
+	}
+
+	const U64 due_usec = get_clock_usec() + (U64)(delay_ms * 1000.f);
+
+	std::lock_guard<std::mutex> lock(mSleepMutex);
+	const bool first_due = (mDelayedJobs.empty()) || (due_usec < mDelayedJobs.begin()->first);
+	mDelayedJobs.insert(std::make_pair(due_usec, DelayedJob{ std::move(job), priority, affinity }));
+	mNextDue = mDelayedJobs.begin()->first;
+	if ( (first_due) && (mSleeping > 0) )
+	{
+		// Whoever waits on the timer is waiting for a later job so have the sleepers sort it out again
+		mSleepCondition.notify_all();
+	}
+}
+
+void LLJobSystem::push(job_t&& job, EPriority priority, S32 affinity, bool wake)
+{
+	const S32 num_workers = (S32)mWorkers.size();
+
+	S32 worker_idx = affinity;
+	if (ANY_WORKER == worker_idx)
+	{
+		// Jobs posted from a job stay with the worker that posted them (its caches are still warm) until someone steals them
+		worker_idx = (ANY_WORKER != sCurrentWorker) ? sCurrentWorker : (S32)(mNextWorker++ % num_workers);
+	}
+	Worker* workerp = mWorkers[worker_idx % num_workers];
+
+	{
+		std::lock_guard<std::mutex> lock(workerp->mMutex);
+		workerp->mQueues[llclamp<S32>(priority, PRIORITY_HIGH, PRIORITY_LOW)].push_back(std::move(job));
+		workerp->mCount++;
+		mPending++;
+	}
+
+	// Pairs with the mSleeping increment in runWorker(): either the sleeper sees the pending job or we see the sleeper
+	if ( (wake) && (mSleeping > 0) )
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mSleepCondition.notify_one();
+	}
+}
+
+bool LLJobSystem::popJob(S32 worker_idx, job_t& job)
+{
+	const S32 num_workers = (S32)mWorkers.size();
+	for (S32 priority = PRIORITY_HIGH; priority < PRIORITY_COUNT; priority++)
+	{
+		// Our own queue first, then the oldest job of the same priority of any other worker
+		for (S32 offset = 0; offset < num_workers; offset++)
+		{
+			Worker* workerp = mWorkers[(worker_idx + offset) % num_workers];
+			if (0 == workerp->mCount)
+			{
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(workerp->mMutex);
+			std::deque<job_t>& queue = workerp->mQueues[priority];
+			if (!queue.empty())
+			{
+				job = std::move(queue.front());
+				queue.pop_front();
+				workerp->mCount--;
+				mPending--;
+				if (offset)
+				{
+					mStealCount++;
+				}
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void LLJobSystem::moveDueJobs(U64 now_usec, U64& next_due_usec)
+{
+	// mSleepMutex must be locked here
+	while ( (!mDelayedJobs.empty()) && (mDelayedJobs.begin()->first <= now_usec) )
+	{
+		DelayedJob& delayed_job = mDelayedJobs.begin()->second;
+		push(std::move(delayed_job.mJob), delayed_job.mPriority, delayed_job.mAffinity, false);
+		mDelayedJobs.erase(mDelayedJobs.begin());
+		if (mSleeping > 0)
+		{
+			mSleepCondition.notify_one();
+		}
+	}
+	next_due_usec = (!mDelayedJobs.empty()) ? mDelayedJobs.begin()->first : 0;
+	mNextDue = next_due_usec;
+}
+
+void LLJobSystem::runWorker(S32 worker_idx)
+{
+	job_t job;
+	while (!mQuitting)
+	{
+		// Busy workers still need to pick up delayed jobs when nobody is sleeping on the timer
+		const U64 next_due = mNextDue.load(std::memory_order_relaxed);
+		if ( (next_due) && (get_clock_usec() >= next_due) )
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+			U64 next_due_usec = 0;
+			moveDueJobs(get_clock_usec(), next_due_usec);
+		}
+
+		if (popJob(worker_idx, job))
+		{
+			job();
+			job = nullptr;
+
+			LLTrace::get_thread_recorder()->pushToParent();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		const U64 now_usec = get_clock_usec();
+		U64 next_due_usec = 0;
+		moveDueJobs(now_usec, next_due_usec);
+
+		mSleeping++;
+		if ( (0 == mPending) && (!mQuitting) )
+		{
+			// Only one worker needs to wake up for the next delayed job
+			if ( (next_due_usec) && (!mHasTimerWaiter) )
+			{
+				mHasTimerWaiter = true;
+				mSleepCondition.wait_for(lock, std::chrono::microseconds(next_due_usec - now_usec));
+				mHasTimerWaiter = false;
+			}
+			else
+			{
+				mSleepCondition.wait(lock);
+			}
+		}
+		mSleeping--;
+	}
+}
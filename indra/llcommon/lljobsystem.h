@@ -0,0 +1,139 @@
+/**
+ * @file lljobsystem.h
+ * @brief Shared pool of worker threads with per-worker queues and work stealing
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLJOBSYSTEM_H
+#define LL_LLJOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class LLJobWorkerThread;
+
+//============================================================================
+// LLJobSystem - a fixed number of worker threads shared by everything that
+// has background work to do.
+//
+// Every worker has its own queue per priority. Jobs go to the queue of the
+// worker named by their affinity hint, the posting worker (when posted from
+// a job) or round robin otherwise. A worker runs its own jobs first (highest
+// priority first) and steals the oldest job of the highest priority from
+// another worker when its own queues are empty, so no worker sits idle while
+// another one has a backlog. Idle workers sleep on a single condition and are
+// only signalled when there actually is a sleeping worker.
+//
+// LLQueuedThread (and therefore LLWorkerThread / LLWorkerClass) can run their
+// request queue on the job system instead of on their own thread, see the
+// use_job_system constructor parameter.
+
+class LL_COMMON_API LLJobSystem
+{
+public:
+	enum EPriority
+	{
+		PRIORITY_HIGH = 0,
+		PRIORITY_NORMAL,
+		PRIORITY_LOW,
+		PRIORITY_COUNT
+	};
+	enum { ANY_WORKER = -1 };
+
+	typedef std::function<void()> job_t;
+
+	// 0 workers picks one less than the number of hardware threads (the main thread has one to itself)
+	static void initClass(S32 num_workers = 0);
+	static void cleanupClass();
+	// NULL before initClass() and after cleanupClass()
+	static LLJobSystem* getInstance() { return sInstance; }
+
+	// Maps LLQueuedThread::priority_t values onto the job priorities
+	static EPriority fromQueuedPriority(U32 priority);
+	// Index of the calling worker thread or ANY_WORKER if not called from one
+	static S32 getCurrentWorker();
+
+protected:
+	LLJobSystem(S32 num_workers);
+	~LLJobSystem();
+
+public:
+	// May be called from any thread
+	void post(job_t job, EPriority priority = PRIORITY_NORMAL, S32 affinity = ANY_WORKER);
+	// Runs the job no sooner than delay_ms from now
+	void postDelayed(job_t job, F32 delay_ms, EPriority priority = PRIORITY_NORMAL, S32 affinity = ANY_WORKER);
+
+	S32 getWorkerCount() const { return (S32)mWorkers.size(); }
+	// Jobs waiting to run (delayed jobs aren't counted until they're due)
+	S32 getPending() const { return mPending; }
+	U64 getStealCount() const { return mStealCount; }
+
+protected:
+	friend class LLJobWorkerThread;
+
+	struct Worker
+	{
+		std::mutex			mMutex;
+		std::deque<job_t>	mQueues[PRIORITY_COUNT];
+		// Lets other workers skip empty queues without taking the lock
+		std::atomic<S32>	mCount { 0 };
+		LLJobWorkerThread*	mThreadp = nullptr;
+	};
+
+	// Wakes a sleeping worker unless the caller already holds mSleepMutex (and will do so itself)
+	void push(job_t&& job, EPriority priority, S32 affinity, bool wake = true);
+	bool popJob(S32 worker_idx, job_t& job);
+	void moveDueJobs(U64 now_usec, U64& next_due_usec);
+	void runWorker(S32 worker_idx);
+
+protected:
+	std::vector<Worker*>	mWorkers;
+	std::atomic<S32>		mPending;
+	std::atomic<S32>		mSleeping;
+	std::atomic<U32>		mNextWorker;
+	std::atomic<U64>		mStealCount;
+	std::atomic<bool>		mQuitting;
+
+	// Idle workers wait on this; mSleepMutex also guards the delayed jobs
+	std::mutex				mSleepMutex;
+	std::condition_variable	mSleepCondition;
+	struct DelayedJob
+	{
+		job_t		mJob;
+		EPriority	mPriority;
+		S32			mAffinity;
+	};
+	std::multimap<U64, DelayedJob> mDelayedJobs;
+	// Due time of the first delayed job (0 if there are none) so busy workers can check without locking
+	std::atomic<U64>		mNextDue;
+	bool					mHasTimerWaiter;
+
+	static LLJobSystem*		sInstance;
+};
+
+#endif // LL_LLJOBSYSTEM_H
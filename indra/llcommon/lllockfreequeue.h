@@ -0,0 +1,401 @@
+/**
+ * @file lllockfreequeue.h
+ * @brief Bounded lock-free multi-producer multi-consumer variant of LLThreadSafeQueue
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLLOCKFREEQUEUE_H
+#define LL_LLLOCKFREEQUEUE_H
+
+#include "llthreadsafequeue.h"
+
+#include <atomic>
+#include <memory>
+
+//
+// Drop-in replacement for LLThreadSafeQueue for hand-offs that see enough
+// traffic for the queue lock to become a convoy.
+//
+// Elements live in a fixed ring of cells, each with a sequence number that
+// tells producers and consumers whose turn it is (D. Vyukov's bounded MPMC
+// queue). Pushing and popping an element is a CAS on the shared position
+// plus a store to the cell; there is no lock on that path. The lock and the
+// conditions are only used to put callers of the blocking methods to sleep
+// while the queue is full (pushFront) or empty (popBack), and the other side
+// only touches them when it sees that somebody is actually waiting.
+//
+// Differences with LLThreadSafeQueue:
+// - capacity is rounded up to a power of two
+// - the non-blocking methods never fail because another thread holds the
+//   lock, they only fail on a full (or closed) or empty queue
+// - size() is a snapshot that can be stale by the time the caller uses it
+//
+template<typename ElementT>
+class LLLockFreeQueue
+{
+public:
+	typedef ElementT value_type;
+
+	LLLockFreeQueue(U32 capacity = 1024);
+
+	// Add an element to the front of queue (will block if the queue has
+	// reached capacity).
+	//
+	// This call will raise an interrupt error if the queue is closed while
+	// the caller is blocked.
+	void pushFront(ElementT const & element);
+
+	// Try to add an element to the front of queue without blocking. Returns
+	// true only if the element was actually added.
+	bool tryPushFront(ElementT const & element);
+
+	// Try to add an element to the front of queue, blocking if full but with
+	// timeout. Returns true if the element was added.
+	template <typename Rep, typename Period>
+	bool tryPushFrontFor(const std::chrono::duration<Rep, Period>& timeout,
+						 ElementT const & element);
+
+	// Pop the element at the end of the queue (will block if the queue is
+	// empty).
+	//
+	// This call will raise an interrupt error if the queue is closed while
+	// the caller is blocked.
+	ElementT popBack(void);
+
+	// Pop an element from the end of the queue if there is one available.
+	// Returns true only if an element was popped.
+	bool tryPopBack(ElementT & element);
+
+	// Returns the size of the queue.
+	size_t size();
+
+	// Same semantics as LLThreadSafeQueue::close()
+	void close();
+
+	// detect closed state
+	bool isClosed();
+	// inverse of isClosed()
+	explicit operator bool();
+
+private:
+	bool tryPush(ElementT const & element);
+	bool tryPop(ElementT & element);
+	// True if the next push (or pop) would find its cell ready
+	bool canPush() const;
+	bool canPop() const;
+	void notifyWaiters(std::atomic<S32>& waiters, boost::fibers::condition_variable_any& cond);
+
+	struct Cell
+	{
+		std::atomic<size_t>	mSequence;
+		ElementT			mData;
+	};
+
+	std::unique_ptr<Cell[]>	mCells;
+	size_t					mMask;
+	// Producers and consumers each get their own cache line (padding rather than alignas since queues end up on the heap)
+	char					mPad0[64];
+	std::atomic<size_t>		mPushPos;
+	char					mPad1[64 - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t>		mPopPos;
+	char					mPad2[64 - sizeof(std::atomic<size_t>)];
+	std::atomic<bool>		mClosed;
+
+	// Only used while the queue is full or empty
+	std::atomic<S32> mPushWaiters;
+	std::atomic<S32> mPopWaiters;
+	boost::fibers::mutex mWaitLock;
+	typedef std::unique_lock<decltype(mWaitLock)> lock_t;
+	boost::fibers::condition_variable_any mCapacityCond;
+	boost::fibers::condition_variable_any mEmptyCond;
+};
+
+// LLLockFreeQueue
+//-----------------------------------------------------------------------------
+
+template<typename ElementT>
+LLLockFreeQueue<ElementT>::LLLockFreeQueue(U32 capacity) :
+	mMask(0),
+	mPushPos(0),
+	mPopPos(0),
+	mClosed(false),
+	mPushWaiters(0),
+	mPopWaiters(0)
+{
+	size_t num_cells = 2;
+	while (num_cells < capacity)
+	{
+		num_cells <<= 1;
+	}
+	mMask = num_cells - 1;
+
+	mCells.reset(new Cell[num_cells]);
+	for (size_t idx = 0; idx < num_cells; idx++)
+	{
+		mCells[idx].mSequence.store(idx, std::memory_order_relaxed);
+	}
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::tryPush(ElementT const & element)
+{
+	size_t pos = mPushPos.load(std::memory_order_relaxed);
+	Cell* cellp;
+	while (true)
+	{
+		cellp = &mCells[pos & mMask];
+		const size_t seq = cellp->mSequence.load(std::memory_order_acquire);
+		const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+		if (0 == diff)
+		{
+			// The cell is free for this position, claim it
+			if (mPushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// The consumer of the previous lap hasn't freed the cell yet: full
+			return false;
+		}
+		else
+		{
+			pos = mPushPos.load(std::memory_order_relaxed);
+		}
+	}
+
+	cellp->mData = element;
+	cellp->mSequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::tryPop(ElementT & element)
+{
+	size_t pos = mPopPos.load(std::memory_order_relaxed);
+	Cell* cellp;
+	while (true)
+	{
+		cellp = &mCells[pos & mMask];
+		const size_t seq = cellp->mSequence.load(std::memory_order_acquire);
+		const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+		if (0 == diff)
+		{
+			if (mPopPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// Nothing has been pushed for this position yet: empty
+			return false;
+		}
+		else
+		{
+			pos = mPopPos.load(std::memory_order_relaxed);
+		}
+	}
+
+	element = cellp->mData;
+	// Don't keep whatever the element holds on to alive until the cell is reused
+	cellp->mData = ElementT();
+	cellp->mSequence.store(pos + mMask + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::canPush() const
+{
+	const size_t pos = mPushPos.load(std::memory_order_seq_cst);
+	return mCells[pos & mMask].mSequence.load(std::memory_order_seq_cst) == pos;
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::canPop() const
+{
+	const size_t pos = mPopPos.load(std::memory_order_seq_cst);
+	return mCells[pos & mMask].mSequence.load(std::memory_order_seq_cst) == pos + 1;
+}
+
+template<typename ElementT>
+void LLLockFreeQueue<ElementT>::notifyWaiters(std::atomic<S32>& waiters, boost::fibers::condition_variable_any& cond)
+{
+	// Pairs with the fence in the waiting methods: either the waiter sees our change or we see the waiter
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (waiters.load(std::memory_order_relaxed) > 0)
+	{
+		// Taking the lock makes sure the waiter is either not waiting yet (and will see our change) or is waiting
+		lock_t lock(mWaitLock);
+		lock.unlock();
+		cond.notify_one();
+	}
+}
+
+template<typename ElementT>
+void LLLockFreeQueue<ElementT>::pushFront(ElementT const & element)
+{
+	while (true)
+	{
+		if (mClosed)
+		{
+			LLTHROW(LLThreadSafeQueueInterrupt());
+		}
+
+		if (tryPush(element))
+		{
+			notifyWaiters(mPopWaiters, mEmptyCond);
+			return;
+		}
+
+		// Storage full. Wait for signal.
+		lock_t lock(mWaitLock);
+		mPushWaiters++;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if ( (!mClosed) && (!canPush()) )
+		{
+			mCapacityCond.wait(lock);
+		}
+		mPushWaiters--;
+	}
+}
+
+template <typename ElementT>
+template <typename Rep, typename Period>
+bool LLLockFreeQueue<ElementT>::tryPushFrontFor(const std::chrono::duration<Rep, Period>& timeout,
+												ElementT const & element)
+{
+	auto endpoint = std::chrono::steady_clock::now() + timeout;
+	while (true)
+	{
+		if (mClosed)
+		{
+			return false;
+		}
+
+		if (tryPush(element))
+		{
+			notifyWaiters(mPopWaiters, mEmptyCond);
+			return true;
+		}
+
+		// Storage full. Wait for signal.
+		lock_t lock(mWaitLock);
+		mPushWaiters++;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		bool timed_out = false;
+		if ( (!mClosed) && (!canPush()) )
+		{
+			timed_out = (LLCoros::cv_status::timeout == mCapacityCond.wait_until(lock, endpoint));
+		}
+		mPushWaiters--;
+		if (timed_out)
+		{
+			return false;
+		}
+	}
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::tryPushFront(ElementT const & element)
+{
+	if ( (mClosed) || (!tryPush(element)) )
+		return false;
+
+	notifyWaiters(mPopWaiters, mEmptyCond);
+	return true;
+}
+
+template<typename ElementT>
+ElementT LLLockFreeQueue<ElementT>::popBack(void)
+{
+	ElementT value;
+	while (true)
+	{
+		if (tryPop(value))
+		{
+			notifyWaiters(mPushWaiters, mCapacityCond);
+			return value;
+		}
+
+		if (mClosed)
+		{
+			LLTHROW(LLThreadSafeQueueInterrupt());
+		}
+
+		// Storage empty. Wait for signal.
+		lock_t lock(mWaitLock);
+		mPopWaiters++;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if ( (!mClosed) && (!canPop()) )
+		{
+			mEmptyCond.wait(lock);
+		}
+		mPopWaiters--;
+	}
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::tryPopBack(ElementT & element)
+{
+	// no need to check mClosed: as with LLThreadSafeQueue a closed queue
+	// simply stops getting new elements
+	if (!tryPop(element))
+		return false;
+
+	notifyWaiters(mPushWaiters, mCapacityCond);
+	return true;
+}
+
+template<typename ElementT>
+size_t LLLockFreeQueue<ElementT>::size(void)
+{
+	// Read the consumer side first so the difference can't go negative
+	const size_t pop_pos = mPopPos.load(std::memory_order_acquire);
+	const size_t push_pos = mPushPos.load(std::memory_order_acquire);
+	return (push_pos > pop_pos) ? push_pos - pop_pos : 0;
+}
+
+template<typename ElementT>
+void LLLockFreeQueue<ElementT>::close()
+{
+	{
+		lock_t lock(mWaitLock);
+		mClosed = true;
+	}
+	// wake up any blocked popBack() calls
+	mEmptyCond.notify_all();
+	// wake up any blocked pushFront() calls
+	mCapacityCond.notify_all();
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::isClosed()
+{
+	return mClosed && (0 == size());
+}
+
+template<typename ElementT>
+LLLockFreeQueue<ElementT>::operator bool()
+{
+	return ! isClosed();
+}
+
+#endif // LL_LLLOCKFREEQUEUE_H
@@ -53,6 +53,42 @@ int LLMemoryStreamBuf::underflow()
 	return EOF;
 }
 
+LLMemoryStreamBuf::pos_type LLMemoryStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	if (!(which & std::ios_base::in))
+	{
+		return pos_type(off_type(-1));
+	}
+
+	char* pos = nullptr;
+	switch (dir)
+	{
+		case std::ios_base::beg:
+			pos = eback() + off;
+			break;
+		case std::ios_base::cur:
+			pos = gptr() + off;
+			break;
+		case std::ios_base::end:
+			pos = egptr() + off;
+			break;
+		default:
+			return pos_type(off_type(-1));
+	}
+	if ( (pos < eback()) || (pos > egptr()) )
+	{
+		return pos_type(off_type(-1));
+	}
+
+	setg(eback(), pos, egptr());
+	return pos_type(off_type(pos - eback()));
+}
+
+LLMemoryStreamBuf::pos_type LLMemoryStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
 /** 
  * @class LLMemoryStreamBuf
  */
@@ -57,6 +57,9 @@ class LL_COMMON_API LLMemoryStreamBuf : public std::streambuf
 protected:
 	int underflow();
 	//std::streamsize xsgetn(char* dest, std::streamsize n);
+	// Seeking (and tellg) within the memory block
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in);
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in);
 };
 
 
@@ -26,6 +26,9 @@
 #include "linden_common.h"
 #include "llqueuedthread.h"
 
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+#include "lljobsystem.h"
+// [/SL:KB]
 #include "llstl.h"
 #include "lltimer.h"	// ms_sleep()
 #include "lltracethreadrecorder.h"
@@ -33,17 +36,39 @@
 //============================================================================
 
 // MAIN THREAD
-LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool should_pause) :
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool should_pause, bool use_job_system) :
+// [/SL:KB]
+//LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool should_pause) :
 	LLThread(name),
 	mThreaded(threaded),
 	mIdleThread(TRUE),
 	mNextHandle(0),
 	mStarted(FALSE),
 // [SL:KB] - Patch: Viewer-OptimizationThreadLock | Checked: Catznip-6.0
-	mRequestQueueSize(0)
+	mRequestQueueSize(0),
+// [/SL:KB]
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	mJobMode(false),
+	mJobQueued(false),
+	mJobAffinity(LLJobSystem::ANY_WORKER),
+	mJobBackoff(false)
 // [/SL:KB]
 {
-	if (mThreaded)
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	if ( (mThreaded) && (use_job_system) && (LLJobSystem::getInstance()) )
+	{
+		// No thread of our own, requests are processed by jobs posted whenever there's something in the queue
+		mJobMode = true;
+		mStatus = RUNNING;
+		if (should_pause)
+		{
+			pause();
+		}
+	}
+	else if (mThreaded)
+// [/SL:KB]
+//	if (mThreaded)
 	{
 		if(should_pause)
 		{
@@ -70,7 +95,41 @@ void LLQueuedThread::shutdown()
 	setQuitting();
 
 	unpause(); // MAIN THREAD
-	if (mThreaded)
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	if (mJobMode)
+	{
+		// A job still has to run to call endThread() in the same context the requests ran in
+		if ( (LLJobSystem::getInstance()) && (!isStopped()) )
+		{
+			postJob();
+
+			S32 timeout = 100;
+			for ( ; timeout>0; timeout--)
+			{
+				if (isStopped())
+				{
+					break;
+				}
+				ms_sleep(100);
+				LLThread::yield();
+			}
+			if (timeout == 0)
+			{
+				LL_WARNS() << "~LLQueuedThread (" << mName << ") timed out!" << LL_ENDL;
+			}
+			// The last job sets STOPPED with the data lock held, wait for it to let go before tearing anything down
+			lockData();
+			unlockData();
+		}
+		else if (!isStopped())
+		{
+			endThread();
+			mStatus = STOPPED;
+		}
+	}
+	else if (mThreaded)
+// [/SL:KB]
+//	if (mThreaded)
 	{
 		S32 timeout = 100;
 		for ( ; timeout>0; timeout--)
@@ -139,6 +198,12 @@ S32 LLQueuedThread::updateQueue(F32 max_time_ms)
 		if(pending > 0)
 		{
 		unpause();
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+		if (mJobMode)
+		{
+			postJob();
+		}
+// [/SL:KB]
 	}
 	}
 	else
@@ -158,7 +223,14 @@ void LLQueuedThread::incQueue()
 	// Something has been added to the queue
 	if (!isPaused())
 	{
-		if (mThreaded)
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+		if (mJobMode)
+		{
+			postJob();
+		}
+		else if (mThreaded)
+// [/SL:KB]
+//		if (mThreaded)
 		{
 			wake(); // Wake the thread up if necessary.
 		}
@@ -476,7 +548,14 @@ S32 LLQueuedThread::processNextRequest()
 			mRequestQueueSize = mRequestQueue.size();
 // [/SL:KB]
 			unlockData();
-			if (mThreaded && start_priority < PRIORITY_NORMAL)
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+			if (mJobMode && start_priority < PRIORITY_NORMAL)
+			{
+				mJobBackoff = true; // don't hold on to the job worker, runJob() will come back a little later
+			}
+			else if (mThreaded && start_priority < PRIORITY_NORMAL)
+// [/SL:KB]
+//			if (mThreaded && start_priority < PRIORITY_NORMAL)
 			{
 				ms_sleep(1); // sleep the thread a little
 			}
@@ -538,6 +617,90 @@ void LLQueuedThread::run()
 	LL_INFOS() << "LLQueuedThread " << mName << " EXITING." << LL_ENDL;
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+// May be called from any thread
+void LLQueuedThread::postJob()
+{
+	if (!mJobQueued.exchange(true))
+	{
+		lockData();
+		const U32 priority = (!mRequestQueue.empty()) ? (*mRequestQueue.begin())->getPriority() : (U32)PRIORITY_NORMAL;
+		unlockData();
+
+		queueJob(priority, 0.f);
+	}
+}
+
+// mJobQueued must be set by the caller
+void LLQueuedThread::queueJob(U32 priority, F32 delay_ms)
+{
+	if (LLJobSystem* job_systemp = LLJobSystem::getInstance())
+	{
+		job_systemp->postDelayed(std::bind(&LLQueuedThread::runJob, this), delay_ms, LLJobSystem::fromQueuedPriority(priority), mJobAffinity);
+	}
+	else
+	{
+		LL_WARNS() << "LLQueuedThread " << mName << " has pending requests but the job system is gone" << LL_ENDL;
+		mJobQueued = false;
+	}
+}
+
+// Runs on a JOB WORKER thread (the job mode equivalent of run())
+void LLQueuedThread::runJob()
+{
+	// Don't let a single queue keep the worker to itself for too long
+	const F32 JOB_TIME_SLICE = 0.005f;
+
+	if (!mStarted)
+	{
+		startThread();
+		mStarted = TRUE;
+	}
+
+	if (isQuitting())
+	{
+		LLTrace::get_thread_recorder()->pushToParent();
+		endThread();
+
+		lockData();
+		mJobQueued = false;
+		mStatus = STOPPED; // shutdown() may destroy us as soon as the data lock is released
+		unlockData();
+		return;
+	}
+
+	mIdleThread = FALSE;
+	mJobBackoff = false;
+
+	threadedUpdate();
+
+	LLTimer timer;
+	S32 pending_work = 0;
+	do
+	{
+		pending_work = processNextRequest();
+	} while ( (pending_work > 0) && (!mJobBackoff) && (!isQuitting()) && (timer.getElapsedTimeF32() < JOB_TIME_SLICE) );
+
+	if (pending_work == 0)
+	{
+		mIdleThread = TRUE;
+	}
+
+	// Requests added after this point see mJobQueued cleared and post a job of their own
+	lockData();
+	if ( (isQuitting()) || (!mRequestQueue.empty()) )
+	{
+		const U32 priority = (!mRequestQueue.empty()) ? (*mRequestQueue.begin())->getPriority() : (U32)PRIORITY_NORMAL;
+		unlockData();
+
+		queueJob(priority, (mJobBackoff) ? 1.f : 0.f);
+		return;
+	}
+	mJobQueued = false;
+	unlockData();
+}
+// [/SL:KB]
+
 // virtual
 void LLQueuedThread::startThread()
 {
@@ -152,7 +152,11 @@ class LL_COMMON_API LLQueuedThread : public LLThread
 	static handle_t nullHandle() { return handle_t(0); }
 	
 public:
-	LLQueuedThread(const std::string& name, bool threaded = true, bool should_pause = false);
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	// use_job_system runs the request queue as jobs on LLJobSystem instead of on a thread of our own (if it's initialized)
+	LLQueuedThread(const std::string& name, bool threaded = true, bool should_pause = false, bool use_job_system = false);
+// [/SL:KB]
+//	LLQueuedThread(const std::string& name, bool threaded = true, bool should_pause = false);
 	virtual ~LLQueuedThread();	
 	virtual void shutdown();
 	
@@ -166,6 +170,11 @@ class LL_COMMON_API LLQueuedThread : public LLThread
 	virtual void startThread(void);
 	virtual void endThread(void);
 	virtual void threadedUpdate(void);
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	void postJob();
+	void queueJob(U32 priority, F32 delay_ms);
+	void runJob();
+// [/SL:KB]
 
 protected:
 	handle_t generateHandle();
@@ -187,6 +196,11 @@ class LL_COMMON_API LLQueuedThread : public LLThread
 // [/SL:KB]
 //	virtual S32 getPending();
 	bool getThreaded() { return mThreaded ? true : false; }
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	bool getJobMode() const { return mJobMode; }
+	// Keeps the queue's jobs on one job worker (LLJobSystem::ANY_WORKER lets any worker run them)
+	void setJobAffinity(S32 affinity) { mJobAffinity = affinity; }
+// [/SL:KB]
 
 	// Request accessors
 	status_t getRequestStatus(handle_t handle);
@@ -218,6 +232,14 @@ class LL_COMMON_API LLQueuedThread : public LLThread
 
 	handle_t mNextHandle;
 
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	bool mJobMode;
+	// Only one job drains the queue at a time so requests still run in order and never concurrently
+	std::atomic<bool> mJobQueued;
+	S32 mJobAffinity;
+	// Set by processNextRequest() when a low priority request wants to be retried a little later
+	bool mJobBackoff;
+// [/SL:KB]
 };
 
 #endif // LL_LLQUEUEDTHREAD_H
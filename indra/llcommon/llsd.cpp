@@ -35,6 +35,9 @@
 #include "llformat.h"
 #include "llsdserialize.h"
 #include "stringize.h"
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+#include <mutex>
+// [/SL:KB]
 
 #ifndef LL_RELEASE_FOR_DOWNLOAD
 #define NAME_UNNAMED_NAMESPACE
@@ -66,6 +69,136 @@ S32 sLLSDNetObjects = 0;
 #define	ALLOC_LLSD_OBJECT			{ llsd::sLLSDNetObjects++;	llsd::sLLSDAllocationCount++;	}
 #define	FREE_LLSD_OBJECT			{ llsd::sLLSDNetObjects--;									}
 
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+namespace
+{
+	// Pooled blocks are multiples of the granularity up to the maximum block size (covers the scalar and container
+	// Impl objects and map nodes with a short key; larger ones go to the heap)
+	const size_t POOL_GRANULARITY = 16;
+	const size_t POOL_MAX_BLOCK_SIZE = 128;
+	const size_t POOL_SIZE_CLASSES = POOL_MAX_BLOCK_SIZE / POOL_GRANULARITY;
+	const size_t POOL_CHUNK_SIZE = 16 * 1024;
+	// Number of blocks moved between a thread's free list and the shared depot at a time
+	const U32 POOL_BATCH_SIZE = 256;
+
+	struct LLSDPoolBlock
+	{
+		LLSDPoolBlock* mNext;
+	};
+
+	struct LLSDPoolFreeList
+	{
+		LLSDPoolBlock* mHead;
+		U32            mCount;
+	};
+
+	// Batches of free blocks released by threads that free more than they allocate (i.e. a thread consuming LLSD
+	// built on another one) so they find their way back to the producing thread instead of piling up
+	struct LLSDPoolDepot
+	{
+		std::mutex                  mMutex;
+		std::vector<LLSDPoolBlock*> mBatches[POOL_SIZE_CLASSES];
+	};
+
+	LL_THREAD_LOCAL LLSDPoolFreeList sPoolFreeLists[POOL_SIZE_CLASSES];
+
+	LLSDPoolDepot& getPoolDepot()
+	{
+		// Never destroyed so LLSD statics can still release their blocks during shutdown
+		static LLSDPoolDepot* sDepot = new LLSDPoolDepot();
+		return *sDepot;
+	}
+}
+
+namespace llsd
+{
+
+void* pool_allocate(size_t size)
+{
+	if ( (0 == size) || (size > POOL_MAX_BLOCK_SIZE) )
+	{
+		return ::operator new(size);
+	}
+
+	const size_t size_class = (size - 1) / POOL_GRANULARITY;
+	LLSDPoolFreeList& free_list = sPoolFreeLists[size_class];
+	if (!free_list.mHead)
+	{
+		LLSDPoolDepot& depot = getPoolDepot();
+		{
+			std::lock_guard<std::mutex> lock(depot.mMutex);
+			if (!depot.mBatches[size_class].empty())
+			{
+				free_list.mHead = depot.mBatches[size_class].back();
+				free_list.mCount = POOL_BATCH_SIZE;
+				depot.mBatches[size_class].pop_back();
+			}
+		}
+
+		if (!free_list.mHead)
+		{
+			// Carve a new chunk up into blocks of this size class (chunks are never returned to the heap)
+			const size_t block_size = (size_class + 1) * POOL_GRANULARITY;
+			const size_t block_count = POOL_CHUNK_SIZE / block_size;
+			char* chunk = static_cast<char*>(::operator new(POOL_CHUNK_SIZE));
+			for (size_t idx = block_count; idx > 0; --idx)
+			{
+				LLSDPoolBlock* block = reinterpret_cast<LLSDPoolBlock*>(chunk + (idx - 1) * block_size);
+				block->mNext = free_list.mHead;
+				free_list.mHead = block;
+			}
+			free_list.mCount = block_count;
+		}
+	}
+
+	LLSDPoolBlock* block = free_list.mHead;
+	free_list.mHead = block->mNext;
+	free_list.mCount--;
+	return block;
+}
+
+void pool_free(void* ptr, size_t size)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	if ( (0 == size) || (size > POOL_MAX_BLOCK_SIZE) )
+	{
+		::operator delete(ptr);
+		return;
+	}
+
+	const size_t size_class = (size - 1) / POOL_GRANULARITY;
+	LLSDPoolFreeList& free_list = sPoolFreeLists[size_class];
+
+	LLSDPoolBlock* block = static_cast<LLSDPoolBlock*>(ptr);
+	block->mNext = free_list.mHead;
+	free_list.mHead = block;
+	if (++free_list.mCount >= 2 * POOL_BATCH_SIZE)
+	{
+		// Hand the most recently freed batch over to the depot and keep the remainder
+		LLSDPoolBlock* batch_tail = free_list.mHead;
+		for (U32 idx = 1; idx < POOL_BATCH_SIZE; idx++)
+		{
+			batch_tail = batch_tail->mNext;
+		}
+
+		LLSDPoolBlock* batch = free_list.mHead;
+		free_list.mHead = batch_tail->mNext;
+		free_list.mCount -= POOL_BATCH_SIZE;
+		batch_tail->mNext = nullptr;
+
+		LLSDPoolDepot& depot = getPoolDepot();
+		std::lock_guard<std::mutex> lock(depot.mMutex);
+		depot.mBatches[size_class].push_back(batch);
+	}
+}
+
+} // namespace llsd
+// [/SL:KB]
+
 class LLSD::Impl
 	/**< This class is the abstract base class of the implementation of LLSD
 		 It provides the reference counting implementation, and the default
@@ -86,10 +219,26 @@ class LLSD::Impl
 	virtual ~Impl();
 	
 	bool shared() const							{ return (mUseCount > 1) && (mUseCount != STATIC_USAGE_COUNT); }
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	bool immutable() const						{ return shared() || (mUseCount == STATIC_USAGE_COUNT); }
+		///< true if an assignment can't modify the receiver in place
+
+	static Impl* sharedBoolean(LLSD::Boolean);
+	static Impl* sharedInteger(LLSD::Integer);
+	static Impl* sharedString(const LLSD::String&);
+	static Impl* sharedUUID(const LLSD::UUID&);
+		///< returns the static immutable Impl for common values (NULL if the
+		//   value isn't one of them)
+// [/SL:KB]
 	
 	U32 mUseCount;
 
 public:
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	static void* operator new(size_t size)				{ return llsd::pool_allocate(size); }
+	static void  operator delete(void* ptr, size_t size)	{ llsd::pool_free(ptr, size); }
+// [/SL:KB]
+
 	static void reset(Impl*& var, Impl* impl);
 		///< safely set var to refer to the new impl (possibly shared)
 		
@@ -142,7 +291,10 @@ class LLSD::Impl
 	virtual const LLSD& ref(Integer) const		{ return undef(); }
 
 	virtual LLSD::map_const_iterator beginMap() const { return endMap(); }
-	virtual LLSD::map_const_iterator endMap() const { static const std::map<String, LLSD> empty; return empty.end(); }
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	virtual LLSD::map_const_iterator endMap() const { static const LLSD::map_type empty; return empty.end(); }
+// [/SL:KB]
+//	virtual LLSD::map_const_iterator endMap() const { static const std::map<String, LLSD> empty; return empty.end(); }
 	virtual LLSD::array_const_iterator beginArray() const { return endArray(); }
 	virtual LLSD::array_const_iterator endArray() const { static const std::vector<LLSD> empty; return empty.end(); }
 
@@ -183,12 +335,18 @@ namespace
 
 	public:
 		ImplBase(DataRef value) : mValue(value) { }
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+		ImplBase(DataRef value, StaticAllocationMarker marker) : Impl(marker), mValue(value) { }
+// [/SL:KB]
 		
 		virtual LLSD::Type type() const { return T; }
 
 		using LLSD::Impl::assign; // Unhiding base class virtuals...
 		virtual void assign(LLSD::Impl*& var, DataRef value) {
-			if (shared())
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+			if (immutable())
+// [/SL:KB]
+//			if (shared())
 			{
 				Impl::assign(var, value);
 			}
@@ -205,6 +363,9 @@ namespace
 	{
 	public:
 		ImplBoolean(LLSD::Boolean v) : Base(v) { }
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+		ImplBoolean(LLSD::Boolean v, StaticAllocationMarker marker) : Base(v, marker) { }
+// [/SL:KB]
 		
 		virtual LLSD::Boolean	asBoolean() const	{ return mValue; }
 		virtual LLSD::Integer	asInteger() const	{ return mValue ? 1 : 0; }
@@ -226,6 +387,9 @@ namespace
 	{
 	public:
 		ImplInteger(LLSD::Integer v) : Base(v) { }
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+		ImplInteger(LLSD::Integer v, StaticAllocationMarker marker) : Base(v, marker) { }
+// [/SL:KB]
 		
 		virtual LLSD::Boolean	asBoolean() const	{ return mValue != 0; }
 		virtual LLSD::Integer	asInteger() const	{ return mValue; }
@@ -264,6 +428,9 @@ namespace
 	{
 	public:
 		ImplString(const LLSD::String& v) : Base(v) { }
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+		ImplString(const LLSD::String& v, StaticAllocationMarker marker) : Base(v, marker) { }
+// [/SL:KB]
 				
 		virtual LLSD::Boolean	asBoolean() const	{ return !mValue.empty(); }
 		virtual LLSD::Integer	asInteger() const;
@@ -308,6 +475,9 @@ namespace
 	{
 	public:
 		ImplUUID(const LLSD::UUID& v) : Base(v) { }
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+		ImplUUID(const LLSD::UUID& v, StaticAllocationMarker marker) : Base(v, marker) { }
+// [/SL:KB]
 				
 		virtual LLSD::String	asString() const{ return mValue.asString(); }
 		virtual LLSD::UUID		asUUID() const	{ return mValue; }
@@ -359,7 +529,10 @@ namespace
 	class ImplMap : public LLSD::Impl
 	{
 	private:
-		typedef std::map<LLSD::String, LLSD>	DataMap;
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+		typedef LLSD::map_type	DataMap;
+// [/SL:KB]
+//		typedef std::map<LLSD::String, LLSD>	DataMap;
 		
 		DataMap mData;
 		
@@ -648,7 +821,10 @@ LLSD::Impl::Impl()
 }
 
 LLSD::Impl::Impl(StaticAllocationMarker)
-	: mUseCount(0)
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	: mUseCount(STATIC_USAGE_COUNT)
+// [/SL:KB]
+//	: mUseCount(0)
 {
 }
 
@@ -709,12 +885,19 @@ void LLSD::Impl::assignUndefined(Impl*& var)
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Boolean v)
 {
-	reset(var, new ImplBoolean(v));
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	reset(var, sharedBoolean(v));
+// [/SL:KB]
+//	reset(var, new ImplBoolean(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Integer v)
 {
-	reset(var, new ImplInteger(v));
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	Impl* shared_impl = sharedInteger(v);
+	reset(var, (shared_impl) ? shared_impl : new ImplInteger(v));
+// [/SL:KB]
+//	reset(var, new ImplInteger(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Real v)
@@ -724,12 +907,20 @@ void LLSD::Impl::assign(Impl*& var, LLSD::Real v)
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::String& v)
 {
-	reset(var, new ImplString(v));
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	Impl* shared_impl = sharedString(v);
+	reset(var, (shared_impl) ? shared_impl : new ImplString(v));
+// [/SL:KB]
+//	reset(var, new ImplString(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::UUID& v)
 {
-	reset(var, new ImplUUID(v));
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+	Impl* shared_impl = sharedUUID(v);
+	reset(var, (shared_impl) ? shared_impl : new ImplUUID(v));
+// [/SL:KB]
+//	reset(var, new ImplUUID(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::Date& v)
@@ -747,6 +938,51 @@ void LLSD::Impl::assign(Impl*& var, const LLSD::Binary& v)
 	reset(var, new ImplBinary(v));
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+// Flags, types, small counts and enum values make up most of the integers in parsed payloads
+static const LLSD::Integer SHARED_INTEGER_MIN = -1;
+static const LLSD::Integer SHARED_INTEGER_MAX = 255;
+
+// The shared values below are never destroyed since static LLSD objects can still refer to them during shutdown
+
+LLSD::Impl* LLSD::Impl::sharedBoolean(LLSD::Boolean v)
+{
+	static Impl* sFalse = new ImplBoolean(false, STATIC_USAGE_COUNT);
+	static Impl* sTrue = new ImplBoolean(true, STATIC_USAGE_COUNT);
+	return (v) ? sTrue : sFalse;
+}
+
+LLSD::Impl* LLSD::Impl::sharedInteger(LLSD::Integer v)
+{
+	if ( (v < SHARED_INTEGER_MIN) || (v > SHARED_INTEGER_MAX) )
+	{
+		return NULL;
+	}
+
+	static Impl** sIntegers = []()
+		{
+			Impl** integers = new Impl*[SHARED_INTEGER_MAX - SHARED_INTEGER_MIN + 1];
+			for (LLSD::Integer value = SHARED_INTEGER_MIN; value <= SHARED_INTEGER_MAX; value++)
+			{
+				integers[value - SHARED_INTEGER_MIN] = new ImplInteger(value, STATIC_USAGE_COUNT);
+			}
+			return integers;
+		}();
+	return sIntegers[v - SHARED_INTEGER_MIN];
+}
+
+LLSD::Impl* LLSD::Impl::sharedString(const LLSD::String& v)
+{
+	static Impl* sEmpty = new ImplString(LLSD::String(), STATIC_USAGE_COUNT);
+	return (v.empty()) ? sEmpty : NULL;
+}
+
+LLSD::Impl* LLSD::Impl::sharedUUID(const LLSD::UUID& v)
+{
+	static Impl* sNull = new ImplUUID(LLUUID::null, STATIC_USAGE_COUNT);
+	return (v.isNull()) ? sNull : NULL;
+}
+// [/SL:KB]
 
 const LLSD& LLSD::Impl::undef()
 {
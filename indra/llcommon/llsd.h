@@ -37,6 +37,39 @@
 #include "lluri.h"
 #include "lluuid.h"
 
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+namespace llsd
+{
+	/// Small block pool backing LLSD values and map entries.
+	///
+	/// Blocks are handed out from per-thread free lists carved out of larger
+	/// chunks, which turns the many tiny allocations made while building
+	/// LLSD trees into a pointer pop. A block may be released on any thread
+	/// and is then reused by that thread. Chunk memory is kept for the
+	/// lifetime of the process. Sizes above the pooled range fall through to
+	/// the regular heap.
+	LL_COMMON_API void* pool_allocate(size_t size);
+	LL_COMMON_API void pool_free(void* ptr, size_t size);
+
+	template<typename T>
+	class pool_allocator
+	{
+	public:
+		typedef T value_type;
+		template<typename U> struct rebind { typedef pool_allocator<U> other; };
+
+		pool_allocator() { }
+		template<typename U> pool_allocator(const pool_allocator<U>&) { }
+
+		T*   allocate(size_t n)				{ return static_cast<T*>(pool_allocate(n * sizeof(T))); }
+		void deallocate(T* ptr, size_t n)	{ pool_free(ptr, n * sizeof(T)); }
+
+		template<typename U> bool operator==(const pool_allocator<U>&) const { return true; }
+		template<typename U> bool operator!=(const pool_allocator<U>&) const { return false; }
+	};
+}
+// [/SL:KB]
+
 /**
 	LLSD provides a flexible data system similar to the data facilities of
 	dynamic languages like Perl and Python.  It is created to support exchange
@@ -314,8 +347,14 @@ class LL_COMMON_API LLSD
 	//@{
 		int size() const;
 
-		typedef std::map<String, LLSD>::iterator		map_iterator;
-		typedef std::map<String, LLSD>::const_iterator	map_const_iterator;
+// [SL:KB] - Patch: Viewer-OptimizationLLSD | Checked: Catznip-6.7
+		typedef std::map<String, LLSD, std::less<String>, llsd::pool_allocator<std::pair<const String, LLSD> > > map_type;
+
+		typedef map_type::iterator						map_iterator;
+		typedef map_type::const_iterator				map_const_iterator;
+// [/SL:KB]
+//		typedef std::map<String, LLSD>::iterator		map_iterator;
+//		typedef std::map<String, LLSD>::const_iterator	map_const_iterator;
 		
 		map_iterator		beginMap();
 		map_iterator		endMap();
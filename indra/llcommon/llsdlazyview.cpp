@@ -0,0 +1,403 @@
+/**
+ * @file llsdlazyview.cpp
+ * @brief Read-only LLSD view over a serialized buffer that only decodes what's accessed
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsdlazyview.h"
+
+#include <algorithm>
+#include <sstream>
+
+/**
+ * Local functions.
+ */
+namespace
+{
+	struct LLSDLazyChild
+	{
+		LLSD::String	mKey;		// Empty for array elements
+		size_t			mBegin;		// Byte range of the value in the buffer
+		size_t			mEnd;
+		LLSD::Type		mType;
+	};
+
+	/**
+	 * @class LLSDLazyIndexer
+	 * @brief Visitor recording the type and byte range of every direct child of the parsed value.
+	 */
+	class LLSDLazyIndexer : public LLSDParseVisitor
+	{
+	public:
+		LLSDLazyIndexer(const LLSDBufferParser& parser, size_t base, std::vector<LLSDLazyChild>& children)
+			: mParser(parser)
+			, mBase(base)
+			, mChildren(children)
+			, mDepth(0)
+			, mType(LLSD::TypeUndefined)
+			, mChildType(LLSD::TypeUndefined)
+			, mChildBegin(0)
+		{
+		}
+
+		virtual bool beginMap(S32 size)							{ return beginContainer(LLSD::TypeMap, size); }
+		virtual bool endMap()									{ return endContainer(); }
+		virtual bool beginArray(S32 size)						{ return beginContainer(LLSD::TypeArray, size); }
+		virtual bool endArray()									{ return endContainer(); }
+		virtual bool mapKey(const LLSD::String& key)
+		{
+			if (1 == mDepth)
+			{
+				// The parser reuses its key strings so nested keys could overwrite this one before the value is done
+				mKey.assign(key);
+				mChildBegin = mParser.getParseOffset();
+			}
+			return true;
+		}
+
+		// Nothing gets built while indexing
+		virtual bool undefValue()								{ return scalarValue(LLSD::TypeUndefined); }
+		virtual bool booleanValue(LLSD::Boolean v)				{ return scalarValue(LLSD::TypeBoolean); }
+		virtual bool integerValue(LLSD::Integer v)				{ return scalarValue(LLSD::TypeInteger); }
+		virtual bool realValue(LLSD::Real v)					{ return scalarValue(LLSD::TypeReal); }
+		virtual bool stringValue(const char* str, size_t len)	{ return scalarValue(LLSD::TypeString); }
+		virtual bool uuidValue(const LLSD::UUID& v)				{ return scalarValue(LLSD::TypeUUID); }
+		virtual bool dateValue(const LLSD::Date& v)				{ return scalarValue(LLSD::TypeDate); }
+		virtual bool uriValue(const LLSD::URI& v)				{ return scalarValue(LLSD::TypeURI); }
+		virtual bool binaryValue(const U8* data, size_t len)	{ return scalarValue(LLSD::TypeBinary); }
+
+		LLSD::Type getType() const								{ return mType; }
+
+	protected:
+		bool beginContainer(LLSD::Type type, S32 size)
+		{
+			if (0 == mDepth)
+			{
+				mType = type;
+				mChildren.reserve(llmax(size, 0));
+				mChildBegin = mParser.getParseOffset();
+			}
+			else if (1 == mDepth)
+			{
+				mChildType = type;
+			}
+			mDepth++;
+			return true;
+		}
+
+		bool endContainer()
+		{
+			if (1 == --mDepth)
+			{
+				addChild();
+			}
+			return true;
+		}
+
+		bool scalarValue(LLSD::Type type)
+		{
+			if (0 == mDepth)
+			{
+				mType = type;
+			}
+			else if (1 == mDepth)
+			{
+				mChildType = type;
+				addChild();
+			}
+			return true;
+		}
+
+		void addChild()
+		{
+			const size_t child_end = mParser.getParseOffset();
+
+			mChildren.push_back(LLSDLazyChild());
+			LLSDLazyChild& child = mChildren.back();
+			if (LLSD::TypeMap == mType)
+			{
+				child.mKey = mKey;
+			}
+			child.mBegin = mBase + mChildBegin;
+			child.mEnd = mBase + child_end;
+			child.mType = mChildType;
+
+			mChildBegin = child_end;
+		}
+
+	protected:
+		const LLSDBufferParser&		mParser;
+		size_t						mBase;
+		std::vector<LLSDLazyChild>&	mChildren;
+		S32							mDepth;
+		LLSD::Type					mType;
+		LLSD::Type					mChildType;
+		LLSD::String				mKey;
+		size_t						mChildBegin;
+	};
+
+	bool index_value(const char* buf, size_t begin, size_t end, LLSDBufferParser::EFormat format, LLSD::Type& type, std::vector<LLSDLazyChild>& children)
+	{
+		LLSDBufferParser parser;
+		LLSDLazyIndexer indexer(parser, begin, children);
+		if (LLSDParser::PARSE_FAILURE == parser.parse(buf + begin, end - begin, format, indexer))
+		{
+			children.clear();
+			return false;
+		}
+		type = indexer.getType();
+
+		if (LLSD::TypeMap == type)
+		{
+			// Order by key like LLSD does and resolve duplicate keys the same way the parser does (the first one wins in binary, the last one in XML)
+			std::stable_sort(children.begin(), children.end(), [](const LLSDLazyChild& lhs, const LLSDLazyChild& rhs) { return lhs.mKey < rhs.mKey; });
+
+			const bool keep_last = (LLSDBufferParser::FORMAT_BINARY != format);
+			std::vector<LLSDLazyChild>::iterator it_out = children.begin();
+			for (std::vector<LLSDLazyChild>::iterator it_run = children.begin(); it_run != children.end(); )
+			{
+				std::vector<LLSDLazyChild>::iterator it_run_end = it_run + 1;
+				while ( (it_run_end != children.end()) && (it_run_end->mKey == it_run->mKey) )
+				{
+					++it_run_end;
+				}
+
+				std::vector<LLSDLazyChild>::iterator it_keep = (keep_last) ? it_run_end - 1 : it_run;
+				if (it_out != it_keep)
+				{
+					*it_out = std::move(*it_keep);
+				}
+				++it_out;
+				it_run = it_run_end;
+			}
+			children.erase(it_out, children.end());
+		}
+		return true;
+	}
+}
+
+/**
+ * LLSDLazyView internals
+ */
+struct LLSDLazyView::LLSDLazyBuffer
+{
+	LLSDLazyBuffer(const LLSD& data, EFormat format)
+		: mData(data)
+		, mFormat(format)
+	{
+	}
+
+	const char* data() const
+	{
+		const LLSD::Binary& data = mData.asBinary();
+		return (!data.empty()) ? reinterpret_cast<const char*>(data.data()) : "";
+	}
+
+	size_t size() const
+	{
+		return mData.asBinary().size();
+	}
+
+	LLSD	mData;
+	EFormat	mFormat;
+};
+
+struct LLSDLazyView::LLSDLazyNode
+{
+	LLSDLazyNode(size_t begin, size_t end, LLSD::Type type, bool is_root)
+		: mBegin(begin)
+		, mEnd(end)
+		, mType(type)
+		, mRoot(is_root)
+		, mIndexed(false)
+		, mValid(true)
+	{
+	}
+
+	size_t						mBegin;
+	size_t						mEnd;
+	LLSD::Type					mType;
+	bool						mRoot;
+	bool						mIndexed;
+	bool						mValid;
+	std::vector<LLSDLazyChild>	mChildren;
+};
+
+/**
+ * LLSDLazyView
+ */
+LLSDLazyView::LLSDLazyView()
+{
+}
+
+LLSDLazyView::LLSDLazyView(const char* buf, size_t len, EFormat format)
+	: mBuffer(std::make_shared<LLSDLazyBuffer>(LLSD::Binary(reinterpret_cast<const U8*>(buf), reinterpret_cast<const U8*>(buf) + len), format))
+	, mNode(std::make_shared<LLSDLazyNode>(0, len, LLSD::TypeUndefined, true))
+{
+}
+
+LLSDLazyView::LLSDLazyView(const LLSD& buffer, EFormat format)
+	: mBuffer(std::make_shared<LLSDLazyBuffer>(buffer, format))
+	, mNode(std::make_shared<LLSDLazyNode>(0, mBuffer->size(), LLSD::TypeUndefined, true))
+{
+}
+
+LLSDLazyView::LLSDLazyView(const std::shared_ptr<LLSDLazyBuffer>& buffer, const std::shared_ptr<LLSDLazyNode>& node)
+	: mBuffer(buffer)
+	, mNode(node)
+{
+}
+
+bool LLSDLazyView::isValid() const
+{
+	indexNode();
+	return (mNode) && (mNode->mValid);
+}
+
+LLSD::Type LLSDLazyView::type() const
+{
+	indexNode();
+	return (mNode) ? mNode->mType : LLSD::TypeUndefined;
+}
+
+S32 LLSDLazyView::size() const
+{
+	indexNode();
+	return (mNode) ? (S32)mNode->mChildren.size() : 0;
+}
+
+bool LLSDLazyView::has(const LLSD::String& key) const
+{
+	return findKey(key) >= 0;
+}
+
+LLSDLazyView LLSDLazyView::get(const LLSD::String& key) const
+{
+	return get(findKey(key));
+}
+
+LLSDLazyView LLSDLazyView::get(S32 index) const
+{
+	indexNode();
+	if ( (!mNode) || (index < 0) || (index >= (S32)mNode->mChildren.size()) )
+	{
+		return LLSDLazyView();
+	}
+
+	// The child's own children only get indexed if it's accessed in turn
+	const LLSDLazyChild& child = mNode->mChildren[index];
+	return LLSDLazyView(mBuffer, std::make_shared<LLSDLazyNode>(child.mBegin, child.mEnd, child.mType, false));
+}
+
+const LLSD::String& LLSDLazyView::keyAt(S32 index) const
+{
+	static const LLSD::String s_empty_key;
+
+	indexNode();
+	if ( (!mNode) || (index < 0) || (index >= (S32)mNode->mChildren.size()) )
+	{
+		return s_empty_key;
+	}
+	return mNode->mChildren[index].mKey;
+}
+
+LLSD LLSDLazyView::asLLSD() const
+{
+	if (!isValid())
+	{
+		return LLSD();
+	}
+
+	LLSD sd;
+	LLSDBufferParser().parse(mBuffer->data() + mNode->mBegin, mNode->mEnd - mNode->mBegin, getNodeFormat(), sd);
+	return sd;
+}
+
+S32 LLSDLazyView::findKey(const LLSD::String& key) const
+{
+	if (!isMap())
+	{
+		return -1;
+	}
+
+	const std::vector<LLSDLazyChild>& children = mNode->mChildren;
+	std::vector<LLSDLazyChild>::const_iterator it_child = std::lower_bound(children.begin(), children.end(), key, [](const LLSDLazyChild& child, const LLSD::String& key) { return child.mKey < key; });
+	return ( (children.end() != it_child) && (key == it_child->mKey) ) ? S32(it_child - children.begin()) : -1;
+}
+
+void LLSDLazyView::indexNode() const
+{
+	if ( (!mNode) || (mNode->mIndexed) )
+	{
+		return;
+	}
+	mNode->mIndexed = true;
+
+	if (mNode->mRoot)
+	{
+		mNode->mValid = indexRoot();
+	}
+	else if ( (LLSD::TypeMap == mNode->mType) || (LLSD::TypeArray == mNode->mType) )
+	{
+		// Children are only created out of an already validated parent so this can't fail
+		mNode->mValid = index_value(mBuffer->data(), mNode->mBegin, mNode->mEnd, getNodeFormat(), mNode->mType, mNode->mChildren);
+	}
+}
+
+bool LLSDLazyView::indexRoot() const
+{
+	LLSDLazyBuffer& buffer = *mBuffer;
+	if (index_value(buffer.data(), 0, buffer.size(), buffer.mFormat, mNode->mType, mNode->mChildren))
+	{
+		return true;
+	}
+
+	// Let LLSDSerialize deal with anything the buffer parser doesn't handle and view its result in binary form
+	LLSD sd;
+	const S32 parse_count = (LLSDBufferParser::FORMAT_BINARY == buffer.mFormat) ? LLSDSerialize::fromBinary(sd, buffer.data(), buffer.size())
+	                                                                            : LLSDSerialize::fromXML(sd, buffer.data(), buffer.size());
+	if (LLSDParser::PARSE_FAILURE == parse_count)
+	{
+		mNode->mType = LLSD::TypeUndefined;
+		return false;
+	}
+
+	std::ostringstream str;
+	LLSDSerialize::toBinary(sd, str);
+	const std::string binary = str.str();
+	buffer.mData = LLSD::Binary(binary.begin(), binary.end());
+	buffer.mFormat = LLSDBufferParser::FORMAT_BINARY;
+	mNode->mEnd = buffer.size();
+	return index_value(buffer.data(), 0, buffer.size(), buffer.mFormat, mNode->mType, mNode->mChildren);
+}
+
+LLSDLazyView::EFormat LLSDLazyView::getNodeFormat() const
+{
+	// Values inside of an XML document are parsed without the surrounding <llsd> element
+	if ( (mNode->mRoot) || (LLSDBufferParser::FORMAT_BINARY == mBuffer->mFormat) )
+	{
+		return mBuffer->mFormat;
+	}
+	return LLSDBufferParser::FORMAT_XML_FRAGMENT;
+}
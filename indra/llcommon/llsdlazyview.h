@@ -0,0 +1,130 @@
+/**
+ * @file llsdlazyview.h
+ * @brief Read-only LLSD view over a serialized buffer that only decodes what's accessed
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDLAZYVIEW_H
+#define LL_LLSDLAZYVIEW_H
+
+#include "llsd.h"
+#include "llsdserialize.h"
+
+#include <memory>
+
+/**
+ * @class LLSDLazyView
+ * @brief Read-only view of binary or XML LLSD that is decoded on demand.
+ *
+ * Large capability responses are often only walked one array element at
+ * a time. Rather than building the whole document as an LLSD up front,
+ * the view records where each child of a map or array starts and ends
+ * the first time the container is touched and only builds an LLSD out of
+ * a child when asLLSD() is called on it. Walking a big array therefore
+ * never holds more than one of its elements in decoded form.
+ *
+ * The first touch of the root validates the entire document. Documents
+ * the buffer parser doesn't handle are parsed by the regular stream
+ * parser instead and re-encoded as binary LLSD, so a view always agrees
+ * with what LLSDSerialize would have produced. isValid() is false only
+ * when LLSDSerialize would have failed as well.
+ *
+ * Map children are ordered by key like LLSD's map iteration and can be
+ * walked by index with get(S32) and keyAt(). Child views
+ * share the underlying buffer but not the index: hold on to a view
+ * rather than looking it up repeatedly. Like LLSD a view is not thread
+ * safe.
+ */
+class LL_COMMON_API LLSDLazyView
+{
+public:
+	typedef LLSDBufferParser::EFormat EFormat;
+
+	/**
+	 * @brief Constructs an undefined view.
+	 */
+	LLSDLazyView();
+
+	/**
+	 * @brief Constructs a view over a copy of the buffer.
+	 */
+	LLSDLazyView(const char* buf, size_t len, EFormat format);
+
+	/**
+	 * @brief Constructs a view over an LLSD::Binary (such as the "raw" result
+	 *  of HttpCoroutineAdapter) which is shared rather than copied.
+	 */
+	LLSDLazyView(const LLSD& buffer, EFormat format);
+
+	/**
+	 * @brief Returns false if the buffer doesn't hold valid LLSD.
+	 */
+	bool isValid() const;
+
+	LLSD::Type type() const;
+	bool isUndefined() const							{ return LLSD::TypeUndefined == type(); }
+	bool isMap() const									{ return LLSD::TypeMap == type(); }
+	bool isArray() const								{ return LLSD::TypeArray == type(); }
+
+	/**
+	 * @brief Number of children of a map or array (0 for anything else).
+	 */
+	S32 size() const;
+
+	bool has(const LLSD::String& key) const;
+	LLSDLazyView get(const LLSD::String& key) const;
+	LLSDLazyView get(S32 index) const;
+	const LLSD::String& keyAt(S32 index) const;
+
+	LLSDLazyView operator[](const LLSD::String& key) const	{ return get(key); }
+	LLSDLazyView operator[](const char* key) const			{ return get(LLSD::String(key)); }
+	LLSDLazyView operator[](S32 index) const				{ return get(index); }
+
+	/**
+	 * @brief Decodes the value (and everything under it) into an LLSD.
+	 */
+	LLSD asLLSD() const;
+
+	LLSD::Boolean	asBoolean() const					{ return asLLSD().asBoolean(); }
+	LLSD::Integer	asInteger() const					{ return asLLSD().asInteger(); }
+	LLSD::Real		asReal() const						{ return asLLSD().asReal(); }
+	LLSD::String	asString() const					{ return asLLSD().asString(); }
+	LLSD::UUID		asUUID() const						{ return asLLSD().asUUID(); }
+
+protected:
+	struct LLSDLazyBuffer;
+	struct LLSDLazyNode;
+
+	LLSDLazyView(const std::shared_ptr<LLSDLazyBuffer>& buffer, const std::shared_ptr<LLSDLazyNode>& node);
+
+	S32 findKey(const LLSD::String& key) const;
+	void indexNode() const;
+	bool indexRoot() const;
+	EFormat getNodeFormat() const;
+
+protected:
+	std::shared_ptr<LLSDLazyBuffer>	mBuffer;
+	std::shared_ptr<LLSDLazyNode>	mNode;
+};
+
+#endif // LL_LLSDLAZYVIEW_H
@@ -408,6 +408,134 @@ class LL_COMMON_API LLSDBinaryParser : public LLSDParser
 	bool parseString(std::istream& istr, std::string& value) const;
 };
 
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+/** 
+ * @class LLSDParseVisitor
+ * @brief Receives the values found by an LLSDBufferParser in document order.
+ *
+ * Scalars arrive through the typed callbacks, which by default wrap the
+ * value in an LLSD and forward it to value(), so a visitor only needs to
+ * override what it is interested in. Map keys, strings, URIs and binary
+ * data point into the parsed buffer (or the parser's scratch space) and are
+ * only valid for the duration of the call. Any callback can return false to
+ * abort the parse.
+ */
+class LL_COMMON_API LLSDParseVisitor
+{
+public:
+	virtual ~LLSDParseVisitor() { }
+
+	/// size is the number of entries announced by the buffer or -1 if unknown
+	virtual bool beginMap(S32 size)							{ return true; }
+	virtual bool mapKey(const LLSD::String& key)			{ return true; }
+	virtual bool endMap()									{ return true; }
+	virtual bool beginArray(S32 size)						{ return true; }
+	virtual bool endArray()									{ return true; }
+
+	virtual bool value(const LLSD& v)						{ return true; }
+	virtual bool undefValue()								{ return value(LLSD()); }
+	virtual bool booleanValue(LLSD::Boolean v)				{ return value(LLSD(v)); }
+	virtual bool integerValue(LLSD::Integer v)				{ return value(LLSD(v)); }
+	virtual bool realValue(LLSD::Real v)					{ return value(LLSD(v)); }
+	virtual bool stringValue(const char* str, size_t len)	{ return value(LLSD(LLSD::String(str, len))); }
+	virtual bool uuidValue(const LLSD::UUID& v)				{ return value(LLSD(v)); }
+	virtual bool dateValue(const LLSD::Date& v)				{ return value(LLSD(v)); }
+	virtual bool uriValue(const LLSD::URI& v)				{ return value(LLSD(v)); }
+	virtual bool binaryValue(const U8* data, size_t len)	{ return value(LLSD(LLSD::Binary(data, data + len))); }
+};
+
+/** 
+ * @class LLSDBufferParser
+ * @brief Parses binary or XML LLSD straight out of a memory buffer.
+ *
+ * Works on pointers into the buffer rather than through an istream,
+ * scans XML character data 16 bytes at a time and reuses a single
+ * string for every occurrence of the same map key. The result is either
+ * built into an LLSD or handed to an LLSDParseVisitor so callers that
+ * only extract a few fields never materialize the whole tree.
+ *
+ * XML is limited to the documents LLSDXMLFormatter and the simulator
+ * produce: a single value inside <llsd> with comments and processing
+ * instructions outside of values. Anything else (CDATA sections, unknown
+ * elements, keys outside of maps, notation style strings in binary,
+ * ...) fails the parse; LLSDSerialize's buffer methods then hand the
+ * buffer to the stream parsers so those keep their existing behaviour.
+ */
+class LL_COMMON_API LLSDBufferParser
+{
+public:
+	enum EFormat
+	{
+		FORMAT_BINARY,
+		FORMAT_XML,
+		FORMAT_XML_FRAGMENT		// A single XML value element outside of an <llsd> document
+	};
+
+	LLSDBufferParser();
+
+	/** 
+	 * @brief Parses one LLSD value out of the buffer.
+	 *
+	 * @param buf The buffer to parse.
+	 * @param len Size of the buffer in bytes.
+	 * @param format Format of the buffer's contents.
+	 * @param visitor Receives the parsed values.
+	 * @param max_depth Max depth parser will check before exiting
+	 *  with parse error, -1 - unlimited.
+	 * @return Returns the number of LLSD objects parsed. Returns
+	 * LLSDParser::PARSE_FAILURE (-1) on parse failure.
+	 */
+	S32 parse(const char* buf, size_t len, EFormat format, LLSDParseVisitor& visitor, S32 max_depth = -1);
+
+	/** 
+	 * @brief Same as above but builds the parsed value into data.
+	 *
+	 * Duplicate map keys resolve the same way as the stream parsers (the
+	 * first value wins in binary, the last value in XML).
+	 */
+	S32 parse(const char* buf, size_t len, EFormat format, LLSD& data, S32 max_depth = -1);
+
+	/** 
+	 * @brief Returns the number of bytes consumed by the last successful parse.
+	 */
+	size_t getBytesParsed() const { return mBytesParsed; }
+
+	/** 
+	 * @brief Returns the offset into the buffer the parse has reached.
+	 *
+	 * Meant for visitors: during a callback this is just past the value
+	 * (or the container's opening) being reported.
+	 */
+	size_t getParseOffset() const { return mCur - mBegin; }
+
+protected:
+	S32 parseBinaryValue(S32 max_depth);
+	bool readBinarySize(S32& size);
+	bool readBinaryString(const char*& str, S32& len);
+
+	S32 parseXMLDocument(S32 max_depth);
+	S32 parseXMLValue(S32 max_depth);
+	bool readXMLAttributes(const char** encoding, size_t* encoding_len, bool& self_closing);
+	bool readXMLText(const char*& text, size_t& len);
+	bool readXMLEndTag(const char* name, size_t name_len);
+	bool skipXMLMisc();
+
+	const LLSD::String& internKey(const char* key, size_t len);
+
+protected:
+	const char*			mBegin;
+	const char*			mCur;
+	const char*			mEnd;
+	LLSDParseVisitor*	mVisitor;
+	size_t				mBytesParsed;
+	LLSD::String		mScratch;		// Decoded XML character data
+	LLSD::String		mTextScratch;	// Scalar conversions that need a NULL terminated string
+
+	static const U32	KEY_CACHE_SIZE = 256;
+	LLSD::String		mKeyCache[KEY_CACHE_SIZE];
+};
+// [/SL:KB]
+
 
 /** 
  * @class LLSDFormatter
@@ -757,6 +885,12 @@ class LL_COMMON_API LLSDSerialize
 	 * @return Returns true if the stream appears to contain valid data
 	 */
 	static bool deserialize(LLSD& sd, std::istream& str, S32 max_bytes);
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+	/**
+	 * @brief Same as above for an in-memory buffer.
+	 */
+	static bool deserialize(LLSD& sd, const char* buf, size_t len);
+// [/SL:KB]
 
 	/*
 	 * Notation Methods
@@ -825,6 +959,10 @@ class LL_COMMON_API LLSDSerialize
 		return fromXMLEmbedded(sd, str, emit_errors);
 //		return fromXMLDocument(sd, str, emit_errors);
 	}
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+	// Parses with LLSDBufferParser and falls back on the stream parser for anything it doesn't handle
+	static S32 fromXML(LLSD& sd, const char* buf, size_t len, bool emit_errors=true);
+// [/SL:KB]
 
 	/*
 	 * Binary Methods
@@ -846,6 +984,11 @@ class LL_COMMON_API LLSDSerialize
 		(void)p->parse(str, sd, max_bytes, max_depth);
 		return sd;
 	}
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+	// Parses with LLSDBufferParser and falls back on the stream parser for anything it doesn't handle (bytes_parsed receives
+	// the number of bytes the value took up)
+	static S32 fromBinary(LLSD& sd, const char* buf, size_t len, S32 max_depth = -1, size_t* bytes_parsed = nullptr);
+// [/SL:KB]
 };
 
 class LL_COMMON_API LLUZipHelper : public LLRefCount
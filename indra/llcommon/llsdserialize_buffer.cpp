@@ -0,0 +1,1155 @@
+/**
+ * @file llsdserialize_buffer.cpp
+ * @brief Pointer based parsing of binary and XML LLSD held in memory
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsdserialize.h"
+
+#include "llmemorystream.h"
+
+#include <deque>
+#include <emmintrin.h>
+#if LL_WINDOWS
+#include <intrin.h>
+#endif
+
+#include "apr_base64.h"
+
+// File constants
+static const char BINARY_HEADER[] = "<? LLSD/Binary ?>";
+static const char XML_HEADER[] = "<? LLSD/XML ?>";
+
+/**
+ * Local functions.
+ */
+namespace
+{
+	// Index of the lowest set bit of a non-zero mask
+	inline U32 lowest_set_bit(U32 mask)
+	{
+#if LL_WINDOWS
+		unsigned long idx;
+		_BitScanForward(&idx, mask);
+		return idx;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	inline U32 read_u32_nbo(const char* ptr)
+	{
+		const U8* bytes = reinterpret_cast<const U8*>(ptr);
+		return ((U32)bytes[0] << 24) | ((U32)bytes[1] << 16) | ((U32)bytes[2] << 8) | (U32)bytes[3];
+	}
+
+	inline bool is_xml_space(char c)
+	{
+		return (' ' == c) || ('\t' == c) || ('\n' == c) || ('\r' == c);
+	}
+
+	inline bool is_xml_name_char(char c)
+	{
+		return ( (c >= 'a') && (c <= 'z') ) || ( (c >= 'A') && (c <= 'Z') ) || ( (c >= '0') && (c <= '9') ) || ('_' == c) || ('-' == c) || ('.' == c) || (':' == c);
+	}
+
+	/**
+	 * @brief Returns the first byte in [ptr, end) that needs a closer look in XML
+	 *  character data ('<', '&', control characters and anything outside of ASCII)
+	 */
+	const char* scan_xml_text(const char* ptr, const char* end)
+	{
+		const __m128i lt = _mm_set1_epi8('<');
+		const __m128i amp = _mm_set1_epi8('&');
+		const __m128i space = _mm_set1_epi8(' ');
+		while (end - ptr >= 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+			// The signed compare catches both control characters and bytes >= 0x80
+			const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, lt), _mm_cmpeq_epi8(chunk, amp)), _mm_cmplt_epi8(chunk, space));
+			const U32 mask = _mm_movemask_epi8(special);
+			if (mask)
+			{
+				return ptr + lowest_set_bit(mask);
+			}
+			ptr += 16;
+		}
+		while ( (ptr < end) && ((U8)*ptr >= 0x20) && ((U8)*ptr < 0x80) && ('<' != *ptr) && ('&' != *ptr) )
+		{
+			ptr++;
+		}
+		return ptr;
+	}
+
+	// Steps over one UTF-8 encoded character (rejecting the same malformed sequences and non-characters expat does)
+	bool skip_utf8_char(const char*& ptr, const char* end)
+	{
+		const U8* bytes = reinterpret_cast<const U8*>(ptr);
+		const size_t avail = end - ptr;
+		if ( (bytes[0] >= 0xC2) && (bytes[0] <= 0xDF) )
+		{
+			if ( (avail < 2) || ((bytes[1] & 0xC0) != 0x80) )
+				return false;
+			ptr += 2;
+			return true;
+		}
+		if ( (bytes[0] >= 0xE0) && (bytes[0] <= 0xEF) )
+		{
+			if ( (avail < 3) || ((bytes[1] & 0xC0) != 0x80) || ((bytes[2] & 0xC0) != 0x80) )
+				return false;
+			const U32 code_point = ((bytes[0] & 0x0F) << 12) | ((bytes[1] & 0x3F) << 6) | (bytes[2] & 0x3F);
+			if ( (code_point < 0x800) || ((code_point >= 0xD800) && (code_point <= 0xDFFF)) || (code_point >= 0xFFFE) )
+				return false;
+			ptr += 3;
+			return true;
+		}
+		if ( (bytes[0] >= 0xF0) && (bytes[0] <= 0xF4) )
+		{
+			if ( (avail < 4) || ((bytes[1] & 0xC0) != 0x80) || ((bytes[2] & 0xC0) != 0x80) || ((bytes[3] & 0xC0) != 0x80) )
+				return false;
+			const U32 code_point = ((bytes[0] & 0x07) << 18) | ((bytes[1] & 0x3F) << 12) | ((bytes[2] & 0x3F) << 6) | (bytes[3] & 0x3F);
+			if ( (code_point < 0x10000) || (code_point > 0x10FFFF) )
+				return false;
+			ptr += 4;
+			return true;
+		}
+		return false;
+	}
+
+	bool append_utf8_char(std::string& out, U32 code_point)
+	{
+		// Same set of characters XML allows in a document
+		if ( (code_point < 0x20) ? ((code_point != '\t') && (code_point != '\n') && (code_point != '\r'))
+		                         : (((code_point >= 0xD800) && (code_point <= 0xDFFF)) || (code_point == 0xFFFE) || (code_point == 0xFFFF) || (code_point > 0x10FFFF)) )
+		{
+			return false;
+		}
+
+		if (code_point < 0x80)
+		{
+			out += (char)code_point;
+		}
+		else if (code_point < 0x800)
+		{
+			out += (char)(0xC0 | (code_point >> 6));
+			out += (char)(0x80 | (code_point & 0x3F));
+		}
+		else if (code_point < 0x10000)
+		{
+			out += (char)(0xE0 | (code_point >> 12));
+			out += (char)(0x80 | ((code_point >> 6) & 0x3F));
+			out += (char)(0x80 | (code_point & 0x3F));
+		}
+		else
+		{
+			out += (char)(0xF0 | (code_point >> 18));
+			out += (char)(0x80 | ((code_point >> 12) & 0x3F));
+			out += (char)(0x80 | ((code_point >> 6) & 0x3F));
+			out += (char)(0x80 | (code_point & 0x3F));
+		}
+		return true;
+	}
+
+	// Decodes the entity or character reference at ptr (pointing at the '&')
+	bool decode_xml_entity(const char*& ptr, const char* end, std::string& out)
+	{
+		// Longest reference we accept is "&#x10FFFF;"
+		const char* semicolon = ptr + 1;
+		while ( (semicolon < end) && (';' != *semicolon) && (semicolon - ptr <= 9) )
+		{
+			semicolon++;
+		}
+		if ( (semicolon >= end) || (';' != *semicolon) )
+		{
+			return false;
+		}
+
+		const char* name = ptr + 1;
+		const size_t name_len = semicolon - name;
+		ptr = semicolon + 1;
+		if ( (2 == name_len) && (!memcmp(name, "lt", 2)) )
+		{
+			out += '<';
+		}
+		else if ( (2 == name_len) && (!memcmp(name, "gt", 2)) )
+		{
+			out += '>';
+		}
+		else if ( (3 == name_len) && (!memcmp(name, "amp", 3)) )
+		{
+			out += '&';
+		}
+		else if ( (4 == name_len) && (!memcmp(name, "quot", 4)) )
+		{
+			out += '"';
+		}
+		else if ( (4 == name_len) && (!memcmp(name, "apos", 4)) )
+		{
+			out += '\'';
+		}
+		else if ( (name_len >= 2) && ('#' == name[0]) )
+		{
+			const bool hex = ('x' == name[1]);
+			const char* digit = name + ((hex) ? 2 : 1);
+			if (digit == semicolon)
+			{
+				return false;
+			}
+
+			U32 code_point = 0;
+			for (; digit < semicolon; digit++)
+			{
+				U32 digit_value;
+				if ( (*digit >= '0') && (*digit <= '9') )
+					digit_value = *digit - '0';
+				else if ( (hex) && (*digit >= 'a') && (*digit <= 'f') )
+					digit_value = *digit - 'a' + 10;
+				else if ( (hex) && (*digit >= 'A') && (*digit <= 'F') )
+					digit_value = *digit - 'A' + 10;
+				else
+					return false;
+				code_point = code_point * ((hex) ? 16 : 10) + digit_value;
+				if (code_point > 0x10FFFF)
+				{
+					return false;
+				}
+			}
+			return append_utf8_char(out, code_point);
+		}
+		else
+		{
+			// Anything else would have to be declared in a DTD
+			return false;
+		}
+		return true;
+	}
+
+	enum EXMLElement
+	{
+		XML_UNDEF,
+		XML_BOOLEAN,
+		XML_INTEGER,
+		XML_REAL,
+		XML_STRING,
+		XML_UUID,
+		XML_DATE,
+		XML_URI,
+		XML_BINARY,
+		XML_MAP,
+		XML_ARRAY,
+		XML_UNKNOWN
+	};
+
+	EXMLElement get_xml_element(const char* name, size_t len)
+	{
+		switch (len)
+		{
+			case 3:
+				if (!memcmp(name, "map", 3)) return XML_MAP;
+				if (!memcmp(name, "uri", 3)) return XML_URI;
+				break;
+			case 4:
+				if (!memcmp(name, "real", 4)) return XML_REAL;
+				if (!memcmp(name, "uuid", 4)) return XML_UUID;
+				if (!memcmp(name, "date", 4)) return XML_DATE;
+				break;
+			case 5:
+				if (!memcmp(name, "array", 5)) return XML_ARRAY;
+				if (!memcmp(name, "undef", 5)) return XML_UNDEF;
+				break;
+			case 6:
+				if (!memcmp(name, "string", 6)) return XML_STRING;
+				if (!memcmp(name, "binary", 6)) return XML_BINARY;
+				break;
+			case 7:
+				if (!memcmp(name, "integer", 7)) return XML_INTEGER;
+				if (!memcmp(name, "boolean", 7)) return XML_BOOLEAN;
+				break;
+		}
+		return XML_UNKNOWN;
+	}
+
+	/**
+	 * @class LLSDBuilder
+	 * @brief Visitor building the parsed values into an LLSD.
+	 */
+	class LLSDBuilder : public LLSDParseVisitor
+	{
+	public:
+		LLSDBuilder(LLSD& result, bool replace_duplicates)
+			: mResult(result)
+			, mReplaceDuplicates(replace_duplicates)
+			, mKey(nullptr)
+		{
+		}
+
+		virtual bool beginMap(S32 size)					{ return push(LLSD::emptyMap()); }
+		virtual bool mapKey(const LLSD::String& key)	{ mKey = &key; return true; }
+		virtual bool endMap()							{ mStack.pop_back(); return true; }
+		virtual bool beginArray(S32 size)				{ return push(LLSD::emptyArray()); }
+		virtual bool endArray()							{ mStack.pop_back(); return true; }
+		virtual bool value(const LLSD& v)				{ nextSlot() = v; return true; }
+
+	protected:
+		bool push(const LLSD& container)
+		{
+			LLSD& slot = nextSlot();
+			slot = container;
+			mStack.push_back(&slot);
+			return true;
+		}
+
+		// Containers are built in place (the parent doesn't change while a child is open so the pointers on the stack stay valid)
+		LLSD& nextSlot()
+		{
+			if (mStack.empty())
+			{
+				return mResult;
+			}
+
+			LLSD& parent = *mStack.back();
+			if (parent.isArray())
+			{
+				return parent.append(LLSD());
+			}
+
+			const S32 size = parent.size();
+			LLSD& slot = parent[*mKey];
+			if ( (!mReplaceDuplicates) && (parent.size() == size) )
+			{
+				// Duplicate key where the first value wins so build this one on the side
+				mDiscarded.push_back(LLSD());
+				return mDiscarded.back();
+			}
+			return slot;
+		}
+
+	protected:
+		LLSD&				mResult;
+		bool				mReplaceDuplicates;
+		const LLSD::String*	mKey;
+		std::vector<LLSD*>	mStack;
+		std::deque<LLSD>	mDiscarded;
+	};
+}
+
+/**
+ * LLSDBufferParser
+ */
+LLSDBufferParser::LLSDBufferParser()
+	: mBegin(nullptr)
+	, mCur(nullptr)
+	, mEnd(nullptr)
+	, mVisitor(nullptr)
+	, mBytesParsed(0)
+{
+}
+
+S32 LLSDBufferParser::parse(const char* buf, size_t len, EFormat format, LLSDParseVisitor& visitor, S32 max_depth)
+{
+	mBegin = mCur = buf;
+	mEnd = buf + len;
+	mVisitor = &visitor;
+	mBytesParsed = 0;
+
+	S32 parse_count = LLSDParser::PARSE_FAILURE;
+	if (buf)
+	{
+		switch (format)
+		{
+			case FORMAT_BINARY:
+				parse_count = parseBinaryValue(max_depth);
+				break;
+			case FORMAT_XML:
+				parse_count = parseXMLDocument(max_depth);
+				break;
+			case FORMAT_XML_FRAGMENT:
+				parse_count = (skipXMLMisc()) ? parseXMLValue(max_depth) : LLSDParser::PARSE_FAILURE;
+				break;
+		}
+	}
+	if (LLSDParser::PARSE_FAILURE != parse_count)
+	{
+		mBytesParsed = mCur - mBegin;
+	}
+
+	mVisitor = nullptr;
+	return parse_count;
+}
+
+S32 LLSDBufferParser::parse(const char* buf, size_t len, EFormat format, LLSD& data, S32 max_depth)
+{
+	LLSD result;
+	LLSDBuilder builder(result, FORMAT_BINARY != format);
+
+	S32 parse_count = parse(buf, len, format, builder, max_depth);
+	data = (LLSDParser::PARSE_FAILURE != parse_count) ? result : LLSD();
+	return parse_count;
+}
+
+const LLSD::String& LLSDBufferParser::internKey(const char* key, size_t len)
+{
+	// FNV-1a
+	U32 hash = 2166136261U;
+	for (size_t idx = 0; idx < len; idx++)
+	{
+		hash = (hash ^ (U8)key[idx]) * 16777619U;
+	}
+
+	LLSD::String& cached_key = mKeyCache[hash & (KEY_CACHE_SIZE - 1)];
+	if ( (cached_key.size() != len) || (0 != memcmp(cached_key.data(), key, len)) )
+	{
+		cached_key.assign(key, len);
+	}
+	return cached_key;
+}
+
+/**
+ * Binary
+ */
+S32 LLSDBufferParser::parseBinaryValue(S32 max_depth)
+{
+	if ( (mCur >= mEnd) || (0 == max_depth) )
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+
+	S32 parse_count = 1;
+	bool success = true;
+	switch (*mCur++)
+	{
+		case '{':
+		{
+			S32 size = 0;
+			success = (readBinarySize(size)) && (mVisitor->beginMap(size));
+			for (S32 idx = 0; (success) && (idx < size); idx++)
+			{
+				const char* key = nullptr;
+				S32 key_len = 0;
+				success = (mCur < mEnd) && ('k' == *mCur++) && (readBinaryString(key, key_len)) && (mVisitor->mapKey(internKey(key, key_len)));
+				if (success)
+				{
+					// Every key needs a value
+					const S32 child_count = parseBinaryValue(max_depth - 1);
+					success = (child_count > 0);
+					parse_count += child_count;
+				}
+			}
+			success = (success) && (mCur < mEnd) && ('}' == *mCur++) && (mVisitor->endMap());
+			break;
+		}
+
+		case '[':
+		{
+			S32 size = 0;
+			success = (readBinarySize(size)) && (mVisitor->beginArray(size));
+			for (S32 idx = 0; (success) && (idx < size); idx++)
+			{
+				// An early ']' means fewer values than announced
+				const S32 child_count = ( (mCur < mEnd) && (']' != *mCur) ) ? parseBinaryValue(max_depth - 1) : LLSDParser::PARSE_FAILURE;
+				success = (child_count > 0);
+				parse_count += child_count;
+			}
+			success = (success) && (mCur < mEnd) && (']' == *mCur++) && (mVisitor->endArray());
+			break;
+		}
+
+		case '!':
+			success = mVisitor->undefValue();
+			break;
+
+		case '0':
+			success = mVisitor->booleanValue(false);
+			break;
+
+		case '1':
+			success = mVisitor->booleanValue(true);
+			break;
+
+		case 'i':
+			if (mEnd - mCur >= 4)
+			{
+				const S32 value = (S32)read_u32_nbo(mCur);
+				mCur += 4;
+				success = mVisitor->integerValue(value);
+			}
+			else
+			{
+				success = false;
+			}
+			break;
+
+		case 'r':
+			if (mEnd - mCur >= 8)
+			{
+				const U64 bits = ((U64)read_u32_nbo(mCur) << 32) | read_u32_nbo(mCur + 4);
+				F64 real;
+				memcpy(&real, &bits, sizeof(F64));
+				mCur += 8;
+				success = mVisitor->realValue(real);
+			}
+			else
+			{
+				success = false;
+			}
+			break;
+
+		case 'u':
+			if (mEnd - mCur >= UUID_BYTES)
+			{
+				LLUUID id;
+				memcpy(id.mData, mCur, UUID_BYTES);
+				mCur += UUID_BYTES;
+				success = mVisitor->uuidValue(id);
+			}
+			else
+			{
+				success = false;
+			}
+			break;
+
+		case 's':
+		{
+			const char* str = nullptr;
+			S32 len = 0;
+			success = (readBinaryString(str, len)) && (mVisitor->stringValue(str, len));
+			break;
+		}
+
+		case 'l':
+		{
+			const char* str = nullptr;
+			S32 len = 0;
+			success = (readBinaryString(str, len)) && (mVisitor->uriValue(LLURI(std::string(str, len))));
+			break;
+		}
+
+		case 'd':
+			if (mEnd - mCur >= 8)
+			{
+				// Dates are written in host byte order
+				F64 seconds;
+				memcpy(&seconds, mCur, sizeof(F64));
+				mCur += 8;
+				success = mVisitor->dateValue(LLDate(seconds));
+			}
+			else
+			{
+				success = false;
+			}
+			break;
+
+		case 'b':
+		{
+			S32 size = 0;
+			success = (mEnd - mCur >= 4);
+			if (success)
+			{
+				size = (S32)read_u32_nbo(mCur);
+				mCur += 4;
+				success = (size <= mEnd - mCur);
+			}
+			if (success)
+			{
+				// Negative sizes read as empty
+				size = llmax(size, 0);
+				mCur += size;
+				success = mVisitor->binaryValue(reinterpret_cast<const U8*>(mCur - size), size);
+			}
+			break;
+		}
+
+		default:
+			// Includes notation style strings which are left to the stream parser
+			success = false;
+			break;
+	}
+	return (success) ? parse_count : LLSDParser::PARSE_FAILURE;
+}
+
+bool LLSDBufferParser::readBinarySize(S32& size)
+{
+	if (mEnd - mCur < 4)
+	{
+		return false;
+	}
+	size = (S32)read_u32_nbo(mCur);
+	mCur += 4;
+
+	// Every entry takes up at least a byte so don't take a corrupt size at its word
+	return size <= mEnd - mCur;
+}
+
+bool LLSDBufferParser::readBinaryString(const char*& str, S32& len)
+{
+	if (mEnd - mCur < 4)
+	{
+		return false;
+	}
+	len = (S32)read_u32_nbo(mCur);
+	mCur += 4;
+	if ( (len < 0) || (len > mEnd - mCur) )
+	{
+		return false;
+	}
+	str = mCur;
+	mCur += len;
+	return true;
+}
+
+/**
+ * XML
+ */
+S32 LLSDBufferParser::parseXMLDocument(S32 max_depth)
+{
+	// Byte order mark
+	if ( (mEnd - mCur >= 3) && (!memcmp(mCur, "\xEF\xBB\xBF", 3)) )
+	{
+		mCur += 3;
+	}
+
+	if ( (!skipXMLMisc()) || (mEnd - mCur < 6) || (memcmp(mCur, "<llsd", 5)) || ((mCur[5] != '>') && (!is_xml_space(mCur[5]))) )
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	mCur += 5;
+
+	// Attributes on <llsd> don't matter
+	bool self_closing = false;
+	if ( (!readXMLAttributes(nullptr, nullptr, self_closing)) || (self_closing) || (!skipXMLMisc()) )
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+
+	// Exactly one value followed by </llsd> (nothing after that is looked at)
+	const S32 parse_count = parseXMLValue(max_depth);
+	if ( (LLSDParser::PARSE_FAILURE == parse_count) || (!skipXMLMisc()) || (!readXMLEndTag("llsd", 4)) )
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	return parse_count;
+}
+
+S32 LLSDBufferParser::parseXMLValue(S32 max_depth)
+{
+	if ( (mCur >= mEnd) || ('<' != *mCur) || (0 == max_depth) )
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+
+	const char* name = ++mCur;
+	while ( (mCur < mEnd) && (is_xml_name_char(*mCur)) )
+	{
+		mCur++;
+	}
+	const size_t name_len = mCur - name;
+	const EXMLElement element = get_xml_element(name, name_len);
+
+	const char* encoding = nullptr;
+	size_t encoding_len = 0;
+	bool self_closing = false;
+	if ( (XML_UNKNOWN == element) || (!readXMLAttributes(&encoding, &encoding_len, self_closing)) )
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+
+	S32 parse_count = 1;
+	bool success = true;
+	switch (element)
+	{
+		case XML_MAP:
+			success = mVisitor->beginMap(-1);
+			while ( (success) && (!self_closing) )
+			{
+				success = skipXMLMisc();
+				if ( (success) && (mEnd - mCur >= 2) && ('<' == mCur[0]) && ('/' == mCur[1]) )
+				{
+					success = readXMLEndTag("map", 3);
+					break;
+				}
+
+				// Keys need to be non-empty and directly followed by their value
+				const char* key = nullptr;
+				size_t key_len = 0;
+				success = (success) && (mEnd - mCur >= 5) && (!memcmp(mCur, "<key>", 5));
+				if (success)
+				{
+					mCur += 5;
+					success = (readXMLText(key, key_len)) && (key_len > 0) && (readXMLEndTag("key", 3)) &&
+						(mVisitor->mapKey(internKey(key, key_len))) && (skipXMLMisc());
+				}
+				if (success)
+				{
+					const S32 child_count = parseXMLValue(max_depth - 1);
+					success = (LLSDParser::PARSE_FAILURE != child_count);
+					parse_count += child_count;
+				}
+			}
+			success = (success) && (mVisitor->endMap());
+			break;
+
+		case XML_ARRAY:
+			success = mVisitor->beginArray(-1);
+			while ( (success) && (!self_closing) )
+			{
+				success = skipXMLMisc();
+				if ( (success) && (mEnd - mCur >= 2) && ('<' == mCur[0]) && ('/' == mCur[1]) )
+				{
+					success = readXMLEndTag("array", 5);
+					break;
+				}
+
+				if (success)
+				{
+					const S32 child_count = parseXMLValue(max_depth - 1);
+					success = (LLSDParser::PARSE_FAILURE != child_count);
+					parse_count += child_count;
+				}
+			}
+			success = (success) && (mVisitor->endArray());
+			break;
+
+		default:
+		{
+			const char* text = "";
+			size_t text_len = 0;
+			if (!self_closing)
+			{
+				success = (readXMLText(text, text_len)) && (readXMLEndTag(name, name_len));
+				if (!success)
+				{
+					break;
+				}
+			}
+
+			// Conversions match the ones LLSDXMLParser makes
+			switch (element)
+			{
+				case XML_UNDEF:
+					success = mVisitor->undefValue();
+					break;
+
+				case XML_BOOLEAN:
+					success = mVisitor->booleanValue( ((4 == text_len) && (!memcmp(text, "true", 4))) || ((1 == text_len) && ('1' == *text)) );
+					break;
+
+				case XML_INTEGER:
+				{
+					// Plain decimal numbers (almost all of them) don't need to go through sscanf
+					const bool negative = (text_len > 0) && ('-' == *text);
+					S32 value = 0;
+					size_t idx = (negative) ? 1 : 0;
+					bool simple = (text_len > idx) && (text_len - idx <= 9);
+					for (; (simple) && (idx < text_len); idx++)
+					{
+						simple = (text[idx] >= '0') && (text[idx] <= '9');
+						value = value * 10 + (text[idx] - '0');
+					}
+
+					if (!simple)
+					{
+						mTextScratch.assign(text, text_len);
+						if (sscanf(mTextScratch.c_str(), "%d", &value) != 1)
+						{
+							value = LLSD(mTextScratch).asInteger();
+						}
+					}
+					else if (negative)
+					{
+						value = -value;
+					}
+					success = mVisitor->integerValue(value);
+					break;
+				}
+
+				case XML_REAL:
+					mTextScratch.assign(text, text_len);
+					success = mVisitor->realValue(LLSD(mTextScratch).asReal());
+					break;
+
+				case XML_STRING:
+					success = mVisitor->stringValue(text, text_len);
+					break;
+
+				case XML_UUID:
+					mTextScratch.assign(text, text_len);
+					success = mVisitor->uuidValue(LLUUID(mTextScratch));
+					break;
+
+				case XML_DATE:
+					mTextScratch.assign(text, text_len);
+					success = mVisitor->dateValue(LLDate(mTextScratch));
+					break;
+
+				case XML_URI:
+					mTextScratch.assign(text, text_len);
+					success = mVisitor->uriValue(LLURI(mTextScratch));
+					break;
+
+				case XML_BINARY:
+				{
+					// The stream parser skips binary values in other encodings
+					success = (!encoding) || ((6 == encoding_len) && (!memcmp(encoding, "base64", 6)));
+					if (success)
+					{
+						// Base64 written by other tools can be wrapped so strip all whitespace
+						mTextScratch.clear();
+						for (size_t idx = 0; idx < text_len; idx++)
+						{
+							if (!isspace((U8)text[idx]))
+							{
+								mTextScratch += text[idx];
+							}
+						}
+
+						std::vector<U8> data(apr_base64_decode_len(mTextScratch.c_str()));
+						data.resize(apr_base64_decode_binary(data.data(), mTextScratch.c_str()));
+						success = mVisitor->binaryValue(data.data(), data.size());
+					}
+					break;
+				}
+
+				default:
+					success = false;
+					break;
+			}
+			break;
+		}
+	}
+	return (success) ? parse_count : LLSDParser::PARSE_FAILURE;
+}
+
+bool LLSDBufferParser::readXMLAttributes(const char** encoding, size_t* encoding_len, bool& self_closing)
+{
+	while (mCur < mEnd)
+	{
+		const char* attr_start = mCur;
+		while ( (mCur < mEnd) && (is_xml_space(*mCur)) )
+		{
+			mCur++;
+		}
+		if (mCur >= mEnd)
+		{
+			break;
+		}
+
+		if ('>' == *mCur)
+		{
+			mCur++;
+			self_closing = false;
+			return true;
+		}
+		if ( ('/' == *mCur) && (mCur + 1 < mEnd) && ('>' == mCur[1]) )
+		{
+			mCur += 2;
+			self_closing = true;
+			return true;
+		}
+
+		// Attributes have to be separated by whitespace
+		const char* name = mCur;
+		while ( (mCur < mEnd) && (is_xml_name_char(*mCur)) )
+		{
+			mCur++;
+		}
+		const size_t name_len = mCur - name;
+		if ( (attr_start == name) || (0 == name_len) )
+		{
+			return false;
+		}
+
+		while ( (mCur < mEnd) && (is_xml_space(*mCur)) )
+		{
+			mCur++;
+		}
+		if ( (mCur >= mEnd) || ('=' != *mCur++) )
+		{
+			return false;
+		}
+		while ( (mCur < mEnd) && (is_xml_space(*mCur)) )
+		{
+			mCur++;
+		}
+		if ( (mCur >= mEnd) || (('"' != *mCur) && ('\'' != *mCur)) )
+		{
+			return false;
+		}
+
+		// Attribute values needing any kind of normalization are left to the stream parser
+		const char quote = *mCur++;
+		const char* value = mCur;
+		while ( (mCur < mEnd) && (quote != *mCur) )
+		{
+			if ( ('<' == *mCur) || ('&' == *mCur) || ((U8)*mCur < 0x20) || ((U8)*mCur >= 0x80) )
+			{
+				return false;
+			}
+			mCur++;
+		}
+		if (mCur >= mEnd)
+		{
+			return false;
+		}
+
+		if ( (encoding) && (8 == name_len) && (!memcmp(name, "encoding", 8)) )
+		{
+			*encoding = value;
+			*encoding_len = mCur - value;
+		}
+		mCur++;
+	}
+	return false;
+}
+
+bool LLSDBufferParser::readXMLText(const char*& text, size_t& len)
+{
+	// Character data is handed out straight from the buffer unless it contains references or carriage returns
+	const char* run_start = mCur;
+	bool decoded = false;
+	while (true)
+	{
+		mCur = scan_xml_text(mCur, mEnd);
+		if (mCur >= mEnd)
+		{
+			return false;
+		}
+
+		const U8 c = *mCur;
+		if ('<' == c)
+		{
+			break;
+		}
+		else if ( ('\t' == c) || ('\n' == c) )
+		{
+			mCur++;
+			continue;
+		}
+		else if (c >= 0x80)
+		{
+			if (!skip_utf8_char(mCur, mEnd))
+			{
+				return false;
+			}
+			continue;
+		}
+		else if ( ('&' != c) && ('\r' != c) )
+		{
+			// Control characters aren't allowed in XML
+			return false;
+		}
+
+		if (!decoded)
+		{
+			mScratch.clear();
+			decoded = true;
+		}
+		mScratch.append(run_start, mCur);
+
+		if ('\r' == c)
+		{
+			// Line ends are normalized to a single line feed
+			mScratch += '\n';
+			mCur += ( (mCur + 1 < mEnd) && ('\n' == mCur[1]) ) ? 2 : 1;
+		}
+		else if (!decode_xml_entity(mCur, mEnd, mScratch))
+		{
+			return false;
+		}
+		run_start = mCur;
+	}
+
+	if (decoded)
+	{
+		mScratch.append(run_start, mCur);
+		text = mScratch.data();
+		len = mScratch.size();
+	}
+	else
+	{
+		text = run_start;
+		len = mCur - run_start;
+	}
+	return true;
+}
+
+bool LLSDBufferParser::readXMLEndTag(const char* name, size_t name_len)
+{
+	if ( (mEnd - mCur < (S32)name_len + 3) || ('<' != mCur[0]) || ('/' != mCur[1]) || (memcmp(mCur + 2, name, name_len)) )
+	{
+		return false;
+	}
+	mCur += name_len + 2;
+
+	while ( (mCur < mEnd) && (is_xml_space(*mCur)) )
+	{
+		mCur++;
+	}
+	return (mCur < mEnd) && ('>' == *mCur++);
+}
+
+bool LLSDBufferParser::skipXMLMisc()
+{
+	while (mCur < mEnd)
+	{
+		if (is_xml_space(*mCur))
+		{
+			mCur++;
+		}
+		else if ( (mEnd - mCur >= 4) && (!memcmp(mCur, "<!--", 4)) )
+		{
+			// "--" can only appear as part of the closing "-->"
+			const char* end = mCur + 4;
+			while ( (end + 1 < mEnd) && (('-' != end[0]) || ('-' != end[1])) )
+			{
+				end++;
+			}
+			if ( (end + 2 >= mEnd) || ('>' != end[2]) )
+			{
+				return false;
+			}
+			mCur = end + 3;
+		}
+		else if ( (mEnd - mCur >= 2) && ('<' == mCur[0]) && ('?' == mCur[1]) )
+		{
+			// Processing instructions, with the XML declaration only allowed at the very start
+			const char* target = mCur + 2;
+			if ( (target >= mEnd) || (!is_xml_name_char(*target)) || ('-' == *target) || ('.' == *target) || ((*target >= '0') && (*target <= '9')) )
+			{
+				// Not a valid target (which also rules out the "<? LLSD/XML ?>" header)
+				return false;
+			}
+			const bool reserved = (mEnd - target >= 3) && (!strncasecmp(target, "xml", 3));
+			const bool at_start = (mCur == mBegin) || ((mCur - mBegin == 3) && (!memcmp(mBegin, "\xEF\xBB\xBF", 3)));
+			if ( (reserved) && ((!at_start) || (memcmp(target, "xml", 3)) || (mEnd - target < 4) || (!is_xml_space(target[3]))) )
+			{
+				return false;
+			}
+
+			const char* end = target;
+			while ( (end + 1 < mEnd) && (('?' != end[0]) || ('>' != end[1])) )
+			{
+				end++;
+			}
+			if (end + 1 >= mEnd)
+			{
+				return false;
+			}
+			mCur = end + 2;
+		}
+		else
+		{
+			break;
+		}
+	}
+	return true;
+}
+
+/**
+ * LLSDSerialize
+ */
+
+// static
+bool LLSDSerialize::deserialize(LLSD& sd, const char* buf, size_t len)
+{
+	// The header has to be on a line of its own for the stream version to consume exactly the same bytes
+	const char* body = nullptr;
+	bool is_binary = false;
+	for (const char* header : { BINARY_HEADER, XML_HEADER })
+	{
+		const size_t header_len = strlen(header);
+		if ( (len > header_len) && (!memcmp(buf, header, header_len)) )
+		{
+			body = buf + header_len;
+			if ( (body < buf + len) && ('\r' == *body) )
+			{
+				body++;
+			}
+			if ( (body < buf + len) && ('\n' == *body) )
+			{
+				is_binary = (BINARY_HEADER == header);
+				break;
+			}
+			body = nullptr;
+		}
+	}
+
+	if (body)
+	{
+		while ( (body < buf + len) && (isspace((U8)*body)) )
+		{
+			body++;
+		}
+
+		// Like the stream version this succeeds as long as the header was recognized
+		const size_t body_len = buf + len - body;
+		if (is_binary)
+			fromBinary(sd, body, body_len);
+		else
+			fromXML(sd, body, body_len);
+		return true;
+	}
+
+	LLMemoryStream str(reinterpret_cast<const U8*>(buf), (S32)len);
+	return deserialize(sd, str, (S32)len);
+}
+
+// static
+S32 LLSDSerialize::fromXML(LLSD& sd, const char* buf, size_t len, bool emit_errors)
+{
+	LLSDBufferParser parser;
+	const S32 parse_count = parser.parse(buf, len, LLSDBufferParser::FORMAT_XML, sd);
+	if (LLSDParser::PARSE_FAILURE != parse_count)
+	{
+		return parse_count;
+	}
+
+	// Anything the buffer parser doesn't handle (or considers malformed) gets the stream parser's treatment
+	LLMemoryStream str(reinterpret_cast<const U8*>(buf), (S32)len);
+	return fromXML(sd, str, emit_errors);
+}
+
+// static
+S32 LLSDSerialize::fromBinary(LLSD& sd, const char* buf, size_t len, S32 max_depth, size_t* bytes_parsed)
+{
+	LLSDBufferParser parser;
+	S32 parse_count = parser.parse(buf, len, LLSDBufferParser::FORMAT_BINARY, sd, max_depth);
+	if (LLSDParser::PARSE_FAILURE != parse_count)
+	{
+		if (bytes_parsed)
+		{
+			*bytes_parsed = parser.getBytesParsed();
+		}
+		return parse_count;
+	}
+
+	// Anything the buffer parser doesn't handle (or considers malformed) gets the stream parser's treatment
+	LLMemoryStream str(reinterpret_cast<const U8*>(buf), (S32)len);
+	parse_count = fromBinary(sd, str, (S32)len, max_depth);
+	if (bytes_parsed)
+	{
+		const std::streamoff pos = str.tellg();
+		*bytes_parsed = (pos >= 0) ? (size_t)pos : len;
+	}
+	return parse_count;
+}
@@ -87,6 +87,52 @@ U8 hex_as_nybble(char hex)
 	return 0; // uh - oh, not hex any more...
 }
 
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+void dict_sort_key(const std::string& str, std::string& key)
+{
+	// compareDict() subtracts (signed) chars so flipping the sign bit gives the same order when compared as unsigned bytes
+	const char SIGN_FLIP = (char)0x80;
+
+	key.clear();
+	key.reserve(str.size() * 2 + 8);
+
+	// Primary key: case folded characters with every run of digits prefixed by its length (longer numbers sort after shorter ones)
+	for (const char* ptr = str.c_str(); *ptr; )
+	{
+		const char ch = *ptr;
+		if (LLStringOps::isDigit(ch))
+		{
+			U32 len = 1;
+			while (LLStringOps::isDigit(ptr[len]))
+			{
+				len++;
+			}
+			// Any digit works as the run's marker since compareDict() only compares digits against non-digits at that point
+			key += '0' ^ SIGN_FLIP;
+			key += (char)(len >> 24); key += (char)(len >> 16); key += (char)(len >> 8); key += (char)len;
+			for (U32 idx = 0; idx < len; idx++)
+			{
+				key += ptr[idx] ^ SIGN_FLIP;
+			}
+			ptr += len;
+		}
+		else
+		{
+			key += ((LLStringOps::isUpper(ch)) ? LLStringOps::toLower(ch) : ch) ^ SIGN_FLIP;
+			ptr++;
+		}
+	}
+	// compareDict() compares the end of the shorter string as a zero char
+	key += SIGN_FLIP;
+
+	// Secondary key: when the folded strings are equal the first character that is only upper case in one of them decides
+	for (const char* ptr = str.c_str(); *ptr; ptr++)
+	{
+		key += (LLStringOps::isUpper(*ptr)) ? '\0' : '\1';
+	}
+}
+// [/SL:KB]
+
 bool iswindividual(llwchar elem)
 {   
 	U32 cur_char = (U32)elem;
@@ -470,6 +470,16 @@ struct LLDictionaryLess
 	}
 };
 
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+/**
+ * @brief Builds a key whose byte-wise order (std::string::compare) is the order of LLStringUtil::compareDict().
+ *
+ * Strings that get compared over and over (e.g. names when sorting folder views) only pay for the case folding and
+ * number handling once and every comparison after that is a plain memcmp.
+ */
+LL_COMMON_API void dict_sort_key(const std::string& str, std::string& key);
+// [/SL:KB]
+
 
 /**
  * Simple support functions
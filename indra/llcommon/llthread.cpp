@@ -34,6 +34,12 @@
 #include "lltimer.h"
 #include "lltrace.h"
 #include "lltracethreadrecorder.h"
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+#include "llfasttimertrace.h"
+// [/SL:KB]
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+#include "llarena.h"
+// [/SL:KB]
 #include "llexception.h"
 
 #if LL_LINUX || LL_SOLARIS
@@ -140,6 +146,9 @@ void LLThread::threadRun()
 
     // for now, hard code all LLThreads to report to single master thread recorder, which is known to be running on main thread
     mRecorder = new LLTrace::ThreadRecorder(*LLTrace::get_master_thread_recorder());
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+    LLTrace::BlockTimerTrace::setThreadName(mName);
+// [/SL:KB]
 
     // Run the user supplied function
     do 
@@ -167,6 +176,12 @@ void LLThread::threadRun()
 
     delete mRecorder;
     mRecorder = NULL;
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+    LLTrace::BlockTimerTrace::releaseThread();
+// [/SL:KB]
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+    LLArena::releaseThreadArena();
+// [/SL:KB]
 
     // We're done with the run function, this thread is done executing now.
     //NB: we are using this flag to sync across threads...we really need memory barriers here
@@ -34,8 +34,12 @@
 //============================================================================
 // Run on MAIN thread
 
-LLWorkerThread::LLWorkerThread(const std::string& name, bool threaded, bool should_pause) :
-	LLQueuedThread(name, threaded, should_pause),
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+LLWorkerThread::LLWorkerThread(const std::string& name, bool threaded, bool should_pause, bool use_job_system) :
+	LLQueuedThread(name, threaded, should_pause, use_job_system),
+// [/SL:KB]
+//LLWorkerThread::LLWorkerThread(const std::string& name, bool threaded, bool should_pause) :
+//	LLQueuedThread(name, threaded, should_pause),
 // [SL:KB] - Patch: Viewer-OptimizationThreadLock | Checked: Catznip-6.0
 	mDeleteCount(0)
 // [/SL:KB]
@@ -88,7 +88,10 @@ class LL_COMMON_API LLWorkerThread : public LLQueuedThread
 	LLMutex* mDeleteMutex;
 	
 public:
-	LLWorkerThread(const std::string& name, bool threaded = true, bool should_pause = false);
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	LLWorkerThread(const std::string& name, bool threaded = true, bool should_pause = false, bool use_job_system = false);
+// [/SL:KB]
+//	LLWorkerThread(const std::string& name, bool threaded = true, bool should_pause = false);
 	~LLWorkerThread();
 
 	/*virtual*/ S32 update(F32 max_time_ms);
@@ -0,0 +1,124 @@
+/**
+ * @file llarena_test.cpp
+ * @brief LLArena test cases.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llarena.h"
+
+#include <map>
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct arena
+	{
+	};
+
+	typedef test_group<arena> arena_t;
+	typedef arena_t::object arena_object_t;
+	tut::arena_t tut_singleton("LLArena");
+
+	template<> template<>
+	void arena_object_t::test<1>()
+	{
+		set_test_name("allocations are aligned and don't overlap");
+
+		LLArena arena(1024);
+		U8* firstp = static_cast<U8*>(arena.allocate(3));
+		U8* secondp = static_cast<U8*>(arena.allocate(100, 64));
+		memset(firstp, 1, 3);
+		memset(secondp, 2, 100);
+
+		ensure_equals("alignment", (uintptr_t)secondp % 64, (uintptr_t)0);
+		ensure("no overlap", secondp >= firstp + 3);
+		ensure_equals("first intact", (S32)firstp[2], 1);
+		ensure_equals("reserved", arena.getBytesReserved(), (size_t)1024);
+	}
+
+	template<> template<>
+	void arena_object_t::test<2>()
+	{
+		set_test_name("rewinding reuses memory and frees oversized blocks");
+
+		LLArena arena(1024);
+		arena.allocate(16);
+		const LLArena::Marker marker = arena.getMarker();
+		const size_t used = arena.getBytesUsed();
+
+		void* firstp = arena.allocate(900);
+		arena.allocate(900);			// second regular block
+		arena.allocate(8192);			// dedicated block
+		ensure_equals("reserved", arena.getBytesReserved(), (size_t)(2 * 1024 + 8192 + LLArena::DEFAULT_ALIGNMENT));
+
+		arena.rewind(marker);
+		ensure_equals("used", arena.getBytesUsed(), used);
+		ensure_equals("oversized freed", arena.getBytesReserved(), (size_t)(2 * 1024));
+		ensure("reused", firstp == arena.allocate(900));
+
+		arena.reset();
+		ensure_equals("empty", arena.getBytesUsed(), (size_t)0);
+		ensure_equals("retained", arena.getBytesReserved(), (size_t)(2 * 1024));
+	}
+
+	template<> template<>
+	void arena_object_t::test<3>()
+	{
+		set_test_name("scopes, buffers and allocators");
+
+		LLArena& arena = LLArena::getThreadArena();
+		const size_t used = arena.getBytesUsed();
+		{
+			LLArenaBuffer<U8> buffer(256);
+			buffer[255] = 42;
+			ensure("buffer used", arena.getBytesUsed() >= used + 256);
+			{
+				LLArena::Scope scope;
+				scope.allocate(4096);
+			}
+			ensure("inner scope rewound", arena.getBytesUsed() < used + 4096);
+			ensure_equals("buffer intact", (S32)buffer[255], 42);
+		}
+		ensure_equals("outer scope rewound", arena.getBytesUsed(), used);
+
+		LLArena map_arena;
+		typedef std::map<S32, S32, std::less<S32>, LLArenaAllocator<std::pair<const S32, S32> > > arena_map_t;
+		{
+			arena_map_t arena_map((arena_map_t::allocator_type(&map_arena)));
+			arena_map_t heap_map;
+			for (S32 idx = 0; idx < 100; idx++)
+			{
+				arena_map[idx] = idx;
+				heap_map[idx] = idx;
+			}
+			ensure_equals("arena map", arena_map[50], 50);
+			ensure_equals("heap map", heap_map[50], 50);
+			ensure("arena used", map_arena.getBytesUsed() > 0);
+		}
+		map_arena.reset();
+		ensure_equals("arena reset", map_arena.getBytesUsed(), (size_t)0);
+	}
+}
@@ -0,0 +1,110 @@
+/**
+ * @file llasyncfileio_test.cpp
+ * @brief LLAsyncFileIO test cases.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llasyncfileio.h"
+#include "lltimer.h"
+
+#include <atomic>
+#include <vector>
+
+#include "../test/lltut.h"
+#include "../test/namedtempfile.h"
+
+namespace tut
+{
+	struct asyncfileio
+	{
+		asyncfileio()
+			: mFile("bin", "")
+		{
+		}
+
+		~asyncfileio()
+		{
+			LLAsyncFileIO::cleanupClass();
+		}
+
+		NamedTempFile mFile;
+	};
+
+	typedef test_group<asyncfileio> asyncfileio_t;
+	typedef asyncfileio_t::object asyncfileio_object_t;
+	tut::asyncfileio_t tut_singleton("LLAsyncFileIO");
+
+	template<> template<>
+	void asyncfileio_object_t::test<1>()
+	{
+		set_test_name("operations run inline without I/O threads");
+
+		const std::string data("0123456789");
+		S32 result = -2;
+		LLAsyncFileIO::write(mFile.getName(), (const U8*)data.data(), 0, (S32)data.size(), [&result](S32 bytes) { result = bytes; }, true);
+		ensure_equals("written", result, (S32)data.size());
+		ensure_equals("appended", LLAsyncFileIO::writeAndSuspend(mFile.getName(), (const U8*)"ab", -1, 2), 2);
+		ensure_equals("synced", LLAsyncFileIO::fsyncAndSuspend(mFile.getName()), 0);
+
+		char buffer[32] = {};
+		ensure_equals("read past end", LLAsyncFileIO::readAndSuspend(mFile.getName(), (U8*)buffer, 8, sizeof(buffer)), 4);
+		ensure_equals("read data", std::string(buffer), std::string("89ab"));
+		ensure_equals("missing file", LLAsyncFileIO::readAndSuspend(mFile.getName() + ".missing", (U8*)buffer, 0, 1), -1);
+	}
+
+	template<> template<>
+	void asyncfileio_object_t::test<2>()
+	{
+		set_test_name("many writes in flight on the I/O threads");
+
+		LLAsyncFileIO::initClass(3);
+
+		const S32 CHUNK_COUNT = 64, CHUNK_SIZE = 256;
+		std::vector<U8> data(CHUNK_COUNT * CHUNK_SIZE);
+		for (size_t idx = 0; idx < data.size(); idx++)
+		{
+			data[idx] = (U8)(idx * 7);
+		}
+
+		std::atomic<S32> done(0), failed(0);
+		for (S32 chunk = 0; chunk < CHUNK_COUNT; chunk++)
+		{
+			LLAsyncFileIO::write(mFile.getName(), &data[chunk * CHUNK_SIZE], chunk * CHUNK_SIZE, CHUNK_SIZE,
+				[&done, &failed](S32 bytes) { if (CHUNK_SIZE != bytes) failed++; done++; });
+		}
+		for (S32 wait = 0; (done < CHUNK_COUNT) && (wait < 10000); wait++)
+		{
+			ms_sleep(1);
+		}
+		ensure_equals("completed", (S32)done, CHUNK_COUNT);
+		ensure_equals("failed", (S32)failed, 0);
+		ensure_equals("pending", LLAsyncFileIO::getInstance()->getPending(), 0);
+
+		// Suspends until an I/O thread has read the file back
+		std::vector<U8> readback(data.size());
+		ensure_equals("read", LLAsyncFileIO::readAndSuspend(mFile.getName(), &readback[0], 0, (S32)readback.size()), (S32)readback.size());
+		ensure("contents", readback == data);
+	}
+}
@@ -0,0 +1,166 @@
+/**
+ * @file llfasttimertrace_test.cpp
+ * @brief LLTrace::BlockTimerTrace test cases.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llfasttimer.h"
+#include "../llfasttimertrace.h"
+#include "../lltracethreadrecorder.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	using namespace LLTrace;
+
+	static BlockTimerStatHandle sTraceOuter("trace_outer");
+	static BlockTimerStatHandle sTraceInner("trace_inner");
+
+	struct fasttimertrace
+	{
+		fasttimertrace()
+		{
+			// Every test starts out with an empty buffer for the calling thread
+			BlockTimerTrace::releaseThread();
+			BlockTimerTrace::setThreadName("Test \"thread\"");
+		}
+
+		~fasttimertrace()
+		{
+			BlockTimerTrace::setEnabled(false);
+			BlockTimerTrace::releaseThread();
+		}
+
+		std::string getTrace()
+		{
+			std::ostringstream str;
+			BlockTimerTrace::writeChromeTrace(str);
+			return str.str();
+		}
+
+		static S32 countOf(const std::string& str, const std::string& needle)
+		{
+			S32 count = 0;
+			for (size_t pos = str.find(needle); std::string::npos != pos; pos = str.find(needle, pos + needle.size()))
+			{
+				count++;
+			}
+			return count;
+		}
+
+		ThreadRecorder mRecorder;
+	};
+
+	typedef test_group<fasttimertrace> fasttimertrace_t;
+	typedef fasttimertrace_t::object fasttimertrace_object_t;
+	tut::fasttimertrace_t tut_singleton("LLFastTimerTrace");
+
+	template<> template<>
+	void fasttimertrace_object_t::test<1>()
+	{
+		set_test_name("scopes are only recorded while enabled");
+
+		{
+			LL_RECORD_BLOCK_TIME(sTraceOuter);
+		}
+		ensure_equals("disabled", countOf(getTrace(), "\"ph\":\"X\""), 0);
+
+		BlockTimerTrace::setEnabled(true);
+		{
+			LL_RECORD_BLOCK_TIME(sTraceOuter);
+			{
+				LL_RECORD_BLOCK_TIME(sTraceInner);
+			}
+		}
+		BlockTimerTrace::setEnabled(false);
+		{
+			LL_RECORD_BLOCK_TIME(sTraceInner);
+		}
+
+		const std::string trace = getTrace();
+		ensure_equals("outer", countOf(trace, "\"name\":\"trace_outer\""), 1);
+		ensure_equals("inner", countOf(trace, "\"name\":\"trace_inner\""), 1);
+		ensure("thread name", std::string::npos != trace.find("\"args\":{\"name\":\"Test \\\"thread\\\"\"}"));
+	}
+
+	template<> template<>
+	void fasttimertrace_object_t::test<2>()
+	{
+		set_test_name("full buffers keep the most recent scopes");
+
+		BlockTimerTrace::setEnabled(true);
+		for (U32 idx = 0; idx < BlockTimerTrace::BUFFER_SIZE; idx++)
+		{
+			BlockTimerTrace::record(&sTraceOuter, 1000 + idx, 1001 + idx);
+		}
+		for (U32 idx = 0; idx < 10; idx++)
+		{
+			BlockTimerTrace::record(&sTraceInner, 1000 + BlockTimerTrace::BUFFER_SIZE + idx, 1001 + BlockTimerTrace::BUFFER_SIZE + idx);
+		}
+
+		// The slot of the oldest scope is the one the next scope goes into so it's never part of the trace
+		const std::string trace = getTrace();
+		ensure_equals("total", countOf(trace, "\"ph\":\"X\""), (S32)BlockTimerTrace::BUFFER_SIZE - 1);
+		ensure_equals("newest", countOf(trace, "\"name\":\"trace_inner\""), 10);
+		// The oldest remaining scope is the time base
+		ensure("time base", std::string::npos != trace.find("\"ts\":0.000,"));
+	}
+
+	template<> template<>
+	void fasttimertrace_object_t::test<3>()
+	{
+		set_test_name("snapshots can be limited to the most recent scopes");
+
+		BlockTimerTrace::setEnabled(true);
+		const U64 now = BlockTimer::getCPUClockCount64();
+		const U64 two_secs = 2 * BlockTimer::countsPerSecond();
+		for (U32 idx = 0; idx < 10; idx++)
+		{
+			BlockTimerTrace::record(&sTraceOuter, now - two_secs - 10 + idx, now - two_secs - 9 + idx);
+		}
+		for (U32 idx = 0; idx < 5; idx++)
+		{
+			BlockTimerTrace::record(&sTraceInner, now - 5 + idx, now - 4 + idx);
+		}
+
+		BlockTimerTrace::snapshot_t snapshot;
+		BlockTimerTrace::takeSnapshot(snapshot, 1.0);
+		const BlockTimerTrace::ThreadSnapshot* thread_snapshot = nullptr;
+		for (const BlockTimerTrace::ThreadSnapshot& cur_snapshot : snapshot)
+		{
+			if ("Test \"thread\"" == cur_snapshot.mName)
+				thread_snapshot = &cur_snapshot;
+		}
+		ensure("thread", nullptr != thread_snapshot);
+		ensure_equals("window", thread_snapshot->mEvents.size(), (size_t)5);
+		ensure("newest", &sTraceInner == thread_snapshot->mEvents.front().mTimer);
+
+		std::ostringstream str;
+		BlockTimerTrace::writeChromeTrace(str, snapshot);
+		ensure_equals("written", countOf(str.str(), "\"name\":\"trace_inner\""), 5);
+		ensure_equals("full", countOf(getTrace(), "\"ph\":\"X\""), 15);
+	}
+}
@@ -0,0 +1,148 @@
+/**
+ * @file llinternedstring_test.cpp
+ * @brief LLInternedString test cases.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llinternedstring.h"
+
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct internedstring
+	{
+	};
+
+	typedef test_group<internedstring> internedstring_t;
+	typedef internedstring_t::object internedstring_object_t;
+	tut::internedstring_t tut_singleton("LLInternedString");
+
+	template<> template<>
+	void internedstring_object_t::test<1>()
+	{
+		set_test_name("equal strings share a handle");
+
+		const LLInternedString first("interned_test_name");
+		const LLInternedString second(std::string("interned_test_") + "name");
+		const LLInternedString other("interned_test_other");
+
+		ensure("equal", first == second);
+		ensure("not equal", first != other);
+		ensure_equals("hash", first.hash(), second.hash());
+		ensure_equals("str", second.str(), std::string("interned_test_name"));
+		ensure("same storage", first.c_str() == second.c_str());
+
+		ensure("empty", LLInternedString("").empty());
+		ensure("default", LLInternedString() == LLInternedString(std::string()));
+		ensure_equals("empty str", LLInternedString().str(), std::string());
+
+		std::unordered_map<LLInternedString, S32> map;
+		map[first] = 1;
+		map[other] = 2;
+		ensure_equals("map", map[LLInternedString("interned_test_name")], 1);
+	}
+
+	template<> template<>
+	void internedstring_object_t::test<2>()
+	{
+		set_test_name("find doesn't add strings");
+
+		const size_t count = LLInternedString::getTableSize();
+		ensure("not interned", LLInternedString::find("interned_test_never_added").empty());
+		ensure_equals("table size", LLInternedString::getTableSize(), count);
+
+		const LLInternedString added("interned_test_added");
+		ensure("found", LLInternedString::find(std::string("interned_test_added")) == added);
+		ensure_equals("table size", LLInternedString::getTableSize(), count + 1);
+	}
+
+	template<> template<>
+	void internedstring_object_t::test<3>()
+	{
+		set_test_name("interning from several threads");
+
+		const S32 THREAD_COUNT = 4, STRING_COUNT = 500;
+		std::vector<std::vector<LLInternedString>> results(THREAD_COUNT);
+		std::vector<std::thread> threads;
+		for (S32 thread_idx = 0; thread_idx < THREAD_COUNT; thread_idx++)
+		{
+			threads.emplace_back([&results, thread_idx]()
+				{
+					for (S32 idx = 0; idx < STRING_COUNT; idx++)
+					{
+						results[thread_idx].push_back(LLInternedString(llformat("interned_thread_%d", idx)));
+					}
+				});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		for (S32 idx = 0; idx < STRING_COUNT; idx++)
+		{
+			for (S32 thread_idx = 1; thread_idx < THREAD_COUNT; thread_idx++)
+			{
+				ensure("same handle", results[0][idx] == results[thread_idx][idx]);
+			}
+		}
+	}
+
+	template<> template<>
+	void internedstring_object_t::test<4>()
+	{
+		set_test_name("strings are removed with their last handle");
+
+		const size_t count = LLInternedString::getTableSize();
+		{
+			LLInternedString first("interned_test_transient");
+			ensure_equals("added", LLInternedString::getTableSize(), count + 1);
+			{
+				const LLInternedString copy(first);
+				LLInternedString assigned;
+				assigned = first;
+				const LLInternedString found = LLInternedString::find("interned_test_transient");
+				ensure("found", found == first);
+			}
+			ensure_equals("copies released", LLInternedString::getTableSize(), count + 1);
+
+			LLInternedString moved(std::move(first));
+			ensure("moved from", first.empty());
+			ensure_equals("moved", moved.str(), std::string("interned_test_transient"));
+		}
+		ensure_equals("removed", LLInternedString::getTableSize(), count);
+		ensure("not found", LLInternedString::find("interned_test_transient").empty());
+
+		// Re-interning after removal gives a working handle again
+		const LLInternedString again("interned_test_transient");
+		ensure_equals("re-added", again.str(), std::string("interned_test_transient"));
+		ensure_equals("re-added size", LLInternedString::getTableSize(), count + 1);
+	}
+}
@@ -0,0 +1,253 @@
+/**
+ * @file lljobsystem_test.cpp
+ * @brief LLJobSystem test cases.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lljobsystem.h"
+#include "../llqueuedthread.h"
+#include "../lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <atomic>
+#include <vector>
+
+namespace
+{
+	// Polls for at most five seconds so a broken job system fails the test instead of hanging it
+	template<typename T>
+	bool wait_for(T condition)
+	{
+		LLTimer timer;
+		while (!condition())
+		{
+			if (timer.getElapsedTimeF32() > 5.f)
+			{
+				return false;
+			}
+			ms_sleep(1);
+		}
+		return true;
+	}
+
+	class TestRequest : public LLQueuedThread::QueuedRequest
+	{
+	public:
+		TestRequest(LLQueuedThread::handle_t handle, U32 priority, std::atomic<S32>& count, S32 repeat)
+			: LLQueuedThread::QueuedRequest(handle, priority, LLQueuedThread::FLAG_AUTO_COMPLETE)
+			, mCount(count)
+			, mRepeat(repeat)
+		{
+		}
+
+	protected:
+		bool processRequest() override
+		{
+			// Incomplete requests go back into the queue and get processed again
+			if (--mRepeat > 0)
+			{
+				return false;
+			}
+			mCount++;
+			return true;
+		}
+
+	protected:
+		std::atomic<S32>& mCount;
+		S32 mRepeat;
+	};
+
+	class TestQueue : public LLQueuedThread
+	{
+	public:
+		TestQueue(bool use_job_system)
+			: LLQueuedThread("TestQueue", true, false, use_job_system)
+		{
+		}
+
+		handle_t addTestRequest(std::atomic<S32>& count, U32 priority, S32 repeat = 1)
+		{
+			handle_t handle = generateHandle();
+			addRequest(new TestRequest(handle, priority, count, repeat));
+			return handle;
+		}
+	};
+}
+
+namespace tut
+{
+	struct jobsystem
+	{
+		~jobsystem()
+		{
+			LLJobSystem::cleanupClass();
+		}
+	};
+
+	typedef test_group<jobsystem> jobsystem_t;
+	typedef jobsystem_t::object jobsystem_object_t;
+	tut::jobsystem_t tut_singleton("LLJobSystem");
+
+	template<> template<>
+	void jobsystem_object_t::test<1>()
+	{
+		set_test_name("every posted job runs");
+
+		LLJobSystem::initClass(4);
+		LLJobSystem* job_systemp = LLJobSystem::getInstance();
+		ensure("instance", job_systemp != NULL);
+		ensure_equals("workers", job_systemp->getWorkerCount(), 4);
+
+		std::atomic<S32> count(0);
+		for (S32 idx = 0; idx < 1000; idx++)
+		{
+			job_systemp->post([&count]() { count++; }, (LLJobSystem::EPriority)(idx % LLJobSystem::PRIORITY_COUNT));
+		}
+		// Jobs posted from a job go to the posting worker's own queue
+		job_systemp->post([&count, job_systemp]()
+			{
+				for (S32 idx = 0; idx < 100; idx++)
+				{
+					job_systemp->post([&count]() { count++; });
+				}
+			});
+
+		ensure("all jobs ran", wait_for([&count]() { return 1100 == count; }));
+		ensure("nothing pending", wait_for([job_systemp]() { return 0 == job_systemp->getPending(); }));
+		ensure_equals("not a worker", LLJobSystem::getCurrentWorker(), (S32)LLJobSystem::ANY_WORKER);
+	}
+
+	template<> template<>
+	void jobsystem_object_t::test<2>()
+	{
+		set_test_name("higher priority jobs run first");
+
+		LLJobSystem::initClass(1);
+		LLJobSystem* job_systemp = LLJobSystem::getInstance();
+
+		// Keep the only worker busy until everything is queued up
+		std::atomic<bool> release(false);
+		job_systemp->post([&release]() { wait_for([&release]() { return release.load(); }); });
+
+		std::vector<S32> order;
+		std::atomic<S32> count(0);
+		for (S32 priority : { LLJobSystem::PRIORITY_LOW, LLJobSystem::PRIORITY_NORMAL, LLJobSystem::PRIORITY_HIGH })
+		{
+			job_systemp->post([&order, &count, priority]() { order.push_back(priority); count++; }, (LLJobSystem::EPriority)priority);
+		}
+		release = true;
+
+		ensure("jobs ran", wait_for([&count]() { return 3 == count; }));
+		ensure_equals("high", order[0], (S32)LLJobSystem::PRIORITY_HIGH);
+		ensure_equals("normal", order[1], (S32)LLJobSystem::PRIORITY_NORMAL);
+		ensure_equals("low", order[2], (S32)LLJobSystem::PRIORITY_LOW);
+	}
+
+	template<> template<>
+	void jobsystem_object_t::test<3>()
+	{
+		set_test_name("idle workers steal from busy ones");
+
+		LLJobSystem::initClass(2);
+		LLJobSystem* job_systemp = LLJobSystem::getInstance();
+
+		// Everything is queued on the worker that's stuck on the first job so the other one has to steal the rest
+		std::atomic<bool> release(false);
+		std::atomic<S32> busy_worker(LLJobSystem::ANY_WORKER);
+		job_systemp->post([&release, &busy_worker]()
+			{
+				busy_worker = LLJobSystem::getCurrentWorker();
+				wait_for([&release]() { return release.load(); });
+			});
+		ensure("blocked", wait_for([&busy_worker]() { return LLJobSystem::ANY_WORKER != busy_worker; }));
+
+		std::atomic<S32> count(0);
+		for (S32 idx = 0; idx < 10; idx++)
+		{
+			job_systemp->post([&count]() { count++; }, LLJobSystem::PRIORITY_NORMAL, busy_worker);
+		}
+
+		ensure("stolen jobs ran", wait_for([&count]() { return 10 == count; }));
+		ensure("steal count", job_systemp->getStealCount() >= 10);
+		release = true;
+	}
+
+	template<> template<>
+	void jobsystem_object_t::test<4>()
+	{
+		set_test_name("delayed jobs wait until they're due");
+
+		LLJobSystem::initClass(2);
+		LLJobSystem* job_systemp = LLJobSystem::getInstance();
+
+		LLTimer timer;
+		std::atomic<F32> first_ran(0.f), second_ran(0.f);
+		job_systemp->postDelayed([&timer, &second_ran]() { second_ran = timer.getElapsedTimeF32(); }, 100.f);
+		job_systemp->postDelayed([&timer, &first_ran]() { first_ran = timer.getElapsedTimeF32(); }, 20.f);
+
+		ensure("delayed jobs ran", wait_for([&first_ran, &second_ran]() { return (first_ran > 0.f) && (second_ran > 0.f); }));
+		ensure("first not early", first_ran >= 0.019f);
+		ensure("second not early", second_ran >= 0.099f);
+		ensure("in order", first_ran < second_ran);
+	}
+
+	template<> template<>
+	void jobsystem_object_t::test<5>()
+	{
+		set_test_name("LLQueuedThread requests run as jobs");
+
+		LLJobSystem::initClass(2);
+
+		std::atomic<S32> count(0);
+		{
+			TestQueue queue(true);
+			ensure("job mode", queue.getJobMode());
+
+			for (S32 idx = 0; idx < 50; idx++)
+			{
+				queue.addTestRequest(count, LLQueuedThread::PRIORITY_NORMAL);
+			}
+			// Low priority requests that need a few passes back off between them
+			LLQueuedThread::handle_t handle = queue.addTestRequest(count, LLQueuedThread::PRIORITY_LOW, 3);
+
+			ensure("requests ran", wait_for([&count]() { return 51 == count; }));
+			ensure("auto completed", wait_for([&queue, handle]() { return LLQueuedThread::STATUS_EXPIRED == queue.getRequestStatus(handle); }));
+			ensure_equals("queue empty", queue.getPending(), 0);
+
+			queue.shutdown();
+			ensure("stopped", queue.isStopped());
+		}
+
+		// Without the job system the queue falls back to a thread of its own
+		LLJobSystem::cleanupClass();
+		{
+			TestQueue queue(true);
+			ensure("thread mode", !queue.getJobMode());
+			queue.addTestRequest(count, LLQueuedThread::PRIORITY_NORMAL);
+			ensure("request ran", wait_for([&count]() { return 52 == count; }));
+		}
+	}
+}
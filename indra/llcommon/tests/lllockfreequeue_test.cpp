@@ -0,0 +1,165 @@
+/**
+ * @file lllockfreequeue_test.cpp
+ * @brief LLLockFreeQueue test cases.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lllockfreequeue.h"
+
+#include "../test/lltut.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace tut
+{
+	struct lockfreequeue
+	{
+	};
+
+	typedef test_group<lockfreequeue> lockfreequeue_t;
+	typedef lockfreequeue_t::object lockfreequeue_object_t;
+	tut::lockfreequeue_t tut_singleton("LLLockFreeQueue");
+
+	template<> template<>
+	void lockfreequeue_object_t::test<1>()
+	{
+		set_test_name("first in first out up to capacity");
+
+		// Capacity is rounded up to a power of two
+		LLLockFreeQueue<std::string> queue(3);
+		ensure("push 1", queue.tryPushFront("one"));
+		ensure("push 2", queue.tryPushFront("two"));
+		queue.pushFront("three");
+		ensure("push 4", queue.tryPushFront("four"));
+		ensure("full", !queue.tryPushFront("five"));
+		ensure("timed out", !queue.tryPushFrontFor(std::chrono::milliseconds(10), "five"));
+		ensure_equals("size", queue.size(), 4U);
+
+		std::string value;
+		ensure("pop 1", queue.tryPopBack(value));
+		ensure_equals("value 1", value, "one");
+		ensure_equals("value 2", queue.popBack(), "two");
+		ensure("push after pop", queue.tryPushFront("five"));
+		ensure_equals("value 3", queue.popBack(), "three");
+		ensure_equals("value 4", queue.popBack(), "four");
+		ensure_equals("value 5", queue.popBack(), "five");
+		ensure("empty", !queue.tryPopBack(value));
+		ensure_equals("size", queue.size(), 0U);
+	}
+
+	template<> template<>
+	void lockfreequeue_object_t::test<2>()
+	{
+		set_test_name("closed queues drain and then refuse");
+
+		LLLockFreeQueue<S32> queue(8);
+		queue.pushFront(1);
+		queue.pushFront(2);
+		queue.close();
+
+		ensure("not closed while not drained", bool(queue));
+		ensure("no push after close", !queue.tryPushFront(3));
+		try
+		{
+			queue.pushFront(3);
+			fail("pushFront() on a closed queue should throw");
+		}
+		catch (const LLThreadSafeQueueInterrupt&)
+		{
+		}
+
+		S32 value = 0;
+		ensure("pop 1", queue.tryPopBack(value));
+		ensure_equals("value 1", value, 1);
+		ensure_equals("value 2", queue.popBack(), 2);
+		ensure("closed", queue.isClosed());
+		ensure("drained", !queue.tryPopBack(value));
+		try
+		{
+			queue.popBack();
+			fail("popBack() on a drained closed queue should throw");
+		}
+		catch (const LLThreadSafeQueueInterrupt&)
+		{
+		}
+	}
+
+	template<> template<>
+	void lockfreequeue_object_t::test<3>()
+	{
+		set_test_name("every element arrives exactly once across threads");
+
+		// A small queue so producers and consumers both end up blocking
+		LLLockFreeQueue<U32> queue(16);
+		const U32 NUM_PRODUCERS = 4, NUM_ITEMS = 20000;
+		std::atomic<U64> count(0), sum(0);
+
+		std::vector<std::thread> consumers;
+		for (S32 idx = 0; idx < 2; idx++)
+		{
+			consumers.emplace_back([&queue, &count, &sum]()
+				{
+					try
+					{
+						while (true)
+						{
+							sum += queue.popBack();
+							count++;
+						}
+					}
+					catch (const LLThreadSafeQueueInterrupt&)
+					{
+					}
+				});
+		}
+
+		std::vector<std::thread> producers;
+		for (U32 idx = 0; idx < NUM_PRODUCERS; idx++)
+		{
+			producers.emplace_back([&queue, idx, NUM_ITEMS]()
+				{
+					for (U32 item = 1; item <= NUM_ITEMS; item++)
+					{
+						queue.pushFront(idx * NUM_ITEMS + item);
+					}
+				});
+		}
+		for (std::thread& producer : producers)
+		{
+			producer.join();
+		}
+		queue.close();
+		for (std::thread& consumer : consumers)
+		{
+			consumer.join();
+		}
+
+		const U64 total = NUM_PRODUCERS * NUM_ITEMS;
+		ensure_equals("count", count.load(), total);
+		ensure_equals("sum", sum.load(), total * (total + 1) / 2);
+	}
+}
@@ -0,0 +1,167 @@
+/**
+ * @file llsdlazyview_test.cpp
+ * @brief LLSDLazyView test cases.
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llsd.h"
+#include "../llsdlazyview.h"
+#include "../llsdserialize.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct llsdlazyview_data
+	{
+		llsdlazyview_data()
+		{
+			mSD = LLSD::emptyMap();
+			mSD["version"] = 7;
+			mSD["agent_id"] = LLUUID("d7f4aeca-88f1-42a1-b385-b9db18abb255");
+			mSD["folders"] = LLSD::emptyArray();
+			for (int idx = 0; idx < 3; idx++)
+			{
+				LLSD folder = LLSD::emptyMap();
+				folder["name"] = llformat("Folder <%d>", idx);
+				folder["items"] = LLSD::emptyArray();
+				folder["items"].append(idx);
+				folder["items"].append(LLSD());
+				mSD["folders"].append(folder);
+			}
+		}
+
+		std::string toXML(const LLSD& sd)
+		{
+			std::ostringstream str;
+			LLSDSerialize::toXML(sd, str);
+			return str.str();
+		}
+
+		std::string toBinary(const LLSD& sd)
+		{
+			std::ostringstream str;
+			LLSDSerialize::toBinary(sd, str);
+			return str.str();
+		}
+
+		// Walks the view alongside the LLSD it should match
+		void ensureMatches(const std::string& msg, const LLSDLazyView& view, const LLSD& sd)
+		{
+			ensure_equals(msg + " type", view.type(), sd.type());
+			ensure_equals(msg + " value", view.asLLSD(), sd);
+			if (sd.isMap())
+			{
+				ensure_equals(msg + " size", view.size(), sd.size());
+				S32 idx = 0;
+				for (LLSD::map_const_iterator it = sd.beginMap(); it != sd.endMap(); ++it, ++idx)
+				{
+					ensure_equals(msg + " key", view.keyAt(idx), it->first);
+					ensure(msg + " has", view.has(it->first));
+					ensureMatches(msg + "/" + it->first, view[it->first], it->second);
+				}
+			}
+			else if (sd.isArray())
+			{
+				ensure_equals(msg + " size", view.size(), sd.size());
+				for (S32 idx = 0; idx < sd.size(); idx++)
+				{
+					ensureMatches(msg + "/" + llformat("%d", idx), view[idx], sd[idx]);
+				}
+			}
+		}
+
+		LLSD mSD;
+	};
+	typedef test_group<llsdlazyview_data> llsdlazyview_test;
+	typedef llsdlazyview_test::object llsdlazyview_object;
+	tut::llsdlazyview_test llsdlazyview_testcase("LLSDLazyView");
+
+	template<> template<>
+	void llsdlazyview_object::test<1>()
+	{
+		const std::string xml = toXML(mSD), binary = toBinary(mSD);
+		ensureMatches("xml", LLSDLazyView(xml.data(), xml.size(), LLSDBufferParser::FORMAT_XML), mSD);
+		ensureMatches("binary", LLSDLazyView(binary.data(), binary.size(), LLSDBufferParser::FORMAT_BINARY), mSD);
+
+		// Shared rather than copied buffer
+		LLSD buffer = LLSD::Binary(binary.begin(), binary.end());
+		ensureMatches("shared binary", LLSDLazyView(buffer, LLSDBufferParser::FORMAT_BINARY), mSD);
+	}
+
+	template<> template<>
+	void llsdlazyview_object::test<2>()
+	{
+		// Lookups that don't exist give an undefined view
+		const std::string xml = toXML(mSD);
+		LLSDLazyView view(xml.data(), xml.size(), LLSDBufferParser::FORMAT_XML);
+		ensure("missing key", !view.has("missing"));
+		ensure("missing key view", view["missing"].isUndefined());
+		ensure("out of range", view["folders"][3].isUndefined());
+		ensure_equals("scalar size", view["version"].size(), 0);
+		ensure_equals("scalar conversion", view["version"].asInteger(), 7);
+		ensure_equals("nested scalar", view["folders"][1]["name"].asString(), std::string("Folder <1>"));
+
+		// Duplicate keys resolve like a full parse
+		const std::string dup_xml("<llsd><map><key>a</key><integer>1</integer><key>a</key><integer>2</integer></map></llsd>");
+		ensure_equals("xml duplicate key", LLSDLazyView(dup_xml.data(), dup_xml.size(), LLSDBufferParser::FORMAT_XML)["a"].asInteger(), 2);
+		const std::string dup_binary("{\0\0\0\2k\0\0\0\1ai\0\0\0\1k\0\0\0\1ai\0\0\0\2}", 28);
+		LLSDLazyView dup_view(dup_binary.data(), dup_binary.size(), LLSDBufferParser::FORMAT_BINARY);
+		ensure_equals("binary duplicate key", dup_view["a"].asInteger(), 1);
+		ensure_equals("duplicate key size", dup_view.size(), 1);
+	}
+
+	template<> template<>
+	void llsdlazyview_object::test<3>()
+	{
+		// Documents the buffer parser doesn't handle still give the same result as LLSDSerialize
+		const std::string cdata("<llsd><map><key>text</key><string><![CDATA[<raw>]]></string><key>count</key><integer>2</integer></map></llsd>");
+		LLSDLazyView view(cdata.data(), cdata.size(), LLSDBufferParser::FORMAT_XML);
+		ensure("fallback valid", view.isValid());
+		ensure_equals("fallback string", view["text"].asString(), std::string("<raw>"));
+		ensure_equals("fallback integer", view["count"].asInteger(), 2);
+
+		// Invalid documents
+		const std::string bad("<llsd><map><key>a</key>");
+		ensure("invalid xml", !LLSDLazyView(bad.data(), bad.size(), LLSDBufferParser::FORMAT_XML).isValid());
+		ensure("undefined view", !LLSDLazyView().isValid());
+		ensure_equals("invalid value", LLSDLazyView(bad.data(), bad.size(), LLSDBufferParser::FORMAT_XML).asLLSD(), LLSD());
+	}
+
+	template<> template<>
+	void llsdlazyview_object::test<4>()
+	{
+		// "tl" and "zb" land in the same key cache slot as "folder" so parsing the nested maps reuses the root key's string
+		LLSD sd = LLSD::emptyMap();
+		sd["folder"]["tl"] = 1;
+		sd["folder"]["zb"] = 2;
+		sd["name"] = "outer";
+		sd["tl"]["zb"] = 3;
+
+		const std::string xml = toXML(sd), binary = toBinary(sd);
+		ensureMatches("xml", LLSDLazyView(xml.data(), xml.size(), LLSDBufferParser::FORMAT_XML), sd);
+		ensureMatches("binary", LLSDLazyView(binary.data(), binary.size(), LLSDBufferParser::FORMAT_BINARY), sd);
+	}
+}
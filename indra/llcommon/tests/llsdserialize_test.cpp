@@ -1495,6 +1495,188 @@ namespace tut
 	}
 */
 
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+	/**
+	 * @class TestLLSDBufferParsing
+	 * @brief Checks LLSDBufferParser (and the LLSDSerialize buffer methods) against the stream parsers
+	 */
+	class TestLLSDBufferParsing
+	{
+	public:
+		TestLLSDBufferParsing()
+		{
+			mSD = LLSD::emptyMap();
+			mSD["int"] = 42;
+			mSD["negative"] = -12345;
+			mSD["real"] = 3.25;
+			mSD["string"] = "escaped <&> \"quotes\"";
+			mSD["uuid"] = LLUUID("d7f4aeca-88f1-42a1-b385-b9db18abb255");
+			mSD["date"] = LLDate(1234567890.0);
+			mSD["uri"] = LLURI("http://secondlife.com");
+			mSD["binary"] = LLSD::Binary(5, 0xAB);
+			mSD["array"] = LLSD::emptyArray();
+			mSD["array"].append(LLSD());
+			mSD["array"].append(true);
+			mSD["array"].append(LLSD::emptyMap());
+			mSD["array"][2]["nested"] = "value";
+		}
+
+		// The buffer parser may refuse a document but never parse it differently; LLSDSerialize always matches the stream parser
+		void ensureXML(const std::string& msg, const std::string& xml)
+		{
+			LLSD stream_sd, buffer_sd, serialize_sd;
+			std::istringstream input(xml);
+			S32 stream_count = LLSDSerialize::fromXML(stream_sd, input);
+			S32 buffer_count = LLSDBufferParser().parse(xml.data(), xml.size(), LLSDBufferParser::FORMAT_XML, buffer_sd);
+			if (LLSDParser::PARSE_FAILURE != buffer_count)
+			{
+				ensure_equals(msg + " (value)", buffer_sd, stream_sd);
+				ensure_equals(msg + " (count)", buffer_count, stream_count);
+			}
+
+			S32 serialize_count = LLSDSerialize::fromXML(serialize_sd, xml.data(), xml.size());
+			ensure_equals(msg + " (serialize value)", serialize_sd, stream_sd);
+			ensure_equals(msg + " (serialize count)", serialize_count, stream_count);
+		}
+
+		void ensureBinary(const std::string& msg, const std::string& binary)
+		{
+			LLSD stream_sd, buffer_sd, serialize_sd;
+			std::istringstream input(binary);
+			S32 stream_count = LLSDSerialize::fromBinary(stream_sd, input, binary.size());
+			LLSDBufferParser parser;
+			S32 buffer_count = parser.parse(binary.data(), binary.size(), LLSDBufferParser::FORMAT_BINARY, buffer_sd);
+			if (LLSDParser::PARSE_FAILURE != buffer_count)
+			{
+				ensure_equals(msg + " (value)", buffer_sd, stream_sd);
+				ensure_equals(msg + " (count)", buffer_count, stream_count);
+				ensure_equals(msg + " (bytes)", parser.getBytesParsed(), (size_t)input.tellg());
+			}
+
+			S32 serialize_count = LLSDSerialize::fromBinary(serialize_sd, binary.data(), binary.size());
+			ensure_equals(msg + " (serialize value)", serialize_sd, stream_sd);
+			ensure_equals(msg + " (serialize count)", serialize_count, stream_count);
+		}
+
+		LLSD mSD;
+	};
+
+	typedef tut::test_group<TestLLSDBufferParsing> TestLLSDBufferParsingGroup;
+	typedef TestLLSDBufferParsingGroup::object TestLLSDBufferParsingObject;
+	TestLLSDBufferParsingGroup gTestLLSDBufferParsingGroup("llsd buffer parsing");
+
+	template<> template<> 
+	void TestLLSDBufferParsingObject::test<1>()
+	{
+		std::ostringstream xml, pretty_xml, binary;
+		LLSDSerialize::toXML(mSD, xml);
+		LLSDSerialize::toPrettyXML(mSD, pretty_xml);
+		LLSDSerialize::toBinary(mSD, binary);
+
+		ensureXML("xml", xml.str());
+		ensureXML("pretty xml", pretty_xml.str());
+		ensureBinary("binary", binary.str());
+		ensureBinary("binary with trailing data", binary.str() + "trailing");
+	}
+
+	template<> template<> 
+	void TestLLSDBufferParsingObject::test<2>()
+	{
+		// Character data
+		ensureXML("entities", "<llsd><string>&lt;&gt;&amp;&quot;&apos;</string></llsd>");
+		ensureXML("character references", "<llsd><string>&#65;&#x20AC;&#x1F600;</string></llsd>");
+		ensureXML("line endings", "<llsd><string>a\r\nb\rc\nd</string></llsd>");
+		ensureXML("utf-8", "<llsd><string>caf\xC3\xA9 \xE2\x82\xAC</string></llsd>");
+		ensureXML("self closing", "<llsd><array><undef/><string/><integer/><map/></array></llsd>");
+		ensureXML("prolog", "<?xml version=\"1.0\" ?>\n<!-- comment -->\n<llsd><integer>1</integer></llsd>");
+		ensureXML("conversions", "<llsd><array><boolean>1</boolean><boolean>TRUE</boolean><integer> 12</integer><integer>3.7</integer><real>1e3</real></array></llsd>");
+
+		// Duplicate keys resolve differently in the two formats
+		ensureXML("duplicate keys", "<llsd><map><key>a</key><integer>1</integer><key>a</key><integer>2</integer></map></llsd>");
+		LLSD sd;
+		const std::string binary("{\0\0\0\2k\0\0\0\1ai\0\0\0\1k\0\0\0\1ai\0\0\0\2}", 28);
+		ensureBinary("duplicate keys", binary);
+		LLSDSerialize::fromBinary(sd, binary.data(), binary.size());
+		ensure_equals("first binary key wins", sd["a"].asInteger(), 1);
+	}
+
+	template<> template<> 
+	void TestLLSDBufferParsingObject::test<3>()
+	{
+		// Documents outside of what the buffer parser handles still parse through LLSDSerialize
+		const std::string cdata("<llsd><string><![CDATA[<raw>]]></string></llsd>");
+		LLSD sd;
+		ensure_equals("cdata buffer", LLSDBufferParser().parse(cdata.data(), cdata.size(), LLSDBufferParser::FORMAT_XML, sd), LLSDParser::PARSE_FAILURE);
+		ensure_equals("cdata buffer value", sd, LLSD());
+		ensure_equals("cdata fallback", LLSDSerialize::fromXML(sd, cdata.data(), cdata.size()), 1);
+		ensure_equals("cdata fallback value", sd.asString(), std::string("<raw>"));
+
+		const std::string notation_string("'abc'");
+		ensure_equals("notation string buffer", LLSDBufferParser().parse(notation_string.data(), notation_string.size(), LLSDBufferParser::FORMAT_BINARY, sd), LLSDParser::PARSE_FAILURE);
+		ensure_equals("notation string fallback", LLSDSerialize::fromBinary(sd, notation_string.data(), notation_string.size()), 1);
+		ensure_equals("notation string fallback value", sd.asString(), std::string("abc"));
+		const std::string notation_trailing("'abc'xyz");
+		size_t bytes_parsed = 0;
+		ensure_equals("notation trailing fallback", LLSDSerialize::fromBinary(sd, notation_trailing.data(), notation_trailing.size(), -1, &bytes_parsed), 1);
+		ensure_equals("notation trailing bytes parsed", bytes_parsed, (size_t)5);
+
+		// Truncated and malformed input
+		std::ostringstream binary;
+		LLSDSerialize::toBinary(mSD, binary);
+		for (size_t len = 0; len < binary.str().size(); len += 7)
+		{
+			ensureBinary("truncated binary", binary.str().substr(0, len));
+		}
+		ensureXML("bad entity", "<llsd><string>&nbsp;</string></llsd>");
+		ensureXML("control character", "<llsd><string>\x01</string></llsd>");
+		ensureXML("invalid utf-8", "<llsd><string>\xC3</string></llsd>");
+		ensureXML("mismatched tag", "<llsd><string>abc</integer></llsd>");
+		ensureXML("serialization header", "<? LLSD/XML ?>\n<llsd><integer>1</integer></llsd>");
+	}
+
+	template<> template<> 
+	void TestLLSDBufferParsingObject::test<4>()
+	{
+		// Headers
+		for (LLSDSerialize::ELLSD_Serialize type : { LLSDSerialize::LLSD_BINARY, LLSDSerialize::LLSD_XML })
+		{
+			std::ostringstream output;
+			LLSDSerialize::serialize(mSD, output, type);
+
+			LLSD sd;
+			ensure("deserialize", LLSDSerialize::deserialize(sd, output.str().data(), output.str().size()));
+			ensure_equals("deserialize value", sd, mSD);
+		}
+	}
+
+	template<> template<> 
+	void TestLLSDBufferParsingObject::test<5>()
+	{
+		// Visitors can pick out values without building the tree and stop early
+		class LLFindKeyVisitor : public LLSDParseVisitor
+		{
+		public:
+			LLFindKeyVisitor(const std::string& key) : mKey(key), mDepth(0), mMatch(false) {}
+
+			virtual bool beginMap(S32 size)					{ mDepth++; return true; }
+			virtual bool endMap()							{ mDepth--; return true; }
+			virtual bool mapKey(const LLSD::String& key)	{ mMatch = (1 == mDepth) && (mKey == key); return true; }
+			virtual bool value(const LLSD& v)				{ if (mMatch) { mValue = v; return false; } return true; }
+
+			std::string mKey;
+			S32 mDepth;
+			bool mMatch;
+			LLSD mValue;
+		};
+
+		std::ostringstream binary;
+		LLSDSerialize::toBinary(mSD, binary);
+		LLFindKeyVisitor visitor("real");
+		ensure_equals("stopped early", LLSDBufferParser().parse(binary.str().data(), binary.str().size(), LLSDBufferParser::FORMAT_BINARY, visitor), LLSDParser::PARSE_FAILURE);
+		ensure_equals("found value", visitor.mValue.asReal(), 3.25);
+	}
+// [/SL:KB]
+
    /**
 	 * @class TestLLSDCrossCompatible
 	 * @brief Miscellaneous serialization and parsing tests
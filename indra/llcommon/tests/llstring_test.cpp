@@ -868,4 +868,31 @@ namespace tut
 					  LLStringUtil::getTokens("it's^ up there^", " ", "", "'", "^"),
 					  list_of("it's up")("there^"));
     }
+
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+	template<> template<>
+	void string_index_object_t::test<43>()
+	{
+		// dict_sort_key() byte order should match compareDict()
+		const char* names[] = { "", "a", "A", "b", "B", "ab", "aB", "Ab", "AB", "abc", "a b", "a-b", "a_b", "a~b",
+								"1", "2", "9", "10", "010", "09", "100", "a1", "a2", "a10", "A10", "a02", "a1b", "a1B", "a10b",
+								"item 9", "item 10", "Item 10", "item 10 (copy)", "item10", "0", "00", "zz", "Z",
+								"\xe9", "a\xe9", "A\xe9", "\xe9a", "a\xc3\xa9b", "!", "~", "/", "[x]" };
+		const S32 count = sizeof(names) / sizeof(names[0]);
+
+		std::string key_a, key_b;
+		for (S32 idx_a = 0; idx_a < count; idx_a++)
+		{
+			dict_sort_key(names[idx_a], key_a);
+			for (S32 idx_b = 0; idx_b < count; idx_b++)
+			{
+				dict_sort_key(names[idx_b], key_b);
+
+				S32 expected = LLStringUtil::compareDict(names[idx_a], names[idx_b]);
+				S32 actual = key_a.compare(key_b);
+				ensure_equals(llformat("\"%s\" vs \"%s\"", names[idx_a], names[idx_b]), (actual > 0) - (actual < 0), (expected > 0) - (expected < 0));
+			}
+		}
+	}
+// [/SL:KB]
 }
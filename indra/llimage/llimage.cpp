@@ -39,6 +39,9 @@
 #include "llimagepng.h"
 #include "llimagedxt.h"
 #include "llmemory.h"
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+#include "llarena.h"
+// [/SL:KB]
 
 #include <boost/preprocessor.hpp>
 
@@ -973,7 +976,10 @@ void LLImageRaw::verticalFlip()
 {
 	S32 row_bytes = getWidth() * getComponents();
 	llassert(row_bytes > 0);
-	std::vector<U8> line_buffer(row_bytes);
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	LLArenaBuffer<U8> line_buffer(row_bytes);
+// [/SL:KB]
+//	std::vector<U8> line_buffer(row_bytes);
 	S32 mid_row = getHeight() / 2;
 	for( S32 row = 0; row < mid_row; row++ )
 	{
@@ -1133,7 +1139,10 @@ void LLImageRaw::compositeScaled4onto3(LLImageRaw* src)
 
 	S32 temp_data_size = src->getWidth() * dst->getHeight() * src->getComponents();
 	llassert_always(temp_data_size > 0);
-	std::vector<U8> temp_buffer(temp_data_size);
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	LLArenaBuffer<U8> temp_buffer(temp_data_size);
+// [/SL:KB]
+//	std::vector<U8> temp_buffer(temp_data_size);
 
 	// Vertical: scale but no composite
 	for( S32 col = 0; col < src->getWidth(); col++ )
@@ -1480,7 +1489,10 @@ bool LLImageRaw::scale( S32 new_width, S32 new_height, bool scale_image_data )
 	{
 		// copy	out	existing image data
 		S32	temp_data_size = old_width * old_height	* components;
-		std::vector<U8> temp_buffer(temp_data_size);
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+		LLArenaBuffer<U8> temp_buffer(temp_data_size);
+// [/SL:KB]
+//		std::vector<U8> temp_buffer(temp_data_size);
 		memcpy(&temp_buffer[0],	getData(), temp_data_size);
 
 		// allocate	new	image data,	will delete	old	data
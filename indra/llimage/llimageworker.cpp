@@ -32,8 +32,12 @@
 //----------------------------------------------------------------------------
 
 // MAIN THREAD
-LLImageDecodeThread::LLImageDecodeThread(bool threaded)
-	: LLQueuedThread("imagedecode", threaded)
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+LLImageDecodeThread::LLImageDecodeThread(bool threaded, bool use_job_system)
+	: LLQueuedThread("imagedecode", threaded, false, use_job_system)
+// [/SL:KB]
+//LLImageDecodeThread::LLImageDecodeThread(bool threaded)
+//	: LLQueuedThread("imagedecode", threaded)
 // [SL:KB] - Patch: Viewer-OptimizationThreadLock | Checked: Catznip-6.0
 	, mCreationCount(0)
 // [/SL:KB]
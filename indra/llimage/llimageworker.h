@@ -72,7 +72,10 @@ class LLImageDecodeThread : public LLQueuedThread
 	};
 	
 public:
-	LLImageDecodeThread(bool threaded = true);
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	LLImageDecodeThread(bool threaded = true, bool use_job_system = false);
+// [/SL:KB]
+//	LLImageDecodeThread(bool threaded = true);
 	virtual ~LLImageDecodeThread();
 
 	handle_t decodeImage(LLImageFormatted* image,
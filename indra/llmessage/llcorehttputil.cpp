@@ -38,6 +38,9 @@
 #include "reader.h" // JSON
 #include "writer.h" // JSON
 #include "llvfile.h"
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+#include "llarena.h"
+// [/SL:KB]
 
 #include "message.h" // for getting the port
 
@@ -143,7 +146,16 @@ bool responseToLLSD(HttpResponse * response, bool log, LLSD & out_llsd)
 	else
 	{
 // [/SL:KB]
-		S32 parse_status(LLSDSerialize::fromXML(body_llsd, bas, log));
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+		// One copy into contiguous memory lets the buffer parser skip the stream (and expat) entirely for well-formed documents
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+		LLArenaBuffer<char> body_data(body->size());
+// [/SL:KB]
+//		std::vector<char> body_data(body->size());
+		body->read(0, body_data.data(), body_data.size());
+		S32 parse_status(LLSDSerialize::fromXML(body_llsd, body_data.data(), body_data.size(), log));
+// [/SL:KB]
+//		S32 parse_status(LLSDSerialize::fromXML(body_llsd, bas, log));
 		if (LLSDParser::PARSE_FAILURE == parse_status){
 			return false;
 		}
@@ -155,6 +167,46 @@ bool responseToLLSD(HttpResponse * response, bool log, LLSD & out_llsd)
     return true;
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+bool responseToLazyLLSD(HttpResponse * response, LLSDLazyView & out_view)
+{
+	BufferArray * body(response->getBody());
+	if (!body || !body->size())
+	{
+		return false;
+	}
+
+	LLCore::HttpHeaders::ptr_t httpHeaders(response->getHeaders());
+	const std::string* pstrContentType = (httpHeaders) ? httpHeaders->find(HTTP_IN_HEADER_CONTENT_TYPE) : nullptr;
+	if ( (pstrContentType) && ((HTTP_CONTENT_JSON == *pstrContentType) || (boost::starts_with(*pstrContentType, HTTP_CONTENT_JSON + ";"))) )
+	{
+		// JSON has to be converted in full so view the result in binary form
+		LLSD body_llsd;
+		if (!responseToLLSD(response, true, body_llsd))
+		{
+			return false;
+		}
+
+		std::ostringstream str;
+		LLSDSerialize::toBinary(body_llsd, str);
+		const std::string binary = str.str();
+		out_view = LLSDLazyView(binary.data(), binary.size(), LLSDBufferParser::FORMAT_BINARY);
+		return true;
+	}
+
+	LLSD::Binary body_data(body->size());
+	body->read(0, body_data.data(), body_data.size());
+
+	LLSDLazyView body_view(LLSD(body_data), LLSDBufferParser::FORMAT_XML);
+	if (!body_view.isValid())
+	{
+		return false;
+	}
+	out_view = body_view;
+	return true;
+}
+// [/SL:KB]
+
 
 HttpHandle requestPostWithLLSD(HttpRequest * request,
     HttpRequest::policy_t policy_id,
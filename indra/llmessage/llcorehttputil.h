@@ -40,6 +40,9 @@
 #include "bufferarray.h"
 #include "bufferstream.h"
 #include "llsd.h"
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+#include "llsdlazyview.h"
+// [/SL:KB]
 #include "llevents.h"
 #include "llcoros.h"
 #include "lleventcoro.h"
@@ -90,6 +93,18 @@ bool responseToLLSD(LLCore::HttpResponse * response,
 					bool log,
 					LLSD & out_llsd);
 
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+/// Same as responseToLLSD() but only checks the response body and
+/// decodes parts of it as they're accessed through the returned view.
+/// Meant for large responses that are walked one element at a time.
+///
+/// @return				Returns true (and writes to out_view) if
+///						the body holds valid LLSD.  False otherwise.
+///
+bool responseToLazyLLSD(LLCore::HttpResponse * response,
+						LLSDLazyView & out_view);
+// [/SL:KB]
+
 /// Create a std::string representation of a response object
 /// suitable for logging.  Mainly intended for logging of
 /// failures and debug information.  This won't be fast,
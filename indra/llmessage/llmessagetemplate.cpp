@@ -45,8 +45,20 @@ void LLMsgVarData::addData(const void *data, S32 size, EMsgVariableType type, S3
 	}
 	if(size)
 	{
-		delete[] mData; // Delete it if it already exists
-		mData = new U8[size];
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+		if (mArena)
+		{
+			// Arena memory is released with the whole message
+			mData = static_cast<U8*>(mArena->allocate(size, sizeof(U32)));
+		}
+		else
+		{
+			delete[] mData; // Delete it if it already exists
+			mData = new U8[size];
+		}
+// [/SL:KB]
+//		delete[] mData; // Delete it if it already exists
+//		mData = new U8[size];
 		htolememcpy(mData, data, mType, size);
 	}
 }
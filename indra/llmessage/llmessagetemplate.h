@@ -30,18 +30,32 @@
 #include "message.h" // TODO: babbage: Remove...
 #include "llstl.h"
 #include "llindexedvector.h"
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+#include "llarena.h"
+// [/SL:KB]
 
 class LLMsgVarData
 {
 public:
-	LLMsgVarData() : mName(NULL), mSize(-1), mDataSize(-1), mData(NULL), mType(MVT_U8)
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	LLMsgVarData() : mName(NULL), mSize(-1), mDataSize(-1), mData(NULL), mType(MVT_U8), mArena(NULL)
 	{
 	}
 
-	LLMsgVarData(const char *name, EMsgVariableType type) : mSize(-1), mDataSize(-1), mData(NULL), mType(type)
+	// Data is taken from the arena (and never deleted) if one is passed in
+	LLMsgVarData(const char *name, EMsgVariableType type, LLArena* arenap = NULL) : mSize(-1), mDataSize(-1), mData(NULL), mType(type), mArena(arenap)
 	{
 		mName = (char *)name; 
 	}
+// [/SL:KB]
+//	LLMsgVarData() : mName(NULL), mSize(-1), mDataSize(-1), mData(NULL), mType(MVT_U8)
+//	{
+//	}
+//
+//	LLMsgVarData(const char *name, EMsgVariableType type) : mSize(-1), mDataSize(-1), mData(NULL), mType(type)
+//	{
+//		mName = (char *)name; 
+//	}
 
 	~LLMsgVarData() 
 	{
@@ -50,7 +64,13 @@ class LLMsgVarData
 	
 	void deleteData() 
 	{
-		delete[] mData;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+		if (!mArena)
+		{
+			delete[] mData;
+		}
+// [/SL:KB]
+//		delete[] mData;
 		mData = NULL;
 	}
 	
@@ -70,15 +90,24 @@ class LLMsgVarData
 
 	U8					*mData;
 	EMsgVariableType	mType;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	LLArena*			mArena;
+// [/SL:KB]
 };
 
 class LLMsgBlkData
 {
 public:
-        LLMsgBlkData(const char *name, S32 blocknum) : mBlockNumber(blocknum), mTotalSize(-1) 
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	LLMsgBlkData(const char *name, S32 blocknum, LLArena* arenap = NULL) : mBlockNumber(blocknum), mTotalSize(-1), mArena(arenap)
 	{ 
 		mName = (char *)name; 
 	}
+// [/SL:KB]
+//        LLMsgBlkData(const char *name, S32 blocknum) : mBlockNumber(blocknum), mTotalSize(-1) 
+//	{ 
+//		mName = (char *)name; 
+//	}
 
 	~LLMsgBlkData()
 	{
@@ -91,7 +120,10 @@ class LLMsgBlkData
 
 	void addVariable(const char *name, EMsgVariableType type)
 	{
-		LLMsgVarData tmp(name,type);
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+		LLMsgVarData tmp(name, type, mArena);
+// [/SL:KB]
+//		LLMsgVarData tmp(name,type);
 		mMemberVarData[name] = tmp;
 	}
 
@@ -106,21 +138,55 @@ class LLMsgBlkData
 	msg_var_data_map_t					mMemberVarData;
 	char								*mName;
 	S32									mTotalSize;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	LLArena*							mArena;
+// [/SL:KB]
 };
 
 class LLMsgData
 {
 public:
-	LLMsgData(const char *name) : mTotalSize(-1) 
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	// When given an arena the blocks, their variable data and the block map all live in it; blocks have to be made with createBlock()
+	LLMsgData(const char *name, LLArena* arenap = NULL) : mMemberBlocks(msg_blk_data_map_t::key_compare(), msg_blk_data_map_t::allocator_type(arenap)), mTotalSize(-1), mArena(arenap)
 	{ 
 		mName = (char *)name; 
 	}
 	~LLMsgData()
 	{
-		for_each(mMemberBlocks.begin(), mMemberBlocks.end(), DeletePairedPointer());
+		if (mArena)
+		{
+			for (msg_blk_data_map_t::iterator iter = mMemberBlocks.begin(); iter != mMemberBlocks.end(); ++iter)
+			{
+				iter->second->~LLMsgBlkData();
+			}
+		}
+		else
+		{
+			for_each(mMemberBlocks.begin(), mMemberBlocks.end(), DeletePairedPointer());
+		}
 		mMemberBlocks.clear();
 	}
 
+	LLMsgBlkData* createBlock(const char *name, S32 blocknum)
+	{
+		if (mArena)
+		{
+			return new(mArena->allocate(sizeof(LLMsgBlkData), alignof(LLMsgBlkData))) LLMsgBlkData(name, blocknum, mArena);
+		}
+		return new LLMsgBlkData(name, blocknum);
+	}
+// [/SL:KB]
+//	LLMsgData(const char *name) : mTotalSize(-1) 
+//	{ 
+//		mName = (char *)name; 
+//	}
+//	~LLMsgData()
+//	{
+//		for_each(mMemberBlocks.begin(), mMemberBlocks.end(), DeletePairedPointer());
+//		mMemberBlocks.clear();
+//	}
+
 	void addBlock(LLMsgBlkData *blockp)
 	{
 		mMemberBlocks[blockp->mName] = blockp;
@@ -129,10 +195,16 @@ class LLMsgData
 	void addDataFast(char *blockname, char *varname, const void *data, S32 size, EMsgVariableType type, S32 data_size = -1);
 
 public:
-	typedef std::map<char*, LLMsgBlkData*> msg_blk_data_map_t;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	typedef std::map<char*, LLMsgBlkData*, std::less<char*>, LLArenaAllocator<std::pair<char* const, LLMsgBlkData*> > > msg_blk_data_map_t;
+// [/SL:KB]
+//	typedef std::map<char*, LLMsgBlkData*> msg_blk_data_map_t;
 	msg_blk_data_map_t					mMemberBlocks;
 	char								*mName;
 	S32									mTotalSize;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	LLArena*							mArena;
+// [/SL:KB]
 };
 
 // LLMessage* classes store the template of messages
@@ -43,15 +43,22 @@ LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
 	mReceiveSize(0),
 	mCurrentRMessageTemplate(NULL),
 	mCurrentRMessageData(NULL),
-	mMessageNumbers(number_template_map)
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	mMessageNumbers(number_template_map),
+	mDecodeArena(16 * 1024, 1)
+// [/SL:KB]
+//	mMessageNumbers(number_template_map)
 {
 }
 
 //virtual 
 LLTemplateMessageReader::~LLTemplateMessageReader()
 {
-	delete mCurrentRMessageData;
-	mCurrentRMessageData = NULL;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	deleteMessageData();
+// [/SL:KB]
+//	delete mCurrentRMessageData;
+//	mCurrentRMessageData = NULL;
 }
 
 //virtual
@@ -59,10 +66,26 @@ void LLTemplateMessageReader::clearMessage()
 {
 	mReceiveSize = -1;
 	mCurrentRMessageTemplate = NULL;
-	delete mCurrentRMessageData;
-	mCurrentRMessageData = NULL;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	deleteMessageData();
+// [/SL:KB]
+//	delete mCurrentRMessageData;
+//	mCurrentRMessageData = NULL;
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+void LLTemplateMessageReader::deleteMessageData()
+{
+	if (mCurrentRMessageData)
+	{
+		// The message data lives in the decode arena so only destruct it and recycle the arena afterwards
+		mCurrentRMessageData->~LLMsgData();
+		mCurrentRMessageData = NULL;
+	}
+	mDecodeArena.reset();
+}
+// [/SL:KB]
+
 void LLTemplateMessageReader::getData(const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
 {
 	// is there a message ready to go?
@@ -536,7 +559,10 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 	llassert( mReceiveSize >= 0 );
 	llassert( mCurrentRMessageTemplate);
 	llassert( !mCurrentRMessageData );
-	delete mCurrentRMessageData; // just to make sure
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	deleteMessageData(); // just to make sure
+// [/SL:KB]
+//	delete mCurrentRMessageData; // just to make sure
 
 	// The offset tells us how may bytes to skip after the end of the
 	// message name.
@@ -544,7 +570,10 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 	S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(mCurrentRMessageTemplate->mFrequency) + offset;
 
 	// create base working data set
-	mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	mCurrentRMessageData = new(mDecodeArena.allocate(sizeof(LLMsgData), alignof(LLMsgData))) LLMsgData(mCurrentRMessageTemplate->mName, &mDecodeArena);
+// [/SL:KB]
+//	mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
 	
 	// loop through the template building the data structure as we go
 	LLMessageTemplate::message_block_map_t::const_iterator iter;
@@ -602,12 +631,18 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 			{
 				// build new name to prevent collisions
 				// TODO: This should really change to a vector
-				cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+				cur_data_block = mCurrentRMessageData->createBlock(mbci->mName, repeat_number);
+// [/SL:KB]
+//				cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
 				cur_data_block->mName = mbci->mName + i;
 			}
 			else
 			{
-				cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+				cur_data_block = mCurrentRMessageData->createBlock(mbci->mName, repeat_number);
+// [/SL:KB]
+//				cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
 			}
 
 			// add the block to the message
@@ -28,6 +28,9 @@
 #define LL_LLTEMPLATEMESSAGEREADER_H
 
 #include "llmessagereader.h"
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+#include "llarena.h"
+// [/SL:KB]
 
 #include <map>
 
@@ -117,11 +120,18 @@ class LLTemplateMessageReader : public LLMessageReader
 	void logRanOffEndOfPacket( const LLHost& host, const S32 where, const S32 wanted );
 
 	BOOL decodeData(const U8* buffer, const LLHost& sender );
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	void deleteMessageData();
+// [/SL:KB]
 
 	S32	mReceiveSize;
 	LLMessageTemplate* mCurrentRMessageTemplate;
 	LLMsgData* mCurrentRMessageData;
 	message_template_number_map_t& mMessageNumbers;
+// [SL:KB] - Patch: Viewer-OptimizationArena | Checked: Catznip-6.7
+	// Holds mCurrentRMessageData (and everything hanging off of it) until the next message comes in
+	LLArena mDecodeArena;
+// [/SL:KB]
 };
 
 #endif // LL_LLTEMPLATEMESSAGEREADER_H
@@ -480,6 +480,65 @@ class LLFolderViewFolder : public LLFolderViewItem
 	//WARNING: do not call directly...use the appropriate LLFolderViewModel-derived class instead
 	template<typename SORT_FUNC> void sortFolders(const SORT_FUNC& func) { mFolders.sort(func); }
 	template<typename SORT_FUNC> void sortItems(const SORT_FUNC& func) { mItems.sort(func); }
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+	// Same as the above but only moves the children that are out of place when there are just a few (e.g. after a rename or an add)
+	template<typename SORT_FUNC> void resortFolders(const SORT_FUNC& func) { resortList(mFolders, func); }
+	template<typename SORT_FUNC> void resortItems(const SORT_FUNC& func) { resortList(mItems, func); }
+
+protected:
+	template<typename T, typename SORT_FUNC> static void resortList(std::list<T*>& list, const SORT_FUNC& func)
+	{
+		if (list.size() < 2)
+		{
+			return;
+		}
+
+		// Single pass that takes out everything that doesn't fit between its kept predecessor and its successor; what stays behind is sorted
+		const size_t max_misplaced = llmax<size_t>(8, list.size() / 16);
+		std::list<T*> misplaced;
+		typename std::list<T*>::iterator itPrev = list.end();
+		// Set when the current child was already compared against the kept predecessor (as the successor of the previous one)
+		bool has_prev_result = false, prev_result = false;
+		for (typename std::list<T*>::iterator itCur = list.begin(); itCur != list.end(); )
+		{
+			typename std::list<T*>::iterator itNext = std::next(itCur);
+			bool is_misplaced = (itPrev != list.end()) && ((has_prev_result) ? prev_result : func(*itCur, *itPrev));
+			has_prev_result = false;
+			if ( (!is_misplaced) && (itNext != list.end()) )
+			{
+				has_prev_result = true;
+				prev_result = func(*itNext, *itCur);
+				if (prev_result)
+				{
+					// Either this one moved up or the next one moved down; it's the next one if it doesn't fit after the previous one either
+					is_misplaced = (itPrev == list.end()) || (!func(*itNext, *itPrev));
+				}
+			}
+
+			if (is_misplaced)
+			{
+				has_prev_result = false;
+				misplaced.splice(misplaced.end(), list, itCur);
+				if (misplaced.size() > max_misplaced)
+				{
+					// Too much changed to be worth it
+					list.splice(list.end(), misplaced);
+					list.sort(func);
+					return;
+				}
+			}
+			else
+			{
+				itPrev = itCur;
+			}
+			itCur = itNext;
+		}
+
+		// A single linear merge (which keeps the kept children ahead of equivalent misplaced ones, same as upper_bound would)
+		misplaced.sort(func);
+		list.merge(misplaced, func);
+	}
+// [/SL:KB]
 };
 
 typedef std::deque<LLFolderViewItem*> folder_view_item_deque;
@@ -503,8 +503,12 @@ class LLFolderViewModel : public LLFolderViewModelCommon
 	{
 		if (needsSort(folder->getViewModelItem()))
 		{
-			folder->sortFolders(ViewModelCompare(getSorter()));
-			folder->sortItems(ViewModelCompare(getSorter()));
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+			folder->resortFolders(ViewModelCompare(getSorter()));
+			folder->resortItems(ViewModelCompare(getSorter()));
+// [/SL:KB]
+//			folder->sortFolders(ViewModelCompare(getSorter()));
+//			folder->sortItems(ViewModelCompare(getSorter()));
 			folder->getViewModelItem()->setSortVersion(mTargetSortVersion);
 			folder->requestArrange();
 		}
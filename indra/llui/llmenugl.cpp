@@ -1035,12 +1035,18 @@ LLView* LLMenuItemBranchGL::getChildView(const std::string& name, BOOL recurse)
 	return LLView::getChildView(name, recurse);
 }
 
-LLView* LLMenuItemBranchGL::findChildView(const std::string& name, BOOL recurse) const
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+LLView* LLMenuItemBranchGL::findChildView(const LLInternedString& name, BOOL recurse) const
+// [/SL:KB]
+//LLView* LLMenuItemBranchGL::findChildView(const std::string& name, BOOL recurse) const
 {
 	LLMenuGL* branch = getBranch();
 	if (branch)
 	{
-		if (branch->getName() == name)
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+		if (branch->getNameKey() == name)
+// [/SL:KB]
+//		if (branch->getName() == name)
 		{
 			return branch;
 		}
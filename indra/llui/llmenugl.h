@@ -683,7 +683,11 @@ class LLMenuItemBranchGL : public LLMenuItemGL
 	virtual void openMenu();
 
 	virtual LLView* getChildView(const std::string& name, BOOL recurse = TRUE) const;
-	virtual LLView* findChildView(const std::string& name, BOOL recurse = TRUE) const;
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	using LLView::findChildView;
+	virtual LLView* findChildView(const LLInternedString& name, BOOL recurse = TRUE) const;
+// [/SL:KB]
+//	virtual LLView* findChildView(const std::string& name, BOOL recurse = TRUE) const;
 
 private:
 	LLHandle<LLView> mBranchHandle;
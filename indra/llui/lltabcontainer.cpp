@@ -433,13 +433,19 @@ LLView* LLTabContainer::getChildView(const std::string& name, BOOL recurse) cons
 }
 
 //virtual
-LLView* LLTabContainer::findChildView(const std::string& name, BOOL recurse) const
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+LLView* LLTabContainer::findChildView(const LLInternedString& name, BOOL recurse) const
+// [/SL:KB]
+//LLView* LLTabContainer::findChildView(const std::string& name, BOOL recurse) const
 {
 	tuple_list_t::const_iterator itor;
 	for (itor = mTabList.begin(); itor != mTabList.end(); ++itor)
 	{
 		LLPanel *panel = (*itor)->mTabPanel;
-		if (panel->getName() == name)
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+		if (panel->getNameKey() == name)
+// [/SL:KB]
+//		if (panel->getName() == name)
 		{
 			return panel;
 		}
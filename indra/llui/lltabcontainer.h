@@ -160,7 +160,11 @@ class LLTabContainer : public LLPanel
 									   EDragAndDropType type, void* cargo_data,
 									   EAcceptance* accept, std::string& tooltip);
 	/*virtual*/ LLView* getChildView(const std::string& name, BOOL recurse = TRUE) const;
-	/*virtual*/ LLView* findChildView(const std::string& name, BOOL recurse = TRUE) const;
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	using LLView::findChildView;
+	/*virtual*/ LLView* findChildView(const LLInternedString& name, BOOL recurse = TRUE) const;
+// [/SL:KB]
+//	/*virtual*/ LLView* findChildView(const std::string& name, BOOL recurse = TRUE) const;
 	/*virtual*/ void initFromParams(const LLPanel::Params& p);
 	/*virtual*/ bool addChild(LLView* view, S32 tab_group = 0);
 	/*virtual*/ BOOL postBuild();
@@ -142,6 +142,9 @@ LLView::LLView(const LLView::Params& p)
 	mVisible(p.visible),
 	mInDraw(false),
 	mName(p.name),
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	mNameKey(LLView::getName()),
+// [/SL:KB]
 	mParentView(NULL),
 	mReshapeFlags(FOLLOWS_NONE),
 	mFromXUI(p.from_xui),
@@ -251,6 +254,14 @@ const std::string& LLView::getName() const
 	return mName.empty() ? no_name : mName;
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+void LLView::setName(std::string name)
+{
+	mName = name;
+	mNameKey = LLInternedString(LLView::getName());
+}
+// [/SL:KB]
+
 void LLView::sendChildToFront(LLView* child)
 {
 // 	llassert_always(sDepth == 0); // Avoid re-ordering while drawing; it can cause subtle iterator bugs
@@ -1585,7 +1596,17 @@ LLView* LLView::getChildView(const std::string& name, BOOL recurse) const
 
 static LLTrace::BlockTimerStatHandle FTM_FIND_VIEWS("Find Widgets");
 
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
 LLView* LLView::findChildView(const std::string& name, BOOL recurse) const
+{
+	// Every view name is interned so if this name never was there is no view to find
+	const LLInternedString name_key = LLInternedString::find(name);
+	return (!name_key.empty()) ? findChildView(name_key, recurse) : NULL;
+}
+
+LLView* LLView::findChildView(const LLInternedString& name, BOOL recurse) const
+// [/SL:KB]
+//LLView* LLView::findChildView(const std::string& name, BOOL recurse) const
 {
 	LL_RECORD_BLOCK_TIME(FTM_FIND_VIEWS);
 	//richard: should we allow empty names?
@@ -1595,7 +1616,10 @@ LLView* LLView::findChildView(const std::string& name, BOOL recurse) const
 	BOOST_FOREACH(LLView* childp, mChildList)
 	{
 		llassert(childp);
-		if (childp->getName() == name)
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+		if (childp->getNameKey() == name)
+// [/SL:KB]
+//		if (childp->getName() == name)
 		{
 			return childp;
 		}
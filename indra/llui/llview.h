@@ -47,6 +47,9 @@
 #include "lluictrlfactory.h"
 #include "lltreeiterators.h"
 #include "llfocusmgr.h"
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+#include "llinternedstring.h"
+// [/SL:KB]
 
 #include <list>
 #include <boost/function.hpp>
@@ -238,7 +241,10 @@ class LLView
 	void		setFollowsAll()					{ mReshapeFlags |= FOLLOWS_ALL; }
 
 	void        setSoundFlags(U8 flags)			{ mSoundFlags = flags; }
-	void		setName(std::string name)			{ mName = name; }
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	void		setName(std::string name);
+// [/SL:KB]
+//	void		setName(std::string name)			{ mName = name; }
 	void		setUseBoundingRect( BOOL use_bounding_rect );
 	BOOL		getUseBoundingRect() const;
 
@@ -463,7 +469,14 @@ class LLView
 	}
 
 	virtual LLView* getChildView(const std::string& name, BOOL recurse = TRUE) const;
-	virtual LLView* findChildView(const std::string& name, BOOL recurse = TRUE) const;
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	LLView* findChildView(const std::string& name, BOOL recurse = TRUE) const;
+	// Compares interned names only; override this one rather than the std::string version
+	virtual LLView* findChildView(const LLInternedString& name, BOOL recurse = TRUE) const;
+	// Interned getName()
+	const LLInternedString& getNameKey() const { return mNameKey; }
+// [/SL:KB]
+//	virtual LLView* findChildView(const std::string& name, BOOL recurse = TRUE) const;
 
 	template <class T> T* getDefaultWidget(const std::string& name) const
 	{
@@ -592,6 +605,9 @@ class LLView
 	
 	std::string mLayout;
 	std::string	mName;
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	LLInternedString mNameKey;
+// [/SL:KB]
 	
 	U32			mReshapeFlags;
 
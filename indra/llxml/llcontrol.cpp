@@ -392,6 +392,19 @@ LLPointer<LLControlVariable> LLControlGroup::getControl(const std::string& name)
 	return iter == mNameTable.end() ? LLPointer<LLControlVariable>() : iter->second;
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+LLPointer<LLControlVariable> LLControlGroup::getControl(const LLInternedString& name)
+{
+	if (mSettingsProfile)
+	{
+		incrCount(name.str());
+	}
+
+	ctrl_name_index_t::const_iterator iter = mNameIndex.find(name);
+	return iter == mNameIndex.end() ? LLPointer<LLControlVariable>() : LLPointer<LLControlVariable>(iter->second);
+}
+// [/SL:KB]
+
 
 ////////////////////////////////////////////////////////////////////////////
 
@@ -487,6 +500,9 @@ void LLControlGroup::cleanup()
 	}
 
 	mNameTable.clear();
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	mNameIndex.clear();
+// [/SL:KB]
 }
 
 eControlType LLControlGroup::typeStringToEnum(const std::string& typestr)
@@ -535,6 +551,9 @@ LLControlVariable* LLControlGroup::declareControl(const std::string& name, eCont
 	LLControlVariable* control = new LLControlVariable(name, type, initial_val, comment, persist, hidefromsettingseditor, exclude_from_preset, tooltip, tooltipflags);
 // [/SL:KB]
 	mNameTable[name] = control;	
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	mNameIndex[LLInternedString(name)] = control;
+// [/SL:KB]
 	return control;
 }
 
@@ -33,8 +33,14 @@
 #include "llrect.h"
 #include "llrefcount.h"
 #include "llinstancetracker.h"
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+#include "llinternedstring.h"
+// [/SL:KB]
 
 #include <vector>
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+#include <unordered_map>
+// [/SL:KB]
 
 // *NOTE: boost::visit_each<> generates warning 4675 on .net 2003
 // Disable the warning for the boost includes.
@@ -233,6 +239,12 @@ class LLControlGroup : public LLInstanceTracker<LLControlGroup, std::string>
 protected:
 	typedef std::map<std::string, LLControlVariablePtr > ctrl_name_table_t;
 	ctrl_name_table_t mNameTable;
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	// Hashed by interned name for callers that hold an LLInternedString (mNameTable owns the controls, keeps them sorted
+	// and serves plain string lookups without having to intern the name first)
+	typedef std::unordered_map<LLInternedString, LLControlVariable*> ctrl_name_index_t;
+	ctrl_name_index_t mNameIndex;
+// [/SL:KB]
 	static const std::string mTypeString[TYPE_COUNT];
 
 public:
@@ -244,6 +256,9 @@ class LLControlGroup : public LLInstanceTracker<LLControlGroup, std::string>
 	void cleanup();
 
 	LLControlVariablePtr getControl(const std::string& name);
+// [SL:KB] - Patch: Viewer-OptimizationInternedNames | Checked: Catznip-6.7
+	LLControlVariablePtr getControl(const LLInternedString& name);
+// [/SL:KB]
 
 	struct ApplyFunctor
 	{
@@ -2406,7 +2406,11 @@ void LLAppearanceMgr::updateCOF(LLInventoryModel::item_array_t& body_items_new,
 	{
 		dump_sequential_xml(gAgentAvatarp->getFullname() + "_slam_request", contents);
 	}
-	slam_inventory_folder(getCOF(), contents, link_waiter);
+// [SL:KB] - Patch: Appearance-COFDiff | Checked: Catznip-6.7
+	static LLCachedControl<S32> s_nDiffMaxRemovals(gSavedSettings, "CurrentOutfitDiffMaxRemovals", 10);
+	diff_slam_inventory_folder(getCOF(), contents, s_nDiffMaxRemovals, link_waiter);
+// [/SL:KB]
+//	slam_inventory_folder(getCOF(), contents, link_waiter);
 
 	LL_DEBUGS("Avatar") << self_av_string() << "waiting for LLUpdateAppearanceOnDestroy" << LL_ENDL;
 }
@@ -3255,24 +3259,28 @@ void LLAppearanceMgr::addCOFItemLink(const LLInventoryItem *item,
 
 LLInventoryModel::item_array_t LLAppearanceMgr::findCOFItemLinks(const LLUUID& item_id)
 {
-	LLInventoryModel::item_array_t result;
-
-    LLUUID linked_id = gInventory.getLinkedItemID(item_id);
-    LLInventoryModel::cat_array_t cat_array;
-    LLInventoryModel::item_array_t item_array;
-    gInventory.collectDescendents(LLAppearanceMgr::getCOF(),
-                                  cat_array,
-                                  item_array,
-                                  LLInventoryModel::EXCLUDE_TRASH);
-    for (S32 i=0; i<item_array.size(); i++)
-    {
-        const LLViewerInventoryItem* inv_item = item_array.at(i).get();
-        if (inv_item->getLinkedUUID() == linked_id)
-        {
-            result.push_back(item_array.at(i));
-        }
-    }
-	return result;
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+	// The COF only holds links so the backlinks of the item are all we need to look at
+	return gInventory.collectLinksTo(gInventory.getLinkedItemID(item_id), LLAppearanceMgr::getCOF());
+// [/SL:KB]
+//	LLInventoryModel::item_array_t result;
+//
+//    LLUUID linked_id = gInventory.getLinkedItemID(item_id);
+//    LLInventoryModel::cat_array_t cat_array;
+//    LLInventoryModel::item_array_t item_array;
+//    gInventory.collectDescendents(LLAppearanceMgr::getCOF(),
+//                                  cat_array,
+//                                  item_array,
+//                                  LLInventoryModel::EXCLUDE_TRASH);
+//    for (S32 i=0; i<item_array.size(); i++)
+//    {
+//        const LLViewerInventoryItem* inv_item = item_array.at(i).get();
+//        if (inv_item->getLinkedUUID() == linked_id)
+//        {
+//            result.push_back(item_array.at(i));
+//        }
+//    }
+//	return result;
 }
 
 bool LLAppearanceMgr::isLinkedInCOF(const LLUUID& item_id)
@@ -171,6 +171,12 @@
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "llimageworker.h"
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+#include "lljobsystem.h"
+// [/SL:KB]
+// [SL:KB] - Patch: Viewer-OptimizationAsyncFileIO | Checked: Catznip-6.7
+#include "llasyncfileio.h"
+// [/SL:KB]
 #include "llevents.h"
 
 // The files below handle dependencies from cleanup.
@@ -835,6 +841,11 @@ bool LLAppViewer::init()
 // [/SL:KB]
 //	setupErrorHandling(mSecondInstance);
 
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+	// "mainloop" is posted to every frame; this needs to happen before anything starts listening on it
+	LLEventPumps::instance().obtain("mainloop").setFastDispatch(true);
+// [/SL:KB]
+
 	//
 	// Start of the application
 	//
@@ -1516,11 +1527,58 @@ bool LLAppViewer::frame()
 	return ret;
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+void LLAppViewer::saveTimerTrace(const std::string& reason, F64 window_secs)
+{
+	const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "timer_trace_" + LLDate::now().toHTTPDateString("%Y%m%d_%H%M%S") + ".json");
+
+	std::shared_ptr<LLTrace::BlockTimerTrace::snapshot_t> snapshotp = std::make_shared<LLTrace::BlockTimerTrace::snapshot_t>();
+	LLTrace::BlockTimerTrace::takeSnapshot(*snapshotp, window_secs);
+
+	auto writeTrace = [filename, reason, snapshotp]()
+		{
+			if (LLTrace::BlockTimerTrace::writeChromeTrace(filename, *snapshotp))
+			{
+				LL_INFOS("FastTimers") << "Saved timer trace to " << filename << " (" << reason << ")" << LL_ENDL;
+			}
+		};
+
+	// Formatting and writing out the trace takes far longer than the frame we're trying to diagnose
+	if (LLJobSystem* pJobSystem = LLJobSystem::getInstance())
+		pJobSystem->post(writeTrace, LLJobSystem::PRIORITY_LOW);
+	else
+		writeTrace();
+}
+// [/SL:KB]
+
 bool LLAppViewer::doFrame()
 {
-	LLEventPump& mainloop(LLEventPumps::instance().obtain("mainloop"));
+// [SL:KB] - Patch: Viewer-OptimizationEventDispatch | Checked: Catznip-6.7
+	static LLEventPumpHandle<> s_mainloop("mainloop");
+	LLEventPump& mainloop(s_mainloop.obtain());
+// [/SL:KB]
+//	LLEventPump& mainloop(LLEventPumps::instance().obtain("mainloop"));
 	LLSD newFrame;
 
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	{
+		// The previous frame's FTM_FRAME scope has ended by now so it's part of the trace
+		static LLTimer s_frame_timer;
+		static LLFrameTimer s_save_timer;
+		static LLCachedControl<F32> s_slow_frame_ms(gSavedSettings, "FastTimerTraceSlowFrame", 0.f);
+
+		const F32 frame_ms = s_frame_timer.getElapsedTimeAndResetF32() * 1000.f;
+		if ( (LLTrace::BlockTimerTrace::isEnabled()) && (s_slow_frame_ms > 0.f) && (frame_ms > s_slow_frame_ms) &&
+		     ((!s_save_timer.getStarted()) || (s_save_timer.getElapsedTimeF32() > 10.f)) )
+		{
+			// Don't flood the log folder when hitches come in bursts
+			s_save_timer.start();
+			// Only keep the slow frame along with what led up to it (the same amount of time again, but at least a second)
+			saveTimerTrace(llformat("slow frame (%.1f ms)", frame_ms), llmax(2.0 * frame_ms / 1000.0, 1.0));
+		}
+	}
+// [/SL:KB]
+
 	LL_RECORD_BLOCK_TIME(FTM_FRAME);
 	LLTrace::BlockTimer::processTimes();
 	LLTrace::get_frame_recording().nextPeriod();
@@ -2182,6 +2240,13 @@ bool LLAppViewer::cleanup()
     sImageDecodeThread = NULL;
 	delete mFastTimerLogThread;
 	mFastTimerLogThread = NULL;
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	// Only after everything that might still post jobs is gone
+	LLJobSystem::cleanupClass();
+// [/SL:KB]
+// [SL:KB] - Patch: Viewer-OptimizationAsyncFileIO | Checked: Catznip-6.7
+	LLAsyncFileIO::cleanupClass();
+// [/SL:KB]
 
 	if (LLFastTimerView::sAnalyzePerformance)
 	{
@@ -2421,15 +2486,29 @@ bool LLAppViewer::initThreads()
 
 	LLVFSThread::initClass(enable_threads && false);
 	LLLFSThread::initClass(enable_threads && false);
+// [SL:KB] - Patch: Viewer-OptimizationAsyncFileIO | Checked: Catznip-6.7
+	LLAsyncFileIO::initClass(gSavedSettings.getS32("AsyncFileIOThreadCount"));
+// [/SL:KB]
 
 	// Image decoding
-	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
-	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	LLJobSystem::initClass(gSavedSettings.getS32("JobSystemWorkerCount"));
+	const bool use_job_system = gSavedSettings.getBOOL("JobSystemQueuedThreads");
+	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true, use_job_system);
+	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true, use_job_system);
+// [/SL:KB]
+//	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
+//	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
 	LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(),
 													sImageDecodeThread,
 													enable_threads && true,
 													app_metrics_qa_mode);
 
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	LLTrace::BlockTimerTrace::setThreadName("Main");
+	LLTrace::BlockTimerTrace::setEnabled(gSavedSettings.getBOOL("FastTimerTraceEvents"));
+// [/SL:KB]
+
 	if (LLTrace::BlockTimer::sLog || LLTrace::BlockTimer::sMetricLog)
 	{
 		LLTrace::BlockTimer::setLogLock(new LLMutex());
@@ -219,6 +219,12 @@ class LLAppViewer : public LLApp
 
     void updateNameLookupUrl();
 
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	// Saves the recorded timer scopes of all threads (only the ones that ended in the last window_secs if non-zero) to the
+	// log folder as a Chrome trace; only the snapshot is taken on the calling thread, writing it happens on the job system
+	void saveTimerTrace(const std::string& reason, F64 window_secs = 0.0);
+// [/SL:KB]
+
 protected:
 	virtual bool initWindow(); // Initialize the viewer's window.
 	virtual void initLoggingAndGetLastDuration(); // Initialize log files, logging system
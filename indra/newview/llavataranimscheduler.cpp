@@ -0,0 +1,123 @@
+/**
+ * @file llavataranimscheduler.cpp
+ * @brief Per-frame animation budget and update tiers for avatars
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llavataranimscheduler.h"
+
+#include "llframetimer.h"
+#include "lltimer.h"
+#include "llviewercontrol.h"
+
+// ============================================================================
+// LLAvatarAnimScheduler
+//
+
+// Indexed by EAnimTier (TIER_FROZEN isn't area based)
+const F32 LLAvatarAnimScheduler::TIER_MIN_PIXEL_AREA[TIER_FROZEN] = { 128.f * 128.f, 64.f * 64.f, 24.f * 24.f, 0.f };
+
+static const U32 TIER_PERIODS[LLAvatarAnimScheduler::TIER_COUNT] = { 1, 2, 4, 8, 16 };
+static const char* TIER_NAMES[LLAvatarAnimScheduler::TIER_COUNT] = { "full", "reduced", "low", "minimal", "frozen" };
+
+LLAvatarAnimScheduler::LLAvatarAnimScheduler()
+	: mFrame(0)
+	, mFrameTime(0.0)
+	, mDeferredCount(0)
+{
+}
+
+// static
+U32 LLAvatarAnimScheduler::getTierPeriod(EAnimTier tier)
+{
+	return (tier < TIER_COUNT) ? TIER_PERIODS[tier] : 1;
+}
+
+// static
+const char* LLAvatarAnimScheduler::getTierName(EAnimTier tier)
+{
+	return (tier < TIER_COUNT) ? TIER_NAMES[tier] : "unknown";
+}
+
+// static
+bool LLAvatarAnimScheduler::isEnabled()
+{
+	static LLCachedControl<bool> s_anim_lod(gSavedSettings, "AvatarAnimationLOD", true);
+	return s_anim_lod;
+}
+
+void LLAvatarAnimScheduler::checkFrame()
+{
+	U32 cur_frame = LLFrameTimer::getFrameCount();
+	if (cur_frame != mFrame)
+	{
+		mFrame = cur_frame;
+		mFrameTime = 0.0;
+		mDeferredCount = 0;
+	}
+}
+
+bool LLAvatarAnimScheduler::requestUpdate(EAnimTier tier, U32 frames_since_update, U32 update_period)
+{
+	checkFrame();
+
+	static LLCachedControl<F32> s_frame_budget(gSavedSettings, "AvatarAnimationFrameBudget", 4.f);
+	if ( (TIER_FULL == tier) || (s_frame_budget <= 0.f) || (!isEnabled()) )
+	{
+		return true;
+	}
+
+	if (mFrameTime * 1000.0 < s_frame_budget)
+	{
+		return true;
+	}
+
+	// Over budget but don't let the avatar fall more than one extra period behind
+	if (frames_since_update >= 2 * update_period)
+	{
+		return true;
+	}
+
+	mDeferredCount++;
+	return false;
+}
+
+// ============================================================================
+// LLAvatarAnimScheduler::LLUpdateTimer
+//
+
+LLAvatarAnimScheduler::LLUpdateTimer::LLUpdateTimer()
+	: mStartTime(LLTimer::getTotalSeconds().value())
+{
+}
+
+LLAvatarAnimScheduler::LLUpdateTimer::~LLUpdateTimer()
+{
+	LLAvatarAnimScheduler& scheduler = LLAvatarAnimScheduler::instance();
+	scheduler.checkFrame();
+	scheduler.mFrameTime += LLTimer::getTotalSeconds().value() - mStartTime;
+}
+
+// ============================================================================
@@ -0,0 +1,88 @@
+/**
+ * @file llavataranimscheduler.h
+ * @brief Per-frame animation budget and update tiers for avatars
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAVATARANIMSCHEDULER_H
+#define LL_LLAVATARANIMSCHEDULER_H
+
+#include "llsingleton.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLAvatarAnimScheduler
+//
+// Each avatar is assigned an animation tier every frame (see
+// LLVOAvatar::computeAnimationTier()) which sets how often it runs a full
+// character update. On top of that the scheduler keeps a running total of
+// the time spent in avatar updates during the current frame; once that
+// exceeds the configured budget the remaining reduced-tier avatars are pushed
+// to a later frame instead of all landing in the same one. An avatar is never
+// deferred for more than one extra update period.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLAvatarAnimScheduler : public LLSingleton<LLAvatarAnimScheduler>
+{
+	LLSINGLETON(LLAvatarAnimScheduler);
+	LOG_CLASS(LLAvatarAnimScheduler);
+public:
+	enum EAnimTier
+	{
+		TIER_FULL = 0,	// Every frame
+		TIER_REDUCED,	// Close but small on screen, or a fast refreshing impostor
+		TIER_LOW,
+		TIER_MINIMAL,	// Far away, visually muted or a slow refreshing impostor
+		TIER_FROZEN,	// Not visible: pose is frozen and only the root keeps tracking the object
+		TIER_COUNT
+	};
+
+	// Smallest pixel area an avatar needs for each of the visible tiers
+	static const F32 TIER_MIN_PIXEL_AREA[TIER_FROZEN];
+
+	static U32				getTierPeriod(EAnimTier tier);
+	static const char*		getTierName(EAnimTier tier);
+	static bool				isEnabled();
+
+	// Returns true if an avatar whose update is due may run it this frame, false if it should be deferred to the next one
+	bool					requestUpdate(EAnimTier tier, U32 frames_since_update, U32 update_period);
+	U32						getDeferredCount() const	{ return mDeferredCount; }
+
+	// Accumulates the time spent in an avatar update against the frame budget
+	class LLUpdateTimer
+	{
+	public:
+		LLUpdateTimer();
+		~LLUpdateTimer();
+	protected:
+		F64 mStartTime;
+	};
+
+protected:
+	void					checkFrame();
+
+protected:
+	U32						mFrame;
+	F64						mFrameTime;		// Seconds spent in avatar updates so far this frame
+	U32						mDeferredCount;	// Number of updates deferred this frame
+};
+
+#endif // LL_LLAVATARANIMSCHEDULER_H
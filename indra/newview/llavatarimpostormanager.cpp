@@ -0,0 +1,162 @@
+/**
+ * @file llavatarimpostormanager.cpp
+ * @brief Per-frame budget and reuse policy for avatar impostor regeneration
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llavatarimpostormanager.h"
+
+#include "llframetimer.h"
+#include "lltimer.h"
+#include "llviewercontrol.h"
+#include "llvoavatar.h"
+#include "pipeline.h"
+
+// ============================================================================
+// LLAvatarImpostorManager
+//
+
+// Complexity that adds one unit of cost on top of the base cost of a regeneration
+static const F32 COMPLEXITY_PER_COST = 100000.f;
+// Impostor texels that add one unit of cost
+static const F32 TEXELS_PER_COST = 256.f * 256.f;
+// Weight of the latest measurement in the seconds per cost estimate
+static const F64 COST_ESTIMATE_WEIGHT = 0.1;
+// Priority boost for impostors showing an outdated appearance (rather than a slightly outdated angle)
+static const F32 APPEARANCE_CHANGE_PRIORITY = 4.f;
+
+LLAvatarImpostorManager::LLAvatarImpostorManager()
+	: mSecondsPerCost(0.0005)
+	, mGeneratedCount(0)
+	, mReusedCount(0)
+	, mDeferredCount(0)
+{
+}
+
+// static
+bool LLAvatarImpostorManager::isEnabled()
+{
+	static LLCachedControl<bool> s_impostor_throttle(gSavedSettings, "RenderAvatarImpostorThrottle", true);
+	return s_impostor_throttle;
+}
+
+// static
+F32 LLAvatarImpostorManager::estimateCost(LLVOAvatar* avatar)
+{
+	// Regenerating renders all of the avatar's geometry into a render target sized to its on-screen footprint
+	return 1.f + avatar->getVisualComplexity() / COMPLEXITY_PER_COST +
+		(F32)(avatar->mImpostor.getWidth() * avatar->mImpostor.getHeight()) / TEXELS_PER_COST;
+}
+
+void LLAvatarImpostorManager::updateImpostors(const std::vector<LLVOAvatar*>& avatars)
+{
+	static LLCachedControl<F32> s_frame_budget(gSavedSettings, "RenderAvatarImpostorFrameBudget", 2.f);
+	static LLCachedControl<F32> s_reuse_angle(gSavedSettings, "RenderAvatarImpostorReuseAngle", 5.f);
+
+	mGeneratedCount = mReusedCount = mDeferredCount = 0;
+	mRequests.clear();
+
+	const U32 cur_frame = LLFrameTimer::getFrameCount();
+	const F32 reuse_cos = cosf(llclamp((F32)s_reuse_angle, 0.f, 90.f) * DEG_TO_RAD);
+	for (LLVOAvatar* avatar : avatars)
+	{
+		const size_t appearance_hash = avatar->computeImpostorAppearanceHash();
+		const bool appearance_changed = (appearance_hash != avatar->getImpostorAppearanceHash());
+		if ( (!avatar->needsImpostorUpdate()) && (!avatar->mImpostorUpdatePending) )
+		{
+			if (!appearance_changed)
+			{
+				continue;
+			}
+		}
+		else if ( (!appearance_changed) && (avatar->isImpostorReusable(reuse_cos)) )
+		{
+			// Only the camera moved and not far enough to matter
+			avatar->mNeedsImpostorUpdate = FALSE;
+			avatar->mImpostorRequestFrame = 0;
+			avatar->mImpostorUpdatePending = false;
+			mReusedCount++;
+			continue;
+		}
+
+		if (0 == avatar->mImpostorRequestFrame)
+		{
+			avatar->mImpostorRequestFrame = cur_frame;
+		}
+
+		LLImpostorRequest request;
+		request.mAvatar = avatar;
+		request.mCost = estimateCost(avatar);
+		request.mFramesWaiting = cur_frame - avatar->mImpostorRequestFrame;
+		request.mHasImpostor = avatar->mImpostor.isComplete();
+		request.mPriority = (1.f + request.mFramesWaiting) * llmax(avatar->getPixelArea(), 1.f) * ((appearance_changed) ? APPEARANCE_CHANGE_PRIORITY : 1.f);
+		mRequests.push_back(request);
+	}
+
+	if (mRequests.empty())
+	{
+		return;
+	}
+
+	std::sort(mRequests.begin(), mRequests.end(), [](const LLImpostorRequest& lhs, const LLImpostorRequest& rhs) { return lhs.mPriority > rhs.mPriority; });
+
+	// The highest priority request, avatars that don't have an impostor to show yet and anything that has waited too long always
+	// go through (as does everything when there's no budget)
+	const F64 frame_budget = llmax((F32)s_frame_budget, 0.f) / 1000.0;
+	F64 frame_time = 0.0;
+	for (const LLImpostorRequest& request : mRequests)
+	{
+		if ( (0 == mGeneratedCount) || (frame_budget <= 0.0) || (!request.mHasImpostor) || (request.mFramesWaiting >= MAX_DEFER_FRAMES) ||
+		     (frame_time + request.mCost * mSecondsPerCost <= frame_budget) )
+		{
+			generateImpostor(request.mAvatar, request.mCost, frame_time);
+		}
+		else
+		{
+			// Keep drawing the current impostor (rather than the full avatar) until the request gets its turn
+			request.mAvatar->mNeedsImpostorUpdate = FALSE;
+			request.mAvatar->mImpostorUpdatePending = true;
+			mDeferredCount++;
+		}
+	}
+
+	LL_DEBUGS("AvatarRenderPipeline") << "Impostors generated: " << mGeneratedCount << " reused: " << mReusedCount << " deferred: " << mDeferredCount
+	                                  << " (" << frame_time * 1000.0 << "ms)" << LL_ENDL;
+}
+
+void LLAvatarImpostorManager::generateImpostor(LLVOAvatar* avatar, F32 cost, F64& frame_time)
+{
+	const F64 start_time = LLTimer::getTotalSeconds().value();
+
+	avatar->calcMutedAVColor();
+	gPipeline.generateImpostor(avatar);
+
+	const F64 elapsed = LLTimer::getTotalSeconds().value() - start_time;
+	mSecondsPerCost += (elapsed / cost - mSecondsPerCost) * COST_ESTIMATE_WEIGHT;
+	frame_time += elapsed;
+	mGeneratedCount++;
+}
+
+// ============================================================================
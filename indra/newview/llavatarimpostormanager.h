@@ -0,0 +1,86 @@
+/**
+ * @file llavatarimpostormanager.h
+ * @brief Per-frame budget and reuse policy for avatar impostor regeneration
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAVATARIMPOSTORMANAGER_H
+#define LL_LLAVATARIMPOSTORMANAGER_H
+
+#include "llsingleton.h"
+
+class LLVOAvatar;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLAvatarImpostorManager
+//
+// Decides which impostors get regenerated each frame. Every impostor keeps a
+// hash of the appearance it was rendered with (see
+// LLVOAvatar::computeImpostorAppearanceHash()): a changed hash always asks for
+// a new impostor, while an unchanged one lets the existing texture be reused
+// for as long as the camera stays within a small angle of where it was taken
+// from. The remaining requests are ordered by size on screen and time spent
+// waiting and regenerated until the estimated cost of the frame's updates
+// exceeds the configured budget. Avatars without any impostor are never held
+// back and nothing else waits longer than MAX_DEFER_FRAMES. Deferred avatars
+// keep drawing their current impostor in the meantime (see
+// LLVOAvatar::mImpostorUpdatePending).
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLAvatarImpostorManager : public LLSingleton<LLAvatarImpostorManager>
+{
+	LLSINGLETON(LLAvatarImpostorManager);
+	LOG_CLASS(LLAvatarImpostorManager);
+public:
+	static const U32 MAX_DEFER_FRAMES = 30;
+
+	static bool				isEnabled();
+
+	// Regenerates (or reuses) the impostors of the given avatars that need it
+	void					updateImpostors(const std::vector<LLVOAvatar*>& avatars);
+
+	U32						getGeneratedCount() const	{ return mGeneratedCount; }
+	U32						getReusedCount() const		{ return mReusedCount; }
+	U32						getDeferredCount() const	{ return mDeferredCount; }
+
+protected:
+	static F32				estimateCost(LLVOAvatar* avatar);
+	void					generateImpostor(LLVOAvatar* avatar, F32 cost, F64& frame_time);
+
+	struct LLImpostorRequest
+	{
+		LLVOAvatar*	mAvatar;
+		F32			mCost;
+		F32			mPriority;
+		U32			mFramesWaiting;
+		bool		mHasImpostor;
+	};
+
+protected:
+	std::vector<LLImpostorRequest> mRequests;
+	F64						mSecondsPerCost;	// Running estimate of how long one unit of cost takes to render
+	U32						mGeneratedCount;	// Number of impostors regenerated this frame
+	U32						mReusedCount;		// Number of update requests satisfied by the existing impostor this frame
+	U32						mDeferredCount;		// Number of update requests pushed to a later frame this frame
+};
+
+#endif // LL_LLAVATARIMPOSTORMANAGER_H
@@ -32,6 +32,9 @@
 #include "llinventorypanel.h"
 #include "lltooldraganddrop.h"
 #include "llfavoritesbar.h"
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+#include "lltrans.h"
+// [/SL:KB]
 
 //
 // class LLFolderViewModelInventory
@@ -107,9 +110,25 @@ void LLFolderViewModelInventory::sort( LLFolderViewFolder* folder )
 
 bool LLFolderViewModelInventory::contentsReady()
 {
-	return !LLInventoryModelBackgroundFetch::instance().folderFetchActive();
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	return (!LLInventoryModelBackgroundFetch::instance().folderFetchActive()) && (!isBuildingDeferredViews());
+// [/SL:KB]
+//	return !LLInventoryModelBackgroundFetch::instance().folderFetchActive();
 }
 
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+std::string LLFolderViewModelInventory::getStatusText()
+{
+	if (isBuildingDeferredViews())
+	{
+		LLStringUtil::format_map_t args;
+		args["[COUNT]"] = llformat("%d", mPendingDeferredFolders);
+		return LLTrans::getString("SearchingFolders", args);
+	}
+	return base_t::getStatusText();
+}
+// [/SL:KB]
+
 bool LLFolderViewModelInventory::isFolderComplete(LLFolderViewFolder* folder)
 {
 	LLFolderViewModelItemInventory* modelp = static_cast<LLFolderViewModelItemInventory*>(folder->getViewModelItem());
@@ -118,6 +137,13 @@ bool LLFolderViewModelInventory::isFolderComplete(LLFolderViewFolder* folder)
 	{
 		return false;
 	}
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	if (isDeferredFolder(cat_id))
+	{
+		// The folder's contents may well be known but there aren't any views for them yet
+		return false;
+	}
+// [/SL:KB]
 	LLViewerInventoryCategory* cat = gInventory.getCategory(cat_id);
 	if (cat)
 	{
@@ -364,7 +390,10 @@ bool LLInventorySort::operator()(const LLFolderViewModelItemInventory* const& a,
 
 	if (by_name)
 	{
-		S32 compare = LLStringUtil::compareDict(a->getDisplayName(), b->getDisplayName());
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+		S32 compare = a->getSortKey().compare(b->getSortKey());
+// [/SL:KB]
+//		S32 compare = LLStringUtil::compareDict(a->getDisplayName(), b->getDisplayName());
 		if (0 == compare)
 		{
 			return (a->getCreationDate() > b->getCreationDate());
@@ -381,7 +410,10 @@ bool LLInventorySort::operator()(const LLFolderViewModelItemInventory* const& a,
 		if (weight_a == weight_b)
 		{
             // Equal weight -> use alphabetical order
-			return (LLStringUtil::compareDict(a->getDisplayName(), b->getDisplayName()) < 0);
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+			return (a->getSortKey().compare(b->getSortKey()) < 0);
+// [/SL:KB]
+//			return (LLStringUtil::compareDict(a->getDisplayName(), b->getDisplayName()) < 0);
 		}
 		else if (weight_a == COMPUTE_STOCK_INFINITE)
         {
@@ -405,7 +437,10 @@ bool LLInventorySort::operator()(const LLFolderViewModelItemInventory* const& a,
 		time_t second_create = b->getCreationDate();
 		if (first_create == second_create)
 		{
-			return (LLStringUtil::compareDict(a->getDisplayName(), b->getDisplayName()) < 0);
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+			return (a->getSortKey().compare(b->getSortKey()) < 0);
+// [/SL:KB]
+//			return (LLStringUtil::compareDict(a->getDisplayName(), b->getDisplayName()) < 0);
 		}
 		else
 		{
@@ -426,3 +461,17 @@ LLFolderViewModelItemInventory::LLFolderViewModelItemInventory( class LLFolderVi
 //    mPrevPassedAllFilters(false)
 //{
 //}
+
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+const std::string& LLFolderViewModelItemInventory::getSortKey() const
+{
+	// Checking the cached name is a plain compare and much cheaper than the case/number aware compareDict() the key replaces
+	const std::string& display_name = getDisplayName();
+	if ( (mSortKey.empty()) || (mSortKeyName != display_name) )
+	{
+		mSortKeyName = display_name;
+		dict_sort_key(mSortKeyName, mSortKey);
+	}
+	return mSortKey;
+}
+// [/SL:KB]
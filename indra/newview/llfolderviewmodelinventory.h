@@ -83,8 +83,16 @@ class LLFolderViewModelItemInventory : public LLFolderViewModelItemInventoryComm
 
 	virtual BOOL startDrag(EDragAndDropType* type, LLUUID* id) const = 0;
 	virtual LLToolDragAndDrop::ESource getDragSource() const = 0;
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+	// Collation key of the display name (see dict_sort_key()); rebuilt whenever the display name changes
+	const std::string& getSortKey() const;
+// [/SL:KB]
 protected:
     bool mPrevPassedAllFilters;
+// [SL:KB] - Patch: Inventory-SortKeys | Checked: Catznip-6.7
+	mutable std::string mSortKeyName;
+	mutable std::string mSortKey;
+// [/SL:KB]
 };
 
 class LLInventorySort
@@ -141,8 +149,26 @@ class LLFolderViewModelInventory
 	bool contentsReady();
 	bool isFolderComplete(LLFolderViewFolder* folder);
 	bool startDrag(std::vector<LLFolderViewModelItem*>& items);
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	std::string getStatusText() override;
+
+	// Folders whose children don't have views yet (see LLInventoryPanel::buildFolderChildViews)
+	void addDeferredFolder(const LLUUID& folder_id) { mDeferredFolders.insert(folder_id); }
+	bool removeDeferredFolder(const LLUUID& folder_id) { return mDeferredFolders.erase(folder_id) > 0; }
+	bool isDeferredFolder(const LLUUID& folder_id) const { return mDeferredFolders.end() != mDeferredFolders.find(folder_id); }
+	bool hasDeferredFolders() const { return !mDeferredFolders.empty(); }
+	S32  getDeferredFolderCount() const { return (S32)mDeferredFolders.size(); }
+	const LLUUID& getFirstDeferredFolder() const { return *mDeferredFolders.begin(); }
+	// Number of deferred folders the filter still needs views for (see LLInventoryPanel::updateDeferredViews)
+	void setPendingDeferredFolders(S32 count) { mPendingDeferredFolders = count; }
+	bool isBuildingDeferredViews() const { return mPendingDeferredFolders > 0; }
+// [/SL:KB]
 
 private:
 	LLUUID mTaskID;
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	std::set<LLUUID> mDeferredFolders;
+	S32              mPendingDeferredFolders = 0;
+// [/SL:KB]
 };
 #endif // LL_LLFOLDERVIEWMODELINVENTORY_H
@@ -2204,13 +2204,27 @@ void LLGroupMgr::groupMembersRequestCoro(std::string url, LLUUID groupId)
         httpAdapter(new LLCoreHttpUtil::HttpCoroutineAdapter("groupMembersRequest", httpPolicy));
     LLCore::HttpRequest::ptr_t httpRequest(new LLCore::HttpRequest);
     LLCore::HttpOptions::ptr_t httpOpts = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+    LLCore::HttpHeaders::ptr_t httpHeaders(new LLCore::HttpHeaders);
+    httpHeaders->append(HTTP_OUT_HEADER_CONTENT_TYPE, HTTP_CONTENT_LLSD_XML);
+// [/SL:KB]
 
     mMemberRequestInFlight = true;
 
     LLSD postData = LLSD::emptyMap();
     postData["group_id"] = groupId;
 
-    LLSD result = httpAdapter->postAndSuspend(httpRequest, url, postData, httpOpts);
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+    // Member lists of large groups run into the megabytes so fetch the raw body and only decode one member at a time
+    LLCore::BufferArray::ptr_t rawBody(new LLCore::BufferArray);
+    {
+        LLCore::BufferArrayStream bas(rawBody.get());
+        LLSDSerialize::toXML(postData, bas);
+    }
+
+    LLSD result = httpAdapter->postRawAndSuspend(httpRequest, url, rawBody, httpOpts, httpHeaders);
+// [/SL:KB]
+//    LLSD result = httpAdapter->postAndSuspend(httpRequest, url, postData, httpOpts);
 
     LLSD httpResults = result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS];
     LLCore::HttpStatus status = LLCoreHttpUtil::HttpCoroutineAdapter::getStatusFromLLSD(httpResults);
@@ -2222,8 +2236,18 @@ void LLGroupMgr::groupMembersRequestCoro(std::string url, LLUUID groupId)
         return;
     }
 
-    result.erase(LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS);
-    LLGroupMgr::processCapGroupMembersRequest(result);
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+    const LLSDLazyView content(result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS_RAW], LLSDBufferParser::FORMAT_XML);
+    if (!content.isMap())
+    {
+        LL_WARNS("GrpMgr") << "Malformed group member data " << LL_ENDL;
+        mMemberRequestInFlight = false;
+        return;
+    }
+    LLGroupMgr::processCapGroupMembersRequest(content);
+// [/SL:KB]
+//    result.erase(LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS);
+//    LLGroupMgr::processCapGroupMembersRequest(result);
     mMemberRequestInFlight = false;
 }
 
@@ -2272,7 +2296,10 @@ void LLGroupMgr::sendCapGroupMembersRequest(const LLUUID& group_id)
 }
 
 
-void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+void LLGroupMgr::processCapGroupMembersRequest(const LLSDLazyView& content)
+// [/SL:KB]
+//void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 {
 	// Did we get anything in content?
 	if(!content.size())
@@ -2291,7 +2318,10 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 	}
 
 	// If we have no members, there's no reason to do anything else
-	S32	num_members	= content["member_count"];
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+	S32	num_members	= content["member_count"].asInteger();
+// [/SL:KB]
+//	S32	num_members	= content["member_count"];
 	if (num_members < 1)
 	{
 		LL_INFOS("GrpMgr") << "Received empty group members list for group id: " << group_id.asString() << LL_ENDL;
@@ -2304,9 +2334,14 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 	
 	group_datap->mMemberCount = num_members;
 
-	LLSD	member_list	= content["members"];
-	LLSD	titles		= content["titles"];
-	LLSD	defaults	= content["defaults"];
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+	const LLSDLazyView member_list = content["members"];
+	LLSD	titles		= content["titles"].asLLSD();
+	LLSD	defaults	= content["defaults"].asLLSD();
+// [/SL:KB]
+//	LLSD	member_list	= content["members"];
+//	LLSD	titles		= content["titles"];
+//	LLSD	defaults	= content["defaults"];
 
 	std::string online_status;
 	std::string title;
@@ -2318,10 +2353,14 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 	// Compute this once, rather than every time.
 	U64	default_powers	= llstrtou64(defaults["default_powers"].asString().c_str(), NULL, 16);
 
-	LLSD::map_const_iterator member_iter_start	= member_list.beginMap();
-	LLSD::map_const_iterator member_iter_end	= member_list.endMap();
-	for( ; member_iter_start != member_iter_end; ++member_iter_start)
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+	for (S32 member_idx = 0, member_cnt = member_list.size(); member_idx < member_cnt; ++member_idx)
 	{
+// [/SL:KB]
+//	LLSD::map_const_iterator member_iter_start	= member_list.beginMap();
+//	LLSD::map_const_iterator member_iter_end	= member_list.endMap();
+//	for( ; member_iter_start != member_iter_end; ++member_iter_start)
+//	{
 		// Reset defaults
 		online_status	= "unknown";
 		title			= titles[0].asString();
@@ -2329,8 +2368,12 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 		member_powers	= default_powers;
 		is_owner		= false;
 
-		const LLUUID member_id(member_iter_start->first);
-		LLSD member_info = member_iter_start->second;
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+		const LLUUID member_id(member_list.keyAt(member_idx));
+		LLSD member_info = member_list[member_idx].asLLSD();
+// [/SL:KB]
+//		const LLUUID member_id(member_iter_start->first);
+//		LLSD member_info = member_iter_start->second;
 		
 		if(member_info.has("last_login"))
 		{
@@ -39,6 +39,9 @@
 class LLMessageSystem;
 class LLGroupRoleData;
 class LLGroupMgr;
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+class LLSDLazyView;
+// [/SL:KB]
 
 enum LLGroupChange
 {
@@ -450,7 +453,10 @@ class LLGroupMgr : public LLSingleton<LLGroupMgr>
 
 private:
     void groupMembersRequestCoro(std::string url, LLUUID groupId);
-    void processCapGroupMembersRequest(const LLSD& content);
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+    void processCapGroupMembersRequest(const LLSDLazyView& content);
+// [/SL:KB]
+//    void processCapGroupMembersRequest(const LLSD& content);
 
     void getGroupBanRequestCoro(std::string url, LLUUID groupId);
     void postGroupBanRequestCoro(std::string url, LLUUID groupId, U32 action, uuid_vec_t banList, bool update);
@@ -3930,6 +3930,12 @@ void LLFolderBridge::openItem()
 	LLInventoryModel* model = getInventoryModel();
 	if(!model) return;
 	if(mUUID.isNull()) return;
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	if (LLInventoryPanel* pInvPanel = mInventoryPanel.get())
+	{
+		pInvPanel->buildFolderChildViews(mUUID);
+	}
+// [/SL:KB]
 	bool fetching_inventory = model->fetchDescendentsOf(mUUID);
 	// Only change folder type if we have the folder contents.
 	if (!fetching_inventory)
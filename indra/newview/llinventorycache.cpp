@@ -0,0 +1,803 @@
+/**
+ * @file llinventorycache.cpp
+ * @brief Binary, memory mapped inventory cache with incremental saves
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorycache.h"
+
+#include "llfile.h"
+#include "llviewerinventory.h"
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char * const LOG_INV("Inventory");
+
+// ============================================================================
+// File format
+//
+
+namespace
+{
+	const char CACHE_MAGIC[8] = { 'L', 'L', 'I', 'N', 'V', 'B', 'I', 'N' };
+	const U32 CACHE_FORMAT_VERSION = 1;
+	// Records are written in host byte order
+	const U32 CACHE_BYTE_ORDER = 0x01020304;
+	const U32 SEGMENT_MAGIC = 0x4D474553; // "SEGM"
+	// The segment replaces everything that came before it
+	const U32 SEGMENT_FULL = 0x01;
+	// Appending stops (and the next save rewrites the file) once there are this many segments
+	const U32 MAX_SEGMENTS = 16;
+
+	struct FileHeader
+	{
+		char	mMagic[8];
+		U32		mFormatVersion;
+		U32		mByteOrder;
+		S32		mInvCacheVersion;
+		U32		mReserved;
+		U64		mReserved2;
+	};
+	static_assert(sizeof(FileHeader) == 32, "Unexpected FileHeader size");
+
+	// Followed by the string offsets (mStringCount + 1 entries, padded to 8 bytes), the string data (mStringBytes),
+	// the folder records, the item records and the removed folder ids
+	struct SegmentHeader
+	{
+		U32		mMagic;
+		U32		mFlags;
+		U32		mStringCount;
+		U32		mFolderCount;
+		U32		mItemCount;
+		U32		mRemovedCount;
+		U64		mStringBytes;
+		U64		mPayloadSize;
+		U64		mChecksum;
+	};
+	static_assert(sizeof(SegmentHeader) == 48, "Unexpected SegmentHeader size");
+
+	struct FolderRecord
+	{
+		LLUUID	mID;
+		LLUUID	mParentID;
+		LLUUID	mOwnerID;
+		U64		mHash;
+		S32		mVersion;
+		U32		mName;
+		U32		mFirstItem;
+		U32		mItemCount;
+		S8		mPreferredType;
+		U8		mPad[7];
+	};
+	static_assert(sizeof(FolderRecord) == 80, "Unexpected FolderRecord size");
+
+	// The parent is the folder record the item belongs to
+	struct ItemRecord
+	{
+		LLUUID	mID;
+		LLUUID	mAssetID;
+		LLUUID	mCreatorID;
+		LLUUID	mOwnerID;
+		LLUUID	mLastOwnerID;
+		LLUUID	mGroupID;
+		U32		mMaskBase;
+		U32		mMaskOwner;
+		U32		mMaskGroup;
+		U32		mMaskEveryone;
+		U32		mMaskNext;
+		U32		mFlags;
+		S64		mCreationDate;
+		S32		mSalePrice;
+		U32		mName;
+		U32		mDescription;
+		S8		mType;
+		S8		mInvType;
+		U8		mSaleType;
+		U8		mPad;
+	};
+	static_assert(sizeof(ItemRecord) == 144, "Unexpected ItemRecord size");
+
+	U64 pad8(U64 size)
+	{
+		return (size + 7) & ~(U64)7;
+	}
+
+	// FNV-1a
+	class LLCacheHasher
+	{
+	public:
+		void addBytes(const void* data, size_t size)
+		{
+			const U8* bytes = (const U8*)data;
+			for (size_t idx = 0; idx < size; idx++)
+			{
+				mHash = (mHash ^ bytes[idx]) * 0x100000001b3ULL;
+			}
+		}
+		template<typename T> void addValue(const T& value) { addBytes(&value, sizeof(T)); }
+		void addString(const std::string& str)
+		{
+			addValue<U32>((U32)str.size());
+			addBytes(str.data(), str.size());
+		}
+		U64 get() const { return mHash; }
+
+	protected:
+		U64 mHash = 0xcbf29ce484222325ULL;
+	};
+
+	typedef std::vector<const LLViewerInventoryItem*> folder_items_t;
+
+	// NOTE: LLViewerInventoryItem follows links for most of its getters so only use the LLInventoryItem versions
+	void fill_item_record(ItemRecord& rec, const LLViewerInventoryItem* itemp)
+	{
+		memset(&rec, 0, sizeof(ItemRecord));
+
+		const LLPermissions& perm = itemp->LLInventoryItem::getPermissions();
+		rec.mID = itemp->getUUID();
+		rec.mAssetID = itemp->LLInventoryItem::getAssetUUID();
+		rec.mCreatorID = perm.getCreator();
+		rec.mOwnerID = perm.getOwner();
+		rec.mLastOwnerID = perm.getLastOwner();
+		rec.mGroupID = perm.getGroup();
+		rec.mMaskBase = perm.getMaskBase();
+		rec.mMaskOwner = perm.getMaskOwner();
+		rec.mMaskGroup = perm.getMaskGroup();
+		rec.mMaskEveryone = perm.getMaskEveryone();
+		rec.mMaskNext = perm.getMaskNextOwner();
+		rec.mFlags = itemp->LLInventoryItem::getFlags();
+		rec.mCreationDate = (S64)itemp->LLInventoryItem::getCreationDate();
+		rec.mSalePrice = itemp->LLInventoryItem::getSaleInfo().getSalePrice();
+		rec.mType = (S8)itemp->LLInventoryItem::getType();
+		rec.mInvType = (S8)itemp->LLInventoryItem::getInventoryType();
+		rec.mSaleType = (U8)itemp->LLInventoryItem::getSaleInfo().getSaleType();
+	}
+
+	// Changes whenever anything we'd write out for the folder changes
+	U64 hash_folder(const LLViewerInventoryCategory* catp, const folder_items_t& items)
+	{
+		LLCacheHasher hasher;
+		hasher.addValue(catp->getParentUUID());
+		hasher.addValue(catp->getOwnerID());
+		hasher.addValue<S32>(catp->getVersion());
+		hasher.addValue<S8>((S8)catp->getPreferredType());
+		hasher.addString(catp->getName());
+		hasher.addValue<U32>((U32)items.size());
+
+		ItemRecord rec;
+		for (const LLViewerInventoryItem* itemp : items)
+		{
+			fill_item_record(rec, itemp);
+			hasher.addValue(rec);
+			hasher.addString(itemp->LLInventoryItem::getName());
+			hasher.addString(itemp->LLInventoryItem::getDescription());
+		}
+		return hasher.get();
+	}
+
+	// ============================================================================
+	// LLCacheSegmentWriter class
+	//
+
+	class LLCacheSegmentWriter
+	{
+	public:
+		LLCacheSegmentWriter()
+		{
+			// Index 0 is always the empty string
+			mStringOffsets.push_back(0);
+			mStringOffsets.push_back(0);
+			mStringIndex[std::string()] = 0;
+		}
+
+		void addFolder(const LLViewerInventoryCategory* catp, const folder_items_t& items, U64 hash)
+		{
+			FolderRecord folder;
+			memset(&folder, 0, sizeof(FolderRecord));
+			folder.mID = catp->getUUID();
+			folder.mParentID = catp->getParentUUID();
+			folder.mOwnerID = catp->getOwnerID();
+			folder.mHash = hash;
+			folder.mVersion = catp->getVersion();
+			folder.mName = addString(catp->getName());
+			folder.mFirstItem = (U32)mItems.size();
+			folder.mItemCount = (U32)items.size();
+			folder.mPreferredType = (S8)catp->getPreferredType();
+			mFolders.push_back(folder);
+
+			for (const LLViewerInventoryItem* itemp : items)
+			{
+				mItems.push_back(ItemRecord());
+				ItemRecord& rec = mItems.back();
+				fill_item_record(rec, itemp);
+				rec.mName = addString(itemp->LLInventoryItem::getName());
+				rec.mDescription = addString(itemp->LLInventoryItem::getDescription());
+			}
+		}
+
+		void addRemoved(const LLUUID& folder_id)
+		{
+			mRemoved.push_back(folder_id);
+		}
+
+		U32 getFolderCount() const { return (U32)mFolders.size(); }
+		U32 getItemCount() const { return (U32)mItems.size(); }
+		U32 getRemovedCount() const { return (U32)mRemoved.size(); }
+
+		void write(std::string& out, bool full) const
+		{
+			const U32 string_count = (U32)mStringOffsets.size() - 1;
+			const U64 offsets_size = pad8(mStringOffsets.size() * sizeof(U32));
+			const U64 string_bytes = pad8(mStringBlob.size());
+
+			SegmentHeader header;
+			memset(&header, 0, sizeof(SegmentHeader));
+			header.mMagic = SEGMENT_MAGIC;
+			header.mFlags = (full) ? SEGMENT_FULL : 0;
+			header.mStringCount = string_count;
+			header.mFolderCount = (U32)mFolders.size();
+			header.mItemCount = (U32)mItems.size();
+			header.mRemovedCount = (U32)mRemoved.size();
+			header.mStringBytes = string_bytes;
+			header.mPayloadSize = offsets_size + string_bytes + mFolders.size() * sizeof(FolderRecord) + mItems.size() * sizeof(ItemRecord) + mRemoved.size() * sizeof(LLUUID);
+
+			const size_t header_pos = out.size();
+			out.reserve(header_pos + sizeof(SegmentHeader) + header.mPayloadSize);
+			out.append((const char*)&header, sizeof(SegmentHeader));
+
+			const size_t payload_pos = out.size();
+			out.append((const char*)mStringOffsets.data(), mStringOffsets.size() * sizeof(U32));
+			out.append(payload_pos + offsets_size - out.size(), '\0');
+			out.append(mStringBlob);
+			out.append(payload_pos + offsets_size + string_bytes - out.size(), '\0');
+			if (!mFolders.empty())
+				out.append((const char*)mFolders.data(), mFolders.size() * sizeof(FolderRecord));
+			if (!mItems.empty())
+				out.append((const char*)mItems.data(), mItems.size() * sizeof(ItemRecord));
+			for (const LLUUID& folder_id : mRemoved)
+				out.append((const char*)folder_id.mData, UUID_BYTES);
+			llassert(out.size() - payload_pos == header.mPayloadSize);
+
+			LLCacheHasher hasher;
+			hasher.addBytes(out.data() + payload_pos, header.mPayloadSize);
+			header.mChecksum = hasher.get();
+			memcpy(&out[header_pos], &header, sizeof(SegmentHeader));
+		}
+
+	protected:
+		U32 addString(const std::string& str)
+		{
+			auto itString = mStringIndex.find(str);
+			if (mStringIndex.end() != itString)
+			{
+				return itString->second;
+			}
+
+			const U32 idx = (U32)mStringOffsets.size() - 1;
+			mStringBlob.append(str);
+			mStringOffsets.push_back((U32)mStringBlob.size());
+			mStringIndex.insert(std::make_pair(str, idx));
+			return idx;
+		}
+
+	protected:
+		std::vector<FolderRecord> mFolders;
+		std::vector<ItemRecord>   mItems;
+		std::vector<LLUUID>       mRemoved;
+		std::vector<U32>          mStringOffsets;
+		std::string               mStringBlob;
+		boost::unordered_map<std::string, U32> mStringIndex;
+	};
+
+	// ============================================================================
+	// LLCacheSegmentReader class
+	//
+
+	// Points straight into the mapped file
+	struct LLCacheSegmentReader
+	{
+		const SegmentHeader* mHeader = nullptr;
+		const U32*           mStringOffsets = nullptr;
+		const char*          mStrings = nullptr;
+		const FolderRecord*  mFolders = nullptr;
+		const ItemRecord*    mItems = nullptr;
+		const LLUUID*        mRemoved = nullptr;
+
+		// Returns false if the segment is incomplete or damaged
+		bool init(const U8* data, U64 size)
+		{
+			if (size < sizeof(SegmentHeader))
+				return false;
+
+			mHeader = (const SegmentHeader*)data;
+			if ( (SEGMENT_MAGIC != mHeader->mMagic) || (mHeader->mPayloadSize > size - sizeof(SegmentHeader)) )
+				return false;
+
+			const U64 offsets_size = pad8(((U64)mHeader->mStringCount + 1) * sizeof(U32));
+			const U64 expected_size = offsets_size + mHeader->mStringBytes + (U64)mHeader->mFolderCount * sizeof(FolderRecord) +
+			                          (U64)mHeader->mItemCount * sizeof(ItemRecord) + (U64)mHeader->mRemovedCount * sizeof(LLUUID);
+			if ( (expected_size != mHeader->mPayloadSize) || (0 != (mHeader->mStringBytes & 7)) )
+				return false;
+
+			const U8* payload = data + sizeof(SegmentHeader);
+			LLCacheHasher hasher;
+			hasher.addBytes(payload, mHeader->mPayloadSize);
+			if (hasher.get() != mHeader->mChecksum)
+				return false;
+
+			mStringOffsets = (const U32*)payload;
+			mStrings = (const char*)(payload + offsets_size);
+			mFolders = (const FolderRecord*)(payload + offsets_size + mHeader->mStringBytes);
+			mItems = (const ItemRecord*)(mFolders + mHeader->mFolderCount);
+			mRemoved = (const LLUUID*)(mItems + mHeader->mItemCount);
+
+			// Check every index now so nothing needs to be checked while creating the inventory objects
+			for (U32 idx = 0; idx < mHeader->mStringCount; idx++)
+			{
+				if ( (mStringOffsets[idx] > mStringOffsets[idx + 1]) || (mStringOffsets[idx + 1] > mHeader->mStringBytes) )
+					return false;
+			}
+			for (U32 idx = 0; idx < mHeader->mFolderCount; idx++)
+			{
+				const FolderRecord& folder = mFolders[idx];
+				if ( (folder.mName >= mHeader->mStringCount) || ((U64)folder.mFirstItem + folder.mItemCount > mHeader->mItemCount) )
+					return false;
+			}
+			for (U32 idx = 0; idx < mHeader->mItemCount; idx++)
+			{
+				const ItemRecord& item = mItems[idx];
+				if ( (item.mName >= mHeader->mStringCount) || (item.mDescription >= mHeader->mStringCount) )
+					return false;
+			}
+			return true;
+		}
+
+		U64 getSize() const
+		{
+			return sizeof(SegmentHeader) + mHeader->mPayloadSize;
+		}
+
+		std::string getString(U32 idx) const
+		{
+			return std::string(mStrings + mStringOffsets[idx], mStringOffsets[idx + 1] - mStringOffsets[idx]);
+		}
+	};
+
+	// ============================================================================
+	// LLMappedCacheFile class
+	//
+
+	// Read-only view of a whole file; falls back to reading it into memory if it can't be mapped
+	class LLMappedCacheFile
+	{
+	public:
+		LLMappedCacheFile(const std::string& filename)
+		{
+#if LL_WINDOWS
+			mFile = CreateFileW(ll_convert_string_to_wide(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (INVALID_HANDLE_VALUE != mFile)
+			{
+				LARGE_INTEGER size;
+				if ( (GetFileSizeEx(mFile, &size)) && (size.QuadPart > 0) )
+				{
+					mMapping = CreateFileMappingW(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+					if (mMapping)
+					{
+						mData = (const U8*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+						if (mData)
+							mSize = (U64)size.QuadPart;
+					}
+				}
+			}
+#else
+			mFile = ::open(filename.c_str(), O_RDONLY);
+			if (-1 != mFile)
+			{
+				struct stat stat_data;
+				if ( (0 == fstat(mFile, &stat_data)) && (stat_data.st_size > 0) )
+				{
+					void* data = mmap(NULL, stat_data.st_size, PROT_READ, MAP_PRIVATE, mFile, 0);
+					if (MAP_FAILED != data)
+					{
+						mData = (const U8*)data;
+						mSize = (U64)stat_data.st_size;
+						madvise(data, stat_data.st_size, MADV_SEQUENTIAL);
+					}
+				}
+			}
+#endif
+			if ( (!mData) && (LLFile::isfile(filename)) )
+			{
+				readFile(filename);
+			}
+		}
+
+		~LLMappedCacheFile()
+		{
+#if LL_WINDOWS
+			if ( (mData) && (mFallback.empty()) )
+				UnmapViewOfFile(mData);
+			if (mMapping)
+				CloseHandle(mMapping);
+			if (INVALID_HANDLE_VALUE != mFile)
+				CloseHandle(mFile);
+#else
+			if ( (mData) && (mFallback.empty()) )
+				munmap((void*)mData, mSize);
+			if (-1 != mFile)
+				::close(mFile);
+#endif
+		}
+
+		const U8* getData() const { return mData; }
+		U64       getSize() const { return mSize; }
+
+	protected:
+		void readFile(const std::string& filename)
+		{
+			LLFILE* fp = LLFile::fopen(filename, "rb");
+			if (fp)
+			{
+				fseek(fp, 0, SEEK_END);
+				const long size = ftell(fp);
+				fseek(fp, 0, SEEK_SET);
+				if (size > 0)
+				{
+					mFallback.resize(size);
+					if (fread(mFallback.data(), 1, size, fp) == (size_t)size)
+					{
+						mData = mFallback.data();
+						mSize = (U64)size;
+					}
+					else
+					{
+						mFallback.clear();
+					}
+				}
+				fclose(fp);
+			}
+		}
+
+	protected:
+		const U8*       mData = nullptr;
+		U64             mSize = 0;
+		std::vector<U8> mFallback;
+#if LL_WINDOWS
+		HANDLE          mFile = INVALID_HANDLE_VALUE;
+		HANDLE          mMapping = NULL;
+#else
+		int             mFile = -1;
+#endif
+	};
+}
+
+// ============================================================================
+// LLInventoryCache class
+//
+
+bool LLInventoryCache::load(const std::string& filename,
+							LLInventoryModel::cat_array_t& categories,
+							LLInventoryModel::item_array_t& items,
+							LLInventoryModel::changed_items_t& cats_to_update,
+							bool& is_cache_obsolete)
+{
+	is_cache_obsolete = false;
+	mFiles.erase(filename);
+
+	LLMappedCacheFile file(filename);
+	if (!file.getData())
+	{
+		LL_INFOS(LOG_INV) << "unable to load inventory from: " << filename << LL_ENDL;
+		return false;
+	}
+	LL_INFOS(LOG_INV) << "loading inventory from: (" << filename << ")" << LL_ENDL;
+
+	const U8* data = file.getData();
+	const U64 size = file.getSize();
+
+	const FileHeader* headerp = (const FileHeader*)data;
+	if ( (size < sizeof(FileHeader)) || (0 != memcmp(headerp->mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC))) ||
+	     (CACHE_FORMAT_VERSION != headerp->mFormatVersion) || (CACHE_BYTE_ORDER != headerp->mByteOrder) ||
+	     (LLInventoryModel::sCurrentInvCacheVersion != headerp->mInvCacheVersion) )
+	{
+		LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+		is_cache_obsolete = true;
+		return false;
+	}
+
+	// Figure out which segment has the most recent copy of every folder
+	struct FolderRef
+	{
+		U32                 mSegment;
+		const FolderRecord* mFolder;
+	};
+	boost::unordered_map<LLUUID, FolderRef> folders;
+	std::vector<LLCacheSegmentReader> segments;
+
+	U64 pos = sizeof(FileHeader);
+	while (pos < size)
+	{
+		LLCacheSegmentReader segment;
+		if (!segment.init(data + pos, size - pos))
+		{
+			// Most likely an append that didn't finish; everything before it is still good
+			LL_WARNS(LOG_INV) << "Ignoring damaged inventory cache segment at offset " << pos << LL_ENDL;
+			break;
+		}
+
+		if (segment.mHeader->mFlags & SEGMENT_FULL)
+		{
+			folders.clear();
+		}
+		const U32 segment_idx = (U32)segments.size();
+		for (U32 idx = 0; idx < segment.mHeader->mFolderCount; idx++)
+		{
+			FolderRef& ref = folders[segment.mFolders[idx].mID];
+			ref.mSegment = segment_idx;
+			ref.mFolder = &segment.mFolders[idx];
+		}
+		for (U32 idx = 0; idx < segment.mHeader->mRemovedCount; idx++)
+		{
+			folders.erase(segment.mRemoved[idx]);
+		}
+
+		segments.push_back(segment);
+		pos += segment.getSize();
+	}
+
+	FileState& state = mFiles[filename];
+	state.mFolderHashes.reserve(folders.size());
+	categories.reserve(categories.size() + folders.size());
+
+	for (const auto& folder_ref : folders)
+	{
+		const LLCacheSegmentReader& segment = segments[folder_ref.second.mSegment];
+		const FolderRecord& folder = *folder_ref.second.mFolder;
+
+		LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(folder.mID, folder.mParentID, (LLFolderType::EType)folder.mPreferredType,
+		                                                                         segment.getString(folder.mName), folder.mOwnerID);
+		cat->setVersion(folder.mVersion);
+		categories.push_back(cat);
+		state.mFolderHashes[folder.mID] = folder.mHash;
+
+		for (U32 idx = folder.mFirstItem, end = folder.mFirstItem + folder.mItemCount; idx < end; idx++)
+		{
+			const ItemRecord& rec = segment.mItems[idx];
+			if (rec.mID.isNull())
+			{
+				LL_WARNS(LOG_INV) << "Ignoring inventory with null item id: " << segment.getString(rec.mName) << LL_ENDL;
+				continue;
+			}
+			if (LLAssetType::AT_UNKNOWN == (LLAssetType::EType)rec.mType)
+			{
+				cats_to_update.insert(folder.mID);
+				continue;
+			}
+
+			LLPermissions perm;
+			perm.init(rec.mCreatorID, rec.mOwnerID, rec.mLastOwnerID, rec.mGroupID);
+			perm.setMaskBase(rec.mMaskBase);
+			perm.setMaskOwner(rec.mMaskOwner);
+			perm.setMaskEveryone(rec.mMaskEveryone);
+			perm.setMaskGroup(rec.mMaskGroup);
+			perm.setMaskNext(rec.mMaskNext);
+			perm.fix();
+
+			items.push_back(new LLViewerInventoryItem(rec.mID, folder.mID, perm, rec.mAssetID,
+			                                          (LLAssetType::EType)rec.mType, (LLInventoryType::EType)rec.mInvType,
+			                                          segment.getString(rec.mName), segment.getString(rec.mDescription),
+			                                          LLSaleInfo((LLSaleInfo::EForSale)rec.mSaleType, rec.mSalePrice),
+			                                          rec.mFlags, (time_t)rec.mCreationDate));
+		}
+	}
+
+	// Only append to the file if it ended where we expected it to
+	state.mFileSize = pos;
+	state.mSegmentCount = (U32)segments.size();
+	state.mValid = (pos == size) && (!segments.empty());
+
+	LL_INFOS(LOG_INV) << "Loaded " << folders.size() << " categories from " << segments.size() << " inventory cache segment(s)" << LL_ENDL;
+	return true;
+}
+
+bool LLInventoryCache::save(const std::string& filename,
+							const LLInventoryModel::cat_array_t& categories,
+							const LLInventoryModel::item_array_t& items)
+{
+	if (filename.empty())
+	{
+		LL_ERRS(LOG_INV) << "Filename is Null!" << LL_ENDL;
+		return false;
+	}
+
+	// Only folders with a known version are worth caching (see LLInventoryModel::saveToFile)
+	boost::unordered_map<LLUUID, folder_items_t> folder_items;
+	folder_items.reserve(categories.size());
+	for (const LLPointer<LLViewerInventoryCategory>& cat : categories)
+	{
+		if (LLViewerInventoryCategory::VERSION_UNKNOWN != cat->getVersion())
+		{
+			folder_items[cat->getUUID()];
+		}
+	}
+	for (const LLPointer<LLViewerInventoryItem>& item : items)
+	{
+		auto itFolder = folder_items.find(item->getParentUUID());
+		if (folder_items.end() != itFolder)
+		{
+			itFolder->second.push_back(item.get());
+		}
+	}
+
+	FileState& state = mFiles[filename];
+	llstat stat_data;
+	bool append = (state.mValid) && (state.mSegmentCount < MAX_SEGMENTS) &&
+	              (0 == LLFile::stat(filename, &stat_data)) && ((U64)stat_data.st_size == state.mFileSize);
+
+	struct FolderEntry
+	{
+		const LLViewerInventoryCategory* mCategory;
+		U64  mHash;
+		bool mChanged;
+	};
+	std::vector<FolderEntry> folders;
+	folders.reserve(folder_items.size());
+	boost::unordered_map<LLUUID, U64> folder_hashes;
+	folder_hashes.reserve(folder_items.size());
+	size_t changed_count = 0;
+	for (const LLPointer<LLViewerInventoryCategory>& cat : categories)
+	{
+		auto itFolder = folder_items.find(cat->getUUID());
+		if ( (folder_items.end() == itFolder) || (folder_hashes.count(cat->getUUID())) )
+		{
+			continue;
+		}
+
+		const U64 hash = hash_folder(cat, itFolder->second);
+		folder_hashes[cat->getUUID()] = hash;
+
+		auto itPrevHash = state.mFolderHashes.find(cat->getUUID());
+		const bool changed = (state.mFolderHashes.end() == itPrevHash) || (itPrevHash->second != hash);
+		folders.push_back(FolderEntry{ cat, hash, changed });
+		if (changed)
+		{
+			changed_count++;
+		}
+	}
+
+	// Rewriting is cheaper than appending most of the file again
+	if ( (append) && (changed_count * 2 > folders.size()) )
+	{
+		append = false;
+	}
+
+	LLCacheSegmentWriter writer;
+	for (const FolderEntry& folder : folders)
+	{
+		if ( (!append) || (folder.mChanged) )
+		{
+			writer.addFolder(folder.mCategory, folder_items[folder.mCategory->getUUID()], folder.mHash);
+		}
+	}
+	if (append)
+	{
+		for (const auto& prev_folder : state.mFolderHashes)
+		{
+			if (!folder_hashes.count(prev_folder.first))
+			{
+				writer.addRemoved(prev_folder.first);
+			}
+		}
+
+		if ( (0 == writer.getFolderCount()) && (0 == writer.getRemovedCount()) )
+		{
+			LL_INFOS(LOG_INV) << "Inventory cache is up to date: " << filename << LL_ENDL;
+			return true;
+		}
+	}
+
+	LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
+
+	std::string buffer;
+	writer.write(buffer, !append);
+	if ( (append) ? writeAppend(filename, buffer) : writeFull(filename, buffer) )
+	{
+		state.mFolderHashes.swap(folder_hashes);
+		state.mFileSize = (append) ? state.mFileSize + buffer.size() : sizeof(FileHeader) + buffer.size();
+		state.mSegmentCount = (append) ? state.mSegmentCount + 1 : 1;
+		state.mValid = true;
+
+		LL_INFOS(LOG_INV) << "Inventory saved: " << writer.getFolderCount() << " categories, " << writer.getItemCount() << " items"
+		                  << ((append) ? " (appended)" : "") << LL_ENDL;
+		return true;
+	}
+
+	mFiles.erase(filename);
+	LL_WARNS(LOG_INV) << "unable to save inventory to: " << filename << LL_ENDL;
+	return false;
+}
+
+void LLInventoryCache::remove(const std::string& filename)
+{
+	mFiles.erase(filename);
+	if (LLFile::isfile(filename))
+	{
+		LLFile::remove(filename);
+	}
+}
+
+bool LLInventoryCache::writeFull(const std::string& filename, const std::string& segment)
+{
+	// Write to a temporary file first so a failed save doesn't leave us without a cache at all
+	const std::string temp_filename = filename + ".tmp";
+	LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+	if (!fp)
+	{
+		return false;
+	}
+
+	FileHeader header;
+	memset(&header, 0, sizeof(FileHeader));
+	memcpy(header.mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.mFormatVersion = CACHE_FORMAT_VERSION;
+	header.mByteOrder = CACHE_BYTE_ORDER;
+	header.mInvCacheVersion = LLInventoryModel::sCurrentInvCacheVersion;
+
+	bool success = (1 == fwrite(&header, sizeof(FileHeader), 1, fp)) && (1 == fwrite(segment.data(), segment.size(), 1, fp));
+	success &= (0 == fclose(fp));
+	if (success)
+	{
+		if (LLFile::isfile(filename))
+		{
+			LLFile::remove(filename);
+		}
+		success = (0 == LLFile::rename(temp_filename, filename));
+	}
+	if (!success)
+	{
+		LLFile::remove(temp_filename, ENOENT);
+	}
+	return success;
+}
+
+bool LLInventoryCache::writeAppend(const std::string& filename, const std::string& segment)
+{
+	LLFILE* fp = LLFile::fopen(filename, "ab");
+	if (!fp)
+	{
+		return false;
+	}
+
+	bool success = (1 == fwrite(segment.data(), segment.size(), 1, fp));
+	success &= (0 == fclose(fp));
+	return success;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file llinventorycache.h
+ * @brief Binary, memory mapped inventory cache with incremental saves
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHE_H
+#define LL_LLINVENTORYCACHE_H
+
+#include "llinventorymodel.h"
+#include "llsingleton.h"
+
+#include <boost/unordered_map.hpp>
+
+//============================================================================
+// LLInventoryCache - binary replacement for the gzipped .inv.llsd cache
+//
+// The file starts with a fixed header followed by one or more segments. Each
+// segment has its own string pool (names and descriptions) followed by
+// fixed size folder and item records, with every folder record owning a
+// contiguous run of item records. Loading maps the file into memory and
+// walks the records in place; a folder record in a later segment replaces
+// that folder (and all its items) from earlier segments and a segment can
+// also list folders that no longer exist.
+//
+// Saving only appends a segment with the folders whose contents changed
+// since the file was last loaded or saved. The whole file is rewritten
+// when there is no (valid) file yet, when most folders changed or once
+// there are too many segments.
+
+class LLInventoryCache : public LLSingleton<LLInventoryCache>
+{
+	LLSINGLETON_EMPTY_CTOR(LLInventoryCache);
+public:
+	// Same contract as LLInventoryModel::loadFromFile(); only folders with a known version are stored so every
+	// item returned belongs to one of the returned categories
+	bool load(const std::string& filename,
+			  LLInventoryModel::cat_array_t& categories,
+			  LLInventoryModel::item_array_t& items,
+			  LLInventoryModel::changed_items_t& cats_to_update,
+			  bool& is_cache_obsolete);
+	// Same contract as LLInventoryModel::saveToFile(); items whose parent isn't part of the cached categories are skipped
+	bool save(const std::string& filename,
+			  const LLInventoryModel::cat_array_t& categories,
+			  const LLInventoryModel::item_array_t& items);
+	// Removes the file along with what we know about it
+	void remove(const std::string& filename);
+
+protected:
+	// What we know about the contents of a cache file since we last loaded or wrote it
+	struct FileState
+	{
+		boost::unordered_map<LLUUID, U64> mFolderHashes;
+		U64  mFileSize = 0;
+		U32  mSegmentCount = 0;
+		bool mValid = false;
+	};
+	bool writeFull(const std::string& filename, const std::string& segment);
+	bool writeAppend(const std::string& filename, const std::string& segment);
+
+protected:
+	std::map<std::string, FileState> mFiles;
+};
+
+#endif // LL_LLINVENTORYCACHE_H
@@ -0,0 +1,197 @@
+/**
+ * @file llinventorychangeset.cpp
+ * @brief LLInventoryChangeSet and LLInventoryChangeSetObserver implementation
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorychangeset.h"
+
+// ============================================================================
+// LLInventoryChangeSet
+//
+
+void LLInventoryChangeSet::add(U32 mask, const LLUUID& object_id, const LLUUID& parent_id, LLAssetType::EType type)
+{
+	mMask |= mask;
+	if (object_id.notNull())
+	{
+		auto itObject = mObjects.find(object_id);
+		if (mObjects.end() == itObject)
+		{
+			LLObjectChange& change = mObjects[object_id];
+			change.mMask = mask;
+			change.mParentID = parent_id;
+			change.mType = type;
+		}
+		else
+		{
+			itObject->second.mMask |= mask;
+		}
+	}
+	if (parent_id.notNull())
+	{
+		mFolders[parent_id] |= mask;
+	}
+}
+
+void LLInventoryChangeSet::add(const LLUUID& object_id, const LLObjectChange& change)
+{
+	add(change.mMask, object_id, change.mParentID, change.mType);
+}
+
+void LLInventoryChangeSet::addFolder(U32 mask, const LLUUID& folder_id)
+{
+	if (folder_id.notNull())
+	{
+		mMask |= mask;
+		mFolders[folder_id] |= mask;
+	}
+}
+
+void LLInventoryChangeSet::clear()
+{
+	mMask = LLInventoryObserver::NONE;
+	mObjects.clear();
+	mFolders.clear();
+}
+
+void LLInventoryChangeSet::swap(LLInventoryChangeSet& other)
+{
+	std::swap(mMask, other.mMask);
+	mObjects.swap(other.mObjects);
+	mFolders.swap(other.mFolders);
+}
+
+U32 LLInventoryChangeSet::getFolderMask(const LLUUID& folder_id) const
+{
+	auto itFolder = mFolders.find(folder_id);
+	return (mFolders.end() != itFolder) ? itFolder->second : LLInventoryObserver::NONE;
+}
+
+// ============================================================================
+// LLInventoryChangeSetObserver
+//
+
+LLInventoryChangeSetObserver::LLInventoryChangeSetObserver(U32 mask)
+	: mMask(mask)
+{
+}
+
+// virtual
+LLInventoryChangeSetObserver::~LLInventoryChangeSetObserver()
+{
+}
+
+void LLInventoryChangeSetObserver::addSubtree(const LLUUID& folder_id)
+{
+	if (mSubtrees.end() == std::find(mSubtrees.begin(), mSubtrees.end(), folder_id))
+	{
+		mSubtrees.push_back(folder_id);
+	}
+}
+
+void LLInventoryChangeSetObserver::removeSubtree(const LLUUID& folder_id)
+{
+	mSubtrees.erase(std::remove(mSubtrees.begin(), mSubtrees.end(), folder_id), mSubtrees.end());
+}
+
+void LLInventoryChangeSetObserver::addItemType(LLAssetType::EType type)
+{
+	mItemTypes.insert(type);
+}
+
+void LLInventoryChangeSetObserver::collectChanges(const LLInventoryChangeSet& changes, const descendent_check_t& is_descendent)
+{
+	for (const auto& itObject : changes.getObjects())
+	{
+		if (isInterested(itObject.first, itObject.second, is_descendent))
+		{
+			mPendingChanges.add(itObject.first, itObject.second);
+		}
+	}
+
+	// Folders that only lost children (e.g. the old parent of a move) have no object entry to go by
+	if (mItemTypes.empty())
+	{
+		for (const auto& itFolder : changes.getFolders())
+		{
+			if ( (itFolder.second & mMask) && (isInSubtree(itFolder.first, is_descendent)) )
+			{
+				mPendingChanges.addFolder(itFolder.second & mMask, itFolder.first);
+			}
+		}
+	}
+
+	// A notification without any objects could have touched anything
+	if ( (changes.getObjects().empty()) && (changes.getFolders().empty()) )
+	{
+		mPendingChanges.addMask(changes.getMask() & mMask);
+	}
+}
+
+bool LLInventoryChangeSetObserver::deliverChanges()
+{
+	if (mPendingChanges.isEmpty())
+	{
+		return false;
+	}
+
+	// Swap first so changed() can trigger new notifications without touching the set that's being handed out
+	LLInventoryChangeSet changes;
+	changes.swap(mPendingChanges);
+	changed(changes);
+	return true;
+}
+
+bool LLInventoryChangeSetObserver::isInterested(const LLUUID& object_id, const LLInventoryChangeSet::LLObjectChange& change, const descendent_check_t& is_descendent) const
+{
+	if (0 == (change.mMask & mMask))
+	{
+		return false;
+	}
+	if ( (!mItemTypes.empty()) && (mItemTypes.end() == mItemTypes.find(change.mType)) )
+	{
+		return false;
+	}
+	// Removed objects are no longer in the model so go by their last known parent
+	return (isInSubtree(object_id, is_descendent)) || ((change.mParentID.notNull()) && (isInSubtree(change.mParentID, is_descendent)));
+}
+
+bool LLInventoryChangeSetObserver::isInSubtree(const LLUUID& object_id, const descendent_check_t& is_descendent) const
+{
+	if (mSubtrees.empty())
+	{
+		return true;
+	}
+
+	for (const LLUUID& idSubtree : mSubtrees)
+	{
+		if ( (idSubtree == object_id) || (is_descendent(object_id, idSubtree)) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
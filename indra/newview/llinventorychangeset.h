@@ -0,0 +1,126 @@
+/**
+ * @file llinventorychangeset.h
+ * @brief LLInventoryChangeSet and LLInventoryChangeSetObserver class definitions
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCHANGESET_H
+#define LL_LLINVENTORYCHANGESET_H
+
+#include "llassettype.h"
+#include "llinventoryobserver.h"
+#include "lluuid.h"
+
+#include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryChangeSet
+//
+//   What changed for every object along with a summary of the changes made
+//   to the direct children of every affected folder (both the old and the new
+//   parent for moves).
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryChangeSet
+{
+public:
+	struct LLObjectChange
+	{
+		U32					mMask = LLInventoryObserver::NONE;
+		// Parent at the time of the first change (kept for removed objects)
+		LLUUID				mParentID;
+		// Linked type for links and AT_CATEGORY for folders
+		LLAssetType::EType	mType = LLAssetType::AT_NONE;
+	};
+	typedef boost::unordered_map<LLUUID, LLObjectChange> object_map_t;
+	typedef boost::unordered_map<LLUUID, U32> folder_map_t;
+
+	void add(U32 mask, const LLUUID& object_id, const LLUUID& parent_id, LLAssetType::EType type);
+	void add(const LLUUID& object_id, const LLObjectChange& change);
+	void addFolder(U32 mask, const LLUUID& folder_id);
+	// A change that isn't tied to any object (e.g. addChangedMask() with a null id)
+	void addMask(U32 mask) { mMask |= mask; }
+	void clear();
+	bool isEmpty() const { return (LLInventoryObserver::NONE == mMask) && (mObjects.empty()); }
+	void swap(LLInventoryChangeSet& other);
+
+	U32                 getMask() const     { return mMask; }
+	const object_map_t& getObjects() const  { return mObjects; }
+	const folder_map_t& getFolders() const  { return mFolders; }
+	// Returns the union of the changes made to the folder's direct children (or NONE if nothing in it changed)
+	U32                 getFolderMask(const LLUUID& folder_id) const;
+	bool                hasObject(const LLUUID& object_id) const { return mObjects.end() != mObjects.find(object_id); }
+
+protected:
+	U32          mMask = LLInventoryObserver::NONE;
+	object_map_t mObjects;
+	folder_map_t mFolders;
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryChangeSetObserver
+//
+//   Gets everything that changed during a frame as a single change set from
+//   the idle loop rather than a bare mask on every notifyObservers(), limited
+//   to the subtrees, item types and kinds of changes it subscribed to. Needs
+//   to be registered with LLInventoryModel::addChangeSetObserver() and, like
+//   LLInventoryObserver, has to remove itself before it's destroyed.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryChangeSetObserver
+{
+public:
+	// Returns true if the object is (somewhere) below the folder
+	typedef boost::function<bool (const LLUUID& object_id, const LLUUID& folder_id)> descendent_check_t;
+
+	LLInventoryChangeSetObserver(U32 mask = LLInventoryObserver::ALL);
+	virtual ~LLInventoryChangeSetObserver();
+
+	// Only changes to the folder itself or anything below it (no subtrees means the entire inventory)
+	void addSubtree(const LLUUID& folder_id);
+	void removeSubtree(const LLUUID& folder_id);
+	// Only changes to items of these types; folders only pass when AT_CATEGORY is one of them (no types means everything)
+	void addItemType(LLAssetType::EType type);
+	void setMask(U32 mask) { mMask = mask; }
+
+	// Adds the part of a notification this observer is interested in to its pending changes (called on every notifyObservers())
+	void collectChanges(const LLInventoryChangeSet& changes, const descendent_check_t& is_descendent);
+	// Hands everything collected since the last call to changed() at once (called once per frame); returns false if there was nothing
+	bool deliverChanges();
+	const LLInventoryChangeSet& getPendingChanges() const { return mPendingChanges; }
+
+	virtual void changed(const LLInventoryChangeSet& changes) = 0;
+
+protected:
+	bool isInterested(const LLUUID& object_id, const LLInventoryChangeSet::LLObjectChange& change, const descendent_check_t& is_descendent) const;
+	bool isInSubtree(const LLUUID& object_id, const descendent_check_t& is_descendent) const;
+
+protected:
+	U32                              mMask;
+	uuid_vec_t                       mSubtrees;
+	boost::unordered_set<S32>        mItemTypes;
+	// Changes collected since the last delivery
+	LLInventoryChangeSet             mPendingChanges;
+};
+
+#endif // LL_LLINVENTORYCHANGESET_H
@@ -55,6 +55,12 @@
 #include <boost/algorithm/string.hpp>
 // [/SL:KB]
 
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+// Number of name index changes after which the search terms are run against the index again (rather than falling back
+// to a full check for every object that changed since the last time)
+const U32 NAME_INDEX_MAX_CHANGES = 1000;
+// [/SL:KB]
+
 LLInventoryFilter::FilterOps::FilterOps(const Params& p)
 :	mFilterObjectTypes(p.object_types),
 	mFilterCategoryTypes(p.category_types),
@@ -183,8 +189,11 @@ bool LLInventoryFilter::check(const LLFolderViewModelItem* item, filter_stringma
 //    }
 
 //	bool passed = (mFilterSubString.size() ? desc.find(mFilterSubString) != std::string::npos : true);
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+	bool passed = (mFilterSubStringOrig.size()) ? checkAgainstNameIndex(listener->getUUID(), listener->getSearchableName(), &match_offsets) : true;
+// [/SL:KB]
 // [SL:KB] - Patch: Inventory-FilterCore | Checked: Catznip-5.2
-	bool passed = (mFilterSubStringOrig.size()) ? checkAgainstName(listener->getSearchableName(), &match_offsets) : true;
+//	bool passed = (mFilterSubStringOrig.size()) ? checkAgainstName(listener->getSearchableName(), &match_offsets) : true;
 	passed = passed && (mFilterDescriptionSubString.size() ? boost::algorithm::icontains(listener->getDescription(), mFilterDescriptionSubString) : true);
 // [/SL:KB]
 	passed = passed && checkAgainstFilterType(listener);
@@ -254,6 +263,110 @@ bool LLInventoryFilter::checkAgainstName(const std::string& item_name, filter_st
 	}
 }
 // [/SL:KB]
+
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+bool LLInventoryFilter::updateNameIndexQuery()
+{
+	static LLCachedControl<bool> s_use_name_index(gSavedSettings, "InventoryNameIndex", true);
+	if ( (!s_use_name_index) || (EFilterStringMatchType::RegEx == mFilterSubStringMatchType) || (mFilterSubStrings.empty()) )
+	{
+		return false;
+	}
+
+	const LLInventoryNameIndex& name_index = gInventory.getNameIndex();
+	if ( (!mNameIndexQueryValid) || (name_index.getStamp() - mNameIndexQuery.mStamp > NAME_INDEX_MAX_CHANGES) )
+	{
+		// The index matches case sensitively on upper cased names which is only guaranteed to agree with boost::ifind_first
+		// for ASCII search terms; terms too short to yield trigrams are cheaper to match against the names directly
+		mNameIndexUsable = std::all_of(mFilterSubStrings.begin(), mFilterSubStrings.end(),
+			[](const std::string& strToken) { return std::all_of(strToken.begin(), strToken.end(), [](char ch) { return (U8)ch < 0x80; }); });
+		mNameIndexUsable = (mNameIndexUsable) && (name_index.query(mFilterSubStrings, EFilterStringMatchType::All == mFilterSubStringMatchType, mNameIndexQuery));
+		if (!mNameIndexUsable)
+			mNameIndexQuery = LLInventoryNameIndex::QueryResult();
+		mNameIndexQueryValid = true;
+	}
+	return mNameIndexUsable;
+}
+
+bool LLInventoryFilter::checkAgainstNameIndex(const LLUUID& object_id, const std::string& item_name, filter_stringmatch_results_t* match_offsets_p)
+{
+	if (!updateNameIndexQuery())
+	{
+		return checkAgainstName(item_name, match_offsets_p);
+	}
+
+	const LLInventoryNameIndex& name_index = gInventory.getNameIndex();
+
+	// The index can only answer for objects that didn't change since the query and whose searchable name starts with
+	// their (upper cased) model name; anything else (e.g. task inventory, localized system folders) gets a full check
+	const LLInventoryNameIndex::Entry* pEntry = name_index.find(object_id);
+	if ( (!pEntry) || (pEntry->mStamp > mNameIndexQuery.mStamp) || (0 != item_name.compare(0, pEntry->mName.size(), pEntry->mName)) )
+	{
+		return checkAgainstName(item_name, match_offsets_p);
+	}
+
+	const bool has_suffix = item_name.size() > pEntry->mName.size();
+	if ( (has_suffix) && (EFilterStringMatchType::Any == mFilterSubStringMatchType) )
+	{
+		// An earlier term might only match in the label suffix in which case its offsets should be reported instead
+		return checkAgainstName(item_name, match_offsets_p);
+	}
+
+	auto itMatch = mNameIndexQuery.mMatches.find(object_id);
+	if (mNameIndexQuery.mMatches.end() != itMatch)
+	{
+		if (match_offsets_p)
+			match_offsets_p->insert(match_offsets_p->end(), itMatch->second.begin(), itMatch->second.end());
+		return true;
+	}
+
+	// The name itself doesn't match but the label suffix (e.g. " (worn)") still might
+	return (has_suffix) && (checkAgainstName(item_name, match_offsets_p));
+}
+
+bool LLInventoryFilter::collectNameMatches(const uuid_vec_t& root_ids, uuid_vec_t& object_ids)
+{
+	// Everything other than the name terms needs the object's folder view model item to check against
+	if ( (mFilterSubStrings.empty()) || (!mIncludedFolders.empty()) )
+	{
+		return false;
+	}
+
+	// Objects that changed since the last query aren't in its results so make sure it's current
+	if (mNameIndexQuery.mStamp != gInventory.getNameIndex().getStamp())
+	{
+		mNameIndexQueryValid = false;
+	}
+
+	if (updateNameIndexQuery())
+	{
+		for (const auto& itMatch : mNameIndexQuery.mMatches)
+		{
+			object_ids.push_back(itMatch.first);
+		}
+	}
+	else
+	{
+		for (const LLUUID& root_id : root_ids)
+		{
+			LLInventoryModel::cat_array_t descendent_cats;
+			LLInventoryModel::item_array_t descendent_items;
+			gInventory.collectDescendents(root_id, descendent_cats, descendent_items, LLInventoryModel::INCLUDE_TRASH);
+			for (const LLViewerInventoryCategory* pFolder : descendent_cats)
+			{
+				if (checkAgainstName(pFolder->getName()))
+					object_ids.push_back(pFolder->getUUID());
+			}
+			for (const LLViewerInventoryItem* pItem : descendent_items)
+			{
+				if (checkAgainstName(pItem->getName()))
+					object_ids.push_back(pItem->getUUID());
+			}
+		}
+	}
+	return true;
+}
+// [/SL:KB]
 //bool LLInventoryFilter::check(const LLInventoryItem* item)
 //{
 //	const bool passed_string = (mFilterSubString.size() ? item->getName().find(mFilterSubString) != std::string::npos : true);
@@ -1137,6 +1250,9 @@ void LLInventoryFilter::setFilterSubString(const std::string& string)
 			mFilterSubStrings = std::move(search_tokens);
 			mFilterSubStringRegEx = boost::regex();
 			mFilterSubStringValid = true;
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+			mNameIndexQueryValid = false;
+// [/SL:KB]
 
 			if (less_restrictive)
 				eFilterModified = FILTER_LESS_RESTRICTIVE;
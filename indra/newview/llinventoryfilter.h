@@ -31,6 +31,9 @@
 #include "llinventorytype.h"
 #include "llpermissionsflags.h"
 #include "llfolderviewmodel.h"
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+#include "llinventorynameindex.h"
+// [/SL:KB]
 
 // [SL:KB] - Patch: Inventory-FilterCore | Checked: Catznip-5.2
 #include <boost/regex.hpp>
@@ -329,6 +332,11 @@ class LLInventoryFilter : public LLFolderViewFilter
 	bool				check(const LLInventoryItem* item);
 	bool				checkFolder(const LLFolderViewModelItem* listener) const;
 	bool				checkFolder(const LLUUID& folder_id) const;
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	// Collects the objects whose name passes the name terms (from the name index when it can, otherwise from the descendents
+	// of the root folders); returns false if the filter has no name terms to narrow things down with
+	bool				collectNameMatches(const uuid_vec_t& root_ids, uuid_vec_t& object_ids);
+// [/SL:KB]
 
 	bool				showAllResults() const;
 
@@ -398,6 +406,12 @@ class LLInventoryFilter : public LLFolderViewFilter
 // [SL:KB] - Patch: Inventory-Filter | Checked: Catznip-5.2
 	bool 				checkAgainstFolderIncludes(const class LLInventoryObject* pInvObj) const;
 // [/SL:KB]
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+	// Same as checkAgainstName() but answers from the inventory name index whenever it can
+	bool 				checkAgainstNameIndex(const LLUUID& object_id, const std::string& item_name, filter_stringmatch_results_t* match_offsets_p);
+	// Runs the current terms against the name index if needed and returns whether its results can be used
+	bool				updateNameIndexQuery();
+// [/SL:KB]
 
 	FilterOps				mFilterOps;
 	FilterOps				mDefaultFilterOps;
@@ -410,6 +424,12 @@ class LLInventoryFilter : public LLFolderViewFilter
 	std::vector<std::string> mFilterSubStrings;
 	boost::regex			mFilterSubStringRegEx;
 	bool                    mFilterSubStringValid = true;
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+	// Result of running the current search terms against gInventory's name index
+	LLInventoryNameIndex::QueryResult mNameIndexQuery;
+	bool					mNameIndexQueryValid = false;
+	bool					mNameIndexUsable = false;
 // [/SL:KB]
 	std::string				mFilterSubStringOrig;
 //	std::string				mUsername;
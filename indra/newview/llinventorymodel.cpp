@@ -31,6 +31,9 @@
 #include "llinventorymodel.h"
 
 #include "llaisapi.h"
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
+#include "llinventorycache.h"
+// [/SL:KB]
 #include "llagent.h"
 #include "llagentwearables.h"
 #include "llappearancemgr.h"
@@ -83,6 +86,10 @@ BOOL LLInventoryModel::sFirstTimeInViewer2 = TRUE;
 //BOOL decompress_file(const char* src_filename, const char* dst_filename);
 static const char PRODUCTION_CACHE_FORMAT_STRING[] = "%s.inv.llsd";
 static const char GRID_CACHE_FORMAT_STRING[] = "%s.%s.inv.llsd";
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
+static const char PRODUCTION_BINARY_CACHE_FORMAT_STRING[] = "%s.inv.bin";
+static const char GRID_BINARY_CACHE_FORMAT_STRING[] = "%s.%s.inv.bin";
+// [/SL:KB]
 static const char * const LOG_INV("Inventory");
 
 struct InventoryIDPtrLess
@@ -186,6 +193,10 @@ void LLInventoryModel::cleanupInventory()
 		delete observer;
 	}
 	mObservers.clear();
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	mChangeSetObservers.clear();
+	mChangeSet.clear();
+// [/SL:KB]
 
 	// Run down HTTP transport
     mHttpHeaders.reset();
@@ -204,7 +215,41 @@ BOOL LLInventoryModel::isObjectDescendentOf(const LLUUID& obj_id,
 {
 	if (obj_id == cat_id) return TRUE;
 
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
 	const LLInventoryObject* obj = getObject(obj_id);
+	if (!obj)
+	{
+		return FALSE;
+	}
+
+	const LLUUID& parent_id = obj->getParentUUID();
+	if (parent_id.isNull())
+	{
+		return FALSE;
+	}
+	if (parent_id == cat_id)
+	{
+		return TRUE;
+	}
+
+	// If both are connected to a root folder we only need to climb to the depth of cat_id and compare
+	const S32 cat_depth = getCategoryDepth(cat_id);
+	const S32 parent_depth = (cat_depth >= 0) ? getCategoryDepth(parent_id) : -1;
+	if ( (cat_depth >= 0) && (parent_depth >= 0) )
+	{
+		const LLUUID* ancestor_id = &parent_id;
+		for (S32 depth = parent_depth; depth > cat_depth; --depth)
+		{
+			// All ancestors of a category with a known depth have one as well
+			ancestor_id = &mCategoryDepths.find(*ancestor_id)->second.mParentID;
+		}
+		return *ancestor_id == cat_id;
+	}
+
+	// Orphaned (or still loading) categories take the slow path
+	obj = getCategory(parent_id);
+// [/SL:KB]
+//	const LLInventoryObject* obj = getObject(obj_id);
 	while(obj)
 	{
 		const LLUUID& parent_id = obj->getParentUUID();
@@ -223,6 +268,121 @@ BOOL LLInventoryModel::isObjectDescendentOf(const LLUUID& obj_id,
 	return FALSE;
 }
 
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+// Guards against parent loops in a broken inventory
+static const size_t MAX_CATEGORY_DEPTH = 1024;
+
+S32 LLInventoryModel::getCategoryDepth(const LLUUID& cat_id) const
+{
+	auto itDepth = mCategoryDepths.find(cat_id);
+	if (mCategoryDepths.end() != itDepth)
+	{
+		return itDepth->second.mDepth;
+	}
+
+	// Climb until we reach either a root folder or a category whose depth we already know
+	std::vector<const LLViewerInventoryCategory*> chain;
+	S32 top_depth = -1;
+	for (const LLViewerInventoryCategory* cat = getCategory(cat_id); cat; )
+	{
+		chain.push_back(cat);
+
+		const LLUUID& parent_id = cat->getParentUUID();
+		if (parent_id.isNull())
+		{
+			top_depth = 0;
+			break;
+		}
+
+		itDepth = mCategoryDepths.find(parent_id);
+		if (mCategoryDepths.end() != itDepth)
+		{
+			top_depth = itDepth->second.mDepth + 1;
+			break;
+		}
+
+		if (chain.size() >= MAX_CATEGORY_DEPTH)
+		{
+			break;
+		}
+		cat = getCategory(parent_id);
+	}
+
+	// Unknown category or not connected to a root folder (don't remember anything since adding the missing parent would change it)
+	if (top_depth < 0)
+	{
+		return -1;
+	}
+
+	S32 depth = top_depth;
+	for (auto itCat = chain.rbegin(); itCat != chain.rend(); ++itCat, ++depth)
+	{
+		mCategoryDepths[(*itCat)->getUUID()] = CategoryDepth{ (*itCat)->getParentUUID(), depth };
+	}
+	return depth - 1;
+}
+
+void LLInventoryModel::dirtyCategoryDepths()
+{
+	mCategoryDepths.clear();
+}
+
+void LLInventoryModel::dirtyDescendentCounts(const LLUUID& cat_id)
+{
+	if (mDescendentCounts.empty())
+	{
+		return;
+	}
+
+	// Counts are only ever cached for a folder if they're cached for everything below it as well, so we can stop at the first uncached ancestor
+	const LLViewerInventoryCategory* cat = getCategory(cat_id);
+	for (size_t idxDepth = 0; (cat) && (idxDepth < MAX_CATEGORY_DEPTH); idxDepth++)
+	{
+		if (!mDescendentCounts.erase(cat->getUUID()))
+		{
+			break;
+		}
+		cat = getCategory(cat->getParentUUID());
+	}
+}
+
+bool LLInventoryModel::getDescendentCountsRecursive(const LLUUID& cat_id, S32& cat_count, S32& item_count) const
+{
+	auto itCounts = mDescendentCounts.find(cat_id);
+	if (mDescendentCounts.end() != itCounts)
+	{
+		cat_count = itCounts->second.mCategories;
+		item_count = itCounts->second.mItems;
+		return true;
+	}
+
+	const cat_array_t* cat_array = get_ptr_in_map(mParentChildCategoryTree, cat_id);
+	const item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, cat_id);
+	if ( (!cat_array) && (!item_array) )
+	{
+		cat_count = item_count = 0;
+		return false;
+	}
+
+	DescendentCounts counts = { 0, (item_array) ? (S32)item_array->size() : 0 };
+	if (cat_array)
+	{
+		for (const LLViewerInventoryCategory* cat : *cat_array)
+		{
+			S32 child_cat_count = 0, child_item_count = 0;
+			getDescendentCountsRecursive(cat->getUUID(), child_cat_count, child_item_count);
+			counts.mCategories += 1 + child_cat_count;
+			counts.mItems += child_item_count;
+		}
+	}
+	mDescendentCounts[cat_id] = counts;
+
+	cat_count = counts.mCategories;
+	item_count = counts.mItems;
+	return true;
+}
+// [/SL:KB]
+
 // [SL:KB] - Patch: Inventory-OfferToast | Checked: Catznip-5.2
 BOOL LLInventoryModel::isInTrash(const LLUUID& obj_id) /*const*/
 {
@@ -1024,6 +1184,25 @@ LLInventoryModel::item_array_t LLInventoryModel::collectLinksTo(const LLUUID& id
 	return items;
 }
 
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+LLInventoryModel::item_array_t LLInventoryModel::collectLinksTo(const LLUUID& id, const LLUUID& cat_id)
+{
+	item_array_t items;
+
+	const auto range = mBacklinkMMap.equal_range(id);
+	for (auto itLink = range.first; itLink != range.second; ++itLink)
+	{
+		LLViewerInventoryItem* item = getItem(itLink->second);
+		if ( (item) && ((cat_id.isNull()) || (isObjectDescendentOf(item->getParentUUID(), cat_id))) )
+		{
+			items.push_back(item);
+		}
+	}
+
+	return items;
+}
+// [/SL:KB]
+
 bool LLInventoryModel::isInventoryUsable() const
 {
 	bool result = false;
@@ -1116,6 +1295,13 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
 				item_array->push_back(old_item);
 			}
 			mask |= LLInventoryObserver::STRUCTURE;
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+			dirtyDescendentCounts(old_parent_id);
+			dirtyDescendentCounts(new_parent_id);
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+			mChangeSet.addFolder(LLInventoryObserver::STRUCTURE, old_parent_id);
+// [/SL:KB]
 		}
 		if(old_item->getName() != item->getName())
 		{
@@ -1202,6 +1388,9 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
 			}
 		}
 		mask |= LLInventoryObserver::ADD;
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+		dirtyDescendentCounts(new_item->getParentUUID());
+// [/SL:KB]
 	}
 	if(new_item->getType() == LLAssetType::AT_CALLINGCARD)
 	{
@@ -1297,6 +1486,14 @@ void LLInventoryModel::updateCategory(const LLViewerInventoryCategory* cat, U32
 			}
 			mask |= LLInventoryObserver::STRUCTURE;
             mask |= LLInventoryObserver::INTERNAL;
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+			dirtyCategoryDepths();
+			dirtyDescendentCounts(old_parent_id);
+			dirtyDescendentCounts(new_parent_id);
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+			mChangeSet.addFolder(LLInventoryObserver::STRUCTURE, old_parent_id);
+// [/SL:KB]
 		}
 		if(old_cat->getName() != cat->getName())
 		{
@@ -1325,6 +1522,9 @@ void LLInventoryModel::updateCategory(const LLViewerInventoryCategory* cat, U32
 		{
 			cat_array->push_back(new_cat);
 		}
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+		dirtyDescendentCounts(cat->getParentUUID());
+// [/SL:KB]
 
 		// make space in the tree for this category's children.
 		llassert_always(mCategoryLock[new_cat->getUUID()] == false);
@@ -1356,6 +1556,14 @@ void LLInventoryModel::moveObject(const LLUUID& object_id, const LLUUID& cat_id)
 	LLPointer<LLViewerInventoryCategory> cat = getCategory(object_id);
 	if(cat && (cat->getParentUUID() != cat_id))
 	{
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+		dirtyCategoryDepths();
+		dirtyDescendentCounts(cat->getParentUUID());
+		dirtyDescendentCounts(cat_id);
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+		mChangeSet.addFolder(LLInventoryObserver::STRUCTURE, cat->getParentUUID());
+// [/SL:KB]
 		cat_array_t* cat_array;
 		cat_array = getUnlockedCatArray(cat->getParentUUID());
 		if(cat_array) vector_replace_with_last(*cat_array, cat);
@@ -1368,6 +1576,13 @@ void LLInventoryModel::moveObject(const LLUUID& object_id, const LLUUID& cat_id)
 	LLPointer<LLViewerInventoryItem> item = getItem(object_id);
 	if(item && (item->getParentUUID() != cat_id))
 	{
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+		dirtyDescendentCounts(item->getParentUUID());
+		dirtyDescendentCounts(cat_id);
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+		mChangeSet.addFolder(LLInventoryObserver::STRUCTURE, item->getParentUUID());
+// [/SL:KB]
 		item_array_t* item_array;
 		item_array = getUnlockedItemArray(item->getParentUUID());
 		if(item_array) vector_replace_with_last(*item_array, item);
@@ -1648,8 +1863,22 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links, boo
 	LL_DEBUGS(LOG_INV) << "Deleting inventory object " << id << LL_ENDL;
 	mLastItem = NULL;
 	LLUUID parent_id = obj->getParentUUID();
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	addChangeSetEntry(LLInventoryObserver::REMOVE, id);
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+	if (mCategoryMap.count(id))
+	{
+		dirtyCategoryDepths();
+	}
+	dirtyDescendentCounts(parent_id);
+	mDescendentCounts.erase(id);
+// [/SL:KB]
 	mCategoryMap.erase(id);
 	mItemMap.erase(id);
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+	mNameIndex.remove(id);
+// [/SL:KB]
 	//mInventory.erase(id);
 	item_array_t* item_list = getUnlockedItemArray(parent_id);
 	if(item_list)
@@ -1666,7 +1895,14 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links, boo
     
     // Note : We need to tell the inventory observers that those things are going to be deleted *before* the tree is cleared or they won't know what to delete (in views and view models)
 	addChangedMask(LLInventoryObserver::REMOVE, id);
-	gInventory.notifyObservers();
+// [SL:KB] - Patch: Appearance-COFDiff | Checked: Catznip-6.7
+	// Only categories have children the views need to look up; removed items are picked up by the caller's (or the next idle) notification
+	if ( (mParentChildItemTree.count(id)) || (mParentChildCategoryTree.count(id)) )
+	{
+		gInventory.notifyObservers();
+	}
+// [/SL:KB]
+//	gInventory.notifyObservers();
     
 	item_list = getUnlockedItemArray(id);
 	if(item_list)
@@ -1749,16 +1985,87 @@ BOOL LLInventoryModel::containsObserver(LLInventoryObserver* observer) const
 	return mObservers.find(observer) != mObservers.end();
 }
 
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+void LLInventoryModel::addChangeSetObserver(LLInventoryChangeSetObserver* observer)
+{
+	mChangeSetObservers.insert(observer);
+}
+
+void LLInventoryModel::removeChangeSetObserver(LLInventoryChangeSetObserver* observer)
+{
+	mChangeSetObservers.erase(observer);
+}
+
+bool LLInventoryModel::containsChangeSetObserver(LLInventoryChangeSetObserver* observer) const
+{
+	return mChangeSetObservers.find(observer) != mChangeSetObservers.end();
+}
+
+void LLInventoryModel::addChangeSetEntry(U32 mask, const LLUUID& object_id)
+{
+	if (const LLViewerInventoryCategory* pCat = getCategory(object_id))
+	{
+		mChangeSet.add(mask, object_id, pCat->getParentUUID(), LLAssetType::AT_CATEGORY);
+	}
+	else if (const LLViewerInventoryItem* pItem = getItem(object_id))
+	{
+		mChangeSet.add(mask, object_id, pItem->getParentUUID(), pItem->getType());
+	}
+	else
+	{
+		mChangeSet.add(mask, object_id, LLUUID::null, LLAssetType::AT_NONE);
+	}
+}
+
+void LLInventoryModel::collectChangeSets()
+{
+	if ( (mChangeSetObservers.empty()) || (mChangeSet.isEmpty()) )
+	{
+		return;
+	}
+
+	const LLInventoryChangeSetObserver::descendent_check_t is_descendent = [this](const LLUUID& object_id, const LLUUID& folder_id)
+		{
+			return isObjectDescendentOf(object_id, folder_id);
+		};
+	for (LLInventoryChangeSetObserver* pObserver : mChangeSetObservers)
+	{
+		pObserver->collectChanges(mChangeSet, is_descendent);
+	}
+}
+
+void LLInventoryModel::deliverChangeSets()
+{
+	for (changeset_observer_list_t::iterator itObserver = mChangeSetObservers.begin(); itObserver != mChangeSetObservers.end(); )
+	{
+		LLInventoryChangeSetObserver* pObserver = *itObserver;
+		pObserver->deliverChanges();
+
+		// The observer might have removed itself (or others)
+		itObserver = mChangeSetObservers.upper_bound(pObserver);
+	}
+}
+// [/SL:KB]
+
 void LLInventoryModel::idleNotifyObservers()
 {
 	// *FIX:  Think I want this conditional or moved elsewhere...
 	handleResponses(true);
 	
-	if (mModifyMask == LLInventoryObserver::NONE && (mChangedItemIDs.size() == 0))
+//	if (mModifyMask == LLInventoryObserver::NONE && (mChangedItemIDs.size() == 0))
+//	{
+//		return;
+//	}
+//	notifyObservers();
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	if ( (mModifyMask != LLInventoryObserver::NONE) || (mChangedItemIDs.size() != 0) )
 	{
-		return;
+		notifyObservers();
 	}
-	notifyObservers();
+
+	// Everything the change set observers collected from this frame's notifications goes out at once
+	deliverChangeSets();
+// [/SL:KB]
 }
 
 // Call this method when it's time to update everyone on a new state.
@@ -1779,6 +2086,16 @@ void LLInventoryModel::notifyObservers(const LLUUID& transaction_id)
 	mIsNotifyObservers = TRUE;
 // [SL:KB] - Patch: UI-Notifications | Checked: Catznip-6.5
 	mTransactionId = transaction_id;
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+	// Pick up renames before any observer (e.g. an inventory filter) gets to look at them
+	if (mModifyMask & (LLInventoryObserver::LABEL | LLInventoryObserver::REBUILD))
+	{
+		for (const LLUUID& id : mChangedItemIDs)
+		{
+			updateNameIndex(id);
+		}
+	}
 // [/SL:KB]
 	for (observer_list_t::iterator iter = mObservers.begin();
 		 iter != mObservers.end(); )
@@ -1790,6 +2107,10 @@ void LLInventoryModel::notifyObservers(const LLUUID& transaction_id)
 		iter = mObservers.upper_bound(observer); 
 	}
 
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	collectChangeSets();
+	mChangeSet.clear();
+// [/SL:KB]
 	mModifyMask = LLInventoryObserver::NONE;
 	mChangedItemIDs.clear();
 	mAddedItemIDs.clear();
@@ -1825,6 +2146,9 @@ void LLInventoryModel::addChangedMask(U32 mask, const LLUUID& referent)
 	}
 	
 	mModifyMask |= mask;
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	addChangeSetEntry(mask, referent);
+// [/SL:KB]
 	if (referent.notNull() && (mChangedItemIDs.find(referent) == mChangedItemIDs.end()))
 	{
 		mChangedItemIDs.insert(referent);
@@ -1895,6 +2219,20 @@ std::string LLInventoryModel::getInvCacheAddres(const LLUUID& owner_id)
     return inventory_addr;
 }
 
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
+//static
+std::string LLInventoryModel::getInvBinaryCacheAddres(const LLUUID& owner_id)
+{
+	std::string path(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, owner_id.asString()));
+	if (LLGridManager::getInstance()->isInProductionGrid())
+	{
+		return llformat(PRODUCTION_BINARY_CACHE_FORMAT_STRING, path.c_str());
+	}
+	// See getInvCacheAddres()
+	return llformat(GRID_BINARY_CACHE_FORMAT_STRING, path.c_str(), utf8str_tolower(LLGridManager::getInstance()->getGridId()).c_str());
+}
+// [/SL:KB]
+
 void LLInventoryModel::cache(
 	const LLUUID& parent_folder_id,
 	const LLUUID& agent_id)
@@ -1916,9 +2254,28 @@ void LLInventoryModel::cache(
 		INCLUDE_TRASH,
 		can_cache);
 	std::string inventory_filename = getInvCacheAddres(agent_id);
-	saveToFile(inventory_filename, categories, items);
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
 	std::string gzip_filename(inventory_filename);
 	gzip_filename.append(".gz");
+
+	const std::string binary_filename = getInvBinaryCacheAddres(agent_id);
+	if (gSavedSettings.getBOOL("InventoryCacheBinary"))
+	{
+		if (LLInventoryCache::instance().save(binary_filename, categories, items))
+		{
+			// Don't leave a cache in the old format around that's now out of date
+			if (LLFile::isfile(gzip_filename))
+			{
+				LLFile::remove(gzip_filename);
+			}
+			return;
+		}
+	}
+	LLInventoryCache::instance().remove(binary_filename);
+// [/SL:KB]
+	saveToFile(inventory_filename, categories, items);
+//	std::string gzip_filename(inventory_filename);
+//	gzip_filename.append(".gz");
 	if(gzip_file(inventory_filename, gzip_filename))
 	{
 		LL_DEBUGS(LOG_INV) << "Successfully compressed " << inventory_filename << LL_ENDL;
@@ -1948,6 +2305,9 @@ void LLInventoryModel::addCategory(LLViewerInventoryCategory* category)
 		// Insert category uniquely into the map
 		mCategoryMap[category->getUUID()] = category; // LLPointer will deref and delete the old one
 		//mInventory[category->getUUID()] = category;
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+		updateNameIndex(category->getUUID());
+// [/SL:KB]
 	}
 }
 
@@ -2038,8 +2398,37 @@ void LLInventoryModel::addItem(LLViewerInventoryItem* item)
 			addBacklinkInfo(link_id, target_id);
 		}
 		mItemMap[item->getUUID()] = item;
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+		updateNameIndex(item->getUUID());
+// [/SL:KB]
+	}
+}
+
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+void LLInventoryModel::updateNameIndex(const LLUUID& id)
+{
+	const LLInventoryObject* obj = getObject(id);
+	if (!obj)
+	{
+		mNameIndex.remove(id);
+		return;
+	}
+
+	mNameIndex.update(id, obj->getName());
+	if (!obj->getIsLinkType())
+	{
+		// Links show the name of their target (and links added before their target was known show their own name until now)
+		const auto range = mBacklinkMMap.equal_range(id);
+		for (auto itLink = range.first; itLink != range.second; ++itLink)
+		{
+			if (const LLInventoryObject* link_obj = getObject(itLink->second))
+			{
+				mNameIndex.update(itLink->second, link_obj->getName());
+			}
+		}
 	}
 }
+// [/SL:KB]
 
 // Empty the entire contents
 void LLInventoryModel::empty()
@@ -2058,6 +2447,13 @@ void LLInventoryModel::empty()
 	mBacklinkMMap.clear(); // forget all backlink information.
 	mCategoryMap.clear(); // remove all references (should delete entries)
 	mItemMap.clear(); // remove all references (should delete entries)
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+	mNameIndex.clear();
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+	mCategoryDepths.clear();
+	mDescendentCounts.clear();
+// [/SL:KB]
 	mLastItem = NULL;
 	//mInventory.clear();
 }
@@ -2237,8 +2633,25 @@ bool LLInventoryModel::loadSkeleton(
 		const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
 		std::string gzip_filename(inventory_filename);
 		gzip_filename.append(".gz");
-		LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
 		bool remove_inventory_file = false;
+		bool is_cache_obsolete = false;
+		bool is_cache_loaded = false;
+		if (gSavedSettings.getBOOL("InventoryCacheBinary"))
+		{
+			const std::string binary_filename = getInvBinaryCacheAddres(owner_id);
+			bool is_binary_cache_obsolete = false;
+			is_cache_loaded = LLInventoryCache::instance().load(binary_filename, categories, items, categories_to_update, is_binary_cache_obsolete);
+			if (is_binary_cache_obsolete)
+			{
+				LLInventoryCache::instance().remove(binary_filename);
+			}
+		}
+		// Fall back to the old format (e.g. the first time after switching over)
+		LLFILE* fp = (!is_cache_loaded) ? LLFile::fopen(gzip_filename, "rb") : NULL;
+// [/SL:KB]
+//		LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+//		bool remove_inventory_file = false;
 		if(fp)
 		{
 			fclose(fp);
@@ -2255,8 +2668,11 @@ bool LLInventoryModel::loadSkeleton(
 				LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
 			}
 		}
-		bool is_cache_obsolete = false;
-		if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
+		if ( (is_cache_loaded) || (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete)) )
+// [/SL:KB]
+//		bool is_cache_obsolete = false;
+//		if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
 		{
 			// We were able to find a cache of files. So, use what we
 			// found to generate a set of categories we should add. We
@@ -2462,6 +2878,10 @@ bool LLInventoryModel::loadSkeleton(
 void LLInventoryModel::buildParentChildMap()
 {
 	LL_INFOS(LOG_INV) << "LLInventoryModel::buildParentChildMap()" << LL_ENDL;
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+	dirtyCategoryDepths();
+	mDescendentCounts.clear();
+// [/SL:KB]
 
 	// *NOTE: I am skipping the logic around folder version
 	// synchronization here because it seems if a folder is lost, we
@@ -3699,11 +4119,17 @@ void  LLInventoryModel::checkTrashOverflow()
 	// Note: Do we really need content of subfolders?
 	// This was made to prevent download of trash folder timeouting
 	// viewer and sub-folders are supposed to download independently.
-	LLInventoryModel::cat_array_t cats;
-	LLInventoryModel::item_array_t items;
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
 	const LLUUID trash_id = findCategoryUUIDForType(LLFolderType::FT_TRASH);
-	gInventory.collectDescendents(trash_id, cats, items, LLInventoryModel::INCLUDE_TRASH);
-	S32 item_count = items.size() + cats.size();
+	S32 cat_count = 0, item_count = 0;
+	getDescendentCountsRecursive(trash_id, cat_count, item_count);
+	item_count += cat_count;
+// [/SL:KB]
+//	LLInventoryModel::cat_array_t cats;
+//	LLInventoryModel::item_array_t items;
+//	const LLUUID trash_id = findCategoryUUIDForType(LLFolderType::FT_TRASH);
+//	gInventory.collectDescendents(trash_id, cats, items, LLInventoryModel::INCLUDE_TRASH);
+//	S32 item_count = items.size() + cats.size();
 
 	if (item_count >= trash_max_capacity)
 	{
@@ -38,6 +38,15 @@
 #include "lluuid.h"
 #include "llpermissionsflags.h"
 #include "llviewerinventory.h"
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+#include "llinventorynameindex.h"
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+#include <boost/unordered_map.hpp>
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+#include "llinventorychangeset.h"
+// [/SL:KB]
 #include "llstring.h"
 #include "llmd5.h"
 #include "httpcommon.h"
@@ -166,6 +175,9 @@ class LLInventoryModel
 	void createCommonSystemCategories();
 
 	static std::string getInvCacheAddres(const LLUUID& owner_id);
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
+	static std::string getInvBinaryCacheAddres(const LLUUID& owner_id);
+// [/SL:KB]
 
 	// Call on logout to save a terse representation.
 	void cache(const LLUUID& parent_folder_id, const LLUUID& agent_id);
@@ -187,7 +199,10 @@ class LLInventoryModel
 
 	// Track links to items and categories. We do not store item or
 	// category pointers here, because broken links are also supported.
-	typedef std::multimap<LLUUID, LLUUID> backlink_mmap_t;
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+	typedef boost::unordered_multimap<LLUUID, LLUUID> backlink_mmap_t;
+// [/SL:KB]
+//	typedef std::multimap<LLUUID, LLUUID> backlink_mmap_t;
 	backlink_mmap_t mBacklinkMMap; // key = target_id: ID of item, values = link_ids: IDs of item or folder links referencing it.
 	// For internal use only
 	bool hasBacklinkInfo(const LLUUID& link_id, const LLUUID& target_id) const;
@@ -272,6 +287,13 @@ class LLInventoryModel
 	// Collect all items in inventory that are linked to item_id.
 	// Assumes item_id is itself not a linked item.
 	item_array_t collectLinksTo(const LLUUID& item_id);
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+	// Collect all links to item_id (including broken ones) that are somewhere below cat_id (anywhere if cat_id is null).
+	item_array_t collectLinksTo(const LLUUID& item_id, const LLUUID& cat_id);
+
+	// Number of categories and items below cat_id on all levels (cached until something below cat_id changes).
+	bool getDescendentCountsRecursive(const LLUUID& cat_id, S32& cat_count, S32& item_count) const;
+// [/SL:KB]
 
 	// Check if one object has a parent chain up to the category specified by UUID.
 	BOOL isObjectDescendentOf(const LLUUID& obj_id, const LLUUID& cat_id) const;
@@ -284,6 +306,46 @@ class LLInventoryModel
 	// Follow parent chain to the top.
 	bool getObjectTopmostAncestor(const LLUUID& object_id, LLUUID& result) const;
 
+// [SL:KB] - Patch: Inventory-StructureIndex | Checked: Catznip-6.7
+	//--------------------------------------------------------------------
+	// Structure indexes
+	//--------------------------------------------------------------------
+protected:
+	// Distance of the category from its root folder (the root itself is 0) or -1 if it isn't (yet) connected to a root folder
+	S32 getCategoryDepth(const LLUUID& cat_id) const;
+	// Invalidates the cached recursive counts of cat_id and all of its ancestors; call whenever the direct contents of cat_id change
+	void dirtyDescendentCounts(const LLUUID& cat_id);
+	// Invalidates all cached category depths; call whenever a category is moved or removed
+	void dirtyCategoryDepths();
+private:
+	struct CategoryDepth
+	{
+		LLUUID mParentID;
+		S32    mDepth;
+	};
+	// Only ever holds categories connected to a root folder so adding categories never invalidates it
+	mutable boost::unordered_map<LLUUID, CategoryDepth> mCategoryDepths;
+	struct DescendentCounts
+	{
+		S32 mCategories;
+		S32 mItems;
+	};
+	mutable boost::unordered_map<LLUUID, DescendentCounts> mDescendentCounts;
+// [/SL:KB]
+
+// [SL:KB] - Patch: Inventory-NameIndex | Checked: Catznip-6.7
+	//--------------------------------------------------------------------
+	// Name index
+	//--------------------------------------------------------------------
+public:
+	// Upper cased names of every object in the model (follows links like LLViewerInventoryItem::getName())
+	const LLInventoryNameIndex& getNameIndex() const { return mNameIndex; }
+protected:
+	void updateNameIndex(const LLUUID& id);
+private:
+	LLInventoryNameIndex mNameIndex;
+// [/SL:KB]
+
 	//--------------------------------------------------------------------
 	// Find
 	//--------------------------------------------------------------------
@@ -552,9 +614,21 @@ class LLInventoryModel
 // [SL:KB] - Patch: UI-Notifications | Checked: Catznip-6.5
 	const LLUUID& getTransactionId() const { return mTransactionId; }
 // [/SL:KB]
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	// The changes (and per-folder summary) that will go out with the next (or are going out with the current) notifyObservers()
+	const LLInventoryChangeSet& getChangeSet() const { return mChangeSet; }
+// [/SL:KB]
 protected:
 	// Updates all linked items pointing to this id.
 	void addChangedMaskForLinks(const LLUUID& object_id, U32 mask);
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	// Records the change with the object's current parent and type (needs to be called before a removed object is dropped from the maps)
+	void addChangeSetEntry(U32 mask, const LLUUID& object_id);
+	// Hands the changes of the current notification to the change set observers interested in them
+	void collectChangeSets();
+	// Delivers everything change set observers collected since the last call (once per frame)
+	void deliverChangeSets();
+// [/SL:KB]
 private:
 	// Flag set when notifyObservers is being called, to look for bugs
 	// where it's called recursively.
@@ -566,6 +640,9 @@ class LLInventoryModel
 // [SL:KB] - Patch: UI-Notifications | Checked: Catznip-6.5
 	LLUUID mTransactionId;
 // [/SL:KB]
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	LLInventoryChangeSet mChangeSet;
+// [/SL:KB]
 	
 	
 	//--------------------------------------------------------------------
@@ -576,9 +653,19 @@ class LLInventoryModel
 	void addObserver(LLInventoryObserver* observer);
 	void removeObserver(LLInventoryObserver* observer);
 	BOOL containsObserver(LLInventoryObserver* observer) const;
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	// Change set observers aren't owned by the model (unlike regular observers) and need to remove themselves
+	void addChangeSetObserver(LLInventoryChangeSetObserver* observer);
+	void removeChangeSetObserver(LLInventoryChangeSetObserver* observer);
+	bool containsChangeSetObserver(LLInventoryChangeSetObserver* observer) const;
+// [/SL:KB]
 private:
 	typedef std::set<LLInventoryObserver*> observer_list_t;
 	observer_list_t mObservers;
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	typedef std::set<LLInventoryChangeSetObserver*> changeset_observer_list_t;
+	changeset_observer_list_t mChangeSetObservers;
+// [/SL:KB]
 	
 /**                    Notifications
  **                                                                            **
@@ -637,6 +724,9 @@ class LLInventoryModel
 	//--------------------------------------------------------------------
 	// File I/O
 	//--------------------------------------------------------------------
+// [SL:KB] - Patch: Inventory-BinaryCache | Checked: Catznip-6.7
+	friend class LLInventoryCache;
+// [/SL:KB]
 protected:
 	static bool loadFromFile(const std::string& filename,
 							 cat_array_t& categories,
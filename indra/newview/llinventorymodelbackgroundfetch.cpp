@@ -41,6 +41,9 @@
 #include "bufferarray.h"
 #include "bufferstream.h"
 #include "llcorehttputil.h"
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+#include "lljobsystem.h"
+// [/SL:KB]
 
 // History (may be apocryphal)
 //
@@ -164,18 +167,64 @@ class BGFolderHttpHandler : public LLCore::HttpHandler
 	bool getIsRecursive(const LLUUID & cat_id) const;
 
 private:
-	void processData(LLSD & body, LLCore::HttpResponse * response);
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+	void processData(const LLSDLazyView & body, LLCore::HttpResponse * response);
+// [/SL:KB]
+//	void processData(LLSD & body, LLCore::HttpResponse * response);
 	void processFailure(LLCore::HttpStatus status, LLCore::HttpResponse * response);
 	void processFailure(const char * const reason, LLCore::HttpResponse * response);
 
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+	// Returns NULL if the response body could be decoded or else the reason why it couldn't
+	static const char * decodeResponse(LLCore::HttpResponse * response, LLSDLazyView & body_llsd);
+	// Unpacks the folder contents into mStagedFolders without touching the inventory model (safe on any thread)
+	void stageData(const LLSDLazyView & content);
+	// Applies mStagedFolders to the inventory model (main thread)
+	void applyStagedData();
+	// Worker thread half and main thread half of a response that is processed off the main thread
+	void parseResponse(LLCore::HttpResponse * response);
+	void applyParsedResponse(LLCore::HttpResponse * response);
+// [/SL:KB]
+
 private:
 	LLSD mRequestSD;
 	const uuid_vec_t mRecursiveCatUUIDs; // hack for storing away which cat fetches are recursive
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+	LLTimer mRequestTimer;
+// [/SL:KB]
+
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+	struct StagedFolder
+	{
+		LLUUID mFolderID;
+		LLUUID mOwnerID;
+		S32    mVersion = LLViewerInventoryCategory::VERSION_UNKNOWN;
+		S32    mDescendents = LLViewerInventoryCategory::DESCENDENT_COUNT_UNKNOWN;
+		std::vector<LLPointer<LLViewerInventoryCategory>> mCategories;
+		std::vector<LLPointer<LLViewerInventoryItem>> mItems;
+	};
+	std::vector<StagedFolder> mStagedFolders;
+	const char * mStagedFailure = nullptr;
+// [/SL:KB]
 };
 
 
 const char * const LOG_INV("Inventory");
 
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+// Bounds of the adaptive fetch controller; it starts out at (and never backs off below) what used to be the fixed limits
+const F32 FETCH_LIMIT_INITIAL = 12.f;
+const F32 FETCH_LIMIT_MIN = FETCH_LIMIT_INITIAL;
+const F32 FETCH_BATCH_SIZE_INITIAL = 10.f;
+const F32 FETCH_BATCH_SIZE_MIN = FETCH_BATCH_SIZE_INITIAL;
+// Extra requests allowed in flight for folders the user is waiting on
+const S32 FETCH_PRIORITY_RESERVE = 4;
+// Responses slower than this multiple of the quickest recent response count as congestion
+const F32 FETCH_CONGESTION_FACTOR = 3.f;
+// ... but anything quicker than this never does
+const F32 FETCH_CONGESTION_MIN_LATENCY = 1.f;
+// [/SL:KB]
+
 } // end of namespace anonymous
 
 
@@ -191,11 +240,74 @@ LLInventoryModelBackgroundFetch::LLInventoryModelBackgroundFetch():
 	mRecursiveInventoryFetchStarted(FALSE),
 	mRecursiveLibraryFetchStarted(FALSE),
 	mMinTimeBetweenFetches(0.3f)
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+	, mFetchLimit(FETCH_LIMIT_INITIAL)
+	, mBatchSize(FETCH_BATCH_SIZE_INITIAL)
+	, mLatencyAvg(0.f)
+	, mLatencyMin(0.f)
+// [/SL:KB]
 {}
 
 LLInventoryModelBackgroundFetch::~LLInventoryModelBackgroundFetch()
 {}
 
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+LLTrace::SampleStatHandle<> LLInventoryModelBackgroundFetch::sFetchInFlight("inventory_fetch_in_flight", "Inventory fetch requests in flight");
+LLTrace::SampleStatHandle<> LLInventoryModelBackgroundFetch::sFetchLimit("inventory_fetch_limit", "Adaptive limit of inventory fetch requests in flight");
+LLTrace::SampleStatHandle<> LLInventoryModelBackgroundFetch::sFetchBatchSize("inventory_fetch_batch_size", "Adaptive number of folders per inventory fetch request");
+LLTrace::SampleStatHandle<> LLInventoryModelBackgroundFetch::sFetchQueued("inventory_fetch_queued", "Inventory folders and items waiting to be fetched");
+LLTrace::SampleStatHandle<F32Seconds> LLInventoryModelBackgroundFetch::sFetchLatency("inventory_fetch_latency", "Response time of inventory folder fetch requests");
+
+S32 LLInventoryModelBackgroundFetch::getFetchLimit() const
+{
+	static LLCachedControl<bool> s_adaptive(gSavedSettings, "InventoryFetchAdaptive", true);
+	return (s_adaptive) ? ll_round(mFetchLimit) : (S32)FETCH_LIMIT_INITIAL;
+}
+
+S32 LLInventoryModelBackgroundFetch::getBatchSize() const
+{
+	static LLCachedControl<bool> s_adaptive(gSavedSettings, "InventoryFetchAdaptive", true);
+	return (s_adaptive) ? ll_round(mBatchSize) : (S32)FETCH_BATCH_SIZE_INITIAL;
+}
+
+void LLInventoryModelBackgroundFetch::onFetchCompleted(bool success, F32 latency)
+{
+	static LLCachedControl<S32> s_max_fetch_limit(gSavedSettings, "InventoryFetchMaxConcurrent", 32);
+	static LLCachedControl<S32> s_max_batch_size(gSavedSettings, "InventoryFetchMaxBatchSize", 40);
+
+	if (success)
+	{
+		sample(sFetchLatency, F32Seconds(latency));
+
+		mLatencyAvg = (mLatencyAvg > 0.f) ? lerp(mLatencyAvg, latency, 0.125f) : latency;
+		// The baseline is the quickest recent response; it creeps up slowly so it can follow a connection that got slower for good
+		mLatencyMin = ((mLatencyMin > 0.f) && (latency > mLatencyMin)) ? lerp(mLatencyMin, latency, 0.01f) : latency;
+	}
+
+	const bool congested = (!success) || (latency > llmax(mLatencyMin * FETCH_CONGESTION_FACTOR, FETCH_CONGESTION_MIN_LATENCY));
+	if (congested)
+	{
+		// Only back off once per round trip since everything that was already in flight will report the same congestion
+		if (mBackoffTimer.getElapsedTimeF32() > mLatencyAvg)
+		{
+			const F32 factor = (success) ? 0.75f : 0.5f;
+			mFetchLimit = llmax(FETCH_LIMIT_MIN, mFetchLimit * factor);
+			mBatchSize = llmax(FETCH_BATCH_SIZE_MIN, mBatchSize * factor);
+			mBackoffTimer.reset();
+
+			LL_DEBUGS(LOG_INV) << "Inventory fetch " << ((success) ? "slowed down" : "failed") << ", backing off to " << mFetchLimit
+			                   << " requests of " << mBatchSize << " folders" << LL_ENDL;
+		}
+	}
+	else
+	{
+		// Grows by about one per round trip
+		mFetchLimit = llmin((F32)llmax((S32)s_max_fetch_limit, 1), mFetchLimit + 1.f / mFetchLimit);
+		mBatchSize = llmin((F32)llmax((S32)s_max_batch_size, 1), mBatchSize + 1.f / mFetchLimit);
+	}
+}
+// [/SL:KB]
+
 bool LLInventoryModelBackgroundFetch::isBulkFetchProcessingComplete() const
 {
 	return mFetchQueue.empty() && mFetchCount <= 0;
@@ -282,7 +394,10 @@ void LLInventoryModelBackgroundFetch::start(const LLUUID& id, BOOL recursive)
 			// Specific folder requests go to front of queue.
 			if (mFetchQueue.empty() || mFetchQueue.front().mUUID != id)
 			{
-				mFetchQueue.push_front(FetchQueueInfo(id, recursive));
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+				mFetchQueue.push_front(FetchQueueInfo(id, recursive, true, true));
+// [/SL:KB]
+//				mFetchQueue.push_front(FetchQueueInfo(id, recursive));
 				gIdleCallbacks.addFunction(&LLInventoryModelBackgroundFetch::backgroundFetchCB, NULL);
 			}
 			if (id == gInventory.getLibraryRootFolderID())
@@ -301,7 +416,10 @@ void LLInventoryModelBackgroundFetch::start(const LLUUID& id, BOOL recursive)
 		{
 			mBackgroundFetchActive = TRUE;
 
-			mFetchQueue.push_front(FetchQueueInfo(id, false, false));
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+			mFetchQueue.push_front(FetchQueueInfo(id, false, false, true));
+// [/SL:KB]
+//			mFetchQueue.push_front(FetchQueueInfo(id, false, false));
 			gIdleCallbacks.addFunction(&LLInventoryModelBackgroundFetch::backgroundFetchCB, NULL);
 		}
 	}
@@ -372,8 +490,12 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 	// a fast/slow fetch throttle.  Once login is complete and the scene
 	// is mostly loaded, we could turn up the throttle and fill missing
 	// inventory more quickly.
-	static const U32 max_batch_size(10);
-	static const S32 max_concurrent_fetches(12);		// Outstanding requests, not connections
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+	const U32 max_batch_size(getBatchSize());
+	const S32 max_concurrent_fetches(getFetchLimit());	// Outstanding requests, not connections
+// [/SL:KB]
+//	static const U32 max_batch_size(10);
+//	static const S32 max_concurrent_fetches(12);		// Outstanding requests, not connections
 	static const F32 new_min_time(0.05f);		// *HACK:  Clean this up when old code goes away entirely.
 	
 	mMinTimeBetweenFetches = new_min_time;
@@ -386,6 +508,10 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 	{
 		// Process completed background HTTP requests
 		gInventory.handleResponses(false);
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+		// Apply whatever the workers finished parsing (observers are only notified once below for the whole batch)
+		applyStagedResponses();
+// [/SL:KB]
 		// Just processed a bunch of items.
 		// Note: do we really need notifyObservers() here?
 		// OnIdle it will be called anyway due to Add flag for processed item.
@@ -394,11 +520,26 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 		gInventory.notifyObservers();
 	}
 	
-	if ((mFetchCount > max_concurrent_fetches) ||
-		(mFetchTimer.getElapsedTimeF32() < mMinTimeBetweenFetches))
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+	sample(sFetchInFlight, mFetchCount);
+	sample(sFetchLimit, max_concurrent_fetches);
+	sample(sFetchBatchSize, max_batch_size);
+	sample(sFetchQueued, mFetchQueue.size());
+
+	// Folders the user is waiting on can dip into a few reserved slots when everything else is at the limit
+	const bool has_priority = (!mFetchQueue.empty()) && (mFetchQueue.front().mPriority);
+	if ( (mFetchCount > max_concurrent_fetches + ((has_priority) ? FETCH_PRIORITY_RESERVE : 0)) ||
+		 (mFetchTimer.getElapsedTimeF32() < mMinTimeBetweenFetches) )
 	{
 		return;
 	}
+	const bool priority_only = (mFetchCount > max_concurrent_fetches);
+// [/SL:KB]
+//	if ((mFetchCount > max_concurrent_fetches) ||
+//		(mFetchTimer.getElapsedTimeF32() < mMinTimeBetweenFetches))
+//	{
+//		return;
+//	}
 
 	U32 item_count(0);
 	U32 folder_count(0);
@@ -414,8 +555,13 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 	LLSD item_request_body;
 	LLSD item_request_body_lib;
 
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
 	while (! mFetchQueue.empty() 
-			&& (item_count + folder_count) < max_batch_size)
+			&& (item_count + folder_count) < max_batch_size
+			&& (!priority_only || mFetchQueue.front().mPriority))
+// [/SL:KB]
+//	while (! mFetchQueue.empty() 
+//			&& (item_count + folder_count) < max_batch_size)
 	{
 		const FetchQueueInfo & fetch_info(mFetchQueue.front());
 		if (fetch_info.mIsCategory)
@@ -569,6 +715,41 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 	}
 }
 
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+void LLInventoryModelBackgroundFetch::addStagedResponse(staged_response_t&& fnApply)
+{
+	std::lock_guard<std::mutex> lock(mStagedMutex);
+	mStagedResponses.push_back(std::move(fnApply));
+}
+
+static LLTrace::BlockTimerStatHandle FTM_APPLY_STAGED("Apply Staged Inventory");
+
+void LLInventoryModelBackgroundFetch::applyStagedResponses()
+{
+	LL_RECORD_BLOCK_TIME(FTM_APPLY_STAGED);
+
+	static LLCachedControl<S32> s_max_apply_time(gSavedSettings, "InventoryFetchApplyMaxTimePerFrame", 5);
+	const F32 max_apply_time = llmax(1, (S32)s_max_apply_time) / 1000.f;
+
+	LLTimer apply_timer;
+	while (apply_timer.getElapsedTimeF32() < max_apply_time)
+	{
+		staged_response_t fnApply;
+		{
+			std::lock_guard<std::mutex> lock(mStagedMutex);
+			if (mStagedResponses.empty())
+			{
+				break;
+			}
+			fnApply = std::move(mStagedResponses.front());
+			mStagedResponses.pop_front();
+		}
+		// NOTE: this releases the staged handler which is what takes the response off the fetch count
+		fnApply();
+	}
+}
+// [/SL:KB]
+
 bool LLInventoryModelBackgroundFetch::fetchQueueContainsNoDescendentsOf(const LLUUID & cat_id) const
 {
 	for (fetch_queue_t::const_iterator it = mFetchQueue.begin();
@@ -592,6 +773,32 @@ namespace
 
 void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * response)
 {
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+	LLInventoryModelBackgroundFetch::instance().onFetchCompleted(response->getStatus(), mRequestTimer.getElapsedTimeF32());
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+	static LLCachedControl<bool> s_parallel_parse(gSavedSettings, "InventoryFetchParallelParse", true);
+	LLJobSystem* pJobSystem = LLJobSystem::getInstance();
+	if ( (s_parallel_parse) && (pJobSystem) && (response->getStatus()) )
+	{
+		// The copy keeps this response counted as an outstanding fetch until its contents have actually been applied
+		boost::shared_ptr<BGFolderHttpHandler> stagedp(new BGFolderHttpHandler(mRequestSD, mRecursiveCatUUIDs));
+		response->addRef();
+		pJobSystem->post([stagedp, response]() mutable
+			{
+				stagedp->parseResponse(response);
+
+				// Hand over our reference so the handler is only ever destroyed on the main thread
+				LLInventoryModelBackgroundFetch::instance().addStagedResponse([stagedp = std::move(stagedp), response]()
+					{
+						stagedp->applyParsedResponse(response);
+						response->release();
+					});
+			});
+		return;
+	}
+// [/SL:KB]
+
 	do  	// Single-pass do-while used for common exit handling
 	{
 		LLCore::HttpStatus status(response->getStatus());
@@ -616,8 +823,13 @@ void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRes
 
 		// Convert response to LLSD
 		// body->write(0, "Garbage Response", 16);		// Dev tool to force error handling
-		LLSD body_llsd;
-		if (! LLCoreHttpUtil::responseToLLSD(response, true, body_llsd))
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+		// Large folder responses are only decoded one folder at a time
+		LLSDLazyView body_llsd;
+		if (! LLCoreHttpUtil::responseToLazyLLSD(response, body_llsd))
+// [/SL:KB]
+//		LLSD body_llsd;
+//		if (! LLCoreHttpUtil::responseToLLSD(response, true, body_llsd))
 		{
 			// INFOS-level logging will occur on the parsed failure
 			processFailure("HTTP response contained malformed LLSD", response);
@@ -652,138 +864,331 @@ void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRes
 }
 
 
-void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * response)
+// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+void BGFolderHttpHandler::processData(const LLSDLazyView & content, LLCore::HttpResponse * response)
+// [/SL:KB]
+//void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * response)
 {
-	LLInventoryModelBackgroundFetch * fetcher(LLInventoryModelBackgroundFetch::getInstance());
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+	stageData(content);
+	applyStagedData();
+// [/SL:KB]
+//	LLInventoryModelBackgroundFetch * fetcher(LLInventoryModelBackgroundFetch::getInstance());
+//
+//	// API V2 and earlier should probably be testing for "error" map
+//	// in response as an application-level error.
+//
+//	// Instead, we assume success and attempt to extract information.
+//	if (content.has("folders"))	
+//	{
+//// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+//		const LLSDLazyView folders(content["folders"]);
+//		for (S32 folder_idx = 0, folder_cnt = folders.size(); folder_idx < folder_cnt; ++folder_idx)
+//		{
+//			LLSD folder_sd(folders[folder_idx].asLLSD());
+//// [/SL:KB]
+////		LLSD folders(content["folders"]);
+////		
+////		for (LLSD::array_const_iterator folder_it = folders.beginArray();
+////			folder_it != folders.endArray();
+////			++folder_it)
+////		{	
+////			LLSD folder_sd(*folder_it);
+//
+//			//LLUUID agent_id = folder_sd["agent_id"];
+//
+//			//if(agent_id != gAgent.getID())	//This should never happen.
+//			//{
+//			//	LL_WARNS(LOG_INV) << "Got a UpdateInventoryItem for the wrong agent."
+//			//			<< LL_ENDL;
+//			//	break;
+//			//}
+//
+//			LLUUID parent_id(folder_sd["folder_id"].asUUID());
+//			LLUUID owner_id(folder_sd["owner_id"].asUUID());
+//			S32    version(folder_sd["version"].asInteger());
+//			S32    descendents(folder_sd["descendents"].asInteger());
+//			LLPointer<LLViewerInventoryCategory> tcategory = new LLViewerInventoryCategory(owner_id);
+//
+//            if (parent_id.isNull())
+//            {
+//				LLSD items(folder_sd["items"]);
+//			    LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
+//
+//			    for (LLSD::array_const_iterator item_it = items.beginArray();
+//				    item_it != items.endArray();
+//				    ++item_it)
+//			    {	
+//                    const LLUUID lost_uuid(gInventory.findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
+//
+//                    if (lost_uuid.notNull())
+//                    {
+//				        LLSD item(*item_it);
+//
+//				        titem->unpackMessage(item);
+//
+//                        LLInventoryModel::update_list_t update;
+//                        LLInventoryModel::LLCategoryUpdate new_folder(lost_uuid, 1);
+//                        update.push_back(new_folder);
+//                        gInventory.accountForUpdate(update);
+//
+//                        titem->setParent(lost_uuid);
+//                        titem->updateParentOnServer(FALSE);
+//                        gInventory.updateItem(titem);
+//                    }
+//                }
+//            }
+//
+//	        LLViewerInventoryCategory * pcat(gInventory.getCategory(parent_id));
+//			if (! pcat)
+//			{
+//				continue;
+//			}
+//
+//			LLSD categories(folder_sd["categories"]);
+//			for (LLSD::array_const_iterator category_it = categories.beginArray();
+//				category_it != categories.endArray();
+//				++category_it)
+//			{	
+//				LLSD category(*category_it);
+//				tcategory->fromLLSD(category); 
+//
+//				const bool recursive(getIsRecursive(tcategory->getUUID()));
+//				if (recursive)
+//				{
+//					fetcher->addRequestAtBack(tcategory->getUUID(), recursive, true);
+//				}
+//				else if (! gInventory.isCategoryComplete(tcategory->getUUID()))
+//				{
+//					gInventory.updateCategory(tcategory);
+//				}
+//			}
+//
+//			LLSD items(folder_sd["items"]);
+//			LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
+//			for (LLSD::array_const_iterator item_it = items.beginArray();
+//				 item_it != items.endArray();
+//				 ++item_it)
+//			{	
+//				LLSD item(*item_it);
+//				titem->unpackMessage(item);
+//
+//				gInventory.updateItem(titem);
+//			}
+//
+//			// Set version and descendentcount according to message.
+//			LLViewerInventoryCategory * cat(gInventory.getCategory(parent_id));
+//			if (cat)
+//			{
+//				cat->setVersion(version);
+//				cat->setDescendentCount(descendents);
+//				cat->determineFolderType();
+//			}
+//		}
+//	}
+//
+//	if (content.has("bad_folders"))
+//	{
+//// [SL:KB] - Patch: Viewer-OptimizationLLSDLazy | Checked: Catznip-6.7
+//		const LLSDLazyView bad_folders(content["bad_folders"]);
+//		for (S32 folder_idx = 0, folder_cnt = bad_folders.size(); folder_idx < folder_cnt; ++folder_idx)
+//		{
+//			LLSD folder_sd(bad_folders[folder_idx].asLLSD());
+//// [/SL:KB]
+////		LLSD bad_folders(content["bad_folders"]);
+////		for (LLSD::array_const_iterator folder_it = bad_folders.beginArray();
+////			 folder_it != bad_folders.endArray();
+////			 ++folder_it)
+////		{
+////			// *TODO: Stop copying data [ed:  this isn't copying data]
+////			LLSD folder_sd(*folder_it);
+//
+//			// These folders failed on the dataserver.  We probably don't want to retry them.
+//			LL_WARNS(LOG_INV) << "Folder " << folder_sd["folder_id"].asString() 
+//							  << "Error: " << folder_sd["error"].asString() << LL_ENDL;
+//		}
+//	}
+//
+//	if (fetcher->isBulkFetchProcessingComplete())
+//	{
+//		fetcher->setAllFoldersFetched();
+//	}
+}
+
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+// static
+const char * BGFolderHttpHandler::decodeResponse(LLCore::HttpResponse * response, LLSDLazyView & body_llsd)
+{
+	// Same checks (and failure reasons) as onCompleted()
+	LLCore::BufferArray * body(response->getBody());
+	if (! body || ! body->size())
+	{
+		LL_WARNS(LOG_INV) << "Missing data in inventory folder query." << LL_ENDL;
+		return "HTTP response missing expected body";
+	}
+
+	if (! LLCoreHttpUtil::responseToLazyLLSD(response, body_llsd))
+	{
+		return "HTTP response contained malformed LLSD";
+	}
+
+	if (! body_llsd.isMap())
+	{
+		return "LLSD response not a map";
+	}
+
+	if (body_llsd.has("error"))
+	{
+		return "Inventory application error (200-with-error)";
+	}
+	return nullptr;
+}
+
+void BGFolderHttpHandler::stageData(const LLSDLazyView & content)
+{
+	mStagedFolders.clear();
 
 	// API V2 and earlier should probably be testing for "error" map
 	// in response as an application-level error.
 
 	// Instead, we assume success and attempt to extract information.
-	if (content.has("folders"))	
+	if (content.has("folders"))
 	{
-		LLSD folders(content["folders"]);
-		
-		for (LLSD::array_const_iterator folder_it = folders.beginArray();
-			folder_it != folders.endArray();
-			++folder_it)
-		{	
-			LLSD folder_sd(*folder_it);
+		const LLSDLazyView folders(content["folders"]);
+		mStagedFolders.reserve(folders.size());
+		for (S32 folder_idx = 0, folder_cnt = folders.size(); folder_idx < folder_cnt; ++folder_idx)
+		{
+			const LLSD folder_sd(folders[folder_idx].asLLSD());
+
+			mStagedFolders.push_back(StagedFolder());
+			StagedFolder& staged_folder = mStagedFolders.back();
+			staged_folder.mFolderID = folder_sd["folder_id"].asUUID();
+			staged_folder.mOwnerID = folder_sd["owner_id"].asUUID();
+			staged_folder.mVersion = folder_sd["version"].asInteger();
+			staged_folder.mDescendents = folder_sd["descendents"].asInteger();
+
+			const LLSD& categories = folder_sd["categories"];
+			staged_folder.mCategories.reserve(categories.size());
+			for (LLSD::array_const_iterator category_it = categories.beginArray(); category_it != categories.endArray(); ++category_it)
+			{
+				LLPointer<LLViewerInventoryCategory> tcategory = new LLViewerInventoryCategory(staged_folder.mOwnerID);
+				tcategory->fromLLSD(*category_it);
+				staged_folder.mCategories.push_back(tcategory);
+			}
 
-			//LLUUID agent_id = folder_sd["agent_id"];
-
-			//if(agent_id != gAgent.getID())	//This should never happen.
-			//{
-			//	LL_WARNS(LOG_INV) << "Got a UpdateInventoryItem for the wrong agent."
-			//			<< LL_ENDL;
-			//	break;
-			//}
-
-			LLUUID parent_id(folder_sd["folder_id"].asUUID());
-			LLUUID owner_id(folder_sd["owner_id"].asUUID());
-			S32    version(folder_sd["version"].asInteger());
-			S32    descendents(folder_sd["descendents"].asInteger());
-			LLPointer<LLViewerInventoryCategory> tcategory = new LLViewerInventoryCategory(owner_id);
-
-            if (parent_id.isNull())
-            {
-				LLSD items(folder_sd["items"]);
-			    LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
-				
-			    for (LLSD::array_const_iterator item_it = items.beginArray();
-				    item_it != items.endArray();
-				    ++item_it)
-			    {	
-                    const LLUUID lost_uuid(gInventory.findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
-
-                    if (lost_uuid.notNull())
-                    {
-				        LLSD item(*item_it);
-
-				        titem->unpackMessage(item);
-				
-                        LLInventoryModel::update_list_t update;
-                        LLInventoryModel::LLCategoryUpdate new_folder(lost_uuid, 1);
-                        update.push_back(new_folder);
-                        gInventory.accountForUpdate(update);
-
-                        titem->setParent(lost_uuid);
-                        titem->updateParentOnServer(FALSE);
-                        gInventory.updateItem(titem);
-                    }
-                }
-            }
-
-	        LLViewerInventoryCategory * pcat(gInventory.getCategory(parent_id));
-			if (! pcat)
+			const LLSD& items = folder_sd["items"];
+			staged_folder.mItems.reserve(items.size());
+			for (LLSD::array_const_iterator item_it = items.beginArray(); item_it != items.endArray(); ++item_it)
 			{
-				continue;
+				LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
+				titem->unpackMessage(*item_it);
+				staged_folder.mItems.push_back(titem);
 			}
+		}
+	}
 
-			LLSD categories(folder_sd["categories"]);
-			for (LLSD::array_const_iterator category_it = categories.beginArray();
-				category_it != categories.endArray();
-				++category_it)
-			{	
-				LLSD category(*category_it);
-				tcategory->fromLLSD(category); 
-				
-				const bool recursive(getIsRecursive(tcategory->getUUID()));
-				if (recursive)
-				{
-					fetcher->addRequestAtBack(tcategory->getUUID(), recursive, true);
-				}
-				else if (! gInventory.isCategoryComplete(tcategory->getUUID()))
+	if (content.has("bad_folders"))
+	{
+		const LLSDLazyView bad_folders(content["bad_folders"]);
+		for (S32 folder_idx = 0, folder_cnt = bad_folders.size(); folder_idx < folder_cnt; ++folder_idx)
+		{
+			const LLSD folder_sd(bad_folders[folder_idx].asLLSD());
+
+			// These folders failed on the dataserver.  We probably don't want to retry them.
+			LL_WARNS(LOG_INV) << "Folder " << folder_sd["folder_id"].asString()
+							  << "Error: " << folder_sd["error"].asString() << LL_ENDL;
+		}
+	}
+}
+
+void BGFolderHttpHandler::applyStagedData()
+{
+	LLInventoryModelBackgroundFetch * fetcher(LLInventoryModelBackgroundFetch::getInstance());
+
+	for (StagedFolder& staged_folder : mStagedFolders)
+	{
+		if (staged_folder.mFolderID.isNull())
+		{
+			const LLUUID lost_uuid(gInventory.findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
+			if (lost_uuid.notNull())
+			{
+				for (LLPointer<LLViewerInventoryItem>& titem : staged_folder.mItems)
 				{
-					gInventory.updateCategory(tcategory);
+					LLInventoryModel::update_list_t update;
+					LLInventoryModel::LLCategoryUpdate new_folder(lost_uuid, 1);
+					update.push_back(new_folder);
+					gInventory.accountForUpdate(update);
+
+					titem->setParent(lost_uuid);
+					titem->updateParentOnServer(FALSE);
+					gInventory.updateItem(titem);
 				}
 			}
+		}
 
-			LLSD items(folder_sd["items"]);
-			LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
-			for (LLSD::array_const_iterator item_it = items.beginArray();
-				 item_it != items.endArray();
-				 ++item_it)
-			{	
-				LLSD item(*item_it);
-				titem->unpackMessage(item);
-				
-				gInventory.updateItem(titem);
-			}
+		if (!gInventory.getCategory(staged_folder.mFolderID))
+		{
+			continue;
+		}
 
-			// Set version and descendentcount according to message.
-			LLViewerInventoryCategory * cat(gInventory.getCategory(parent_id));
-			if (cat)
+		for (const LLPointer<LLViewerInventoryCategory>& tcategory : staged_folder.mCategories)
+		{
+			const bool recursive(getIsRecursive(tcategory->getUUID()));
+			if (recursive)
+			{
+				fetcher->addRequestAtBack(tcategory->getUUID(), recursive, true);
+			}
+			else if (! gInventory.isCategoryComplete(tcategory->getUUID()))
 			{
-				cat->setVersion(version);
-				cat->setDescendentCount(descendents);
-				cat->determineFolderType();
+				gInventory.updateCategory(tcategory);
 			}
 		}
-	}
-		
-	if (content.has("bad_folders"))
-	{
-		LLSD bad_folders(content["bad_folders"]);
-		for (LLSD::array_const_iterator folder_it = bad_folders.beginArray();
-			 folder_it != bad_folders.endArray();
-			 ++folder_it)
+
+		for (const LLPointer<LLViewerInventoryItem>& titem : staged_folder.mItems)
 		{
-			// *TODO: Stop copying data [ed:  this isn't copying data]
-			LLSD folder_sd(*folder_it);
-			
-			// These folders failed on the dataserver.  We probably don't want to retry them.
-			LL_WARNS(LOG_INV) << "Folder " << folder_sd["folder_id"].asString() 
-							  << "Error: " << folder_sd["error"].asString() << LL_ENDL;
+			gInventory.updateItem(titem);
+		}
+
+		// Set version and descendentcount according to message.
+		LLViewerInventoryCategory * cat(gInventory.getCategory(staged_folder.mFolderID));
+		if (cat)
+		{
+			cat->setVersion(staged_folder.mVersion);
+			cat->setDescendentCount(staged_folder.mDescendents);
+			cat->determineFolderType();
 		}
 	}
-	
+	mStagedFolders.clear();
+
 	if (fetcher->isBulkFetchProcessingComplete())
 	{
 		fetcher->setAllFoldersFetched();
 	}
 }
 
+void BGFolderHttpHandler::parseResponse(LLCore::HttpResponse * response)
+{
+	LLSDLazyView body_llsd;
+	mStagedFailure = decodeResponse(response, body_llsd);
+	if (!mStagedFailure)
+	{
+		stageData(body_llsd);
+	}
+}
+
+void BGFolderHttpHandler::applyParsedResponse(LLCore::HttpResponse * response)
+{
+	if (mStagedFailure)
+	{
+		processFailure(mStagedFailure, response);
+	}
+	else
+	{
+		applyStagedData();
+	}
+}
+// [/SL:KB]
+
 
 void BGFolderHttpHandler::processFailure(LLCore::HttpStatus status, LLCore::HttpResponse * response)
 {
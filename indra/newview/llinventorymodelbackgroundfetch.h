@@ -34,6 +34,13 @@
 #include "httpoptions.h"
 #include "httpheaders.h"
 #include "httphandler.h"
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+#include "lltrace.h"
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+#include <functional>
+#include <mutex>
+// [/SL:KB]
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Class LLInventoryModelBackgroundFetch
@@ -71,8 +78,31 @@ class LLInventoryModelBackgroundFetch : public LLSingleton<LLInventoryModelBackg
 	void addRequestAtFront(const LLUUID & id, BOOL recursive, bool is_category);
 	void addRequestAtBack(const LLUUID & id, BOOL recursive, bool is_category);
 
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+	typedef std::function<void()> staged_response_t;
+	// Queues a response that was parsed off the main thread (may be called from any thread); bulkFetch() applies them
+	void addStagedResponse(staged_response_t&& fnApply);
+// [/SL:KB]
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+	// Feeds the response time (or failure) of a folder request back into the concurrency and batch size controller
+	void onFetchCompleted(bool success, F32 latency);
+
+	S32 getFetchLimit() const;
+	S32 getBatchSize() const;
+
+	static LLTrace::SampleStatHandle<>				sFetchInFlight;
+	static LLTrace::SampleStatHandle<>				sFetchLimit;
+	static LLTrace::SampleStatHandle<>				sFetchBatchSize;
+	static LLTrace::SampleStatHandle<>				sFetchQueued;
+	static LLTrace::SampleStatHandle<F32Seconds>	sFetchLatency;
+// [/SL:KB]
+
 protected:
 	void bulkFetch();
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+	// Applies staged responses (oldest first) until the per frame time budget runs out
+	void applyStagedResponses();
+// [/SL:KB]
 
 	void backgroundFetch();
 	static void backgroundFetchCB(void*); // background fetch idle function
@@ -91,20 +121,47 @@ class LLInventoryModelBackgroundFetch : public LLSingleton<LLInventoryModelBackg
 	LLFrameTimer mFetchTimer;
 	F32 mMinTimeBetweenFetches;
 
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+	// Additive increase / multiplicative decrease of the number of requests in flight and folders per request:
+	// both grow while responses come back quickly and back off on failures or when responses slow down
+	F32 mFetchLimit;
+	F32 mBatchSize;
+	F32 mLatencyAvg;
+	F32 mLatencyMin;
+	LLFrameTimer mBackoffTimer;
+// [/SL:KB]
+
 	struct FetchQueueInfo
 	{
-		FetchQueueInfo(const LLUUID& id, BOOL recursive, bool is_category = true)
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+		FetchQueueInfo(const LLUUID& id, BOOL recursive, bool is_category = true, bool is_priority = false)
 			: mUUID(id),
 			  mIsCategory(is_category),
-			  mRecursive(recursive)
+			  mRecursive(recursive),
+			  mPriority(is_priority)
 		{}
+// [/SL:KB]
+//		FetchQueueInfo(const LLUUID& id, BOOL recursive, bool is_category = true)
+//			: mUUID(id),
+//			  mIsCategory(is_category),
+//			  mRecursive(recursive)
+//		{}
 		
 		LLUUID mUUID;
 		bool mIsCategory;
 		BOOL mRecursive;
+// [SL:KB] - Patch: Inventory-AdaptiveFetch | Checked: Catznip-6.7
+		// Something the user is looking at (an opened or selected folder, a folder matching a search)
+		bool mPriority;
+// [/SL:KB]
 	};
 	typedef std::deque<FetchQueueInfo> fetch_queue_t;
 	fetch_queue_t mFetchQueue;
+
+// [SL:KB] - Patch: Inventory-ParallelFetch | Checked: Catznip-6.7
+	std::mutex mStagedMutex;
+	std::deque<staged_response_t> mStagedResponses;
+// [/SL:KB]
 };
 
 #endif // LL_LLINVENTORYMODELBACKGROUNDFETCH_H
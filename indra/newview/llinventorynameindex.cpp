@@ -0,0 +1,271 @@
+/**
+ * @file llinventorynameindex.cpp
+ * @brief Case-folded trigram index over inventory object names
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorynameindex.h"
+
+#include <algorithm>
+
+// ============================================================================
+// LLInventoryNameIndex class
+//
+
+void LLInventoryNameIndex::update(const LLUUID& id, const std::string& name)
+{
+	std::string folded_name(name);
+	LLStringUtil::toUpper(folded_name);
+
+	U32 entry_idx;
+	auto itEntry = mEntryIndices.find(id);
+	if (mEntryIndices.end() != itEntry)
+	{
+		entry_idx = itEntry->second;
+		if (mEntries[entry_idx].mName == folded_name)
+		{
+			return;
+		}
+		removePostings(entry_idx);
+	}
+	else
+	{
+		if (!mFreeEntries.empty())
+		{
+			entry_idx = mFreeEntries.back();
+			mFreeEntries.pop_back();
+		}
+		else
+		{
+			entry_idx = (U32)mEntries.size();
+			mEntries.emplace_back();
+		}
+		mEntries[entry_idx].mID = id;
+		mEntryIndices.insert(std::make_pair(id, entry_idx));
+	}
+
+	Entry& entry = mEntries[entry_idx];
+	entry.mName = std::move(folded_name);
+	entry.mStamp = ++mStamp;
+	addPostings(entry_idx);
+}
+
+void LLInventoryNameIndex::remove(const LLUUID& id)
+{
+	auto itEntry = mEntryIndices.find(id);
+	if (mEntryIndices.end() == itEntry)
+	{
+		return;
+	}
+
+	const U32 entry_idx = itEntry->second;
+	removePostings(entry_idx);
+	mEntries[entry_idx] = Entry();
+	mFreeEntries.push_back(entry_idx);
+	mEntryIndices.erase(itEntry);
+	++mStamp;
+}
+
+void LLInventoryNameIndex::clear()
+{
+	mEntries.clear();
+	mFreeEntries.clear();
+	mEntryIndices.clear();
+	mPostings.clear();
+	// Never reset the stamp since query results that are still held on to would otherwise appear current
+	++mStamp;
+}
+
+const LLInventoryNameIndex::Entry* LLInventoryNameIndex::find(const LLUUID& id) const
+{
+	auto itEntry = mEntryIndices.find(id);
+	return (mEntryIndices.end() != itEntry) ? &mEntries[itEntry->second] : nullptr;
+}
+
+// static
+bool LLInventoryNameIndex::canQuery(const std::vector<std::string>& terms, bool match_all)
+{
+	// Terms shorter than a trigram can't narrow down the candidates; when matching all it's enough for one term to do so
+	// but when matching any a single short term would mean looking at everything
+	auto isTrigramTerm = [](const std::string& term) { return term.size() >= 3; };
+	return (match_all) ? std::any_of(terms.begin(), terms.end(), isTrigramTerm) : (!terms.empty()) && (std::all_of(terms.begin(), terms.end(), isTrigramTerm));
+}
+
+bool LLInventoryNameIndex::query(const std::vector<std::string>& terms, bool match_all, QueryResult& result) const
+{
+	result.mMatches.clear();
+	result.mStamp = mStamp;
+
+	if (!canQuery(terms, match_all))
+	{
+		return false;
+	}
+
+	std::vector<const std::string*> trigram_terms;
+	for (const std::string& term : terms)
+	{
+		if (term.size() >= 3)
+			trigram_terms.push_back(&term);
+	}
+
+	posting_list_t candidates;
+	if (match_all)
+	{
+		// Every term has to match so the trigrams of all of them narrow down the same candidates
+		if (!getCandidates(trigram_terms, candidates))
+			return true;
+	}
+	else
+	{
+		posting_list_t term_candidates;
+		for (const std::string* term : trigram_terms)
+		{
+			if (getCandidates(std::vector<const std::string*>(1, term), term_candidates))
+				candidates.insert(candidates.end(), term_candidates.begin(), term_candidates.end());
+		}
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+
+	match_offsets_t offsets;
+	for (U32 entry_idx : candidates)
+	{
+		const Entry& entry = mEntries[entry_idx];
+		offsets.clear();
+		if (matchEntry(entry, terms, match_all, offsets))
+			result.mMatches.insert(std::make_pair(entry.mID, offsets));
+	}
+	return true;
+}
+
+// static
+void LLInventoryNameIndex::getTrigrams(const std::string& name, std::vector<U32>& trigrams)
+{
+	trigrams.clear();
+	for (size_t idx = 0; idx + 3 <= name.size(); idx++)
+	{
+		trigrams.push_back(((U32)(U8)name[idx] << 16) | ((U32)(U8)name[idx + 1] << 8) | (U32)(U8)name[idx + 2]);
+	}
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+bool LLInventoryNameIndex::getCandidates(const std::vector<const std::string*>& terms, posting_list_t& candidates) const
+{
+	candidates.clear();
+
+	std::vector<U32> trigrams, term_trigrams;
+	for (const std::string* term : terms)
+	{
+		getTrigrams(*term, term_trigrams);
+		trigrams.insert(trigrams.end(), term_trigrams.begin(), term_trigrams.end());
+	}
+	if (trigrams.empty())
+	{
+		return true;
+	}
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+	std::vector<const posting_list_t*> postings;
+	postings.reserve(trigrams.size());
+	for (U32 trigram : trigrams)
+	{
+		auto itPostings = mPostings.find(trigram);
+		if (mPostings.end() == itPostings)
+		{
+			return false;
+		}
+		postings.push_back(&itPostings->second);
+	}
+
+	// Intersect starting with the shortest list so the working set only ever shrinks
+	std::sort(postings.begin(), postings.end(), [](const posting_list_t* lhs, const posting_list_t* rhs) { return lhs->size() < rhs->size(); });
+	candidates = *postings.front();
+
+	posting_list_t intersection;
+	for (auto itPostings = postings.begin() + 1; (itPostings != postings.end()) && (!candidates.empty()); ++itPostings)
+	{
+		intersection.clear();
+		std::set_intersection(candidates.begin(), candidates.end(), (*itPostings)->begin(), (*itPostings)->end(), std::back_inserter(intersection));
+		candidates.swap(intersection);
+	}
+	return !candidates.empty();
+}
+
+// static
+bool LLInventoryNameIndex::matchEntry(const Entry& entry, const std::vector<std::string>& terms, bool match_all, match_offsets_t& offsets)
+{
+	for (const std::string& term : terms)
+	{
+		// An empty term never matches (see boost::ifind_first)
+		const size_t pos = (!term.empty()) ? entry.mName.find(term) : std::string::npos;
+		if (std::string::npos == pos)
+		{
+			if (match_all)
+				return false;
+			continue;
+		}
+
+		offsets.push_back(std::make_pair((int)pos, (int)(pos + term.size())));
+		if (!match_all)
+			return true;
+	}
+	return match_all;
+}
+
+void LLInventoryNameIndex::addPostings(U32 entry_idx)
+{
+	std::vector<U32> trigrams;
+	getTrigrams(mEntries[entry_idx].mName, trigrams);
+	for (U32 trigram : trigrams)
+	{
+		// Entries are mostly added in order so this is usually an append
+		posting_list_t& postings = mPostings[trigram];
+		if ( (postings.empty()) || (postings.back() < entry_idx) )
+			postings.push_back(entry_idx);
+		else
+			postings.insert(std::lower_bound(postings.begin(), postings.end(), entry_idx), entry_idx);
+	}
+}
+
+void LLInventoryNameIndex::removePostings(U32 entry_idx)
+{
+	std::vector<U32> trigrams;
+	getTrigrams(mEntries[entry_idx].mName, trigrams);
+	for (U32 trigram : trigrams)
+	{
+		auto itPostings = mPostings.find(trigram);
+		if (mPostings.end() == itPostings)
+			continue;
+
+		posting_list_t& postings = itPostings->second;
+		auto itEntry = std::lower_bound(postings.begin(), postings.end(), entry_idx);
+		if ( (postings.end() != itEntry) && (entry_idx == *itEntry) )
+			postings.erase(itEntry);
+		if (postings.empty())
+			mPostings.erase(itPostings);
+	}
+}
@@ -0,0 +1,109 @@
+/**
+ * @file llinventorynameindex.h
+ * @brief Case-folded trigram index over inventory object names
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYNAMEINDEX_H
+#define LL_LLINVENTORYNAMEINDEX_H
+
+#include "lluuid.h"
+
+#include <boost/unordered_map.hpp>
+#include <string>
+#include <vector>
+
+//============================================================================
+// LLInventoryNameIndex - upper cased names of every inventory object along
+// with posting lists of the (byte) trigrams that occur in them.
+//
+// A substring search for a term of at least three characters only has to
+// look at the objects that contain every trigram of the term rather than at
+// every object in inventory. Queries whose terms can't be narrowed down by
+// their trigrams are refused so the caller can fall back to matching names
+// directly instead of allocating match offsets for every object. Every entry carries the stamp of its last change so a consumer that
+// holds on to the results of a query can tell which objects changed since.
+//
+// Names are folded the same way LLFolderViewModelItemInventory folds its
+// searchable name (LLStringUtil::toUpper) and search terms are expected to
+// already be upper case.
+
+class LLInventoryNameIndex
+{
+public:
+	typedef std::vector<std::pair<int, int>> match_offsets_t;
+	typedef boost::unordered_map<LLUUID, match_offsets_t> match_map_t;
+
+	struct Entry
+	{
+		LLUUID		mID;
+		std::string	mName;
+		U32			mStamp = 0;
+	};
+
+	// Matching objects along with the match offsets (same rules as LLInventoryFilter::checkAgainstName); only valid for
+	// entries whose stamp isn't newer than mStamp
+	struct QueryResult
+	{
+		match_map_t	mMatches;
+		U32			mStamp = 0;
+	};
+
+	void update(const LLUUID& id, const std::string& name);
+	void remove(const LLUUID& id);
+	void clear();
+
+	// NULL if the object isn't indexed
+	const Entry* find(const LLUUID& id) const;
+	// Stamp of the most recent change to the index
+	U32  getStamp() const { return mStamp; }
+	U32  size() const { return (U32)mEntryIndices.size(); }
+
+	// Finds the objects whose name contains all (or any) of the terms; returns false (and leaves no matches) if the terms
+	// don't yield trigrams to narrow down the candidates with (no term of at least three characters when matching all,
+	// any shorter term when matching any)
+	static bool canQuery(const std::vector<std::string>& terms, bool match_all);
+	bool query(const std::vector<std::string>& terms, bool match_all, QueryResult& result) const;
+
+protected:
+	typedef std::vector<U32> posting_list_t;
+
+	static void getTrigrams(const std::string& name, std::vector<U32>& trigrams);
+	// Returns false if no object contains every trigram of the terms (candidates is empty when there are no trigrams)
+	bool getCandidates(const std::vector<const std::string*>& terms, posting_list_t& candidates) const;
+	// Appends the offsets of the terms in the entry name following LLInventoryFilter::checkAgainstName() and returns
+	// whether the entry matches
+	static bool matchEntry(const Entry& entry, const std::vector<std::string>& terms, bool match_all, match_offsets_t& offsets);
+
+	void addPostings(U32 entry_idx);
+	void removePostings(U32 entry_idx);
+
+protected:
+	std::vector<Entry>							mEntries;
+	std::vector<U32>							mFreeEntries;
+	boost::unordered_map<LLUUID, U32>			mEntryIndices;
+	boost::unordered_map<U32, posting_list_t>	mPostings;
+	U32											mStamp = 0;
+};
+
+#endif // LL_LLINVENTORYNAMEINDEX_H
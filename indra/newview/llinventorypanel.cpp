@@ -169,6 +169,9 @@ LLInventoryPanel::LLInventoryPanel(const LLInventoryPanel::Params& p) :
 	mShowItems(p.show_items),
 // [/SL:KB]
 	mBuildViewsOnInit(p.preinitialize_views),
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	mLazyViews(p.lazy_views && gSavedSettings.getBOOL("InventoryLazyViews")),
+// [/SL:KB]
 	mViewsInitialized(VIEWS_UNINITIALIZED),
 	mInvFVBridgeBuilder(NULL),
 	mInventoryViewModel(p.name),
@@ -895,6 +898,9 @@ void LLInventoryPanel::idle(void* user_data)
     // Take into account the fact that the root folder might be invalidated
     if (panel->mFolderRoot.get())
     {
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+        panel->updateDeferredViews();
+// [/SL:KB]
         panel->mFolderRoot.get()->update();
         // while dragging, update selection rendering to reflect single/multi drag status
         if (LLToolDragAndDrop::getInstance()->hasMouseCapture())
@@ -1035,6 +1041,13 @@ LLFolderViewItem* LLInventoryPanel::buildNewViews(const LLUUID& id, LLInventoryO
     }
 
     const LLUUID &parent_id = objectp->getParentUUID();
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+    if ( (!folder_view_item) && (mInventoryViewModel.isDeferredFolder(parent_id)) )
+    {
+        // Built along with the rest of the folder's children
+        return NULL;
+    }
+// [/SL:KB]
     LLFolderViewFolder* parent_folder = (LLFolderViewFolder*)getItemByID(parent_id);
 
     return buildViewsTree(id, parent_id, objectp, folder_view_item, parent_folder);
@@ -1150,7 +1163,14 @@ LLFolderViewItem* LLInventoryPanel::buildViewsTree(const LLUUID& id,
 
 	// If this is a folder, add the children of the folder and recursively add any 
 	// child folders.
-	if (folder_view_item && objectp->getType() == LLAssetType::AT_CATEGORY)
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	if ( (folder_view_item) && (objectp->getType() == LLAssetType::AT_CATEGORY) && (shouldDeferChildViews(id, folder_view_item)) )
+	{
+		mInventoryViewModel.addDeferredFolder(id);
+	}
+	else if (folder_view_item && objectp->getType() == LLAssetType::AT_CATEGORY)
+// [/SL:KB]
+//	if (folder_view_item && objectp->getType() == LLAssetType::AT_CATEGORY)
 	{
 		LLViewerInventoryCategory::cat_array_t* categories;
 		LLViewerInventoryItem::item_array_t* items;
@@ -1209,6 +1229,224 @@ LLFolderViewItem* LLInventoryPanel::buildViewsTree(const LLUUID& id,
 	return folder_view_item;
 }
 
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+bool LLInventoryPanel::shouldDeferChildViews(const LLUUID& folder_id, LLFolderViewItem* folder_view_item) const
+{
+	if ( (!mLazyViews) || (folder_id == mBuildingFolderID) || (folder_view_item == mFolderRoot.get()) )
+	{
+		return false;
+	}
+
+	const LLFolderViewFolder* folderp = dynamic_cast<const LLFolderViewFolder*>(folder_view_item);
+	return (folderp) && (!folderp->isOpen());
+}
+
+void LLInventoryPanel::buildFolderChildViews(const LLUUID& folder_id)
+{
+	if (!mInventoryViewModel.removeDeferredFolder(folder_id))
+	{
+		return;
+	}
+
+	LLFolderViewFolder* folderp = getFolderByID(folder_id);
+	const LLInventoryObject* objectp = mInventory->getObject(folder_id);
+	if ( (folderp) && (objectp) )
+	{
+		mBuildingFolderID = folder_id;
+		buildViewsTree(folder_id, objectp->getParentUUID(), objectp, folderp, folderp->getParentFolder());
+		mBuildingFolderID.setNull();
+	}
+}
+
+LLFolderViewItem* LLInventoryPanel::buildViewsForObject(const LLUUID& object_id)
+{
+	LLFolderViewItem* itemp = getItemByID(object_id);
+	if ( (itemp) || (!mInventoryViewModel.hasDeferredFolders()) )
+	{
+		return itemp;
+	}
+
+	// Walk up to the first ancestor that has a view and then build the children of every folder on the way back down
+	uuid_vec_t folder_ids;
+	const LLInventoryObject* objectp = mInventory->getObject(object_id);
+	for (LLUUID folder_id = (objectp) ? objectp->getParentUUID() : LLUUID::null; folder_id.notNull(); )
+	{
+		folder_ids.push_back(folder_id);
+		if (getItemByID(folder_id))
+		{
+			break;
+		}
+		const LLViewerInventoryCategory* catp = mInventory->getCategory(folder_id);
+		folder_id = (catp) ? catp->getParentUUID() : LLUUID::null;
+	}
+
+	for (auto itFolder = folder_ids.rbegin(); itFolder != folder_ids.rend(); ++itFolder)
+	{
+		buildFolderChildViews(*itFolder);
+	}
+	return getItemByID(object_id);
+}
+
+void LLInventoryPanel::updateDeferredViews()
+{
+	if (!getFilter().isActive())
+	{
+		// Views that were only built for the search go again once it's cleared (unless their folder was left open)
+		for (const LLUUID& folder_id : mSearchBuiltFolders)
+		{
+			LLFolderViewFolder* folderp = getFolderByID(folder_id);
+			if ( (folderp) && (!folderp->isOpen()) )
+			{
+				dropFolderChildViews(folderp);
+			}
+		}
+		mSearchBuiltFolders.clear();
+		mSearchFolders.clear();
+		mSearchFilterGeneration = -1;
+		mInventoryViewModel.setPendingDeferredFolders(0);
+		return;
+	}
+
+	if (!mInventoryViewModel.hasDeferredFolders())
+	{
+		mInventoryViewModel.setPendingDeferredFolders(0);
+		return;
+	}
+
+	// Work out which folders can hold matches whenever the filter changes and (at most once a second) when inventory does
+	const S32 filter_generation = getFilter().getCurrentGeneration();
+	const U32 inventory_stamp = mInventory->getNameIndex().getStamp();
+	if ( (filter_generation != mSearchFilterGeneration) || ((inventory_stamp != mSearchInventoryStamp) && (mSearchUpdateTimer.hasExpired())) )
+	{
+		updateSearchFolders();
+		mSearchFilterGeneration = filter_generation;
+		mSearchInventoryStamp = inventory_stamp;
+		mSearchUpdateTimer.setTimerExpirySec(1.f);
+	}
+
+	// Same budget as the filter, which will pick up the new views as they come in
+	static LLCachedControl<S32> s_max_time_visible(gSavedSettings, "InventoryLazyViewsMaxTimePerFrame", 5);
+	const F32 max_time = llclamp(getVisible() ? (S32)s_max_time_visible : 1, 1, 100) / 1000.f;
+
+	LLTimer build_timer;
+	if (mSearchAllFolders)
+	{
+		// Without name terms to go by anything might pass so every deferred folder needs its views
+		do
+		{
+			const LLUUID folder_id = mInventoryViewModel.getFirstDeferredFolder();
+			buildFolderChildViews(folder_id);
+			mSearchBuiltFolders.insert(folder_id);
+		} while ( (mInventoryViewModel.hasDeferredFolders()) && (build_timer.getElapsedTimeF32() < max_time) );
+		mInventoryViewModel.setPendingDeferredFolders(mInventoryViewModel.getDeferredFolderCount());
+	}
+	else
+	{
+		// Ancestors come first so by the time a folder comes up its own view exists (if it belongs to this panel at all)
+		while ( (mSearchFolderIdx < mSearchFolders.size()) && (build_timer.getElapsedTimeF32() < max_time) )
+		{
+			const LLUUID& folder_id = mSearchFolders[mSearchFolderIdx++];
+			if (mInventoryViewModel.isDeferredFolder(folder_id))
+			{
+				buildFolderChildViews(folder_id);
+				mSearchBuiltFolders.insert(folder_id);
+			}
+		}
+		mInventoryViewModel.setPendingDeferredFolders((S32)(mSearchFolders.size() - mSearchFolderIdx));
+	}
+}
+
+void LLInventoryPanel::updateSearchFolders()
+{
+	mSearchFolders.clear();
+	mSearchFolderIdx = 0;
+
+	uuid_vec_t root_ids;
+	if (getRootFolderID().notNull())
+	{
+		root_ids.push_back(getRootFolderID());
+	}
+	else
+	{
+		root_ids.push_back(gInventory.getRootFolderID());
+		root_ids.push_back(gInventory.getLibraryRootFolderID());
+	}
+
+	uuid_vec_t object_ids;
+	mSearchAllFolders = !getFilter().collectNameMatches(root_ids, object_ids);
+	if (mSearchAllFolders)
+	{
+		return;
+	}
+
+	// Walk up from every match until reaching a folder that was already seen (or the top) and note each folder's depth
+	std::map<LLUUID, S32> folder_depths;
+	uuid_vec_t folder_path;
+	for (const LLUUID& object_id : object_ids)
+	{
+		const LLInventoryObject* objectp = mInventory->getObject(object_id);
+
+		S32 depth = 0;
+		folder_path.clear();
+		for (LLUUID folder_id = (objectp) ? objectp->getParentUUID() : LLUUID::null; folder_id.notNull(); )
+		{
+			auto itDepth = folder_depths.find(folder_id);
+			if (folder_depths.end() != itDepth)
+			{
+				depth = itDepth->second + 1;
+				break;
+			}
+			folder_path.push_back(folder_id);
+
+			const LLViewerInventoryCategory* catp = mInventory->getCategory(folder_id);
+			folder_id = (catp) ? catp->getParentUUID() : LLUUID::null;
+		}
+
+		for (auto itFolder = folder_path.rbegin(); itFolder != folder_path.rend(); ++itFolder)
+		{
+			folder_depths[*itFolder] = depth++;
+		}
+	}
+
+	std::vector<std::pair<S32, LLUUID>> sorted_folders;
+	sorted_folders.reserve(folder_depths.size());
+	for (const auto& itFolder : folder_depths)
+	{
+		sorted_folders.push_back(std::make_pair(itFolder.second, itFolder.first));
+	}
+	std::sort(sorted_folders.begin(), sorted_folders.end());
+
+	mSearchFolders.reserve(sorted_folders.size());
+	for (const auto& itFolder : sorted_folders)
+	{
+		mSearchFolders.push_back(itFolder.second);
+	}
+}
+
+void LLInventoryPanel::dropFolderChildViews(LLFolderViewFolder* folderp)
+{
+	LLFolderViewModelItemInventory* folder_model = static_cast<LLFolderViewModelItemInventory*>(folderp->getViewModelItem());
+	if ( (!folder_model) || (mInventoryViewModel.isDeferredFolder(folder_model->getUUID())) )
+	{
+		return;
+	}
+
+	std::vector<LLFolderViewItem*> child_views(folderp->getFoldersBegin(), folderp->getFoldersEnd());
+	child_views.insert(child_views.end(), folderp->getItemsBegin(), folderp->getItemsEnd());
+	for (LLFolderViewItem* child_view : child_views)
+	{
+		if (LLFolderViewModelItemInventory* child_model = static_cast<LLFolderViewModelItemInventory*>(child_view->getViewModelItem()))
+		{
+			removeItemID(child_model->getUUID());
+		}
+		child_view->destroyView();
+	}
+
+	mInventoryViewModel.addDeferredFolder(folder_model->getUUID());
+	folder_model->dirtyDescendantsFilter();
+}
+// [/SL:KB]
+
 // bit of a hack to make sure the inventory is open.
 void LLInventoryPanel::openStartFolderOrMyInventory()
 {
@@ -1967,12 +2205,18 @@ void LLInventoryPanel::removeItemID(const LLUUID& id)
 	gInventory.collectDescendents(id, categories, items, TRUE);
 
 	mItemMap.erase(id);
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	mInventoryViewModel.removeDeferredFolder(id);
+// [/SL:KB]
 
 	for (LLInventoryModel::cat_array_t::iterator it = categories.begin(),    end_it = categories.end();
 		it != end_it;
 		++it)
 	{
 		mItemMap.erase((*it)->getUUID());
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+		mInventoryViewModel.removeDeferredFolder((*it)->getUUID());
+// [/SL:KB]
 }
 
 	for (LLInventoryModel::item_array_t::iterator it = items.begin(),   end_it  = items.end();
@@ -2007,7 +2251,10 @@ LLFolderViewFolder* LLInventoryPanel::getFolderByID(const LLUUID& id)
 
 void LLInventoryPanel::setSelectionByID( const LLUUID& obj_id, BOOL    take_keyboard_focus )
 {
-	LLFolderViewItem* itemp = getItemByID(obj_id);
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	LLFolderViewItem* itemp = buildViewsForObject(obj_id);
+// [/SL:KB]
+//	LLFolderViewItem* itemp = getItemByID(obj_id);
 	if(itemp && itemp->getViewModelItem())
 	{
 		itemp->arrangeAndSet(TRUE, take_keyboard_focus);
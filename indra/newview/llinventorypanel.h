@@ -115,6 +115,10 @@ class LLInventoryPanel : public LLPanel
         // All item and folder views will be initialized on init if true (default)
         // Will initialize on visibility change otherwise.
         Optional<bool>						preinitialize_views;
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+		// Only build the views of a folder's children once the folder is opened (or the filter needs them)
+		Optional<bool>						lazy_views;
+// [/SL:KB]
 
 		Params()
 		:	sort_order_setting("sort_order_setting"),
@@ -138,7 +142,10 @@ class LLInventoryPanel : public LLPanel
 			folder_view("folder_view"),
 			folder("folder"),
 			item("item"),
-			preinitialize_views("preinitialize_views", true)
+			preinitialize_views("preinitialize_views", true),
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+			lazy_views("lazy_views", false)
+// [/SL:KB]
 		{}
 	};
 
@@ -288,6 +295,10 @@ class LLInventoryPanel : public LLPanel
 	LLFolderViewFolder* getFolderByID(const LLUUID& id);
 	void setSelectionByID(const LLUUID& obj_id, BOOL take_keyboard_focus);
 	void updateSelection();
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	// Builds the views of the folder's direct children if they were deferred
+	void buildFolderChildViews(const LLUUID& folder_id);
+// [/SL:KB]
 
 	void setSuppressOpenItemAction(bool supress_open_item) { mSuppressOpenItemAction = supress_open_item; }
 
@@ -390,6 +401,29 @@ class LLInventoryPanel : public LLPanel
     virtual LLFolderView * createFolderRoot(LLUUID root_id );
 	virtual LLFolderViewFolder*	createFolderViewFolder(LLInvFVBridge * bridge, bool allow_drop);
 	virtual LLFolderViewItem*	createFolderViewItem(LLInvFVBridge * bridge);
+// [SL:KB] - Patch: Inventory-LazyViews | Checked: Catznip-6.7
+	// Returns the object's view, building the views of its ancestors' children as needed
+	LLFolderViewItem*			buildViewsForObject(const LLUUID& object_id);
+	bool						shouldDeferChildViews(const LLUUID& folder_id, LLFolderViewItem* folder_view_item) const;
+	// Builds the deferred views that the filter might need in time slices while it's active
+	void						updateDeferredViews();
+	// Works out which folders lead to objects whose name passes the filter
+	void						updateSearchFolders();
+	// Destroys the views of a folder's children and defers them again
+	void						dropFolderChildViews(LLFolderViewFolder* folderp);
+
+	bool						mLazyViews = false;
+	LLUUID						mBuildingFolderID;
+	// Folders (ancestors before descendants) on the way to the objects that pass the filter's name terms
+	uuid_vec_t					mSearchFolders;
+	size_t						mSearchFolderIdx = 0;
+	bool						mSearchAllFolders = false;
+	S32							mSearchFilterGeneration = -1;
+	U32							mSearchInventoryStamp = 0;
+	LLFrameTimer				mSearchUpdateTimer;
+	// Deferred folders whose views were built for the filter rather than because they were opened
+	uuid_set_t					mSearchBuiltFolders;
+// [/SL:KB]
 private:
     // buildViewsTree does not include some checks and is meant
     // for recursive use, use buildNewViews() for first call
@@ -46,7 +46,10 @@ void LLMainLoopRepeater::start(void)
 {
 	if(mQueue != 0) return;
 
-	mQueue = new LLThreadSafeQueue<LLSD>(1024);
+// [SL:KB] - Patch: Viewer-OptimizationLockFreeQueue | Checked: Catznip-6.7
+	mQueue = new LLLockFreeQueue<LLSD>(1024);
+// [/SL:KB]
+//	mQueue = new LLThreadSafeQueue<LLSD>(1024);
 	mMainLoopConnection = LLEventPumps::instance().
 		obtain("mainloop").listen(LLEventPump::inventName(), boost::bind(&LLMainLoopRepeater::onMainLoop, this, _1));
 	mRepeaterConnection = LLEventPumps::instance().
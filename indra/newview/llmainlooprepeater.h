@@ -29,7 +29,10 @@
 
 
 #include "llsd.h"
-#include "llthreadsafequeue.h"
+// [SL:KB] - Patch: Viewer-OptimizationLockFreeQueue | Checked: Catznip-6.7
+#include "lllockfreequeue.h"
+// [/SL:KB]
+//#include "llthreadsafequeue.h"
 
 
 //
@@ -54,7 +57,10 @@ class LLMainLoopRepeater:
 private:
 	LLTempBoundListener mMainLoopConnection;
 	LLTempBoundListener mRepeaterConnection;
-	LLThreadSafeQueue<LLSD> * mQueue;
+// [SL:KB] - Patch: Viewer-OptimizationLockFreeQueue | Checked: Catznip-6.7
+	LLLockFreeQueue<LLSD> * mQueue;
+// [/SL:KB]
+//	LLThreadSafeQueue<LLSD> * mQueue;
 	
 	bool onMainLoop(LLSD const &);
 	bool onMessage(LLSD const & event);
@@ -1866,29 +1866,56 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 	U32 header_size = 0;
 	if (data_size > 0)
 	{
-        std::istringstream stream;
-        try
-        {
-            std::string res_str((char*)data, data_size);
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+		// Parse straight out of the downloaded data rather than copying it into a stream (twice)
+		static const char deprecated_header[] = "<? LLSD/Binary ?>";
+		static const S32 deprecated_header_size = sizeof(deprecated_header) - 1;
 
-            std::string deprecated_header("<? LLSD/Binary ?>");
-
-            if (res_str.substr(0, deprecated_header.size()) == deprecated_header)
-            {
-                res_str = res_str.substr(deprecated_header.size() + 1, data_size);
-                header_size = deprecated_header.size() + 1;
-            }
-            data_size = res_str.size();
+		const char* header_data = reinterpret_cast<const char*>(data);
+		if ( (data_size > deprecated_header_size) && (!memcmp(header_data, deprecated_header, deprecated_header_size)) )
+		{
+			header_data += deprecated_header_size + 1;
+			data_size -= deprecated_header_size + 1;
+			header_size = deprecated_header_size + 1;
+		}
 
-            stream.str(res_str);
-        }
-        catch (std::bad_alloc&)
-        {
-            // out of memory, we won't be able to process this mesh
-            return MESH_OUT_OF_MEMORY;
-        }
+		size_t bytes_parsed = 0;
+		bool header_parsed = false;
+		try
+		{
+			header_parsed = LLSDSerialize::fromBinary(header, header_data, data_size, -1, &bytes_parsed);
+		}
+		catch (std::bad_alloc&)
+		{
+			// out of memory, we won't be able to process this mesh
+			return MESH_OUT_OF_MEMORY;
+		}
 
-		if (!LLSDSerialize::fromBinary(header, stream, data_size))
+		if (!header_parsed)
+// [/SL:KB]
+//        std::istringstream stream;
+//        try
+//        {
+//            std::string res_str((char*)data, data_size);
+//
+//            std::string deprecated_header("<? LLSD/Binary ?>");
+//
+//            if (res_str.substr(0, deprecated_header.size()) == deprecated_header)
+//            {
+//                res_str = res_str.substr(deprecated_header.size() + 1, data_size);
+//                header_size = deprecated_header.size() + 1;
+//            }
+//            data_size = res_str.size();
+//
+//            stream.str(res_str);
+//        }
+//        catch (std::bad_alloc&)
+//        {
+//            // out of memory, we won't be able to process this mesh
+//            return MESH_OUT_OF_MEMORY;
+//        }
+//
+//		if (!LLSDSerialize::fromBinary(header, stream, data_size))
 		{
 			LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
 							   << LL_ENDL;
@@ -1909,7 +1936,10 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 		// make sure there is at least one lod, function returns -1 and marks as 404 otherwise
 		else if (LLMeshRepository::getActualMeshLOD(header, 0) >= 0)
 		{
-			header_size += stream.tellg();
+// [SL:KB] - Patch: Viewer-OptimizationLLSDParser | Checked: Catznip-6.7
+			header_size += bytes_parsed;
+// [/SL:KB]
+//			header_size += stream.tellg();
 		}
 // [SL:KB] - Patch: Viewer-MeshCostCrash | Checked: Catznip-6.4
 		else
@@ -35,26 +35,61 @@ LLOutfitObserver::LLOutfitObserver() :
 	mCOFLastVersion(LLViewerInventoryCategory::VERSION_UNKNOWN)
 {
 	mItemNameHash.finalize();
-	gInventory.addObserver(this);
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	gInventory.addChangeSetObserver(this);
+// [/SL:KB]
+//	gInventory.addObserver(this);
 }
 
 LLOutfitObserver::~LLOutfitObserver()
 {
-	if (gInventory.containsObserver(this))
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	if (gInventory.containsChangeSetObserver(this))
 	{
-		gInventory.removeObserver(this);
+		gInventory.removeChangeSetObserver(this);
 	}
+// [/SL:KB]
+//	if (gInventory.containsObserver(this))
+//	{
+//		gInventory.removeObserver(this);
+//	}
 }
 
-void LLOutfitObserver::changed(U32 mask)
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+void LLOutfitObserver::changed(const LLInventoryChangeSet& changes)
 {
 	if (!gInventory.isInventoryUsable())
 		return;
 
-	checkCOF();
+	// Everything that changed this frame arrives at once; only look at the COF (and the base outfit) when they were touched.
+	// The base outfit link lives in the COF, the base outfit folder can be anywhere.
+	const LLUUID idCOF = LLAppearanceMgr::instance().getCOF();
+	const bool fFirstCheck = (LLViewerInventoryCategory::VERSION_UNKNOWN == mCOFLastVersion);
+	// Notifications that aren't tied to any object could have touched either
+	const bool fUntargeted = (changes.getObjects().empty()) && (changes.getFolders().empty());
+	const bool fCOFChanged = (changes.getFolderMask(idCOF)) || (changes.hasObject(idCOF));
+	if ( (fFirstCheck) || (fUntargeted) || (fCOFChanged) )
+	{
+		checkCOF();
+	}
 
-	checkBaseOutfit();
+	if ( (fFirstCheck) || (fUntargeted) || (fCOFChanged) ||
+	     ((mBaseOutfitId.notNull()) && ((changes.getFolderMask(mBaseOutfitId)) || (changes.hasObject(mBaseOutfitId)))) )
+	{
+		checkBaseOutfit();
+	}
 }
+// [/SL:KB]
+
+//void LLOutfitObserver::changed(U32 mask)
+//{
+//	if (!gInventory.isInventoryUsable())
+//		return;
+//
+//	checkCOF();
+//
+//	checkBaseOutfit();
+//}
 
 // static
 S32 LLOutfitObserver::getCategoryVersion(const LLUUID& cat_id)
@@ -29,19 +29,28 @@
 
 #include "llsingleton.h"
 #include "llmd5.h"
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+#include "llinventorychangeset.h"
+// [/SL:KB]
 
 /**
  * Outfit observer facade that provides simple possibility to subscribe on
  * BOF(base outfit) replaced, BOF changed, COF(current outfit) changed events.
  */
-class LLOutfitObserver: public LLInventoryObserver, public LLSingleton<LLOutfitObserver>
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+class LLOutfitObserver: public LLInventoryChangeSetObserver, public LLSingleton<LLOutfitObserver>
+// [/SL:KB]
+//class LLOutfitObserver: public LLInventoryObserver, public LLSingleton<LLOutfitObserver>
 {
 	LLSINGLETON(LLOutfitObserver);
 	virtual ~LLOutfitObserver();
 
 public:
 
-	virtual void changed(U32 mask);
+// [SL:KB] - Patch: Inventory-ChangeSet | Checked: Catznip-6.7
+	/*virtual*/ void changed(const LLInventoryChangeSet& changes);
+// [/SL:KB]
+//	virtual void changed(U32 mask);
 
 	void notifyOutfitLockChanged() { mOutfitLockChanged();  }
 
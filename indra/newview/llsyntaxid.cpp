@@ -34,6 +34,9 @@
 #include "llsdserialize.h"
 #include "llviewerregion.h"
 #include "llcorehttputil.h"
+// [SL:KB] - Patch: Viewer-OptimizationAsyncFileIO | Checked: Catznip-6.7
+#include "llasyncfileio.h"
+// [/SL:KB]
 
 //-----------------------------------------------------------------------------
 // LLSyntaxIdLSL
@@ -168,9 +171,17 @@ void LLSyntaxIdLSL::cacheFile(const std::string &fileSpec, const LLSD& content_r
     const std::string xml = str.str();
 
     // save the str to disk, usually to the cache.
-    llofstream file(fileSpec.c_str(), std::ios_base::out);
-    file.write(xml.c_str(), str.str().size());
-    file.close();
+// [SL:KB] - Patch: Viewer-OptimizationAsyncFileIO | Checked: Catznip-6.7
+    // Only called from fetchKeywordsFileCoro() so suspend the coroutine rather than the main thread while writing
+    if (LLAsyncFileIO::writeAndSuspend(fileSpec, (const U8*)xml.data(), 0, (S32)xml.size(), true) < 0)
+    {
+        LL_WARNS("SyntaxLSL") << "Unable to save syntax file as: '" << fileSpec << "'" << LL_ENDL;
+        return;
+    }
+// [/SL:KB]
+//    llofstream file(fileSpec.c_str(), std::ios_base::out);
+//    file.write(xml.c_str(), str.str().size());
+//    file.close();
 
     LL_DEBUGS("SyntaxLSL") << "Syntax file received, saving as: '" << fileSpec << "'" << LL_ENDL;
 }
@@ -828,8 +828,12 @@ void LLTextureCacheWorker::endWork(S32 param, bool aborted)
 
 //////////////////////////////////////////////////////////////////////////////
 
-LLTextureCache::LLTextureCache(bool threaded)
-	: LLWorkerThread("TextureCache", threaded),
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+LLTextureCache::LLTextureCache(bool threaded, bool use_job_system)
+	: LLWorkerThread("TextureCache", threaded, false, use_job_system),
+// [/SL:KB]
+//LLTextureCache::LLTextureCache(bool threaded)
+//	: LLWorkerThread("TextureCache", threaded),
 	  mWorkersMutex(),
 	  mHeaderMutex(),
 	  mListMutex(),
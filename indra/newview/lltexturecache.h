@@ -110,7 +110,10 @@ class LLTextureCache : public LLWorkerThread
 		}
 	};
 	
-	LLTextureCache(bool threaded);
+// [SL:KB] - Patch: Viewer-OptimizationJobSystem | Checked: Catznip-6.7
+	LLTextureCache(bool threaded, bool use_job_system = false);
+// [/SL:KB]
+//	LLTextureCache(bool threaded);
 	~LLTextureCache();
 
 	/*virtual*/ S32 update(F32 max_time_ms);	
@@ -761,6 +761,14 @@ bool handleIdleFastTimerChanged(const LLSD& sdValue)
 }
 // [/SL:KB]
 
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+bool handleTimerTraceChanged(const LLSD& sdValue)
+{
+	LLTrace::BlockTimerTrace::setEnabled(sdValue.asBoolean());
+	return true;
+}
+// [/SL:KB]
+
 bool toggle_show_object_render_cost(const LLSD& newvalue)
 {
 	LLFloaterTools::sShowObjectCost = newvalue.asBoolean();
@@ -972,6 +980,9 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("RenderAutoMuteByteLimit")->getSignal()->connect(boost::bind(&handleRenderAutoMuteByteLimitChanged, _2));
 // [SL:KB] - Patch: Viewer-OptimizationFastTimers | Checked: Catznip-6.0
 	gSavedSettings.getControl("DisableIdleFastTimer")->getSignal()->connect(boost::bind(&handleIdleFastTimerChanged, _2));
+// [/SL:KB]
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	gSavedSettings.getControl("FastTimerTraceEvents")->getSignal()->connect(boost::bind(&handleTimerTraceChanged, _2));
 // [/SL:KB]
 	gSavedPerAccountSettings.getControl("AvatarHoverOffsetZ")->getCommitSignal()->connect(boost::bind(&handleAvatarHoverOffsetChanged, _2));
 // [RLVa:KB] - Checked: 2015-12-27 (RLVa-1.5.0)
@@ -1761,6 +1761,80 @@ void slam_inventory_folder(const LLUUID& folder_id,
     AISAPI::SlamFolder(folder_id, contents, cr);
 }
 
+// [SL:KB] - Patch: Appearance-COFDiff | Checked: Catznip-6.7
+void diff_slam_inventory_folder(const LLUUID& folder_id,
+								const LLSD& contents,
+								S32 max_removals,
+								LLPointer<LLInventoryCallback> cb)
+{
+	LLInventoryModel::cat_array_t* cats; LLInventoryModel::item_array_t* items;
+	gInventory.getDirectDescendentsOf(folder_id, cats, items);
+	if ( (!items) || ((cats) && (!cats->empty())) || (!AISAPI::isAvailable()) )
+	{
+		// Unknown folder contents (or subfolders which would need to be removed recursively)
+		slam_inventory_folder(folder_id, contents, cb);
+		return;
+	}
+
+	// Links are identical if they point to the same object with the same type and description (the name always follows the linked object)
+	typedef std::tuple<LLUUID, S32, std::string> link_key_t;
+	std::multimap<link_key_t, S32> new_links;
+	for (S32 idxLink = 0, cntLink = contents.size(); idxLink < cntLink; idxLink++)
+	{
+		const LLSD& sdLink = contents[idxLink];
+		new_links.insert(std::make_pair(link_key_t(sdLink["linked_id"].asUUID(), sdLink["type"].asInteger(), sdLink["desc"].asString()), idxLink));
+	}
+
+	// Every existing link can satisfy at most one new link; everything left over on either side is removed or created
+	uuid_vec_t remove_ids;
+	for (const LLViewerInventoryItem* pItem : *items)
+	{
+		auto itLink = (pItem->getIsLinkType()) ? new_links.find(link_key_t(pItem->getLinkedUUID(), pItem->getActualType(), pItem->getActualDescription())) : new_links.end();
+		if (new_links.end() != itLink)
+			new_links.erase(itLink);
+		else
+			remove_ids.push_back(pItem->getUUID());
+	}
+
+	if ( (max_removals <= 0) || ((S32)remove_ids.size() > max_removals) )
+	{
+		// AIS can only remove one item per request so a single slam is cheaper past a point
+		slam_inventory_folder(folder_id, contents, cb);
+		return;
+	}
+
+	LL_DEBUGS(LOG_INV) << "updating folder " << folder_id << ": removing " << remove_ids.size() << " and creating " << new_links.size() << " links" << LL_ENDL;
+
+	// All new links are created in a single request
+	if (!new_links.empty())
+	{
+		std::vector<S32> link_idxs;
+		for (const auto& itLink : new_links)
+			link_idxs.push_back(itLink.second);
+		std::sort(link_idxs.begin(), link_idxs.end());
+
+		LLSD links = LLSD::emptyArray();
+		for (S32 idxLink : link_idxs)
+			links.append(contents[idxLink]);
+
+		LLSD new_inventory = LLSD::emptyMap();
+		new_inventory["links"] = links;
+		AISAPI::CreateInventory(folder_id, new_inventory, boost::bind(&doInventoryCb, cb, _1));
+	}
+
+	// Remove the stale links locally right away and let all of the changes reach the observers as one notification
+	for (const LLUUID& idItem : remove_ids)
+	{
+		AISAPI::RemoveItem(idItem, boost::bind(&doInventoryCb, cb, _1));
+		gInventory.onObjectDeletedFromServer(idItem, false, true, false);
+	}
+	if (!remove_ids.empty())
+	{
+		gInventory.notifyObservers();
+	}
+}
+// [/SL:KB]
+
 void remove_folder_contents(const LLUUID& category, bool keep_outfit_links,
 							LLPointer<LLInventoryCallback> cb)
 {
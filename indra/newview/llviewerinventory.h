@@ -459,6 +459,15 @@ void slam_inventory_folder(const LLUUID& folder_id,
 						   const LLSD& contents,
 						   LLPointer<LLInventoryCallback> cb);
 
+// [SL:KB] - Patch: Appearance-COFDiff | Checked: Catznip-6.7
+// Same end result as slam_inventory_folder() but only removes and creates the links that differ from the folder's current contents
+// (falls back to slamming the folder when more than max_removals links would need to be removed)
+void diff_slam_inventory_folder(const LLUUID& folder_id,
+								const LLSD& contents,
+								S32 max_removals,
+								LLPointer<LLInventoryCallback> cb);
+// [/SL:KB]
+
 void remove_folder_contents(const LLUUID& folder_id, bool keep_outfit_links,
 							  LLPointer<LLInventoryCallback> cb);
 
@@ -537,7 +537,10 @@ void LLViewerJointMesh::dump()
 {
 	if (mValid)
 	{
-		LL_INFOS() << "Usable LOD " << mName << LL_ENDL;
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+		LL_INFOS() << "Usable LOD " << getName() << LL_ENDL;
+// [/SL:KB]
+//		LL_INFOS() << "Usable LOD " << mName << LL_ENDL;
 	}
 }
 
@@ -8586,6 +8586,17 @@ class LLAdvancedClickRenderProfile: public view_listener_t
 	}
 };
 
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+class LLAdvancedSaveTimerTrace : public view_listener_t
+{
+	bool handleEvent(const LLSD& userdata)
+	{
+		LLAppViewer::instance()->saveTimerTrace("menu");
+		return true;
+	}
+};
+// [/SL:KB]
+
 F32 gpu_benchmark();
 
 class LLAdvancedClickRenderBenchmark: public view_listener_t
@@ -10390,6 +10401,9 @@ void initialize_menus()
 	view_listener_t::addMenu(new LLAdvancedClickRenderShadowOption(), "Advanced.ClickRenderShadowOption");
 	view_listener_t::addMenu(new LLAdvancedClickRenderProfile(), "Advanced.ClickRenderProfile");
 	view_listener_t::addMenu(new LLAdvancedClickRenderBenchmark(), "Advanced.ClickRenderBenchmark");
+// [SL:KB] - Patch: Viewer-OptimizationTimerTrace | Checked: Catznip-6.7
+	view_listener_t::addMenu(new LLAdvancedSaveTimerTrace(), "Advanced.SaveTimerTrace");
+// [/SL:KB]
 
 	#ifdef TOGGLE_HACKED_GODLIKE_VIEWER
 	view_listener_t::addMenu(new LLAdvancedHandleToggleHackedGodmode(), "Advanced.HandleToggleHackedGodmode");
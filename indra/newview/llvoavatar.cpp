@@ -44,6 +44,9 @@
 #include "llanimationstates.h"
 #include "llavatarnamecache.h"
 #include "llavatarpropertiesprocessor.h"
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+#include "llavatarimpostormanager.h"
+// [/SL:KB]
 #include "llavatarrendernotifier.h"
 #include "llcontrolavatar.h"
 #include "llexperiencecache.h"
@@ -118,6 +121,9 @@
 #include "llrendersphere.h"
 
 #include <boost/lexical_cast.hpp>
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+#include <boost/functional/hash.hpp>
+// [/SL:KB]
 
 extern F32 SPEED_ADJUST_MAX;
 extern F32 SPEED_ADJUST_MAX_SEC;
@@ -639,6 +645,10 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
 	mMeshValid(FALSE),
 	mVisible(FALSE),
 	mLastImpostorUpdateFrameTime(0.f),
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+	mImpostorRequestFrame(0),
+	mImpostorUpdatePending(false),
+// [/SL:KB]
 	mWindFreq(0.f),
 	mRipplePhase( 0.f ),
 	mBelowWater(FALSE),
@@ -664,6 +674,12 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
 	mNeedsSkin(FALSE),
 	mLastSkinTime(0.f),
 	mUpdatePeriod(1),
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+	mAnimTier(LLAvatarAnimScheduler::TIER_FULL),
+	mLastAnimUpdateFrame(0),
+	mAnimUpdatePending(false),
+	mHasRootRenderOffset(false),
+// [/SL:KB]
 	mVisualComplexityStale(true),
 	mVisuallyMuteSetting(AV_RENDER_NORMALLY),
 	mMutedAVColor(LLColor4::white /* used for "uninitialize" */),
@@ -713,6 +729,9 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
 	mNeedsExtentUpdate = true;
 
 	mImpostorDistance = 0;
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+	mImpostorAppearanceHash = 0;
+// [/SL:KB]
 	mImpostorPixelArea = 0;
 
 	setNumTEs(TEX_NUM_INDICES);
@@ -1083,6 +1102,10 @@ void LLVOAvatar::resetImpostors()
 		LLVOAvatar* avatar = (LLVOAvatar*) *iter;
 		avatar->mImpostor.release();
 		avatar->mNeedsImpostorUpdate = TRUE;
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+		avatar->mImpostorAppearanceHash = 0;
+		avatar->mImpostorUpdatePending = false;
+// [/SL:KB]
 	}
 }
 
@@ -1228,6 +1251,14 @@ LLAvatarJointMesh* LLVOAvatar::createAvatarJointMesh()
 	return new LLViewerJointMesh();
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+// virtual
+LLAvatarJointBlock* LLVOAvatar::createAvatarJointBlock(U32 num)
+{
+	return new LLAvatarJointBlockT<LLViewerJoint>(num);
+}
+// [/SL:KB]
+
 // virtual
 LLTexLayerSet* LLVOAvatar::createTexLayerSet()
 {
@@ -3690,7 +3721,10 @@ void LLVOAvatar::slamPosition()
 	{
 		gPipeline.updateMoveNormalAsync(mDrawable);
 	}
-	mRoot->updateWorldMatrixChildren();
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	updateSkeletonWorldMatrices();
+// [/SL:KB]
+//	mRoot->updateWorldMatrixChildren();
 }
 
 bool LLVOAvatar::isVisuallyMuted()
@@ -3972,6 +4006,10 @@ LLViewerInventoryItem* recursiveGetObjectInventoryItem(LLViewerObject *vobj, LLU
 
 void LLVOAvatar::updateAnimationDebugText()
 {
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+		addDebugText(llformat("Anim tier: %s (period %d)", LLAvatarAnimScheduler::getTierName(mAnimTier),
+				llmax((S32)LLAvatarAnimScheduler::getTierPeriod(mAnimTier), mUpdatePeriod)));
+// [/SL:KB]
 		for (LLMotionController::motion_list_t::iterator iter = mMotionController.getActiveMotions().begin();
 			 iter != mMotionController.getActiveMotions().end(); ++iter)
 		{
@@ -4255,6 +4293,54 @@ void LLVOAvatar::computeUpdatePeriod()
 
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+//------------------------------------------------------------------------
+// computeAnimationTier()
+// Picks how often this avatar runs a full character update based on its
+// screen size, visibility and impostor state (see LLAvatarAnimScheduler)
+//------------------------------------------------------------------------
+LLAvatarAnimScheduler::EAnimTier LLVOAvatar::computeAnimationTier()
+{
+	// Own avatar, previews and anything that's been asked to animate right away always run at full rate
+	if ( (isSelf()) || (isUIAvatar()) || (mSpecialRenderMode == 1) || (mNeedsAnimUpdate) || (sFreezeCounter) || (mDrawable.isNull()) ||
+	     (!LLAvatarAnimScheduler::isEnabled()) )
+	{
+		return LLAvatarAnimScheduler::TIER_FULL;
+	}
+
+	// Culled or occluded: the pose isn't seen, only the root needs to keep following the object
+	if (!isVisible())
+	{
+		return LLAvatarAnimScheduler::TIER_FROZEN;
+	}
+
+	if (isVisuallyMuted())
+	{
+		return LLAvatarAnimScheduler::TIER_MINIMAL;
+	}
+
+	// Impostors only need a pose when their texture gets refreshed, which computeUpdatePeriod() already paces
+	if (mUpdatePeriod >= IMPOSTOR_PERIOD)
+	{
+		if (mUpdatePeriod <= 2)
+			return LLAvatarAnimScheduler::TIER_REDUCED;
+		else if (mUpdatePeriod <= 4)
+			return LLAvatarAnimScheduler::TIER_LOW;
+		return LLAvatarAnimScheduler::TIER_MINIMAL;
+	}
+
+	const F32 pixel_area = getPixelArea();
+	for (S32 idxTier = LLAvatarAnimScheduler::TIER_FULL; idxTier < LLAvatarAnimScheduler::TIER_MINIMAL; idxTier++)
+	{
+		if (pixel_area >= LLAvatarAnimScheduler::TIER_MIN_PIXEL_AREA[idxTier])
+		{
+			return (LLAvatarAnimScheduler::EAnimTier)idxTier;
+		}
+	}
+	return LLAvatarAnimScheduler::TIER_MINIMAL;
+}
+// [/SL:KB]
+
 //------------------------------------------------------------------------
 // updateOrientation()
 // Factored out from updateCharacter()
@@ -4540,6 +4626,10 @@ void LLVOAvatar::updateRootPositionAndRotation(LLAgent& agent, F32 speed, bool w
                 // SL-315
                 mRoot->setWorldPosition( newPosition ); // regular update				
             }
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+            mRootRenderOffset = newPosition - getRenderPosition();
+            mHasRootRenderOffset = true;
+// [/SL:KB]
         }
 
 		//--------------------------------------------------------------------
@@ -4563,6 +4653,43 @@ void LLVOAvatar::updateRootPositionAndRotation(LLAgent& agent, F32 speed, bool w
 	}
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+bool LLVOAvatar::updateRootOnSkippedFrame()
+{
+	// Reuses what the last full update worked out (ground height, hover and orientation) rather than redoing it
+	if ( (isSitting()) && (getParent()) )
+	{
+		if (mDrawable.isNull())
+		{
+			return false;
+		}
+
+		LLVector3 pos = mDrawable->getPosition();
+		pos += getHoverOffset() * mDrawable->getRotation();
+		if ( (pos == mRoot->getPosition()) && (mDrawable->getRotation() == mRoot->getRotation()) )
+		{
+			return false;
+		}
+		mRoot->setPosition(pos);
+		mRoot->setRotation(mDrawable->getRotation());
+		return true;
+	}
+	else if ( (mHasRootRenderOffset) && (!isControlAvatar()) )
+	{
+		// Animated object avatars follow their volume from LLDrawable::updateXform()
+		const LLVector3 pos = getRenderPosition() + mRootRenderOffset;
+		if (pos == mRoot->getXform()->getWorldPosition())
+		{
+			return false;
+		}
+		mRoot->touch();
+		mRoot->setWorldPosition(pos);
+		return true;
+	}
+	return false;
+}
+// [/SL:KB]
+
 //------------------------------------------------------------------------
 // updateCharacter()
 //
@@ -4620,7 +4747,19 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
     // Set mUpdatePeriod and visible based on distance and other criteria.
 	//--------------------------------------------------------------------
     computeUpdatePeriod();
-    bool needs_update = (LLDrawable::getCurrentFrame()+mID.mData[0])%mUpdatePeriod == 0;
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+	mAnimTier = computeAnimationTier();
+	const U32 anim_period = llmax(LLAvatarAnimScheduler::getTierPeriod(mAnimTier), (U32)mUpdatePeriod);
+	bool needs_update = (mAnimUpdatePending) || ((LLDrawable::getCurrentFrame() + mID.mData[0]) % anim_period == 0);
+	if ( (needs_update) && (!isSelf()) )
+	{
+		// Spread updates out over several frames rather than letting them all land in the same one
+		const U32 cur_frame = LLFrameTimer::getFrameCount();
+		mAnimUpdatePending = !LLAvatarAnimScheduler::instance().requestUpdate(mAnimTier, cur_frame - mLastAnimUpdateFrame, anim_period);
+		needs_update = !mAnimUpdatePending;
+	}
+// [/SL:KB]
+//    bool needs_update = (LLDrawable::getCurrentFrame()+mID.mData[0])%mUpdatePeriod == 0;
 
 	//--------------------------------------------------------------------
 	// Early out if does not need update and not self
@@ -4628,12 +4767,29 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 	// for example, the "turn around" animation when entering customize avatar needs to trigger
 	// even when your avatar is offscreen
 	//--------------------------------------------------------------------
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
 	if (!needs_update && !isSelf())
 	{
 		updateMotions(LLCharacter::HIDDEN_UPDATE);
+		// Visible (non-impostor) avatars still have their mesh follow the object they're on or moving with, anything else
+		// waits for its next update
+		if ( (visible) && (!isImpostor()) && (updateRootOnSkippedFrame()) )
+		{
+			updateSkeletonWorldMatrices();
+		}
 		return FALSE;
 	}
 
+	// Charges the rest of the update against the frame's animation budget
+	LLAvatarAnimScheduler::LLUpdateTimer anim_timer;
+	mLastAnimUpdateFrame = LLFrameTimer::getFrameCount();
+// [/SL:KB]
+//	if (!needs_update && !isSelf())
+//	{
+//		updateMotions(LLCharacter::HIDDEN_UPDATE);
+//		return FALSE;
+//	}
+
 	//--------------------------------------------------------------------
 	// change animation time quanta based on avatar render load
 	//--------------------------------------------------------------------
@@ -4670,6 +4826,7 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
     // --------------------------------------------------------------------
     updateRootPositionAndRotation(agent, speed, was_sit_ground_constrained);
 	
+
 	//-------------------------------------------------------------------------
 	// Update character motions
 	//-------------------------------------------------------------------------
@@ -4713,7 +4870,10 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
     updateFootstepSounds();
 
 	// Update child joints as needed.
-	mRoot->updateWorldMatrixChildren();
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	updateSkeletonWorldMatrices();
+// [/SL:KB]
+//	mRoot->updateWorldMatrixChildren();
 
     if (visible)
     {
@@ -4821,7 +4981,10 @@ void LLVOAvatar::debugBodySize() const
 //------------------------------------------------------------------------
 void LLVOAvatar::postPelvisSetRecalc()
 {		
-	mRoot->updateWorldMatrixChildren();			
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	updateSkeletonWorldMatrices();
+// [/SL:KB]
+//	mRoot->updateWorldMatrixChildren();
 	computeBodySize();
 	dirtyMesh(2);
 }
@@ -7096,7 +7259,10 @@ void LLVOAvatar::updateVisualParams()
 	{
 		computeBodySize();
 		mLastSkeletonSerialNum = mSkeletonSerialNum;
-		mRoot->updateWorldMatrixChildren();
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+		updateSkeletonWorldMatrices();
+// [/SL:KB]
+//		mRoot->updateWorldMatrixChildren();
 	}
 
 	dirtyMesh();
@@ -7752,7 +7918,10 @@ void LLVOAvatar::sitOnObject(LLViewerObject *sit_object)
 	mRoot->getXform()->setParent(&sit_object->mDrawable->mXform); // LLVOAvatar::sitOnObject
 	// SL-315
 	mRoot->setPosition(getPosition());
-	mRoot->updateWorldMatrixChildren();
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	updateSkeletonWorldMatrices();
+// [/SL:KB]
+//	mRoot->updateWorldMatrixChildren();
 
 	stopMotion(ANIM_AGENT_BODY_NOISE);
 	
@@ -10454,13 +10623,35 @@ void LLVOAvatar::updateImpostors()
 	LLViewerCamera::sCurCameraID = LLViewerCamera::CAMERA_WORLD;
 
     std::vector<LLCharacter*> instances_copy = LLCharacter::sInstances;
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+	if (LLAvatarImpostorManager::isEnabled())
+	{
+		static std::vector<LLVOAvatar*> s_impostor_avatars;
+		s_impostor_avatars.clear();
+		for (LLCharacter* character : instances_copy)
+		{
+			LLVOAvatar* avatar = (LLVOAvatar*)character;
+			if ( (!avatar->isDead()) && (avatar->isVisible()) && ((avatar->isImpostor()) || (LLVOAvatar::AV_DO_NOT_RENDER == avatar->getVisualMuteSettings())) )
+			{
+				s_impostor_avatars.push_back(avatar);
+			}
+		}
+		LLAvatarImpostorManager::instance().updateImpostors(s_impostor_avatars);
+
+		LLCharacter::sAllowInstancesChange = TRUE;
+		return;
+	}
+// [/SL:KB]
 	for (std::vector<LLCharacter*>::iterator iter = instances_copy.begin();
 		iter != instances_copy.end(); ++iter)
 	{
 		LLVOAvatar* avatar = (LLVOAvatar*) *iter;
 		if (!avatar->isDead() && avatar->isVisible()
 			&& (
-                (avatar->isImpostor() || LLVOAvatar::AV_DO_NOT_RENDER == avatar->getVisualMuteSettings()) && avatar->needsImpostorUpdate())
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+                (avatar->isImpostor() || LLVOAvatar::AV_DO_NOT_RENDER == avatar->getVisualMuteSettings()) && (avatar->needsImpostorUpdate() || avatar->mImpostorUpdatePending))
+// [/SL:KB]
+//                (avatar->isImpostor() || LLVOAvatar::AV_DO_NOT_RENDER == avatar->getVisualMuteSettings()) && avatar->needsImpostorUpdate())
             )
 		{
             avatar->calcMutedAVColor();
@@ -10505,8 +10696,88 @@ void LLVOAvatar::setImpostorDim(const LLVector2& dim)
 void LLVOAvatar::cacheImpostorValues()
 {
 	getImpostorValues(mImpostorExtents, mImpostorAngle, mImpostorDistance);
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+	mImpostorViewDir = LLViewerCamera::getInstance()->getOrigin() - (getRenderPosition() + mImpostorOffset);
+	mImpostorViewDir.normalize();
+	mImpostorAppearanceHash = computeImpostorAppearanceHash();
+	mImpostorRequestFrame = 0;
+	mImpostorUpdatePending = false;
+// [/SL:KB]
 }
 
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+// Hash of everything that changes what an impostor looks like other than the camera and pose (which are checked separately). Only
+// state that visibly changes the impostor goes in, anything that keeps changing while an avatar loads would keep asking for new ones.
+size_t LLVOAvatar::computeImpostorAppearanceHash()
+{
+	// Impostors are small enough that a bake at a quarter of its resolution looks the same as the full one
+	const S32 IMPOSTOR_MAX_DISCARD = 2;
+
+	size_t seed = 0;
+	for (U32 idx = 0; idx < mBakedTextureDatas.size(); idx++)
+	{
+		const LLViewerTexture* imagep = getImage(mBakedTextureDatas[idx].mTextureIndex, 0);
+		if (imagep)
+		{
+			const S32 discard_level = imagep->getDiscardLevel();
+			boost::hash_combine(seed, imagep->getID());
+			boost::hash_combine(seed, (discard_level >= 0) && (discard_level <= IMPOSTOR_MAX_DISCARD));
+		}
+	}
+
+	for (const auto& attachment_point : mAttachmentPoints)
+	{
+		const LLViewerJointAttachment* attachment = attachment_point.second;
+		for (const auto& attached_object : attachment->mAttachedObjects)
+		{
+			// The object CRC changes with every update (including moves) so only attaching and detaching counts
+			if (attached_object.notNull())
+			{
+				boost::hash_combine(seed, attached_object->getID());
+			}
+		}
+	}
+
+	boost::hash_combine(seed, (S32)getVisualMuteSettings());
+	boost::hash_combine(seed, isVisuallyMuted());
+	boost::hash_combine(seed, isTooComplex());
+	for (U32 idx = 0; idx < 4; idx++)
+	{
+		boost::hash_combine(seed, mMutedAVColor.mV[idx]);
+	}
+	return seed;
+}
+
+bool LLVOAvatar::isImpostorReusable(F32 min_view_cos) const
+{
+	if ( (!mImpostor.isComplete()) || (mImpostorDistance <= 0.f) || (mDrawable.isNull()) )
+	{
+		return false;
+	}
+
+	// Camera direction and distance
+	LLVector3 view_dir = LLViewerCamera::getInstance()->getOrigin() - (getRenderPosition() + mImpostorOffset);
+	const F32 distance = view_dir.normalize();
+	if ( (view_dir * mImpostorViewDir < min_view_cos) || (fabsf(distance - mImpostorDistance) / mImpostorDistance > 0.1f) )
+	{
+		return false;
+	}
+
+	// Pose (same test as idleUpdateMisc())
+	LL_ALIGN_16(LLVector4a ext[2]);
+	ext[0].load3(mLastAnimExtents[0].mV);
+	ext[1].load3(mLastAnimExtents[1].mV);
+	LLVector4a diff;
+	diff.setSub(ext[1], mImpostorExtents[1]);
+	if (diff.getLength3().getF32() > 0.05f)
+	{
+		return false;
+	}
+	diff.setSub(ext[0], mImpostorExtents[0]);
+	return diff.getLength3().getF32() <= 0.05f;
+}
+// [/SL:KB]
+
 void LLVOAvatar::getImpostorValues(LLVector4a* extents, LLVector3& angle, F32& distance) const
 {
 	const LLVector4a* ext = mDrawable->getSpatialExtents();
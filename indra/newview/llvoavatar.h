@@ -53,6 +53,9 @@
 #include "llviewerstats.h"
 #include "llvovolume.h"
 #include "llavatarrendernotifier.h"
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+#include "llavataranimscheduler.h"
+// [/SL:KB]
 
 extern const LLUUID ANIM_AGENT_BODY_NOISE;
 extern const LLUUID ANIM_AGENT_BREATHE_ROT;
@@ -272,6 +275,12 @@ class LLVOAvatar :
 	virtual BOOL 	updateCharacter(LLAgent &agent);
     void			updateFootstepSounds();
     void			computeUpdatePeriod();
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+	LLAvatarAnimScheduler::EAnimTier computeAnimationTier();
+	LLAvatarAnimScheduler::EAnimTier getAnimationTier() const { return mAnimTier; }
+	// Keeps the root following the object on frames the avatar isn't animated; returns true if the root moved
+	bool			updateRootOnSkippedFrame();
+// [/SL:KB]
     void			updateOrientation(LLAgent &agent, F32 speed, F32 delta_time);
     void			updateTimeStep();
     void			updateRootPositionAndRotation(LLAgent &agent, F32 speed, bool was_sit_ground_constrained);
@@ -412,6 +421,9 @@ class LLVOAvatar :
 	/*virtual*/ LLAvatarJoint*	createAvatarJoint(); // Returns LLViewerJoint
 	/*virtual*/ LLAvatarJoint*	createAvatarJoint(S32 joint_num); // Returns LLViewerJoint
 	/*virtual*/ LLAvatarJointMesh*	createAvatarJointMesh(); // Returns LLViewerJointMesh
+// [SL:KB] - Patch: Viewer-OptimizationSkeleton | Checked: Catznip-6.7
+	/*virtual*/ LLAvatarJointBlock*	createAvatarJointBlock(U32 num); // Returns a block of LLViewerJoint
+// [/SL:KB]
 public:
 	void				updateHeadOffset();
     void				debugBodySize() const;
@@ -507,6 +519,13 @@ class LLVOAvatar :
 	F32			mLastSkinTime; //value of gFrameTimeSeconds at last skin update
 
 	S32	 		mUpdatePeriod;
+// [SL:KB] - Patch: Viewer-OptimizationAnimLOD | Checked: Catznip-6.7
+	LLAvatarAnimScheduler::EAnimTier mAnimTier;
+	U32			mLastAnimUpdateFrame;	// LLFrameTimer frame count of the last full character update
+	bool		mAnimUpdatePending;		// An update came due but was deferred by the animation budget
+	bool		mHasRootRenderOffset;	// mRootRenderOffset was set by a full update
+	LLVector3	mRootRenderOffset;		// Root position relative to the render position as of the last full update
+// [/SL:KB]
 	S32  		mNumInitFaces; //number of faces generated when creating the avatar drawable, does not inculde splitted faces due to long vertex buffer.
 
 	// the isTooComplex method uses these mutable values to avoid recalculating too frequently
@@ -596,6 +615,14 @@ class LLVOAvatar :
 // [/SL:KB]
 //	BOOL		mNeedsImpostorUpdate;
 	F32SecondsImplicit mLastImpostorUpdateFrameTime;
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+	size_t		computeImpostorAppearanceHash();
+	size_t		getImpostorAppearanceHash() const { return mImpostorAppearanceHash; }
+	// Returns true if the current impostor still matches the camera position (within the angle whose cosine is passed in)
+	bool		isImpostorReusable(F32 min_view_cos) const;
+	U32			mImpostorRequestFrame;	// Frame count when the pending impostor update was first requested (0 if none)
+	bool		mImpostorUpdatePending;	// A regeneration was deferred; the current (outdated) impostor keeps being drawn until it happens
+// [/SL:KB]
     const LLVector3*  getLastAnimExtents() const { return mLastAnimExtents; }
 	void		setNeedsExtentUpdate(bool val) { mNeedsExtentUpdate = val; }
 
@@ -609,6 +636,10 @@ class LLVOAvatar :
 	LLVector3	mImpostorAngle;
 	F32			mImpostorDistance;
 	F32			mImpostorPixelArea;
+// [SL:KB] - Patch: Viewer-OptimizationImpostors | Checked: Catznip-6.7
+	LLVector3	mImpostorViewDir;			// Direction from the avatar to the camera when the impostor was generated
+	size_t		mImpostorAppearanceHash;	// Appearance hash when the impostor was generated
+// [/SL:KB]
 	LLVector3	mLastAnimExtents[2];  
 	LLVector3	mLastAnimBasePos;
 	
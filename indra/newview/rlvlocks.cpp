@@ -1078,10 +1078,7 @@ bool RlvFolderLocks::getLockedItems(const LLUUID& idFolder, LLInventoryModel::it
 		// Check the parent folders of any links to this item that exist under #RLV
 		if (!fItemLocked)
 		{
-			LLInventoryModel::item_array_t itemLinks;
-			LLInventoryModel::cat_array_t cats;
-			LLLinkedItemIDMatches f(pItem->getUUID());
-			gInventory.collectDescendentsIf(RlvInventory::instance().getSharedRootID(), cats, itemLinks, LLInventoryModel::EXCLUDE_TRASH, f);
+			LLInventoryModel::item_array_t itemLinks = gInventory.collectLinksTo(pItem->getUUID(), RlvInventory::instance().getSharedRootID());
 
 			for (LLInventoryModel::item_array_t::iterator itItemLink = itemLinks.begin(); 
 					(itItemLink < itemLinks.end()) && (!fItemLocked); ++itItemLink)
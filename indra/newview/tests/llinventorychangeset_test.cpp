@@ -0,0 +1,196 @@
+/**
+ * @file llinventorychangeset_test.cpp
+ * @brief LLInventoryChangeSet and LLInventoryChangeSetObserver unit tests
+ *
+ * $LicenseInfo:firstyear=2020&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2020, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+// llinventoryobserver.h relies on the precompiled header for these
+#include "lltimer.h"
+#include <boost/function.hpp>
+
+#include "../llinventorychangeset.h"
+
+#include <map>
+
+namespace
+{
+	// Records every delivery
+	class LLTestChangeSetObserver : public LLInventoryChangeSetObserver
+	{
+	public:
+		LLTestChangeSetObserver(U32 mask = LLInventoryObserver::ALL) : LLInventoryChangeSetObserver(mask), mCallCount(0) {}
+
+		/*virtual*/ void changed(const LLInventoryChangeSet& changes)
+		{
+			mCallCount++;
+			mLastChanges = changes;
+		}
+
+		S32                  mCallCount;
+		LLInventoryChangeSet mLastChanges;
+	};
+}
+
+namespace tut
+{
+	struct changeset
+	{
+		// A small tree: root > (folder_a > (item_a, folder_sub > item_sub), folder_b > item_b)
+		changeset()
+		{
+			mRoot.generate();
+			mFolderA.generate();
+			mFolderB.generate();
+			mFolderSub.generate();
+			mItemA.generate();
+			mItemB.generate();
+			mItemSub.generate();
+			mParents[mFolderA] = mRoot;
+			mParents[mFolderB] = mRoot;
+			mParents[mFolderSub] = mFolderA;
+			mParents[mItemA] = mFolderA;
+			mParents[mItemB] = mFolderB;
+			mParents[mItemSub] = mFolderSub;
+
+			mIsDescendent = [parents = mParents](const LLUUID& object_id, const LLUUID& folder_id)
+				{
+					for (auto itParent = parents.find(object_id); parents.end() != itParent; itParent = parents.find(itParent->second))
+					{
+						if (folder_id == itParent->second)
+							return true;
+					}
+					return false;
+				};
+		}
+
+		LLUUID mRoot, mFolderA, mFolderB, mFolderSub, mItemA, mItemB, mItemSub;
+		std::map<LLUUID, LLUUID> mParents;
+		LLInventoryChangeSetObserver::descendent_check_t mIsDescendent;
+	};
+
+	typedef test_group<changeset> changeset_t;
+	typedef changeset_t::object changeset_object_t;
+	tut::changeset_t tut_changeset("LLInventoryChangeSet");
+
+	template<> template<>
+	void changeset_object_t::test<1>()
+	{
+		set_test_name("Subtree filtering");
+
+		LLInventoryChangeSet changes;
+		changes.add(LLInventoryObserver::LABEL, mItemSub, mFolderSub, LLAssetType::AT_NOTECARD);
+		changes.add(LLInventoryObserver::LABEL, mItemB, mFolderB, LLAssetType::AT_NOTECARD);
+		// No longer in the model; only the recorded parent places it in the subtree
+		LLUUID idRemoved;
+		idRemoved.generate();
+		changes.add(LLInventoryObserver::REMOVE, idRemoved, mFolderA, LLAssetType::AT_OBJECT);
+		// The old parent of an item that moved from folder_a to folder_b
+		changes.addFolder(LLInventoryObserver::STRUCTURE, mFolderA);
+
+		LLTestChangeSetObserver observer;
+		observer.addSubtree(mFolderA);
+		observer.collectChanges(changes, mIsDescendent);
+		ensure("delivered", observer.deliverChanges());
+		ensure_equals("one call", observer.mCallCount, 1);
+
+		const LLInventoryChangeSet& delivered = observer.mLastChanges;
+		ensure("descendent passes", delivered.hasObject(mItemSub));
+		ensure("outside the subtree is dropped", !delivered.hasObject(mItemB));
+		ensure("removed object goes by its parent", delivered.hasObject(idRemoved));
+		ensure_equals("old parent summary", delivered.getFolderMask(mFolderA), (U32)(LLInventoryObserver::REMOVE | LLInventoryObserver::STRUCTURE));
+		ensure_equals("no summary outside the subtree", delivered.getFolderMask(mFolderB), (U32)LLInventoryObserver::NONE);
+		ensure_equals("mask", delivered.getMask(), (U32)(LLInventoryObserver::LABEL | LLInventoryObserver::REMOVE | LLInventoryObserver::STRUCTURE));
+	}
+
+	template<> template<>
+	void changeset_object_t::test<2>()
+	{
+		set_test_name("Type and mask filtering");
+
+		LLInventoryChangeSet changes;
+		changes.add(LLInventoryObserver::LABEL, mItemA, mFolderA, LLAssetType::AT_CLOTHING);
+		changes.add(LLInventoryObserver::INTERNAL, mItemB, mFolderB, LLAssetType::AT_CLOTHING);
+		changes.add(LLInventoryObserver::LABEL, mItemSub, mFolderSub, LLAssetType::AT_NOTECARD);
+		changes.add(LLInventoryObserver::LABEL, mFolderSub, mFolderA, LLAssetType::AT_CATEGORY);
+
+		LLTestChangeSetObserver observer(LLInventoryObserver::LABEL);
+		observer.addItemType(LLAssetType::AT_CLOTHING);
+		observer.collectChanges(changes, mIsDescendent);
+		ensure("delivered", observer.deliverChanges());
+
+		const LLInventoryChangeSet& delivered = observer.mLastChanges;
+		ensure("matching type and mask", delivered.hasObject(mItemA));
+		ensure("mask excludes", !delivered.hasObject(mItemB));
+		ensure("type excludes", !delivered.hasObject(mItemSub));
+		ensure("folders need AT_CATEGORY", !delivered.hasObject(mFolderSub));
+		ensure_equals("only the matching change", delivered.getObjects().size(), (size_t)1);
+
+		// Nothing of interest means no call at all
+		LLInventoryChangeSet unrelated;
+		unrelated.add(LLInventoryObserver::LABEL, mItemSub, mFolderSub, LLAssetType::AT_NOTECARD);
+		observer.collectChanges(unrelated, mIsDescendent);
+		ensure("nothing to deliver", !observer.deliverChanges());
+		ensure_equals("still one call", observer.mCallCount, 1);
+	}
+
+	template<> template<>
+	void changeset_object_t::test<3>()
+	{
+		set_test_name("Per-frame coalescing");
+
+		LLTestChangeSetObserver observer;
+
+		// Several notifyObservers() during a single frame
+		LLInventoryChangeSet first;
+		first.add(LLInventoryObserver::ADD, mItemA, mFolderA, LLAssetType::AT_OBJECT);
+		observer.collectChanges(first, mIsDescendent);
+
+		LLInventoryChangeSet second;
+		second.add(LLInventoryObserver::LABEL, mItemA, mFolderB, LLAssetType::AT_OBJECT);
+		second.add(LLInventoryObserver::ADD, mItemB, mFolderB, LLAssetType::AT_OBJECT);
+		observer.collectChanges(second, mIsDescendent);
+
+		LLInventoryChangeSet third;
+		third.addMask(LLInventoryObserver::REBUILD);
+		observer.collectChanges(third, mIsDescendent);
+
+		ensure_equals("nothing until delivery", observer.mCallCount, 0);
+		ensure("delivered", observer.deliverChanges());
+		ensure_equals("a single call for the frame", observer.mCallCount, 1);
+		ensure("pending set was handed over", observer.getPendingChanges().isEmpty());
+
+		const LLInventoryChangeSet& delivered = observer.mLastChanges;
+		ensure_equals("two objects", delivered.getObjects().size(), (size_t)2);
+		const LLInventoryChangeSet::LLObjectChange& change = delivered.getObjects().find(mItemA)->second;
+		ensure_equals("masks merge", change.mMask, (U32)(LLInventoryObserver::ADD | LLInventoryObserver::LABEL));
+		ensure("first parent is kept", change.mParentID == mFolderA);
+		ensure_equals("untargeted mask comes through", delivered.getMask() & LLInventoryObserver::REBUILD, (U32)LLInventoryObserver::REBUILD);
+
+		ensure("nothing left for the next frame", !observer.deliverChanges());
+		ensure_equals("still one call", observer.mCallCount, 1);
+	}
+}
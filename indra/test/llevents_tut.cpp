@@ -509,4 +509,83 @@ void events_object::test<11>()
     heaptest.post(2);
 }
 
+template<> template<>
+void events_object::test<12>()
+{
+    set_test_name("fast dispatch");
+    LLEventPump& fast(pumps.obtain("fastdispatch"));
+    fast.setFastDispatch(true);
+    listener0.reset(0);
+    listener1.reset(0);
+    // listener1 goes first and stops the event from reaching listener0
+    LLBoundListener conn0 = listener0.listenTo(fast);
+    LLBoundListener conn1 = listener1.listenTo(fast, &Listener::callstop,
+                                               LLEventPump::empty, make<LLEventPump::NameList>(list_of(listener0.getName())));
+    ensure("handled", fast.post(1));
+    check_listener("first", listener1, 1);
+    check_listener("stopped", listener0, 0);
+    {
+        LLEventPump::Blocker block(conn1);
+        ensure("not handled", ! fast.post(2));
+        check_listener("blocked", listener1, 1);
+        check_listener("unblocked", listener0, 2);
+    }
+    conn1.disconnect();
+    fast.post(3);
+    check_listener("disconnected", listener1, 1);
+    check_listener("after disconnect", listener0, 3);
+    fast.stopListening(listener0.getName());
+    fast.post(4);
+    check_listener("stopped listening", listener0, 3);
+
+    // trackable listeners disconnect as usual
+    bool live = false;
+    {
+        TempTrackableListener tempListener("temp", live);
+        fast.listen(tempListener.getName(), boost::bind(&TempTrackableListener::call, boost::ref(tempListener), _1));
+        fast.post(5);
+        check_listener("trackable", tempListener, 5);
+    }
+    fast.post(6);
+
+    // listeners connected before fast dispatch was turned on still get called
+    LLEventPump& slow(pumps.obtain("slowdispatch"));
+    listener0.reset(0);
+    listener0.listenTo(slow);
+    slow.setFastDispatch(true);
+    slow.post(7);
+    check_listener("unknown listener", listener0, 7);
+    slow.stopListening(listener0.getName());
+    listener0.listenTo(slow);
+    slow.post(8);
+    check_listener("known listener", listener0, 8);
+}
+
+template<> template<>
+void events_object::test<13>()
+{
+    set_test_name("LLEventPumpHandle");
+    LLEventPumpHandle<> handle("pumphandle");
+    ensure("no pump yet", ! handle.get());
+    ensure("nothing posted", ! handle.post(0));
+    LLEventPump& pump(handle.obtain());
+    ensure_equals("obtain", handle.get(), &pump);
+    ensure_equals("registered", pumps.find("pumphandle"), &pump);
+    listener0.reset(0);
+    listener0.listenTo(pump, &Listener::callstop);
+    ensure("posted", handle.post(1));
+    check_listener("received", listener0, 1);
+    pump.stopListening(listener0.getName());
+
+    LLEventPumpHandle<LLEventMailDrop> typed("pumphandle");
+    ensure("wrong type", ! typed.get());
+
+    LLEventPumpHandle<LLEventStream> local("pumphandlelocal");
+    {
+        LLEventStream stream("pumphandlelocal");
+        ensure_equals("local pump", local.get(), &stream);
+    }
+    ensure("local pump gone", ! local.get());
+}
+
 } // namespace tut
@@ -740,33 +740,54 @@ namespace tut
 		
 		{
 			SDAllocationCheck check("assign integer value", 1);
-			LLSD v = 45;
-			v = 33;
+			LLSD v = 4500;
+			v = 3300;
 			v = 0;
 		}
 
 		{
 			SDAllocationCheck check("copy construct integer", 1);
-			LLSD v = 45;
+			LLSD v = 4500;
 			LLSD w = v;
 		}
 
 		{
 			SDAllocationCheck check("assign integer", 1);
-			LLSD v = 45;
+			LLSD v = 4500;
 			LLSD w;
 			w = v;
 		}
 		
 		{
 			SDAllocationCheck check("avoids extra clone", 2);
-			LLSD v = 45;
+			LLSD v = 4500;
 			LLSD w = v;
 			w = "nice day";
 		}
 
 		{
-			SDAllocationCheck check("shared values test for threaded work", 9);
+			SDAllocationCheck check("shared small values", 0);
+			LLSD v = 45;
+			v = 33;
+			LLSD w = true;
+			w = false;
+			LLSD s = "";
+			LLSD u = LLUUID::null;
+		}
+
+		{
+			SDAllocationCheck check("shared values are never modified", 1);
+			LLSD v = 45;
+			LLSD w = 45;
+			v = 33;
+			ensure_equals("shared value unchanged", w.asInteger(), 45);
+			w = 4500;
+			v = 45;
+			ensure_equals("shared value still unchanged", v.asInteger(), 45);
+		}
+
+		{
+			SDAllocationCheck check("shared values test for threaded work", 7);
 
 			//U32 start_llsd_count = LLSD::outstandingCount();
 
@@ -774,7 +795,7 @@ namespace tut
 
 			m["one"] = 1;
 			m["two"] = 2;
-			m["one_copy"] = m["one"];			// 3 (m, "one" and "two")
+			m["one_copy"] = m["one"];			// 1 (m, small integers are shared)
 
 			m["undef_one"] = LLSD();
 			m["undef_two"] = LLSD();
@@ -784,16 +805,16 @@ namespace tut
 				LLSD first_array = LLSD::emptyArray();
 				first_array.append(1.0f);
 				first_array.append(2.0f);			
-				first_array.append(3.0f);			// 7
+				first_array.append(3.0f);			// 5
 
 				m["array"] = first_array;
 				m["array_clone"] = first_array;
-				m["array_copy"] = m["array"];		// 7
+				m["array_copy"] = m["array"];		// 5
 			}
 
 			m["string_one"] = "string one value";
 			m["string_two"] = "string two value";
-			m["string_one_copy"] = m["string_one"];		// 9
+			m["string_one_copy"] = m["string_one"];		// 7
 
 			//U32 llsd_object_count = LLSD::outstandingCount();
 			//std::cout << "Using " << (llsd_object_count - start_llsd_count) << " LLSD objects" << std::endl;